@@ -1,5 +1,8 @@
 var Event          = require('./models/Event');
 var EventScheduler = require('./lib/EventScheduler');
+var IngestStats    = require('./lib/IngestStats');
+var LatencyRecord  = require('./models/LatencyRecord');
+var OtaSession     = require('./lib/OtaSession');
 var Outlet         = require('./models/Outlet');
 var SensorRecord   = require('./models/SensorRecord');
 var SP             = require('serialport');
@@ -21,6 +24,46 @@ const ACTION_ACK_MESSAGE    = 7;
 const HANDSHAKE_MESSAGE     = 8;
 const HANDSHAKE_ACK_MESSAGE = 9;
 const HEARTBEAT_MESSAGE		= 10;
+const ENERGY_MESSAGE        = 11;
+const CONFIG_MESSAGE        = 12;
+const CONFIG_ACK_MESSAGE    = 13;
+const GROUP_ACTION_MESSAGE  = 15;
+const SYNC_MESSAGE          = 16;
+const OTA_REPORT_MESSAGE    = 21;
+const WATT_SECONDS_PER_WH   = 3600;
+
+// Node configuration parameters (name => id sent in a CONFIG message)
+const CONFIG_PARAMS = {
+	pwr_period: 1,
+	temp_period: 2,
+	light_period: 3,
+	pwr_deadband: 4,
+	temp_deadband: 5,
+	light_deadband: 6,
+	heartbeat: 7,
+	groups: 8
+};
+const CONFIG_OK             = 0;
+// CONFIG command id and value are sent as two 7-bit bytes (high bit set) so a
+// '\r' byte can never appear in the middle of the packet.
+const MAX_CONFIG_VALUE      = 1 << 14;
+// Group ids are 1..MAX_GROUP_ID, an outlet's memberships are sent as one bit per
+// group in the 'groups' config parameter.
+const MAX_GROUP_ID          = 14;
+// How long members of a group get to ack a group action (they spread their acks
+// out) before the outlets that didn't are sent their own action.
+const GROUP_ACK_TIMEOUT_MS  = 10000;
+// How long an action's send time is kept waiting for acks (for latency tracing)
+const ACTION_TRACE_TIMEOUT_MS = 60000;
+// A restarted gateway rebuilds its node table from the traffic it hears, so its
+// state sync is requested once every outlet has had a liveness timeout (twelve
+// 5 s heartbeat periods) to be heard.
+const SYNC_SETTLE_MS        = 60000;
+// How long a gateway gets to answer a sync request after a RESET before every
+// outlet is marked inactive (gateways without sync support never answer).
+const SYNC_TIMEOUT_MS       = 10000;
+// Sync request ids are sent as one 7-bit byte with the high bit set
+const MAX_SYNC_ID           = 128;
 
 // Intermediate States
 CREATING_NEW_OUTLET     = 1;
@@ -31,6 +74,12 @@ REACTIVATING_OUTLET     = 3
 var gSerialPort = null;
 var gWatchdogTimer = null;
 var gCache = {};
+var gConfigCommandId = 0;
+var gActionCommandId = 0;
+var gActionTraces = {}; // cmd_id => {sentAt, group}
+var gSyncId = 0;
+var gSyncTimer = null;
+var gOtaSession = null; // the firmware update in progress, if any
 
 /*
  * Returns True if we have made a successful connection to the gateway,
@@ -73,19 +122,23 @@ function saveSensorData(macAddress, power, temperature, light, status) {
 	    }
 
 	    console.log(`Outlet ${macAddress} updated.`);
-	    return outlet.save();
+	    return IngestStats.timeWrite('outlets', outlet.save());
 	  }).catch(console.error);
 }
 
-function saveTimeSeriesData(outlet) {
+/*
+ * Saves the outlet's current sensor values as a time series record. 'age' is
+ * how many seconds ago the values were sampled (set for batched data).
+ */
+function saveTimeSeriesData(outlet, age) {
 	var newRecord = new SensorRecord({
-		timestamp: outlet.last_updated,
+		timestamp: new Date(outlet.last_updated.getTime() - (age || 0) * 1000),
 		mac_address: outlet.mac_address,
 		cur_temperature: outlet.cur_temperature,
 		cur_light: outlet.cur_light,
 		cur_power: outlet.cur_power
 	});
-	return newRecord.save().then( () => outlet);
+	return IngestStats.timeWrite('sensor_records', newRecord.save()).then( () => outlet);
 }
 
 /*
@@ -96,8 +149,9 @@ function handleSensorDataMessage(macAddress, payload) {
 	// Parse sensor data, convert to ints
   var sensorValues = payload.split(',').map(value => parseInt(value));
 
-  // We're expecting five values: power, temp, light, (eventually status).
-  if (sensorValues.length !== 4) {
+  // We're expecting four values: power, temp, light, status, and optionally the
+  // age of the sample in seconds (data expanded from a batch by the gateway).
+  if (sensorValues.length !== 4 && sensorValues.length !== 5) {
     throw new Error(`Invalid number of sensor values in packet: ${sensorValues}`);
   }
 
@@ -106,15 +160,17 @@ function handleSensorDataMessage(macAddress, payload) {
       temperature = sensorValues[1] / 10, // 245 => 24.5 deg
       light = sensorValues[2],
       status = (sensorValues[3] === 0) ? 'OFF' : 'ON';
+  var age = sensorValues[4] || 0;
 
   return saveSensorData(macAddress, power, temperature, light, status)
-  	.then( outlet => saveTimeSeriesData(outlet))
+  	.then( outlet => saveTimeSeriesData(outlet, age))
   	.then(EventScheduler.triggerCommandsFromEvents)
   	.then( commands => {
   		if (commands.length > 0) {
   			console.log('Triggering commands: ', commands);
 	  		// Send and action to the gateway for each command object given
-	  		var commandPromises = commands.map(c => sendAction(c.destMacAddress, c.action));
+	  		var commandPromises = commands.map(c => (c.group) ?
+	  			actuateGroup(c.group, c.action) : sendAction(c.destMacAddress, c.action));
 	  		// Wait until all actions are sent.
 	  		return Promise.all(commandPromises);
   		} else {
@@ -125,6 +181,64 @@ function handleSensorDataMessage(macAddress, payload) {
   	.catch(console.error);
 }
 
+/*
+ * Handle an Energy Message. Nodes send this at the end of every reporting
+ * window with their cumulative energy (watt-seconds since boot) and the
+ * minimum/maximum power seen in the window.
+ * @returns Promise<Outlet> updated outlet data
+ */
+function handleEnergyMessage(macAddress, payload) {
+	var payloadValues = payload.split(',').map(value => parseInt(value));
+	if (payloadValues.length !== 3) {
+		return Promise.reject(new Error(`Invalid number of energy values in packet: ${payloadValues}`));
+	}
+
+	return Outlet.find({mac_address: macAddress}).exec()
+		.then( outlets => {
+			if (outlets.length == 0) {
+				throw new Error(`Outlet does not exist for MAC Address: ${macAddress}`);
+			}
+			var outlet = outlets[0];
+			outlet.energy = payloadValues[0] / WATT_SECONDS_PER_WH;
+			outlet.window_power_min = payloadValues[1];
+			outlet.window_power_max = payloadValues[2];
+			return IngestStats.timeWrite('outlets', outlet.save());
+		}).catch(console.error);
+}
+
+/*
+ * Handle a Config Ack Message. Saves the value the node is now using for the
+ * parameter (the old value if the node rejected the new one).
+ * @returns Promise<Outlet> updated outlet data
+ */
+function handleConfigAckMessage(macAddress, payload) {
+	// "cmd_id,param,value,status"
+	var payloadValues = payload.split(',').map(value => parseInt(value));
+	if (payloadValues.length !== 4) {
+		return Promise.reject(new Error(`Invalid number of config values in packet: ${payloadValues}`));
+	}
+	var paramId = payloadValues[1],
+	    value = payloadValues[2],
+	    status = payloadValues[3];
+	var param = Object.keys(CONFIG_PARAMS).find(name => CONFIG_PARAMS[name] === paramId);
+	if (!param) {
+		return Promise.reject(new Error(`Unknown config parameter: ${paramId}`));
+	}
+
+	return Outlet.find({mac_address: macAddress}).exec()
+		.then( outlets => {
+			if (outlets.length == 0) {
+				throw new Error(`Outlet does not exist for MAC Address: ${macAddress}`);
+			}
+			var outlet = outlets[0];
+			if (status !== CONFIG_OK) {
+				console.warn(`Outlet ${macAddress} rejected ${param}, still using ${value}`);
+			}
+			outlet.config[param] = value;
+			return IngestStats.timeWrite('outlets', outlet.save());
+		}).catch(console.error);
+}
+
 /*
  * Handle a Action Ack Message. Simply toggles the 'status' of the outlet in the
  * database.
@@ -146,13 +260,64 @@ function handleActionAckMessage(macAddress, payload) {
 
   		var status = payloadValues[1];
   		console.log(`New outlet status: ${status}`);
+  		saveLatencyRecord(macAddress, payloadValues);
 
 	    // Toggle outlet status.
 	    outlet.status = (status === 1) ? 'ON' : 'OFF';
-	    return outlet.save();
+	    return IngestStats.timeWrite('outlets', outlet.save());
 		}).catch(console.error);
 }
 
+/*
+ * Start tracing an action: returns a new command id and remembers when the
+ * action was sent, so acks carrying that id can be timed.
+ */
+function traceAction(group) {
+	gActionCommandId = (gActionCommandId + 1) % MAX_CONFIG_VALUE;
+	var cmdId = gActionCommandId;
+	gActionTraces[cmdId] = {sentAt: Date.now(), group: group};
+	setTimeout( () => delete gActionTraces[cmdId], ACTION_TRACE_TIMEOUT_MS);
+	return cmdId;
+}
+
+/*
+ * Save the latency of an acknowledged action. An action ack payload is
+ * "cmd_id,state,node_rx_act,node_act_ack,gateway_queue,gateway_net" (all ms).
+ * Acks without a traced action (e.g. from a button press) are ignored.
+ */
+function saveLatencyRecord(macAddress, payloadValues) {
+	var trace = gActionTraces[payloadValues[0]];
+	if (!trace || payloadValues.length < 6) {
+		return null;
+	}
+	// unicast actions stay traced until the ack (the gateway retries them),
+	// group actions until every member has had a chance to ack
+	if (!trace.group) {
+		delete gActionTraces[payloadValues[0]];
+	}
+
+	var total = Date.now() - trace.sentAt,
+	    nodeRxAct = payloadValues[2],
+	    nodeActAck = payloadValues[3],
+	    gatewayQueue = payloadValues[4],
+	    gatewayNet = payloadValues[5];
+	var record = new LatencyRecord({
+		mac_address: macAddress,
+		cmd_id: payloadValues[0],
+		group: trace.group,
+		total: total,
+		node_rx_act: nodeRxAct,
+		node_act_ack: nodeActAck
+	});
+	// the gateway only times the unicast actions it tracks
+	if (!trace.group && gatewayNet > 0) {
+		record.serial = Math.max(0, total - gatewayQueue - gatewayNet);
+		record.gateway_queue = gatewayQueue;
+		record.radio = Math.max(0, gatewayNet - nodeRxAct - nodeActAck);
+	}
+	return IngestStats.timeWrite('latency_records', record.save()).catch(console.error);
+}
+
 
 /*
  * Handle a Handshake Ack Message. Create a new outlet object in database,
@@ -192,7 +357,7 @@ function handleHandshakeAckMessage(macAddress, payload) {
 			    gCache[newMacAddress] = REACTIVATING_OUTLET;
 	    		// Outlet exists, but is inactive: mark outlet as active again.
 	    		existingOutlet.active = true;
-		    	return existingOutlet.save()
+		    	return IngestStats.timeWrite('outlets', existingOutlet.save())
 		    		.then( outlet => {
 		    			// clear intermediate cache
 		    			gCache[newMacAddress] = null;
@@ -218,7 +383,7 @@ function handleHandshakeAckMessage(macAddress, payload) {
 	    	hardware_version: hardwareVersion
 	    });
 
-	    return outlet.save()
+	    return IngestStats.timeWrite('outlets', outlet.save())
 	    	.then( outlet => {
 	    		// clear intermediate cache for this outlet.
 			    gCache[newMacAddress] = null;
@@ -235,17 +400,24 @@ function handleHeartbeatMessage(macAddress, payload) {
 }
 
 /**
- * Handle a Lost Node. Sends a Websocket message to the client with the outlet's
- * name and id.
- * (TODO: decide if we should immediately delete from the database, or set a
- * 	'disconnected' flag)
+ * Handle a Lost Node message. The gateway reports every node lost in the same
+ * liveness period in one message, as a list of mac addresses.
  */
 function handleLostNodeMessage(macAddress, payload) {
-	var payloadValues = payload.split(',');
-	if (payloadValues.length < 1) {
+	var lostMacAddresses = payload.split(',').filter(value => value.length > 0);
+	if (lostMacAddresses.length < 1) {
 		return Promise.reject(new Error('invalid payload: ', payload));
 	}
-	var lostMacAddress = payloadValues[0];
+	return Promise.all(lostMacAddresses.map(markOutletLost));
+}
+
+/**
+ * Mark a lost outlet inactive. Sends a Websocket message to the client with the
+ * outlet's name and id.
+ * (TODO: decide if we should immediately delete from the database, or set a
+ * 	'disconnected' flag)
+ */
+function markOutletLost(lostMacAddress) {
 	return Outlet.find({mac_address: lostMacAddress}).exec()
 	  .then( outlets => {
 	    if (outlets.length === 0) {
@@ -267,7 +439,7 @@ function handleLostNodeMessage(macAddress, payload) {
 
 	    	// Mark outlet as inactive in database.
 	    	outlet.active = false;
-	    	return outlet.save()
+	    	return IngestStats.timeWrite('outlets', outlet.save())
 	    		.then( outlet => {
 	    			// clear intermediate cache
 	    			gCache[lostMacAddress] = null;
@@ -281,11 +453,146 @@ function handleLostNodeMessage(macAddress, payload) {
 }
 
 function deactivateOutlets() {
-	console.log("Received RESET message, setting all outlets to inactive");
+	console.log("Gateway did not answer the state sync, setting all outlets to inactive");
 	return Outlet.update({}, { active: false }, {multi: true}).exec()
 		.catch(console.error);
 }
 
+/*
+ * Ask the gateway for a snapshot of its node table (answered with a SYNC
+ * message). 'onTimeout' is called if no answer arrives within SYNC_TIMEOUT_MS.
+ * @returns Promise<message> the message sent to the gateway.
+ */
+function requestSync(onTimeout) {
+	clearTimeout(gSyncTimer);
+	gSyncTimer = (onTimeout) ? setTimeout(onTimeout, SYNC_TIMEOUT_MS) : null;
+	gSyncId = (gSyncId + 1) % MAX_SYNC_ID;
+	var packet = new Buffer([0, 0, 0, SYNC_MESSAGE, 0, 0x80 | gSyncId, 0x0D]);
+	console.log("Sync request to be sent: ", packet);
+	return writePacket(packet).catch(console.error);
+}
+
+/*
+ * Handle a Reset Message. The gateway has restarted and is relearning which
+ * outlets are alive; outlets keep their state until its sync arrives.
+ */
+function handleResetMessage() {
+	console.log(`Received RESET message, syncing outlets in ${SYNC_SETTLE_MS / 1000}s`);
+	clearTimeout(gSyncTimer);
+	gSyncTimer = setTimeout( () => requestSync(deactivateOutlets), SYNC_SETTLE_MS);
+	return Promise.resolve();
+}
+
+/*
+ * Handle a Sync Message: the gateway's snapshot of every outlet it considers
+ * alive, "sync_id,mac,state,seq_num,mac,state,seq_num,...". Outlets in the
+ * snapshot are marked active with their last state, every other outlet is
+ * marked inactive, and the app is told about each outlet that changed.
+ * @returns Promise resolved once every changed outlet has been saved.
+ */
+function handleSyncMessage(macAddress, payload) {
+	var values = payload.split(',').filter(value => value.length > 0).map(value => parseInt(value));
+	if (values.length < 1 || (values.length - 1) % 3 !== 0) {
+		return Promise.reject(new Error('Invalid sync payload: ' + payload));
+	}
+	if (values[0] !== gSyncId) {
+		console.log(`Ignoring stale sync ${values[0]} (waiting for ${gSyncId})`);
+		return Promise.resolve(null);
+	}
+	clearTimeout(gSyncTimer);
+	gSyncTimer = null;
+
+	var nodes = {}; // mac_address => {state, seqNum}
+	for (var i = 1; i < values.length; i += 3) {
+		nodes[values[i]] = {state: values[i + 1], seqNum: values[i + 2]};
+	}
+	console.log(`Received sync of ${Object.keys(nodes).length} alive outlets`);
+
+	return Outlet.find({}).exec()
+		.then( outlets => {
+			var saves = outlets.map( outlet => {
+				var node = nodes[outlet.mac_address];
+				var wasActive = outlet.active;
+				delete nodes[outlet.mac_address];
+				outlet.active = !!node;
+				if (node) {
+					// the gateway doesn't know the state until data or an ack is heard
+					if (node.state === 0 || node.state === 1) {
+						outlet.status = (node.state === 1) ? 'ON' : 'OFF';
+					}
+					outlet.last_sequence_number = node.seqNum;
+				}
+				if (!outlet.isModified()) {
+					return null;
+				}
+				return IngestStats.timeWrite('outlets', outlet.save())
+					.then( outlet => {
+						if (outlet.active && !wasActive) {
+							return WS.sendActiveNodeMessage(outlet._id, outlet.name);
+						} else if (!outlet.active && wasActive) {
+							return WS.sendLostNodeMessage(outlet._id, outlet.name);
+						}
+					});
+			});
+
+			// alive outlets the server has never heard a handshake from
+			Object.keys(nodes).forEach( newMacAddress => {
+				var outlet = new Outlet({
+					name: 'NEW OUTLET ' + newMacAddress,
+					mac_address: newMacAddress,
+					last_sequence_number: nodes[newMacAddress].seqNum
+				});
+				saves.push(IngestStats.timeWrite('outlets', outlet.save())
+					.then( outlet => WS.sendNewNodeMessage(outlet._id, outlet.name)));
+			});
+			return Promise.all(saves);
+		}).catch(console.error);
+}
+
+/*
+ * Handle an OTA Report Message: an outlet's progress on the firmware image
+ * being sent. Reports for an image no longer being sent are dropped.
+ * @returns Promise resolved once the report has been handled.
+ */
+function handleOtaReportMessage(macAddress, payload) {
+	if (gOtaSession) {
+		gOtaSession.handleReport(macAddress, payload);
+	}
+	return Promise.resolve();
+}
+
+/*
+ * Handle a packet from the gateway by its message type.
+ * @returns Promise fulfilled once the packet has been handled.
+ */
+function dispatchData(msgId, macAddress, payload) {
+	switch(msgId) {
+		case SENSOR_MESSAGE:
+			return handleSensorDataMessage(macAddress, payload);
+		case ENERGY_MESSAGE:
+			return handleEnergyMessage(macAddress, payload);
+		case CONFIG_ACK_MESSAGE:
+			return handleConfigAckMessage(macAddress, payload);
+		case ACTION_ACK_MESSAGE:
+			return handleActionAckMessage(macAddress, payload);
+		case HANDSHAKE_ACK_MESSAGE:
+    	return handleHandshakeAckMessage(macAddress, payload);
+    case HEARTBEAT_MESSAGE:
+	    return handleHeartbeatMessage(macAddress, payload);
+    case LOST_NODE_MESSAGE:
+	    return handleLostNodeMessage(macAddress, payload);
+	  case RESET_MESSAGE:
+	  	return handleResetMessage();
+	  case SYNC_MESSAGE:
+	  	return handleSyncMessage(macAddress, payload);
+		case OTA_REPORT_MESSAGE:
+			return handleOtaReportMessage(macAddress, payload);
+		default:
+			console.error(`Unknown Message type: ${msgId}`);
+			return Promise.reject(new Error(`Unknown Message type: ${msgId}`));
+	}
+}
+
 // Parse and handle data packet.
 // TODO:
 // 1) Update time series sensor data
@@ -309,23 +616,8 @@ function handleData(data) {
 	    msgId = parseInt(components[2]),
 	    payload = components[4];
 
-	switch(msgId) {
-		case SENSOR_MESSAGE:
-			return handleSensorDataMessage(macAddress, payload);
-		case ACTION_ACK_MESSAGE:
-			return handleActionAckMessage(macAddress, payload);
-		case HANDSHAKE_ACK_MESSAGE:
-    	return handleHandshakeAckMessage(macAddress, payload);
-    case HEARTBEAT_MESSAGE:
-	    return handleHeartbeatMessage(macAddress, payload);
-    case LOST_NODE_MESSAGE:
-	    return handleLostNodeMessage(macAddress, payload);
-	  case RESET_MESSAGE:
-	  	return deactivateOutlets();
-		default:
-			console.error(`Unknown Message type: ${msgId}`);
-			return Promise.reject(new Error(`Unknown Message type: ${msgId}`));
-	}
+	// Time every packet until it has been handled (see /stats/ingest)
+	return IngestStats.timeMessage(msgId, dispatchData(msgId, macAddress, payload));
 }
 
 /*
@@ -346,7 +638,9 @@ function sendAction(outletMacAddress, action) {
 
       // Packet format: "source_mac_addr:seq_num:msg_type:num_hops:payload"
  			//   where "payload" has structure "cmd_id,dest_outlet_id,action,"
-      // Server sends message with source_id 0, seq_num 0, num_hops 0
+      // Server sends message with source_id 0, seq_num 0, num_hops 0. The
+      // cmd_id (sent as two 7-bit bytes, like CONFIG) ties the ack to this send.
+      var cmdId = traceAction(false);
       var sourceMacAddr = 0x0,
       		seqNum = 0x0,
       		msgType = ACTION_MESSAGE,
@@ -356,7 +650,7 @@ function sendAction(outletMacAddress, action) {
       // 0x0D is the integer value for '\r' (carriage return)
       var packet = new Buffer([
       	sourceMacAddr, 0, 0, msgType, numHops,
-      	0, 0, destOutletAddr, action, 0x0D
+      	0x80 | (cmdId >> 7), 0x80 | (cmdId & 0x7F), destOutletAddr, action, 0x0D
       ]);
       console.log("Packet to be sent: ", packet);
 
@@ -380,6 +674,140 @@ function sendAction(outletMacAddress, action) {
   }).catch(console.error);
 };
 
+/*
+ * Given a group id and an action ('ON'/'OFF'), send a single group action
+ * message that every outlet in the group acts on.
+ * @returns Promise<message> the message sent to the gateway.
+ */
+function sendGroupAction(groupId, action) {
+	if (!isConnected()) {
+		return Promise.reject(new Error("Connection to gateway has not started yet"));
+	}
+	if (!(groupId >= 1 && groupId <= MAX_GROUP_ID)) {
+		return Promise.reject(new Error(`Invalid group id: ${groupId}`));
+	}
+	action = (action === 'ON') ? 0x1 : 0x0;
+
+	// Packet format: "source_mac_addr:seq_num:msg_type:num_hops:payload"
+	//   where "payload" has structure "cmd_id,group_id,action". The group id has
+	//   its high bit set so it can never be '\r'.
+	var cmdId = traceAction(true);
+	var packet = new Buffer([
+		0, 0, 0, GROUP_ACTION_MESSAGE, 0,
+		0x80 | (cmdId >> 7), 0x80 | (cmdId & 0x7F), 0x80 | groupId, action, 0x0D
+	]);
+	console.log("Group packet to be sent: ", packet);
+	return writePacket(packet);
+}
+
+/*
+ * Actuate every outlet in a (populated) group. Outlets that have acknowledged
+ * their membership get one group action message; the rest are sent their own
+ * action. Members that haven't reported the new state after
+ * GROUP_ACK_TIMEOUT_MS are also sent their own action.
+ * @returns Promise resolved once all messages are sent.
+ */
+function actuateGroup(group, action) {
+	var bit = (group.group_id) ? (1 << (group.group_id - 1)) : 0;
+	var isMember = outlet => bit !== 0 && outlet.config && (outlet.config.groups & bit) !== 0;
+	var members = group.outlets.filter(isMember);
+	var others = group.outlets.filter(outlet => !isMember(outlet));
+
+	var promise = (members.length > 0) ? sendGroupAction(group.group_id, action) : Promise.resolve();
+	promise = others.reduce( (promise, outlet) => {
+		return promise.then( () => sendAction(outlet.mac_address, action));
+	}, promise);
+
+	if (members.length > 0) {
+		setTimeout( () => {
+			Outlet.find({_id: {$in: members.map(outlet => outlet._id)}, status: {$ne: action}}).exec()
+				.then( outlets => outlets.reduce( (promise, outlet) => {
+					return promise.then( () => sendAction(outlet.mac_address, action));
+				}, Promise.resolve()))
+				.catch(console.error);
+		}, GROUP_ACK_TIMEOUT_MS);
+	}
+	return promise;
+}
+
+/*
+ * Write a packet to the gateway. Resolves once the packet has been drained.
+ * @returns Promise<packet> the packet sent to the gateway.
+ */
+function writePacket(packet) {
+	return new Promise( (resolve, reject) => {
+		gSerialPort.write(packet, (err) => {
+			if (err) {
+				return reject(err);
+			}
+			gSerialPort.drain((err) => {
+				if (err) {
+					return reject(err);
+				}
+				// Same parsing delay as sendAction
+				setTimeout( () => resolve(packet), 100);
+			});
+		});
+	});
+}
+
+/*
+ * Given an outlet's mac address, a config parameter name (see CONFIG_PARAMS) and
+ * a value, send a CONFIG message to the gateway to be propagated to that outlet.
+ * The outlet replies with a CONFIG ACK, which updates the database.
+ * @returns Promise<message> the message sent to the gateway.
+ */
+function sendConfig(outletMacAddress, param, value) {
+	if (!isConnected()) {
+		return Promise.reject(new Error("Connection to gateway has not started yet"));
+	}
+	if (!CONFIG_PARAMS.hasOwnProperty(param)) {
+		return Promise.reject(new Error(`Invalid config parameter: ${param}`));
+	}
+	value = parseInt(value);
+	if (isNaN(value) || value < 0 || value >= MAX_CONFIG_VALUE) {
+		return Promise.reject(new Error(`Invalid value for ${param}: ${value}`));
+	}
+
+	// Packet format: "source_mac_addr:seq_num:msg_type:num_hops:payload"
+	//   where "payload" has structure "cmd_id,dest_outlet_id,param,value"
+	gConfigCommandId = (gConfigCommandId + 1) % MAX_CONFIG_VALUE;
+	var destOutletAddr = parseInt(outletMacAddress) & 0xFF;
+	var packet = new Buffer([
+		0, 0, 0, CONFIG_MESSAGE, 0,
+		0x80 | (gConfigCommandId >> 7), 0x80 | (gConfigCommandId & 0x7F),
+		destOutletAddr, CONFIG_PARAMS[param],
+		0x80 | (value >> 7), 0x80 | (value & 0x7F),
+		0x0D
+	]);
+	console.log("Config packet to be sent: ", packet);
+	return writePacket(packet);
+}
+
+/*
+ * Send every config parameter in 'params' ({name: value}) to an outlet, one
+ * packet at a time.
+ * @returns Promise resolved once all packets are sent.
+ */
+function sendConfigs(outletMacAddress, params) {
+	return Object.keys(params).reduce( (promise, param) => {
+		return promise.then( () => sendConfig(outletMacAddress, param, params[param]));
+	}, Promise.resolve());
+}
+
+/*
+ * Returns true if every key in 'params' is a known config parameter with a
+ * valid value.
+ */
+function isValidConfig(params) {
+	var names = Object.keys(params);
+	return names.length > 0 && names.every( name => {
+		var value = parseInt(params[name]);
+		return CONFIG_PARAMS.hasOwnProperty(name) && !isNaN(value) &&
+			value >= 0 && value < MAX_CONFIG_VALUE;
+	});
+}
+
 function reconnect(port) {
 	gSerialPort.close( () => {
 		start(port);
@@ -417,6 +845,9 @@ function start(port) {
 
 	    // Listen for "data" event from serial port
 	    gSerialPort.on('data', handleData);
+
+	    // Bring the outlets up to date with the gateway's view of the network
+	    requestSync();
 	});
 
 	gSerialPort.on('error', (err) => {
@@ -429,10 +860,56 @@ function start(port) {
 	});
 };
 
+/*
+ * Send a firmware image to outlets over the air (see lib/OtaSession).
+ * 'options': {imageId, image (Buffer), macs, group, activate}. Only one update
+ * runs at a time.
+ * @returns Promise<{mac: result}> each outlet's status once the update ends.
+ */
+function startOta(options) {
+	if (!isConnected()) {
+		return Promise.reject(new Error("Connection to gateway has not started yet"));
+	}
+	if (gOtaSession) {
+		return Promise.reject(new Error(`Image ${gOtaSession.imageId} is still being sent`));
+	}
+	var error = OtaSession.validate(options);
+	if (error) {
+		return Promise.reject(new Error(error));
+	}
+	options.send = writePacket;
+	gOtaSession = new OtaSession(options);
+	gOtaSession.on('progress', progress => {
+		console.log(`[OTA] image ${options.imageId} pass ${progress.pass} window ${progress.window}/${progress.windows}`);
+	});
+	return gOtaSession.run()
+		.then( results => {
+			gOtaSession = null;
+			return results;
+		}, err => {
+			gOtaSession = null;
+			throw err;
+		});
+}
+
+/*
+ * Status of the firmware update in progress, null if there is none.
+ */
+function otaStatus() {
+	return (gOtaSession) ? gOtaSession.status() : null;
+}
+
 // export functions to make them public
 exports.handleData = handleData;
 exports.sendAction = sendAction;
+exports.actuateGroup = actuateGroup;
+exports.MAX_GROUP_ID = MAX_GROUP_ID;
+exports.sendConfig = sendConfig;
+exports.sendConfigs = sendConfigs;
+exports.isValidConfig = isValidConfig;
 exports.isConnected = isConnected;
+exports.startOta = startOta;
+exports.otaStatus = otaStatus;
 exports.start = start;
 
 
@@ -6,9 +6,11 @@ var Gateway					 = require('./Gateway');
 var groupsCtrl       = require('./controllers/Groups');
 var logger           = require('morgan');
 var ObjectId         = require('mongoose').Types.ObjectId;
+var otaCtrl          = require('./controllers/Ota');
 var outletsCtrl      = require('./controllers/Outlets');
 var path             = require('path');
 var eventsCtrl       = require('./controllers/Events');
+var statsCtrl        = require('./controllers/Stats');
 var timeSeriesCtrl   = require('./controllers/TimeSeries');
 
 var app = express();
@@ -38,7 +40,9 @@ app.use(expressValidator({
 app.get('/outlets/', outletsCtrl.getOutlets);
 app.get('/outlets/clear', outletsCtrl.clearOutlets);
 app.get('/outlets/:id/:action(on|off)', outletsCtrl.sendOutletAction);
+app.get('/outlets/:id/latency', outletsCtrl.getOutletLatency);
 app.get('/outlets/:id', outletsCtrl.getOutletDetails);
+app.post('/outlets/:id/config', outletsCtrl.sendOutletConfig);
 app.post('/outlets/:id', outletsCtrl.updateOutlet);
 app.get('/events/', eventsCtrl.getEvents);
 app.post('/events/', eventsCtrl.createEvent);
@@ -51,6 +55,7 @@ app.post('/groups/', groupsCtrl.createGroup);
 app.get('/groups/clear', groupsCtrl.clearGroups);
 app.get('/groups/:id/:action(on|off)', groupsCtrl.sendGroupAction);
 app.get('/groups/:id', groupsCtrl.getGroupDetails);
+app.post('/groups/:id/config', groupsCtrl.sendGroupConfig);
 app.post('/groups/:id', groupsCtrl.updateGroup);
 app.delete('/groups/:id', groupsCtrl.deleteGroup);
 app.get('/handlepacket/:packet', (req, res, next) => {
@@ -59,6 +64,10 @@ app.get('/handlepacket/:packet', (req, res, next) => {
 		.catch(next);
 });
 app.get('/graphs/:id', timeSeriesCtrl.getSensorHistory);
+app.get('/stats/ingest', statsCtrl.getIngestStats);
+app.get('/stats/ingest/clear', statsCtrl.clearIngestStats);
+app.get('/ota', otaCtrl.getOtaStatus);
+app.post('/ota', otaCtrl.startOta);
 
 // Undefined Route Handler
 // (request url doesn't match any routes)
@@ -2,6 +2,32 @@ var BadRequestError = require('../lib/utils').BadRequestError;
 var Gateway         = require('../Gateway');
 var Group           = require('../models/Group');
 var ObjectId        = require('mongoose').Types.ObjectId;
+var Outlet          = require('../models/Outlet');
+
+/*
+ * Sends each of the given outlets the set of groups it is in (the 'groups'
+ * config parameter), so they act on group actions. Outlets are sent one at a
+ * time; failures are only logged.
+ */
+function pushMemberships(outletIds) {
+	return outletIds.reduce( (promise, outletId) => {
+		return promise.then( () => Promise.all([
+				Outlet.findById(outletId).exec(),
+				Group.find({outlets: outletId}).exec()
+			]))
+			.then( results => {
+				var outlet = results[0], groups = results[1];
+				if (!outlet || !Gateway.isConnected()) {
+					return null;
+				}
+				var mask = groups.reduce( (mask, group) => {
+					return (group.group_id) ? (mask | (1 << (group.group_id - 1))) : mask;
+				}, 0);
+				return Gateway.sendConfig(outlet.mac_address, 'groups', mask);
+			})
+			.catch(console.error);
+	}, Promise.resolve());
+}
 
 /*
  * Returns of list of all groups
@@ -44,6 +70,7 @@ exports.updateGroup = (req, res, next) => {
 		return res.send(errors, 400);
 	}
 	var id = new ObjectId(req.params.id);
+	var oldOutlets = [];
 
 	var updatedParams = {};
 
@@ -58,9 +85,17 @@ exports.updateGroup = (req, res, next) => {
 		}
 	}
 
-	return Group.findByIdAndUpdate(id, updatedParams, {new: true})
-		.populate('outlets').exec()
+	return Group.findById(id).exec()
+		.then( group => {
+			oldOutlets = (group) ? group.outlets : [];
+			return Group.findByIdAndUpdate(id, updatedParams, {new: true})
+				.populate('outlets').exec();
+		})
 		.then( group => {
+			// outlets added to or removed from the group need their memberships
+			if (group && req.body.outlets) {
+				pushMemberships(oldOutlets.concat(group.outlets.map(outlet => outlet._id)));
+			}
 			// successful update, return update group
 			return res.json(group);
 		})
@@ -77,8 +112,23 @@ exports.createGroup = (req, res, next) => {
 		return res.send(errors, 400);
 	}
 
-	var newGroup = new Group({name: req.body.name, outlets: []});
-	return newGroup.save()
+	// give the group the lowest free group id
+	return Group.find({group_id: {$exists: true}}).exec()
+		.then( groups => {
+			var used = groups.map(group => group.group_id);
+			var groupId;
+			for (var i = 1; i <= Gateway.MAX_GROUP_ID; i++) {
+				if (used.indexOf(i) < 0) {
+					groupId = i;
+					break;
+				}
+			}
+			if (!groupId) {
+				console.warn('No free group ids, group actions will be sent per outlet');
+			}
+			var newGroup = new Group({name: req.body.name, group_id: groupId, outlets: []});
+			return newGroup.save();
+		})
 		.then( group => res.json(group))
 		.catch(next);
 }
@@ -94,7 +144,12 @@ exports.deleteGroup = (req, res, next) => {
 	}
 	var id = new ObjectId(req.params.id);
 	return Group.findOneAndRemove({_id: id})
-		.then( removedGroup => res.json(removedGroup))
+		.then( removedGroup => {
+			if (removedGroup) {
+				pushMemberships(removedGroup.outlets);
+			}
+			return res.json(removedGroup);
+		})
 		.catch(next);
 }
 
@@ -109,6 +164,37 @@ exports.clearGroups = (req, res) => {
 		});
 };
 
+/*
+ * Sends new sampling/reporting configuration (see Outlets.sendOutletConfig) to
+ * every outlet in a group.
+ */
+exports.sendGroupConfig = (req, res, next) => {
+	req.checkParams('id', 'Invalid Group ID').notEmpty().isObjectId();
+	var errors = req.validationErrors();
+	if (errors) {
+		return res.send(errors, 400);
+	}
+	if (!Gateway.isValidConfig(req.body)) {
+		return res.send('Invalid config parameters', 400);
+	}
+	var id = new ObjectId(req.params.id);
+	return Group.findById(id).populate('outlets').exec()
+		.then( group => {
+			if (!group) {
+				throw new BadRequestError(`Cannot find group with id ${id}`);
+			}
+			if (!Gateway.isConnected()) {
+				throw new BadRequestError('Gateway not connected, cannot configure group');
+			}
+			// Send to one outlet at a time so the gateway isn't flooded.
+			return group.outlets.reduce( (promise, outlet) => {
+				return promise.then( () => Gateway.sendConfigs(outlet.mac_address, req.body));
+			}, Promise.resolve()).then( () => group);
+		})
+		.then((group) => { return res.json(group); })
+		.catch(next);
+}
+
 exports.sendGroupAction = (req, res, next) => {
 	req.checkParams('id', 'Invalid Group ID').notEmpty().isObjectId();
 	var id = new ObjectId(req.params.id);
@@ -119,19 +205,11 @@ exports.sendGroupAction = (req, res, next) => {
 			}
 			var action = (req.params.action === 'on') ? 'ON' : 'OFF';
 			if (Gateway.isConnected()) {
-				// Forward command to gateway to propagate to the network. Group commands
-				// are treated as fire-and-forget (doesn't wait for a CMD-ACK message)
+				// Forward command to gateway to propagate to the network, as a single
+				// group action where possible (see Gateway.actuateGroup). Doesn't wait
+				// for the outlets' CMD-ACK messages.
 				if (group.outlets.length > 0) {
-					var promise = Gateway.sendAction(group.outlets[0].mac_address, action);
-					// Since the value of 'i' can change by the time each promise executes,
-					// wrap the usage of 'i' in a closure so each promise will use the proper
-					// value.
-					var send = (function (i) { return () => Gateway.sendAction(group.outlets[i].mac_address, action)});
-					for(var i=1; i < group.outlets.length; i++) {
-						var curSend = send(i);
-						promise = promise.then( () => curSend());
-					}
-
+					var promise = Gateway.actuateGroup(group, action);
 					promise.catch(console.error);
 					return promise;
 				} else {
@@ -0,0 +1,83 @@
+var BadRequestError = require('../lib/utils').BadRequestError;
+var Gateway         = require('../Gateway');
+var Group           = require('../models/Group');
+var ObjectId        = require('mongoose').Types.ObjectId;
+var Outlet          = require('../models/Outlet');
+
+/*
+ * Finds the outlets an update is for: the given outlet ids, else the outlets
+ * in the given group, else every active outlet.
+ * @returns Promise<{macs, group}> their MAC addresses and the group_id the
+ *   outlets are told the image is for (0 for every outlet).
+ */
+function findTargets(body) {
+	if (body.outlets) {
+		var ids = [].concat(body.outlets).map(id => new ObjectId(id));
+		return Outlet.find({_id: {$in: ids}}).exec()
+			.then( outlets => ({macs: outlets.map(outlet => outlet.mac_address), group: 0}));
+	}
+	if (body.group) {
+		return Group.findById(new ObjectId(body.group)).populate('outlets').exec()
+			.then( group => {
+				if (!group) {
+					throw new BadRequestError(`Cannot find group with id ${body.group}`);
+				}
+				// Outlets that haven't acknowledged their membership check the image
+				// against the group they think they are in, so send it to everyone.
+				var bit = (group.group_id) ? (1 << (group.group_id - 1)) : 0;
+				var members = outlet => bit !== 0 && outlet.config && (outlet.config.groups & bit) !== 0;
+				return {
+					macs: group.outlets.map(outlet => outlet.mac_address),
+					group: group.outlets.every(members) ? group.group_id : 0
+				};
+			});
+	}
+	return Outlet.find({active: true}).exec()
+		.then( outlets => ({macs: outlets.map(outlet => outlet.mac_address), group: 0}));
+}
+
+/*
+ * Starts sending a firmware image to outlets over the air. The body holds the
+ * image ('image', base64), its id ('image_id', 1-127, a new one for each
+ * build), the outlets it is for ('outlets', outlet ids, or 'group', a group
+ * id; every active outlet otherwise) and whether to install it once every
+ * outlet has verified it ('activate'). Responds with the update's status
+ * straight away; GET /ota follows it.
+ */
+exports.startOta = (req, res, next) => {
+	req.checkBody('image', 'Missing firmware image').notEmpty();
+	req.checkBody('image_id', 'Invalid image id').notEmpty().isInt();
+	var errors = req.validationErrors();
+	if (errors) {
+		return res.send(errors, 400);
+	}
+	if (!Gateway.isConnected()) {
+		return next(new BadRequestError('Gateway not connected, cannot send image'));
+	}
+	return findTargets(req.body)
+		.then( targets => {
+			var update = Gateway.startOta({
+				imageId: parseInt(req.body.image_id),
+				image: Buffer.from(req.body.image, 'base64'),
+				macs: targets.macs,
+				group: targets.group,
+				activate: req.body.activate === true || req.body.activate === 'true'
+			});
+			update.then( results => console.log('[OTA] done', results))
+				.catch(console.error);
+			// Errors starting the update reject before any status exists
+			return Gateway.otaStatus() || update.catch( err => {
+				throw new BadRequestError(err.message);
+			});
+		})
+		.then( status => res.json(status))
+		.catch(next);
+}
+
+/*
+ * Returns the status of the update in progress (null if there is none): the
+ * image, the stage it is at and each outlet's last report.
+ */
+exports.getOtaStatus = (req, res) => {
+	return res.json(Gateway.otaStatus());
+}
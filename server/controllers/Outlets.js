@@ -1,7 +1,16 @@
 var BadRequestError = require('../lib/utils').BadRequestError;
 var Gateway         = require('../Gateway');
+var LatencyRecord   = require('../models/LatencyRecord');
 var ObjectId        = require('mongoose').Types.ObjectId;
 var Outlet          = require('../models/Outlet');
+var utils           = require('../lib/utils');
+
+// Actuation latency histogram bucket bounds (ms) and stages (LatencyRecord)
+const LATENCY_BUCKETS_MS = [100, 250, 500, 1000, 2000, 5000, 10000, 30000];
+const LATENCY_STAGES = [
+	'total', 'serial', 'gateway_queue', 'radio', 'node_rx_act', 'node_act_ack'
+];
+const DEFAULT_LATENCY_HOURS = 24;
 
 /*
  * Returns a list of all outlet names and id's
@@ -73,6 +82,73 @@ exports.sendOutletAction = (req, res, next) => {
 		.catch(next);
 }
 
+/*
+ * Sends new sampling/reporting configuration to an outlet. The request body
+ * holds any of the config parameter names (pwr_period, temp_period,
+ * light_period, pwr_deadband, temp_deadband, light_deadband, heartbeat).
+ * The outlet's stored config is updated when the outlet acknowledges it.
+ */
+exports.sendOutletConfig = (req, res, next) => {
+	req.checkParams('id', 'Invalid Outlet ID').notEmpty().isObjectId();
+	var errors = req.validationErrors();
+	if (errors) {
+		return res.send(errors, 400);
+	}
+	if (!Gateway.isValidConfig(req.body)) {
+		return res.send('Invalid config parameters', 400);
+	}
+	var id = new ObjectId(req.params.id);
+	return Outlet.findById(id).exec()
+		.then( outlet => {
+			if (!outlet) {
+				throw new BadRequestError(`Cannot find outlet with id ${id}`);
+			}
+			if (!Gateway.isConnected()) {
+				throw new BadRequestError('Gateway not connected, cannot configure outlet');
+			}
+			return Gateway.sendConfigs(outlet.mac_address, req.body)
+				.then( () => outlet);
+		})
+		.then((outlet) => { return res.json(outlet); })
+		.catch(next);
+}
+
+/*
+ * Returns actuation latency histograms for an outlet, one per stage (see
+ * models/LatencyRecord), over the last 'hours' hours (query param, default
+ * DEFAULT_LATENCY_HOURS).
+ */
+exports.getOutletLatency = (req, res, next) => {
+	req.checkParams('id', 'Invalid Outlet ID').notEmpty().isObjectId();
+	var errors = req.validationErrors();
+	if (errors) {
+		return res.send(errors, 400);
+	}
+	var id = new ObjectId(req.params.id);
+	var hours = parseFloat(req.query.hours) || DEFAULT_LATENCY_HOURS;
+	var since = new Date(Date.now() - hours * 60 * 60 * 1000);
+	return Outlet.findById(id, 'mac_address').exec()
+		.then( outlet => {
+			if (!outlet) {
+				throw new BadRequestError(`Cannot find outlet with id ${id}`);
+			}
+			return LatencyRecord.find({
+				mac_address: outlet.mac_address,
+				timestamp: {$gte: since}
+			}).exec();
+		})
+		.then( records => {
+			var stages = {};
+			LATENCY_STAGES.forEach( stage => {
+				var values = records.map(record => record[stage])
+					.filter(value => typeof value === 'number');
+				stages[stage] = utils.histogram(values, LATENCY_BUCKETS_MS);
+			});
+			return res.json({since: since, count: records.length, stages: stages});
+		})
+		.catch(next);
+}
+
 exports.updateOutlet = (req, res, next) => {
 	req.checkParams('id', 'Invalid Outlet ID').notEmpty().isObjectId();
 	// todo: add check for body param 'name'
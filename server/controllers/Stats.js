@@ -0,0 +1,17 @@
+var IngestStats = require('../lib/IngestStats');
+
+/*
+ * Returns the gateway ingest counters: packets received and handled, handling
+ * latency and database write latency per collection (see lib/IngestStats).
+ */
+exports.getIngestStats = (req, res) => {
+	return res.json(IngestStats.snapshot());
+};
+
+/*
+ * Restart the ingest counters (e.g. at the start of a load test).
+ */
+exports.clearIngestStats = (req, res) => {
+	IngestStats.reset();
+	return res.json(IngestStats.snapshot());
+};
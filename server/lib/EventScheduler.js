@@ -82,6 +82,20 @@ function eventsToActions(events, outlet) {
 					.then( group => {
 						if (!group) throw new Error('Invalid output group id in event');
 
+						// groups the outlets know about are actuated with one group action
+						// (see Gateway.actuateGroup)
+						if (group.group_id) {
+							if (group.outlets.some(groupOutlet => groupOutlet && groupOutlet.status != event.output_action)) {
+								console.log(`Group ${group.group_id} =>${event.output_action}`);
+								actions.push({
+									eventId: event._id,
+									group: group,
+									action: event.output_action
+								});
+							}
+							return actions;
+						}
+
 						// add an action for each outlet in the group to the list.
 						group.outlets.forEach( groupOutlet => {
 							if (groupOutlet && groupOutlet.status != event.output_action) {
@@ -0,0 +1,93 @@
+/** Ingest Statistics */
+var utils = require('./utils');
+
+// Histogram bucket bounds (ms) for message handling and database writes
+const INGEST_BUCKETS_MS = [1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 5000];
+// Latency samples kept per histogram (the oldest are overwritten)
+const MAX_SAMPLES = 100000;
+
+var gStarted = Date.now();
+var gReceived = {};  // msg_type => packets received from the gateway
+var gHandled = 0;    // packets whose handler has finished
+var gInFlight = 0;   // packets received but not yet handled
+var gMaxInFlight = 0;
+var gHandleMs = [];
+var gWriteMs = {};   // collection => [ms]
+
+/*
+ * Keeps the most recent MAX_SAMPLES values in 'samples'.
+ */
+function addSample(samples, value) {
+	if (samples.length < MAX_SAMPLES) {
+		samples.push(value);
+	} else {
+		samples[Math.floor(Math.random() * MAX_SAMPLES)] = value;
+	}
+}
+
+/*
+ * Count a packet from the gateway and time its handler until 'promise' settles.
+ * @returns the given promise
+ */
+function timeMessage(msgType, promise) {
+	var start = Date.now();
+	gReceived[msgType] = (gReceived[msgType] || 0) + 1;
+	gInFlight++;
+	gMaxInFlight = Math.max(gMaxInFlight, gInFlight);
+	var done = () => {
+		gInFlight--;
+		gHandled++;
+		addSample(gHandleMs, Date.now() - start);
+	};
+	promise.then(done, done);
+	return promise;
+}
+
+/*
+ * Time a database write ('promise', e.g. from doc.save()) to 'collection'.
+ * @returns the given promise
+ */
+function timeWrite(collection, promise) {
+	var start = Date.now();
+	var samples = gWriteMs[collection] || (gWriteMs[collection] = []);
+	var done = () => addSample(samples, Date.now() - start);
+	promise.then(done, done);
+	return promise;
+}
+
+/*
+ * Returns the counters since the last reset, with handling and per collection
+ * write latency histograms (see utils.histogram).
+ */
+function snapshot() {
+	var writes = {};
+	Object.keys(gWriteMs).forEach( collection => {
+		writes[collection] = utils.histogram(gWriteMs[collection], INGEST_BUCKETS_MS);
+	});
+	var received = Object.keys(gReceived).reduce((sum, type) => sum + gReceived[type], 0);
+	return {
+		since: new Date(gStarted),
+		seconds: (Date.now() - gStarted) / 1000,
+		received: received,
+		received_by_type: gReceived,
+		handled: gHandled,
+		in_flight: gInFlight,
+		max_in_flight: gMaxInFlight,
+		handle_ms: utils.histogram(gHandleMs, INGEST_BUCKETS_MS),
+		write_ms: writes
+	};
+}
+
+function reset() {
+	gStarted = Date.now();
+	gReceived = {};
+	gHandled = 0;
+	gMaxInFlight = gInFlight;
+	gHandleMs = [];
+	gWriteMs = {};
+}
+
+exports.timeMessage = timeMessage;
+exports.timeWrite = timeWrite;
+exports.snapshot = snapshot;
+exports.reset = reset;
@@ -0,0 +1,403 @@
+"use strict";
+const EventEmitter = require('events').EventEmitter;
+
+// Message Types (see wsn/projects/dicio/utility/type_defs.h)
+const OTA_BEGIN_MESSAGE     = 17;
+const OTA_DATA_MESSAGE      = 18;
+const OTA_POLL_MESSAGE      = 19;
+const OTA_END_MESSAGE       = 20;
+
+// Image layout, as the outlets hold it
+const CHUNK_SIZE            = 64;
+const WINDOW_CHUNKS         = 16;
+const WINDOW_SIZE           = CHUNK_SIZE * WINDOW_CHUNKS;
+const MAX_IMAGE_SIZE        = 0xF000; // the outlets' spare flash bank
+const MAX_IMAGE_ID          = 127;    // ids are sent as one byte, 0 is never used
+const MAX_GROUP_ID          = 14;
+const CRC_POLY              = 0x1021;
+const CRC_INIT              = 0xFFFF;
+
+// END actions
+const OTA_VERIFY            = 0;
+const OTA_ACTIVATE          = 1;
+
+// Report statuses (OTA_STATUS_* in type_defs.h)
+const STATUS_RECEIVING      = 0;
+const STATUS_VERIFIED       = 1;
+const STATUS_BAD_CRC        = 2;
+const STATUS_ACTIVATING     = 3;
+const STATUS_REJECTED       = 4;
+const STATUS_INSTALLED      = 5;
+const STATUS_NAMES = ['receiving', 'verified', 'bad_crc', 'activating', 'rejected', 'installed'];
+
+// The gateway relays up to one queue (4 frames) of OTA frames per 1 s radio
+// period, and each frame takes a 100 ms preamble to send. Sending slower than
+// that leaves room for the gateway's own traffic without its queue filling.
+const FRAME_INTERVAL_MS     = 400;
+// Outlets hold a poll report for up to six 500 ms periods so they don't all
+// answer at once, and the gateway forwards reports once a second.
+const REPORT_WAIT_MS        = 8000;
+// Outlets don't answer a BEGIN, it is sent this many times up front (and again
+// whenever an outlet hasn't answered a poll).
+const BEGIN_REPEATS         = 2;
+// Times each END is sent before the outlets that missed it are given up on,
+// and polls of a window before its stragglers are left for a later pass.
+const ROUNDS                = 4;
+// Passes over the image (the first, then rewinds for outlets that fell behind
+// or failed the CRC check)
+const MAX_PASSES            = 3;
+// An activated outlet copies the image, reboots and rejoins the network
+// before it can say the image is installed.
+const INSTALL_WAIT_MS       = 30000;
+
+function delay(ms) {
+	return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+/*
+ * CRC-16/CCITT of 'image', as ota_crc_byte() computes it on the outlets.
+ */
+function crc16(image) {
+	var crc = CRC_INIT;
+	for (var i = 0; i < image.length; i++) {
+		crc ^= image[i] << 8;
+		for (var bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ CRC_POLY) : (crc << 1);
+			crc &= 0xFFFF;
+		}
+	}
+	return crc;
+}
+
+/*
+ * Packs bytes so none has its high bit clear (and so none is '\r'): each
+ * group of up to seven bytes becomes a byte holding their high bits followed
+ * by the bytes with their high bit set. The gateway's serv_unpack_block()
+ * reverses it.
+ */
+function pack7bit(bytes) {
+	var packed = [];
+	for (var i = 0; i < bytes.length; i += 7) {
+		var group = bytes.slice(i, i + 7);
+		var high = 0;
+		group.forEach( (b, bit) => { high |= ((b >> 7) & 1) << bit; });
+		packed.push(0x80 | high);
+		group.forEach( b => packed.push(0x80 | (b & 0x7F)));
+	}
+	return packed;
+}
+
+/*
+ * Builds an OTA message for the gateway: the server's header (source 0,
+ * sequence number 0, no hops), the packed payload and '\r'.
+ */
+function frame(msgType, payload) {
+	return Buffer.from([0, 0, 0, msgType, 0].concat(pack7bit(payload), [0x0D]));
+}
+
+/**
+ * Sends a firmware image to a set of outlets over the air, through the
+ * gateway.
+ *
+ * The image is sent in windows of WINDOW_CHUNKS chunks. Each outlet holds two
+ * windows, so a window is only repaired once the window after it has been
+ * sent. A report names the oldest window the outlet is missing chunks of and
+ * a bitmap of the chunks missing from it and from the window after it; only
+ * those chunks are sent again. Outlets that fall behind by more than a
+ * window, or whose image fails its CRC check, are caught up by another pass
+ * from the oldest window one of them needs. Verified images are then
+ * activated if asked to.
+ *
+ * Emits 'progress' {pass, window, windows} as windows go out and 'report'
+ * (mac, report) for each report heard.
+ */
+class OtaSession extends EventEmitter {
+	/*
+	 * 'options': {imageId (1..127), image (Buffer), macs (outlets expected to
+	 * take part), group (0 for every outlet, or a group id), activate
+	 * (install the image once verified), send (Buffer => Promise resolved
+	 * once the gateway has it)}.
+	 */
+	constructor(options) {
+		super();
+		this.imageId = options.imageId;
+		this.image = options.image;
+		this.group = options.group || 0;
+		this.activate = !!options.activate;
+		this.send = options.send;
+		this.windows = Math.ceil(this.image.length / WINDOW_SIZE);
+		this.crc = crc16(this.image);
+		this.reports = {}; // mac => latest report
+		this.macs = options.macs.map(mac => parseInt(mac));
+		this.polled = new Set(); // outlets that have answered the last poll
+		this.waiter = null;
+		this.state = 'idle';
+	}
+
+	/*
+	 * Returns an error message if the options can't be sent, otherwise null.
+	 */
+	static validate(options) {
+		if (!(options.imageId >= 1 && options.imageId <= MAX_IMAGE_ID)) {
+			return `Invalid image id: ${options.imageId}`;
+		}
+		if (!options.image || options.image.length === 0 || options.image.length > MAX_IMAGE_SIZE) {
+			return `Image must be 1 to ${MAX_IMAGE_SIZE} bytes`;
+		}
+		if (options.group && !(options.group >= 1 && options.group <= MAX_GROUP_ID)) {
+			return `Invalid group id: ${options.group}`;
+		}
+		if (!options.macs || options.macs.length === 0) {
+			return 'No outlets to update';
+		}
+		return null;
+	}
+
+	/*
+	 * Handle the payload of an OTA REPORT message from an outlet:
+	 * "image_id,status,window,missing,next".
+	 */
+	handleReport(macAddress, payload) {
+		var values = payload.split(',').map(value => parseInt(value));
+		if (values.length !== 5 || values[0] !== this.imageId) {
+			return;
+		}
+		var report = {status: values[1], window: values[2], missing: values[3], next: values[4]};
+		this.reports[macAddress] = report;
+		this.polled.add(macAddress);
+		this.emit('report', macAddress, report);
+		if (this.waiter && this.macs.every(mac => this.polled.has(mac))) {
+			this.waiter();
+		}
+	}
+
+	/*
+	 * Run the update.
+	 * @returns Promise<{mac: result}> resolved with each outlet's final status
+	 *   ('installed', 'activating', 'verified', 'bad_crc', 'rejected',
+	 *   'receiving' or 'no response').
+	 */
+	run() {
+		this.state = 'sending';
+		var begins = Promise.resolve();
+		for (var i = 0; i < BEGIN_REPEATS; i++) {
+			begins = begins.then( () => this.sendBegin());
+		}
+		return begins
+			.then( () => this.pass(0, 0))
+			.then( () => {
+				if (!this.activate) {
+					return null;
+				}
+				this.state = 'activating';
+				return this.repeat(() => this.sendEnd(OTA_ACTIVATE),
+						report => report.status !== STATUS_VERIFIED)
+					.then( () => delay(INSTALL_WAIT_MS))
+					.then( () => this.repeat(() => this.sendPoll(),
+						report => report.status === STATUS_INSTALLED));
+			})
+			.then( () => {
+				this.state = 'done';
+				return this.results();
+			});
+	}
+
+	/*
+	 * Each outlet's status, by MAC address.
+	 */
+	results() {
+		var results = {};
+		this.macs.forEach( mac => {
+			var report = this.reports[mac];
+			results[mac] = report ? STATUS_NAMES[report.status] : 'no response';
+		});
+		return results;
+	}
+
+	/*
+	 * One pass over the image from window 'start', then a CRC check. Outlets
+	 * still behind, or whose image failed the check, get another pass.
+	 */
+	pass(number, start) {
+		var sendWindow = (w) => {
+			this.emit('progress', {pass: number, window: w, windows: this.windows});
+			return this.sendChunks(this.allChunks(w))
+				.then( () => (w > start) ? this.repair(w - 1, w) : null)
+				.then( () => (w + 1 < this.windows) ? sendWindow(w + 1) : this.repair(w, w));
+		};
+
+		return sendWindow(start)
+			.then( () => this.repeat(() => this.sendEnd(OTA_VERIFY), () => true))
+			.then( () => {
+				var behind = this.behind();
+				if (behind.length === 0 || number + 1 >= MAX_PASSES) {
+					return null;
+				}
+				return this.pass(number + 1, Math.min.apply(null, behind.map(mac => this.reports[mac].window)));
+			});
+	}
+
+	/*
+	 * Poll the outlets and resend what those still on 'window' are missing of
+	 * it (and of the window after it, up to 'last'), until they have all of it.
+	 * Outlets are only polled once the chunks have gone out, so their reports
+	 * don't collide with them.
+	 */
+	repair(window, last) {
+		var round = (n) => {
+			if (n >= ROUNDS) {
+				return null;
+			}
+			this.sendPoll();
+			return this.awaitReports()
+				.then( () => {
+					var holding = this.macs.filter( mac => this.polled.has(mac) &&
+						this.reports[mac].status === STATUS_RECEIVING && this.reports[mac].window === window);
+					if (holding.length === 0) {
+						return null;
+					}
+					var chunks = [];
+					holding.forEach( mac => {
+						var report = this.reports[mac];
+						this.addChunks(chunks, window, report.missing);
+						if (window + 1 <= last) {
+							this.addChunks(chunks, window + 1, report.next);
+						}
+					});
+					// outlets that have never answered may have missed the BEGIN
+					if (this.macs.some(mac => !this.reports[mac])) {
+						this.sendBegin();
+					}
+					return this.sendChunks(chunks).then( () => round(n + 1));
+				});
+		};
+		return round(0);
+	}
+
+	/*
+	 * Send an END/poll until every outlet has answered with a report that
+	 * 'settled' accepts (or ROUNDS times).
+	 */
+	repeat(send, settled) {
+		var round = (n) => {
+			var waiting = this.macs.filter(mac => !this.polled.has(mac) || !settled(this.reports[mac]));
+			if (waiting.length === 0 || n >= ROUNDS) {
+				return null;
+			}
+			this.polled.clear();
+			return send()
+				.then( () => this.awaitReports())
+				.then( () => round(n + 1));
+		};
+		this.polled.clear();
+		return round(0);
+	}
+
+	/*
+	 * Outlets that need more of the image: behind the last window or their
+	 * image failed its check (they start again from window 0).
+	 */
+	behind() {
+		return this.macs.filter( mac => {
+			var report = this.reports[mac];
+			return report && (report.status === STATUS_BAD_CRC ||
+				(report.status === STATUS_RECEIVING && report.window < this.windows));
+		});
+	}
+
+	allChunks(window) {
+		var chunks = [];
+		var count = Math.min(WINDOW_CHUNKS, Math.ceil((this.image.length - window * WINDOW_SIZE) / CHUNK_SIZE));
+		for (var chunk = 0; chunk < count; chunk++) {
+			chunks.push({window: window, chunk: chunk});
+		}
+		return chunks;
+	}
+
+	addChunks(chunks, window, bitmap) {
+		for (var chunk = 0; chunk < WINDOW_CHUNKS; chunk++) {
+			if ((bitmap & (1 << chunk)) &&
+					!chunks.some(c => c.window === window && c.chunk === chunk)) {
+				chunks.push({window: window, chunk: chunk});
+			}
+		}
+	}
+
+	sendChunks(chunks) {
+		return chunks.reduce( (promise, c) => promise.then( () => {
+			var offset = (c.window * WINDOW_CHUNKS + c.chunk) * CHUNK_SIZE;
+			var data = Buffer.alloc(CHUNK_SIZE, 0xFF);
+			this.image.copy(data, 0, offset, Math.min(offset + CHUNK_SIZE, this.image.length));
+			return this.paced(frame(OTA_DATA_MESSAGE,
+				[this.imageId, c.window, c.chunk].concat(Array.from(data))));
+		}), Promise.resolve());
+	}
+
+	sendBegin() {
+		var size = this.image.length;
+		return this.paced(frame(OTA_BEGIN_MESSAGE, [this.imageId, this.group,
+			(size >> 8) & 0xFF, size & 0xFF, (this.crc >> 8) & 0xFF, this.crc & 0xFF]));
+	}
+
+	sendEnd(action) {
+		return this.paced(frame(OTA_END_MESSAGE, [this.imageId, action]));
+	}
+
+	/*
+	 * Start a poll. Reports are collected by awaitReports().
+	 */
+	sendPoll() {
+		this.polled.clear();
+		return this.paced(frame(OTA_POLL_MESSAGE, [this.imageId]));
+	}
+
+	/*
+	 * Send a frame, then leave the gateway time to relay it.
+	 */
+	paced(buffer) {
+		this.sending = (this.sending || Promise.resolve())
+			.then( () => this.send(buffer))
+			.then( () => delay(FRAME_INTERVAL_MS));
+		return this.sending;
+	}
+
+	/*
+	 * Resolves once every outlet has answered since the last poll (or BEGIN/
+	 * END), or REPORT_WAIT_MS after the frame went out.
+	 */
+	awaitReports() {
+		return this.sending.then( () => new Promise( resolve => {
+			var timer = setTimeout(finish, REPORT_WAIT_MS);
+			var self = this;
+			function finish() {
+				clearTimeout(timer);
+				self.waiter = null;
+				resolve();
+			}
+			if (this.macs.every(mac => this.polled.has(mac))) {
+				return finish();
+			}
+			this.waiter = finish;
+		}));
+	}
+
+	/*
+	 * Progress for the status route.
+	 */
+	status() {
+		return {
+			imageId: this.imageId,
+			size: this.image.length,
+			crc: this.crc,
+			windows: this.windows,
+			state: this.state,
+			outlets: this.results()
+		};
+	}
+}
+
+OtaSession.crc16 = crc16;
+OtaSession.pack7bit = pack7bit;
+OtaSession.MAX_IMAGE_SIZE = MAX_IMAGE_SIZE;
+
+module.exports = OtaSession;
@@ -0,0 +1,274 @@
+"use strict";
+const EventEmitter = require('events').EventEmitter;
+const spawn = require('child_process').spawn;
+
+// Message Types (see wsn/projects/dicio/utility/type_defs.h)
+const LOST_NODE_MESSAGE     = 1;
+const RESET_MESSAGE         = 2;
+const SENSOR_MESSAGE        = 5;
+const ACTION_MESSAGE        = 6;
+const ACTION_ACK_MESSAGE    = 7;
+const HANDSHAKE_ACK_MESSAGE = 9;
+const HEARTBEAT_MESSAGE     = 10;
+const ENERGY_MESSAGE        = 11;
+const CONFIG_MESSAGE        = 12;
+const CONFIG_ACK_MESSAGE    = 13;
+const GROUP_ACTION_MESSAGE  = 15;
+const SYNC_MESSAGE          = 16;
+
+const GATEWAY_MAC           = 1;
+const HEADER_SIZE           = 5;
+const MAX_SEQ_NUM           = 65536;
+// UART character time: start bit + 8 data bits + stop bit
+const BITS_PER_BYTE         = 10;
+const PACE_INTERVAL_MS      = 10;
+
+// Opens a raw pty pair, links the slave at argv[1] and copies bytes between
+// its stdin/stdout and the master. The slave is kept open so the server can
+// close and reopen the port (watchdog reconnects) without the master failing.
+const PTY_BRIDGE = `
+import os, pty, select, sys, tty
+master, slave = pty.openpty()
+tty.setraw(master)
+tty.setraw(slave)
+link = sys.argv[1]
+if os.path.lexists(link):
+    os.unlink(link)
+os.symlink(os.ttyname(slave), link)
+sys.stderr.write('ready\\n')
+sys.stderr.flush()
+try:
+    while True:
+        ready = select.select([0, master], [], [])[0]
+        if 0 in ready:
+            data = os.read(0, 4096)
+            if not data:
+                break
+            while data:
+                data = data[os.write(master, data):]
+        if master in ready:
+            data = os.read(master, 4096)
+            while data:
+                data = data[os.write(1, data):]
+finally:
+    os.unlink(link)
+`;
+
+/*
+ * Reads the 14-bit value the server sends as two 7-bit bytes with the high bit
+ * set (command ids and config values).
+ */
+function read7bit(frame, index) {
+	return ((frame[index] & 0x7F) << 7) | (frame[index + 1] & 0x7F);
+}
+
+/**
+ * A stand-in for the gateway node on the server's serial port. Lines are
+ * written to a pseudo-terminal in the exact format of assemble_serv_packet()
+ * (gateway/main.c prints each one followed by "\r\n"), paced at the gateway's
+ * UART rate, and command frames written by the server are parsed the way the
+ * gateway's rx_serv_task does.
+ *
+ * Emits 'action' {cmdId, dest, action}, 'group' {cmdId, group, action},
+ * 'config' {cmdId, dest, param, value} and 'sync' {syncId} for the server's
+ * commands, and 'malformed' (frame) for anything else.
+ */
+class VirtualGateway extends EventEmitter {
+	/*
+	 * 'link' is the path the server opens as its serial port. 'baudRate' paces
+	 * the lines written to it, 0 writes them as fast as the server reads.
+	 */
+	constructor(link, baudRate) {
+		super();
+		this.link = link;
+		this.bytesPerMs = (baudRate > 0) ? baudRate / BITS_PER_BYTE / 1000 : 0;
+		this.seqNum = 0;
+		this.queue = [];
+		this.queuedBytes = 0;
+		this.maxQueuedBytes = 0;
+		this.sent = {};      // msg_type => lines written
+		this.sentBytes = 0;
+		this.rxBuffer = Buffer.alloc(0);
+		this.bridge = null;
+		this.blocked = false;
+		this.credit = 0;
+		this.lastPace = Date.now();
+		this.pacer = null;
+	}
+
+	/*
+	 * Create the pty and link it at this.link.
+	 * @returns Promise resolved once the server can open the link.
+	 */
+	open() {
+		return new Promise( (resolve, reject) => {
+			this.bridge = spawn('python3', ['-c', PTY_BRIDGE, this.link]);
+			this.bridge.on('error', reject);
+			this.bridge.stderr.once('data', () => resolve());
+			this.bridge.on('exit', code => this.emit('close', code));
+			this.bridge.stdout.on('data', data => this.receive(data));
+			this.bridge.stdin.on('drain', () => {
+				this.blocked = false;
+				this.flush();
+			});
+			this.pacer = setInterval(() => this.flush(), PACE_INTERVAL_MS);
+		});
+	}
+
+	close() {
+		clearInterval(this.pacer);
+		if (this.bridge) {
+			this.bridge.stdin.end();
+		}
+	}
+
+	nextSeqNum() {
+		this.seqNum = (this.seqNum + 1) % MAX_SEQ_NUM;
+		return this.seqNum;
+	}
+
+	/*
+	 * Queue one "source_mac_addr:seq_num:msg_type:num_hops:payload" line.
+	 */
+	send(source, seqNum, msgType, numHops, payload) {
+		var line = `${source}:${seqNum}:${msgType}:${numHops}:${payload}\r\n`;
+		this.queue.push({type: msgType, line: line});
+		this.queuedBytes += line.length;
+		this.maxQueuedBytes = Math.max(this.maxQueuedBytes, this.queuedBytes);
+		this.sent[msgType] = this.sent[msgType] || 0;
+		this.flush();
+	}
+
+	/*
+	 * Write queued lines as far as the UART rate (and the pty) allows.
+	 */
+	flush() {
+		var now = Date.now();
+		if (this.bytesPerMs > 0) {
+			// don't bank more than one interval of idle line time
+			this.credit = Math.min(this.credit + (now - this.lastPace) * this.bytesPerMs,
+				PACE_INTERVAL_MS * this.bytesPerMs + 1);
+		}
+		this.lastPace = now;
+		while (this.queue.length > 0 && !this.blocked && (this.bytesPerMs === 0 || this.credit > 0)) {
+			var item = this.queue.shift();
+			this.queuedBytes -= item.line.length;
+			this.credit -= item.line.length;
+			this.sent[item.type]++;
+			this.sentBytes += item.line.length;
+			this.blocked = !this.bridge.stdin.write(item.line);
+		}
+	}
+
+	// Gateway's own messages, numbered from its sequence counter
+	sendReset() {
+		this.send(GATEWAY_MAC, this.nextSeqNum(), RESET_MESSAGE, 0, ',');
+	}
+
+	sendHeartbeat() {
+		this.send(GATEWAY_MAC, this.nextSeqNum(), HEARTBEAT_MESSAGE, 0, ',');
+	}
+
+	sendHandshakeAck(mac, hardwareVersion) {
+		this.send(GATEWAY_MAC, this.nextSeqNum(), HANDSHAKE_ACK_MESSAGE, 0,
+			`${mac},${(hardwareVersion >>> 16) & 0xFFFF},${hardwareVersion & 0xFFFF}`);
+	}
+
+	// the gateway reports every node lost in the same period in one message
+	sendLostNodes(macs) {
+		this.send(GATEWAY_MAC, this.nextSeqNum(), LOST_NODE_MESSAGE, 0, `${macs.join(',')},`);
+	}
+
+	/*
+	 * Answer a sync request with the alive outlets ({mac, state, seqNum}), as
+	 * gateway/main.c's send_sync() does.
+	 */
+	sendSync(syncId, outlets) {
+		var entries = outlets.map(outlet => `${outlet.mac},${outlet.state},${outlet.seqNum},`);
+		this.send(GATEWAY_MAC, this.nextSeqNum(), SYNC_MESSAGE, 0, `${syncId},${entries.join('')}`);
+	}
+
+	// Messages relayed from an outlet, with the outlet's own sequence number
+	sendSensorData(outlet, power, temperature, light, state) {
+		this.send(outlet.mac, outlet.nextSeqNum(), SENSOR_MESSAGE, outlet.hops,
+			`${power},${temperature},${light},${state},0`);
+	}
+
+	sendEnergy(outlet, energy, powerMin, powerMax) {
+		this.send(outlet.mac, outlet.nextSeqNum(), ENERGY_MESSAGE, outlet.hops,
+			`${energy},${powerMin},${powerMax}`);
+	}
+
+	/*
+	 * 'trace' holds the latency trace fields in ms: {rxAct, actAck, gatewayQueue,
+	 * gatewayNet} (gateway fields are 0 for group actions).
+	 */
+	sendActionAck(outlet, cmdId, state, trace) {
+		this.send(outlet.mac, outlet.nextSeqNum(), ACTION_ACK_MESSAGE, outlet.hops,
+			`${cmdId},${state},${trace.rxAct},${trace.actAck},${trace.gatewayQueue},${trace.gatewayNet}`);
+	}
+
+	sendConfigAck(outlet, cmdId, param, value, status) {
+		this.send(outlet.mac, outlet.nextSeqNum(), CONFIG_ACK_MESSAGE, outlet.hops,
+			`${cmdId},${param},${value},${status}`);
+	}
+
+	/*
+	 * Split the server's bytes into '\r' terminated frames.
+	 */
+	receive(data) {
+		this.rxBuffer = Buffer.concat([this.rxBuffer, data]);
+		var end;
+		while ((end = this.rxBuffer.indexOf(0x0D)) >= 0) {
+			this.handleFrame(this.rxBuffer.slice(0, end));
+			this.rxBuffer = this.rxBuffer.slice(end + 1);
+		}
+	}
+
+	/*
+	 * Frame format: source_mac_addr, seq_num (2), msg_type, num_hops, payload.
+	 */
+	handleFrame(frame) {
+		var msgType = (frame.length > HEADER_SIZE) ? frame[3] : null;
+		if (msgType === ACTION_MESSAGE && frame.length >= HEADER_SIZE + 4) {
+			this.emit('action', {
+				cmdId: read7bit(frame, HEADER_SIZE),
+				dest: frame[HEADER_SIZE + 2],
+				action: frame[HEADER_SIZE + 3]
+			});
+		} else if (msgType === GROUP_ACTION_MESSAGE && frame.length >= HEADER_SIZE + 4) {
+			this.emit('group', {
+				cmdId: read7bit(frame, HEADER_SIZE),
+				group: frame[HEADER_SIZE + 2] & 0x7F,
+				action: frame[HEADER_SIZE + 3]
+			});
+		} else if (msgType === CONFIG_MESSAGE && frame.length >= HEADER_SIZE + 6) {
+			this.emit('config', {
+				cmdId: read7bit(frame, HEADER_SIZE),
+				dest: frame[HEADER_SIZE + 2],
+				param: frame[HEADER_SIZE + 3],
+				value: read7bit(frame, HEADER_SIZE + 4)
+			});
+		} else if (msgType === SYNC_MESSAGE) {
+			this.emit('sync', {syncId: frame[HEADER_SIZE] & 0x7F});
+		} else {
+			this.emit('malformed', frame);
+		}
+	}
+}
+
+VirtualGateway.SENSOR_MESSAGE = SENSOR_MESSAGE;
+VirtualGateway.ENERGY_MESSAGE = ENERGY_MESSAGE;
+VirtualGateway.MESSAGE_NAMES = {
+	[LOST_NODE_MESSAGE]: 'lost',
+	[RESET_MESSAGE]: 'reset',
+	[SENSOR_MESSAGE]: 'data',
+	[ACTION_ACK_MESSAGE]: 'cmd-ack',
+	[HANDSHAKE_ACK_MESSAGE]: 'hand-ack',
+	[HEARTBEAT_MESSAGE]: 'heartbeat',
+	[ENERGY_MESSAGE]: 'energy',
+	[CONFIG_ACK_MESSAGE]: 'config-ack',
+	[SYNC_MESSAGE]: 'sync'
+};
+
+module.exports = VirtualGateway;
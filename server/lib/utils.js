@@ -11,3 +11,27 @@ function BadRequestError (msg) {
 
 util.inherits(BadRequestError, Error);
 exports.BadRequestError = BadRequestError;
+
+/*
+ * Histogram of 'values' over the upper bucket bounds in 'buckets' (ascending),
+ * plus an overflow bucket (le: null). Also returns the count, 50th/95th
+ * percentiles and maximum, or nulls if there are no values.
+ */
+function histogram(values, buckets) {
+	var sorted = values.slice().sort((a, b) => a - b);
+	var percentile = p => (sorted.length > 0) ?
+		sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))] : null;
+	var counts = buckets.map(le => ({le: le, count: 0})).concat([{le: null, count: 0}]);
+	sorted.forEach( value => {
+		var i = buckets.findIndex(le => value <= le);
+		counts[(i < 0) ? buckets.length : i].count++;
+	});
+	return {
+		count: sorted.length,
+		p50: percentile(0.5),
+		p95: percentile(0.95),
+		max: (sorted.length > 0) ? sorted[sorted.length - 1] : null,
+		buckets: counts
+	};
+}
+exports.histogram = histogram;
@@ -0,0 +1,416 @@
+"use strict";
+/**
+ * Gateway load test: emulates a gateway with N virtual outlets on a pty and
+ * reports how fast the server ingests their traffic.
+ *
+ * Outlets join with a handshake, send sensor (and energy) reports every
+ * --period seconds, are reported lost and rejoin, and ack the actions and
+ * config the server sends them. The server's own counters (GET /stats/ingest)
+ * give its ingest throughput, handling latency and MongoDB write latency.
+ *
+ *   node load_test.js --outlets 2000 --period 10 --spawn
+ *
+ * Without --spawn, start the server on the printed port yourself:
+ *   node index.js /tmp/dicio-gateway
+ *
+ * Outlet addresses start at 2. The gateway firmware and the command format
+ * only carry 8-bit addresses, so beyond 254 outlets commands reach the outlet
+ * with the same low byte (as they would over the mesh); reports still use the
+ * full address, which is enough to load the server.
+ */
+const fs = require('fs');
+const http = require('http');
+const spawn = require('child_process').spawn;
+const VirtualGateway = require('./lib/VirtualGateway');
+
+const OPTIONS = {
+	'outlets':    {value: 1000, help: 'virtual outlets'},
+	'period':     {value: 10, help: 'seconds between an outlet\'s sensor reports'},
+	'energy':     {value: 6, help: 'sensor reports per energy report (0: none)'},
+	'duration':   {value: 60, help: 'seconds to run'},
+	'join-rate':  {value: 50, help: 'handshakes per second while outlets join'},
+	'lost':       {value: 2, help: 'lost node events per minute'},
+	'rejoin':     {value: 30, help: 'seconds before a lost outlet handshakes again'},
+	'actions':    {value: 6, help: 'ON/OFF requests made through the REST API per minute'},
+	'ack-ms':     {value: 250, help: 'mesh delay (ms) before an outlet acks a command'},
+	'baud':       {value: 38400, help: 'gateway UART rate (0: as fast as the server reads)'},
+	'port':       {value: '/tmp/dicio-gateway', help: 'pty link the server opens'},
+	'server':     {value: 'http://127.0.0.1:3000', help: 'server address (\'none\': no stats)'},
+	'spawn':      {value: false, help: 'start the server (node index.js <port>)'},
+	'server-log': {value: '/dev/null', help: 'server output when spawned'},
+	'interval':   {value: 5, help: 'seconds between progress reports'}
+};
+
+const FIRST_OUTLET_MAC    = 2;
+const HEARTBEAT_PERIOD_MS = 5000;  // gateway alive_task period
+const RESET_SENDS         = 2;     // MAX_RESET_SENDS
+const TICK_MS             = 50;
+const GROUP_ACK_SPREAD_MS = 2000;  // members spread their group action acks
+const CONFIG_PARAM_GROUPS = 8;
+const CONFIG_OK           = 0;
+const SERVER_WAIT_MS      = 30000;
+const NODE_RX_ACT_MS      = 5;     // outlet: command received -> relay driven
+const NODE_ACT_ACK_MS     = 20;    // outlet: relay driven -> ack queued
+
+/*
+ * Parse "--name value" and "--flag" arguments into a copy of OPTIONS' values.
+ */
+function parseArgs(argv) {
+	var opts = {};
+	Object.keys(OPTIONS).forEach(name => opts[name] = OPTIONS[name].value);
+	for (var i = 0; i < argv.length; i++) {
+		var name = argv[i].replace(/^--/, '');
+		if (!OPTIONS.hasOwnProperty(name)) {
+			console.log('usage: node load_test.js [options]');
+			Object.keys(OPTIONS).forEach(name => {
+				console.log(`  --${(name + '            ').slice(0, 12)} ${OPTIONS[name].help} (${OPTIONS[name].value})`);
+			});
+			process.exit(name === 'help' ? 0 : 1);
+		}
+		if (typeof OPTIONS[name].value === 'boolean') {
+			opts[name] = true;
+		} else if (typeof OPTIONS[name].value === 'number') {
+			opts[name] = parseFloat(argv[++i]);
+		} else {
+			opts[name] = argv[++i];
+		}
+	}
+	return opts;
+}
+
+function random(min, max) {
+	return min + Math.random() * (max - min);
+}
+
+/*
+ * One virtual outlet: its sensor values, relay state and config.
+ */
+class Outlet {
+	constructor(mac) {
+		this.mac = mac;
+		this.hops = Math.floor(random(0, 3));
+		this.hardwareVersion = 0x00010000 | (mac & 0xFFFF);
+		this.seqNum = 0;
+		this.state = 1;
+		this.load = Math.round(random(20, 1500));
+		this.temperature = Math.round(random(200, 280));
+		this.light = Math.round(random(0, 1023));
+		this.energy = 0;
+		this.powerMin = null;
+		this.powerMax = null;
+		this.reports = 0;
+		this.groups = 0;
+		this.joined = false;
+		this.nextReport = 0;
+	}
+
+	nextSeqNum() {
+		this.seqNum = (this.seqNum + 1) % 65536;
+		return this.seqNum;
+	}
+
+	power() {
+		return (this.state) ? Math.round(this.load * random(0.95, 1.05)) : 0;
+	}
+}
+
+/*
+ * GET a JSON document from the server.
+ * @returns Promise<Object>
+ */
+function getJson(url) {
+	return new Promise( (resolve, reject) => {
+		http.get(url, res => {
+			var body = '';
+			res.on('data', chunk => body += chunk);
+			res.on('end', () => {
+				try {
+					resolve(JSON.parse(body));
+				} catch (err) {
+					reject(new Error(`${url}: ${res.statusCode} ${body.slice(0, 80)}`));
+				}
+			});
+		}).on('error', reject);
+	});
+}
+
+/*
+ * Retry getJson until the server answers or SERVER_WAIT_MS has passed.
+ */
+function waitForServer(url) {
+	var deadline = Date.now() + SERVER_WAIT_MS;
+	var attempt = () => getJson(url).catch(err => {
+		if (Date.now() > deadline) {
+			throw err;
+		}
+		return new Promise(resolve => setTimeout(resolve, 500)).then(attempt);
+	});
+	return attempt();
+}
+
+function ms(value) {
+	return (value === null) ? '-' : `${value} ms`;
+}
+
+function main() {
+	var opts = parseArgs(process.argv.slice(2));
+	var useServer = opts.server !== 'none';
+	var gateway = new VirtualGateway(opts.port, opts.baud);
+	var outlets = [];
+	var byAddr = {};   // 8-bit address => outlets (see the note above)
+	var joinQueue = [];
+	var joinCredit = 0;
+	var resetsSent = 0;
+	var commands = {action: 0, group: 0, config: 0, sync: 0, malformed: 0};
+	var acks = 0;
+	var requests = [];        // REST action requests waiting for their frame
+	var requestMs = [];       // REST request -> command frame at the gateway
+	var outletIds = null;     // mac_address => _id, fetched for REST actions
+	var server = null;
+	var start = null;
+	var last = null;
+
+	for (var mac = FIRST_OUTLET_MAC; mac < FIRST_OUTLET_MAC + opts.outlets; mac++) {
+		var outlet = new Outlet(mac);
+		outlets.push(outlet);
+		(byAddr[mac & 0xFF] = byAddr[mac & 0xFF] || []).push(outlet);
+		joinQueue.push(outlet);
+	}
+
+	function join(outlet) {
+		outlet.joined = true;
+		outlet.nextReport = Date.now() + random(0, opts.period * 1000);
+		gateway.sendHandshakeAck(outlet.mac, outlet.hardwareVersion);
+	}
+
+	function report(outlet, now) {
+		var power = outlet.power();
+		outlet.temperature = Math.max(150, Math.min(350, outlet.temperature + Math.round(random(-2, 2))));
+		outlet.light = Math.max(0, Math.min(1023, outlet.light + Math.round(random(-20, 20))));
+		outlet.energy += power * opts.period;
+		outlet.powerMin = (outlet.powerMin === null) ? power : Math.min(outlet.powerMin, power);
+		outlet.powerMax = (outlet.powerMax === null) ? power : Math.max(outlet.powerMax, power);
+		gateway.sendSensorData(outlet, power, outlet.temperature, outlet.light, outlet.state);
+		outlet.reports++;
+		if (opts.energy > 0 && outlet.reports % opts.energy === 0) {
+			gateway.sendEnergy(outlet, outlet.energy, outlet.powerMin, outlet.powerMax);
+			outlet.powerMin = outlet.powerMax = null;
+		}
+		// +-10% jitter so the outlets don't fall into step
+		outlet.nextReport = now + opts.period * 1000 * random(0.9, 1.1);
+	}
+
+	function tick() {
+		var now = Date.now();
+		joinCredit = Math.min(joinCredit + opts['join-rate'] * TICK_MS / 1000, opts['join-rate']);
+		while (resetsSent >= RESET_SENDS && joinQueue.length > 0 && joinCredit >= 1) {
+			join(joinQueue.shift());
+			joinCredit--;
+		}
+		outlets.forEach( outlet => {
+			if (outlet.joined && now >= outlet.nextReport) {
+				report(outlet, now);
+			}
+		});
+	}
+
+	function heartbeat() {
+		if (resetsSent < RESET_SENDS) {
+			gateway.sendReset();
+			resetsSent++;
+		} else {
+			gateway.sendHeartbeat();
+		}
+	}
+
+	// A random joined outlet drops off the mesh and handshakes again later
+	function loseOutlet() {
+		var joined = outlets.filter(outlet => outlet.joined);
+		if (joined.length === 0) {
+			return;
+		}
+		var outlet = joined[Math.floor(Math.random() * joined.length)];
+		outlet.joined = false;
+		gateway.sendLostNodes([outlet.mac]);
+		setTimeout(() => joinQueue.push(outlet), opts.rejoin * 1000);
+	}
+
+	/*
+	 * Ack a command after the mesh delay. Group members (gatewayQueue null)
+	 * spread their acks and carry no gateway timing, like the firmware.
+	 */
+	function ackAction(outlet, cmdId, action, gatewayQueue) {
+		var group = gatewayQueue === null;
+		var delay = opts['ack-ms'] * random(0.5, 1.5) + (group ? random(0, GROUP_ACK_SPREAD_MS) : 0);
+		setTimeout( () => {
+			if (!outlet.joined) {
+				return;
+			}
+			outlet.state = action ? 1 : 0;
+			gateway.sendActionAck(outlet, cmdId, outlet.state, {
+				rxAct: NODE_RX_ACT_MS,
+				actAck: NODE_ACT_ACK_MS,
+				gatewayQueue: group ? 0 : gatewayQueue,
+				gatewayNet: group ? 0 : Math.round(delay)
+			});
+			acks++;
+		}, delay);
+	}
+
+	gateway.on('action', cmd => {
+		commands.action++;
+		var request = requests.shift();
+		if (request) {
+			requestMs.push(Date.now() - request);
+		}
+		(byAddr[cmd.dest] || []).slice(0, 1).forEach(outlet => {
+			ackAction(outlet, cmd.cmdId, cmd.action, Math.round(random(0, 50)));
+		});
+	});
+
+	gateway.on('group', cmd => {
+		commands.group++;
+		var bit = 1 << (cmd.group - 1);
+		outlets.filter(outlet => outlet.groups & bit).forEach(outlet => {
+			ackAction(outlet, cmd.cmdId, cmd.action, null);
+		});
+	});
+
+	gateway.on('config', cmd => {
+		commands.config++;
+		(byAddr[cmd.dest] || []).slice(0, 1).forEach( outlet => {
+			if (cmd.param === CONFIG_PARAM_GROUPS) {
+				outlet.groups = cmd.value;
+			}
+			setTimeout( () => {
+				gateway.sendConfigAck(outlet, cmd.cmdId, cmd.param, cmd.value, CONFIG_OK);
+				acks++;
+			}, opts['ack-ms'] * random(0.5, 1.5));
+		});
+	});
+
+	gateway.on('sync', req => {
+		commands.sync++;
+		gateway.sendSync(req.syncId, outlets.filter(outlet => outlet.joined));
+	});
+
+	gateway.on('malformed', () => commands.malformed++);
+
+	// Toggle a random joined outlet through the REST API, like the app does
+	function requestAction() {
+		var joined = outlets.filter(outlet => outlet.joined);
+		if (joined.length === 0) {
+			return;
+		}
+		var outlet = joined[Math.floor(Math.random() * joined.length)];
+		var fetchIds = (outletIds && outletIds[outlet.mac]) ? Promise.resolve(outletIds) :
+			getJson(`${opts.server}/outlets/`).then( list => {
+				outletIds = {};
+				list.forEach(doc => outletIds[doc.mac_address] = doc._id);
+				return outletIds;
+			});
+		fetchIds.then( ids => {
+			if (!ids[outlet.mac]) {
+				return;
+			}
+			requests.push(Date.now());
+			return getJson(`${opts.server}/outlets/${ids[outlet.mac]}/${outlet.state ? 'off' : 'on'}`);
+		}).catch(err => console.error('action request failed:', err.message));
+	}
+
+	function sentSummary() {
+		return Object.keys(gateway.sent).map(type =>
+			`${VirtualGateway.MESSAGE_NAMES[type] || type} ${gateway.sent[type]}`).join(', ');
+	}
+
+	function progress() {
+		var now = Date.now();
+		var lines = Object.keys(gateway.sent).reduce((sum, type) => sum + gateway.sent[type], 0);
+		var joined = outlets.filter(outlet => outlet.joined).length;
+		var secs = (now - last.time) / 1000;
+		var line = `[${Math.round((now - start) / 1000)}s] ${joined}/${outlets.length} joined, ` +
+			`tx ${Math.round((lines - last.lines) / secs)} lines/s, uart queue ${gateway.queuedBytes} B`;
+		last.time = now;
+		last.lines = lines;
+		if (!useServer) {
+			return console.log(line);
+		}
+		getJson(`${opts.server}/stats/ingest`).then( stats => {
+			var writes = Object.keys(stats.write_ms).map(collection =>
+				`${collection} ${ms(stats.write_ms[collection].p95)}`).join(', ');
+			console.log(`${line} | server ${Math.round((stats.handled - last.handled) / secs)} handled/s, ` +
+				`${stats.in_flight} in flight, handle p95 ${ms(stats.handle_ms.p95)} | write p95 ${writes || '-'}`);
+			last.handled = stats.handled;
+		}).catch(err => console.log(`${line} | server: ${err.message}`));
+	}
+
+	function printHistogram(name, h) {
+		console.log(`  ${(name + '                ').slice(0, 16)} n ${h.count}, p50 ${ms(h.p50)}, p95 ${ms(h.p95)}, max ${ms(h.max)}`);
+	}
+
+	function finish() {
+		gateway.close();
+		var secs = (Date.now() - start) / 1000;
+		console.log(`\n${outlets.length} outlets, ${Math.round(secs)} s, every ${opts.period} s, uart ${opts.baud || 'unlimited'}`);
+		console.log(`gateway sent ${Math.round(gateway.sentBytes / secs)} B/s: ${sentSummary()}`);
+		console.log(`  ${gateway.queue.length} lines still queued, max queue ${gateway.maxQueuedBytes} B`);
+		console.log(`server commands: ${commands.action} action, ${commands.group} group, ` +
+			`${commands.config} config, ${commands.sync} sync, ${commands.malformed} malformed; ${acks} acks sent`);
+		if (requestMs.length > 0) {
+			var sorted = requestMs.sort((a, b) => a - b);
+			console.log(`  REST action -> gateway: p50 ${sorted[Math.floor(sorted.length / 2)]} ms, max ${sorted[sorted.length - 1]} ms`);
+		}
+		var done = () => {
+			if (server) {
+				server.kill();
+			}
+			process.exit(0);
+		};
+		if (!useServer) {
+			return done();
+		}
+		getJson(`${opts.server}/stats/ingest`).then( stats => {
+			console.log(`server ingest: ${stats.received} received, ${stats.handled} handled ` +
+				`(${(stats.handled / stats.seconds).toFixed(1)}/s), ${stats.in_flight} in flight, max ${stats.max_in_flight}`);
+			printHistogram('handle', stats.handle_ms);
+			Object.keys(stats.write_ms).forEach(collection => printHistogram(`write ${collection}`, stats.write_ms[collection]));
+		}).catch(err => console.error('server stats:', err.message)).then(done);
+	}
+
+	gateway.open().then( () => {
+		console.log(`gateway on ${opts.port}`);
+		if (opts.spawn) {
+			var log = fs.openSync(opts['server-log'], 'a');
+			server = spawn(process.execPath, ['index.js', opts.port], {cwd: __dirname, stdio: ['ignore', log, log]});
+			server.on('exit', code => console.error(`server exited (${code})`));
+		} else if (useServer) {
+			console.log(`waiting for the server: node index.js ${opts.port}`);
+		}
+		return useServer ? waitForServer(`${opts.server}/stats/ingest/clear`) : null;
+	}).then( () => {
+		start = Date.now();
+		last = {time: start, lines: 0, handled: 0};
+		heartbeat();
+		setInterval(heartbeat, HEARTBEAT_PERIOD_MS);
+		setInterval(tick, TICK_MS);
+		setInterval(progress, opts.interval * 1000);
+		if (opts.lost > 0) {
+			setInterval(loseOutlet, 60000 / opts.lost);
+		}
+		if (useServer && opts.actions > 0) {
+			setInterval(requestAction, 60000 / opts.actions);
+		}
+		setTimeout(finish, opts.duration * 1000);
+	}).catch( err => {
+		console.error(err.message);
+		gateway.close();
+		if (server) {
+			server.kill();
+		}
+		process.exit(1);
+	});
+
+	process.on('SIGINT', finish);
+}
+
+main();
@@ -3,6 +3,9 @@ var ObjectId = mongoose.Schema.ObjectId;
 
 var groupSchema = new mongoose.Schema({
 	name: {type: String, default: "NEW GROUP"},
+	// small id the outlets know the group by (1..Gateway.MAX_GROUP_ID), unset
+	// if every id was taken when the group was created
+	group_id: Number,
 	outlets: [{type: ObjectId, ref: 'Outlet'}]
 });
 
@@ -0,0 +1,19 @@
+var mongoose = require('mongoose');
+
+// One acknowledged action, with the time (ms) spent in each stage between the
+// server sending it and receiving the outlet's ack. Stages the gateway can't
+// measure (group actions) are left unset.
+var latencyRecordSchema = new mongoose.Schema({
+	timestamp: {type: Date, default: Date.now},
+	mac_address: {type: String, required: true},
+	cmd_id: Number,
+	group: {type: Boolean, default: false},
+	total: Number,          // server send -> server receives ack
+	serial: Number,         // server <-> gateway, both directions
+	gateway_queue: Number,  // gateway received -> first radio transmission
+	radio: Number,          // gateway <-> outlet over the mesh, including retries
+	node_rx_act: Number,    // outlet received -> relay coil driven
+	node_act_ack: Number    // relay coil driven -> ack sent
+}, {collection: 'latency_records'});
+
+module.exports = mongoose.model('LatencyRecord', latencyRecordSchema);
@@ -11,6 +11,20 @@ var outletSchema = new mongoose.Schema({
 	cur_humidity: Number,
 	cur_light: Number,
 	cur_power: Number,
+	energy: Number, // Wh used since the node booted
+	window_power_min: Number,
+	window_power_max: Number,
+	// node configuration, as last acknowledged by the outlet
+	config: {
+		pwr_period: Number,
+		temp_period: Number,
+		light_period: Number,
+		pwr_deadband: Number,
+		temp_deadband: Number,
+		light_deadband: Number,
+		heartbeat: Number,
+		groups: Number // bit (group_id - 1) set for each group
+	},
 	active: {type: Boolean, default: true},
 	created: { type: Date, default: new Date() },
 	last_updated: { type: Date, default: new Date() }
@@ -135,3 +135,11 @@ RADIO = cc2420
 PLATFORM_FOUND = true 
 endif
 
+ifeq ($(PLATFORM_TYPE),posix)
+# Host build: Nano-RK runs as a Linux process with the FireFly3 pin map,
+# a pty in place of UART0 and a host radio in place of the rf231 SoC.
+# Notice that this sets architecture path, the mcu type and the radio
+MCU = posix
+RADIO = rf231_soc
+PLATFORM_FOUND = true
+endif
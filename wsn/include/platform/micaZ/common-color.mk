@@ -63,6 +63,7 @@ SRC += $(ROOT_DIR)/src/kernel/source/nrk.c
 SRC += $(ROOT_DIR)/src/kernel/source/nrk_stats.c
 SRC += $(ROOT_DIR)/src/kernel/source/nrk_error.c
 SRC += $(ROOT_DIR)/src/kernel/source/nrk_stack_check.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_trace.c
 SRC += $(ROOT_DIR)/src/kernel/source/nrk_events.c
 SRC += $(ROOT_DIR)/src/kernel/source/nrk_task.c
 SRC += $(ROOT_DIR)/src/kernel/source/nrk_time.c
@@ -0,0 +1,178 @@
+#-------------------------------------------------------------------------------
+# Host (POSIX) build of a Nano-RK project.
+#
+# The project makefile is unchanged: build it with PLATFORM=posix on the
+# command line and the kernel, the FireFly3 style platform layer and the
+# project sources are compiled with the host gcc into a Linux executable.
+#
+# On command line:
+#    make PLATFORM=posix = Make the host executable ($(TARGET)).
+#    make PLATFORM=posix clean = Clean out the host build.
+#
+# Objects are kept under $(OBJDIR)/ so that a host build never clobbers the
+# AVR objects that the firefly makefiles leave next to each source file.
+#
+#-------------------------------------------------------------------------------
+
+
+# Optimization level, can be [0, 1, 2, 3, s]. 0 turns off optimization.
+OPT = 2
+
+# By default the NODE_ADDR is 0
+ifndef NODE_ADDR 
+NODE_ADDR = 0
+endif
+
+
+RADIO_TYPE = $(strip $(RADIO))
+
+ifdef PLATFORM_FOUND
+
+SRC += $(ROOT_DIR)/src/radio/$(RADIO_TYPE)/hal/$(MCU)/basic_rf.c 
+
+
+
+SRC += $(ROOT_DIR)/src/platform/$(PLATFORM_TYPE)/source/ulib.c 
+SRC += $(ROOT_DIR)/src/platform/$(PLATFORM_TYPE)/source/hal_wait.c
+SRC += $(ROOT_DIR)/src/platform/$(PLATFORM_TYPE)/source/nrk_eeprom.c
+
+
+
+SRC += $(ROOT_DIR)/src/kernel/source/nrk.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_stats.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_error.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_stack_check.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_trace.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_events.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_task.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_time.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_idle_task.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_scheduler.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_driver.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_reserve.c
+SRC += $(ROOT_DIR)/src/kernel/source/nrk_sw_wdt.c
+SRC += $(ROOT_DIR)/src/kernel/hal/$(MCU)/nrk_timer.c
+SRC += $(ROOT_DIR)/src/kernel/hal/$(MCU)/nrk_status.c
+SRC += $(ROOT_DIR)/src/kernel/hal/$(MCU)/nrk_ext_int.c
+SRC += $(ROOT_DIR)/src/kernel/hal/$(MCU)/nrk_watchdog.c
+SRC += $(ROOT_DIR)/src/kernel/hal/$(MCU)/nrk_cpu.c
+
+
+# List any extra directories to look for include files here.
+#     Each directory must be seperated by a space.
+ifdef EXTRAINCDIRS 
+EXTRAINCDIRS += $(ROOT_DIR)/src/platform/include
+else
+EXTRAINCDIRS = $(ROOT_DIR)/src/platform/include
+endif
+EXTRAINCDIRS += $(ROOT_DIR)/src/platform/$(PLATFORM_TYPE)/include
+EXTRAINCDIRS += $(ROOT_DIR)/src/radio/$(RADIO_TYPE)/include
+EXTRAINCDIRS += $(ROOT_DIR)/src/radio/$(RADIO_TYPE)/hal/$(MCU)
+EXTRAINCDIRS += $(ROOT_DIR)/src/radio/$(RADIO_TYPE)/platform/$(PLATFORM_TYPE)
+EXTRAINCDIRS += $(ROOT_DIR)/src/drivers/include
+EXTRAINCDIRS += $(ROOT_DIR)/src/drivers/platform/$(PLATFORM_TYPE)/include
+EXTRAINCDIRS += $(ROOT_DIR)/src/kernel/include
+EXTRAINCDIRS += $(ROOT_DIR)/src/kernel/hal/include
+
+else
+
+PLATFORM_ERROR="ERROR Unknown platform:"
+endif
+
+# Optional compiler flags.
+#  -D NRK_POSIX:        select the host code paths in shared sources
+#  -D KERNEL_STK_ARRAY: the kernel stack canary lives in nrk_kernel_stk[]
+#  -fcommon:            the kernel headers carry tentative definitions
+#  -fgnu89-inline:      the kernel's "inline" functions are external ones
+CFLAGS += -g -D NANORK -D NRK_POSIX -D KERNEL_STK_ARRAY -D NODE_ADDR=$(NODE_ADDR) -O$(OPT) \
+-funsigned-char -funsigned-bitfields -fcommon \
+-Wall \
+$(patsubst %,-I%,$(EXTRAINCDIRS))
+
+
+# Set a "language standard" compiler flag.
+CFLAGS += -std=gnu99 -fgnu89-inline
+
+
+# Additional libraries
+# -lm = math library
+LDFLAGS += -lm
+
+
+# Define programs and commands.
+SHELL = sh
+
+CC = gcc
+
+REMOVE = rm -f
+REMOVEDIR = rm -rf
+
+
+# Define Messages
+# English
+MSG_ERRORS_NONE = Errors: none
+MSG_BEGIN = -------- begin --------
+MSG_END = --------  end  --------
+MSG_LINKING = Linking:
+MSG_COMPILING = Compiling:
+MSG_CLEANING = Cleaning project:
+
+
+# Object files live under OBJDIR with each "../" of the source path turned
+# into "__/" so that sources above the project directory stay inside it.
+OBJDIR = posix
+OBJ = $(addprefix $(OBJDIR)/,$(subst ../,__/,$(SRC:.c=.o)))
+
+# Combine all necessary flags and optional flags.
+ALL_CFLAGS = -I. $(CFLAGS)
+
+
+# Default target.
+all: begin $(TARGET) finished end
+
+begin:
+	@echo
+	@echo $(MSG_BEGIN)
+
+finished:
+	@echo $(MSG_ERRORS_NONE)
+	@echo Platform: $(PLATFORM_TYPE)
+end:
+	@echo $(MSG_END)
+ifdef PLATFORM_ERROR
+	@echo $(PLATFORM_ERROR)  $(PLATFORM_TYPE)
+endif
+
+
+# Link: create the host executable from object files.
+$(TARGET): $(OBJ)
+	@echo
+	@echo $(MSG_LINKING) $@
+	$(CC) $(ALL_CFLAGS) $(OBJ) --output $@ $(LDFLAGS)
+
+
+# Compile: create object files from C source files, along with the
+# dependency files that are pulled in below.
+.SECONDEXPANSION:
+$(OBJDIR)/%.o : $$(subst __/,../,$$*).c
+	@echo
+	@echo $(MSG_COMPILING) $<
+	@mkdir -p $(dir $@)
+	$(CC) -c -MMD -MP $(ALL_CFLAGS) $< -o $@
+
+
+# Target: clean project.
+clean: begin clean_list finished end
+
+clean_list :
+	@echo
+	@echo $(MSG_CLEANING)
+	$(REMOVE) $(TARGET)
+	$(REMOVEDIR) $(OBJDIR)
+
+
+-include $(OBJ:.o=.d)
+
+
+# Listing of phony targets.
+.PHONY : all begin finished end clean clean_list
@@ -0,0 +1,34 @@
+#!/bin/bash
+## Dicio - A Smart Outlet Mesh Network
+## compare.sh (bench)
+##
+## Compares two benchmark runs, e.g. before and after an optimization:
+##
+##   NRK_POSIX_UART=stdio ./main > before.txt
+##   ...
+##   ./compare.sh before.txt after.txt
+##
+## Uses the fastest batch of each benchmark, which is steadier than the mean
+## on a host with other work going on.  Set FIELD=mean to compare means.
+
+if [ $# -ne 2 ]; then
+	echo "usage: $0 before after" >&2
+	exit 1
+fi
+
+awk -v field="${FIELD:-min}" '
+# "bench <name> <mean> <min> <unit>"
+$1 == "bench" && NF == 5 {
+	v = (field == "mean") ? $3 : $4
+	if(FNR == NR) { before[$2] = v; unit[$2] = $5; order[n++] = $2 }
+	else after[$2] = v
+}
+END {
+	printf "%-32s %10s %10s %8s\n", "benchmark", "before", "after", "change"
+	for(i = 0; i < n; i++) {
+		name = order[i]
+		if(!(name in after)) continue
+		change = (before[name] > 0) ? sprintf("%+.1f%%", 100 * (after[name] - before[name]) / before[name]) : "-"
+		printf "%-32s %10s %10s %8s %s\n", name, before[name], after[name], change, unit[name]
+	}
+}' "$1" "$2"
@@ -0,0 +1,333 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * main.c (bench)
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+// Microbenchmarks for the utility code on every packet's path: the packet
+//  queue, the sequence/alive pool, the parser and the assemblers.
+//
+//  make PLATFORM=posix   host build, ns per operation
+//                        (run with NRK_POSIX_UART=stdio ./main)
+//  make                  FireFly3 build, CPU cycles per operation on UART0
+//  make sim              kernel-free build run under simulavr, CPU cycles
+//                        per operation without the hardware
+//
+// Every result is one "bench <name> <mean> <min> <unit>" line, so two runs
+//  can be compared with compare.sh.
+
+// INCLUDES
+// standard nrk
+#include <nrk.h>
+#include <include.h>
+#include <ulib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <hal.h>
+#include <nrk_timer.h>
+// this package
+#include <assembler.h>
+#include <packet_queue.h>
+#include <parser.h>
+#include <pool.h>
+#ifdef NRK_POSIX
+#include <time.h>
+#endif
+
+// DEFINES
+// The host times a whole batch with the monotonic clock and reports tenths
+//  of a ns. The AVR builds time it with timer 1 counting CPU cycles, so a
+//  batch must stay under 65536 cycles (4ms at 16MHz).
+#ifdef NRK_POSIX
+#define BENCH_ROUNDS 100000
+#define BENCH_UNIT "ns"
+#define BENCH_DECIMAL 10
+typedef uint64_t bench_time_t;
+typedef uint64_t bench_sum_t;
+#else
+#define BENCH_ROUNDS 200
+#define BENCH_UNIT "cycles"
+#define BENCH_DECIMAL 1
+typedef uint16_t bench_time_t;
+typedef uint32_t bench_sum_t;
+#endif
+
+#define BENCH_MSG_TYPES (MSG_CMD_GROUP + 1)
+#define BENCH_POOL_LAST MAX_NEIGHBOR_TABLE // pool hits are on the last entry
+#define BENCH_POOL_MISS 0xFE // node address that is never in the pool
+
+#ifdef BENCH_SIMULAVR
+// simulavr copies every byte written here to its stdout (-W 0x20,-)
+#define BENCH_SIM_OUT (*(volatile uint8_t *)0x20)
+#endif
+
+/**
+ * bench_t struct - one benchmark
+ *
+ * @param name - reported name
+ * @param setup - untimed, run before every batch
+ * @param op - the timed operation
+ * @param arg - passed to setup and op (message type, node address)
+ * @param batch - calls to op per timed batch
+ */
+typedef struct {
+  const char *name;
+  void (*setup)(uint8_t arg);
+  void (*op)(uint8_t arg);
+  uint8_t arg;
+  uint8_t batch;
+} bench_t;
+
+// GLOBALS
+packet_queue g_queue;
+pool_t g_pool;
+packet g_packet;
+msg_view_t g_view;
+packet g_tx[BENCH_MSG_TYPES];                   // one filled packet per type
+uint8_t g_frame[BENCH_MSG_TYPES][MAX_BUF_SIZE]; // g_tx assembled for the network
+uint8_t g_frame_len[BENCH_MSG_TYPES];
+uint8_t g_serv_buf[RF_MAX_PAYLOAD_SIZE];
+
+#ifdef BENCH_SIMULAVR
+static int bench_sim_putc(char c, FILE *stream)
+{
+  BENCH_SIM_OUT = c;
+  return 0;
+}
+
+FILE g_sim_out = FDEV_SETUP_STREAM(bench_sim_putc, NULL, _FDEV_SETUP_WRITE);
+#endif
+
+// bench_timer_start - start the clock used by bench_now
+void bench_timer_start()
+{
+#if defined(NRK_POSIX)
+  // the monotonic clock is always running
+#elif defined(BENCH_SIMULAVR)
+  TCCR1A = 0;
+  TCCR1B = BM(CS10);  // clk I/O no prescale
+#else
+  _nrk_high_speed_timer_start();
+#endif
+}
+
+// bench_now - current time in BENCH_UNIT
+static inline bench_time_t bench_now()
+{
+#if defined(NRK_POSIX)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#elif defined(BENCH_SIMULAVR)
+  return TCNT1;
+#else
+  return _nrk_high_speed_timer_get();
+#endif
+}
+
+// fill_packet - give a packet of the given type recognizable field values
+void fill_packet(packet *p, msg_type type)
+{
+  p->source_id = 7;
+  p->seq_num = 0x1234;
+  p->type = type;
+  p->num_hops = 2;
+  for(uint8_t i = 0; i < MAX_PAYLOAD_SIZE; i++) {
+    p->payload[i] = 0x11 * (i + 1);
+  }
+}
+
+// OPERATIONS
+// bench_nothing - setup for benchmarks that need none, and the calibration op
+void __attribute__((noinline)) bench_nothing(uint8_t arg)
+{
+  asm volatile("");
+}
+
+void bench_queue_empty(uint8_t arg)
+{
+  packet_queue_init(&g_queue);
+}
+
+void bench_queue_full(uint8_t arg)
+{
+  packet_queue_init(&g_queue);
+  for(uint8_t i = 0; i < MAX_PACKET_BUFFER; i++) {
+    push(&g_queue, &g_tx[MSG_DATA]);
+  }
+}
+
+void bench_push(uint8_t arg)
+{
+  push(&g_queue, &g_tx[MSG_DATA]);
+}
+
+void bench_pop(uint8_t arg)
+{
+  pop(&g_queue, &g_packet);
+}
+
+// bench_pool_full - fill the pool with nodes 1..BENCH_POOL_LAST
+void bench_pool_full(uint8_t arg)
+{
+  clear_pool(&g_pool);
+  for(uint8_t i = 1; i <= BENCH_POOL_LAST; i++) {
+    add_to_pool(&g_pool, i, i);
+  }
+}
+
+void bench_in_pool(uint8_t arg)
+{
+  in_pool(&g_pool, arg);
+}
+
+void bench_update_pool(uint8_t arg)
+{
+  update_pool(&g_pool, arg, 0x4321);
+}
+
+void bench_parse(uint8_t arg)
+{
+  parse_msg(&g_packet, g_frame[arg], g_frame_len[arg]);
+}
+
+void bench_view(uint8_t arg)
+{
+  msg_view_init(&g_view, g_frame[arg], g_frame_len[arg]);
+}
+
+void bench_assemble(uint8_t arg)
+{
+  assemble_packet(g_serv_buf, &g_tx[arg]);
+}
+
+void bench_assemble_serv(uint8_t arg)
+{
+  assemble_serv_packet(g_serv_buf, &g_tx[arg]);
+}
+
+// BENCHMARKS
+const bench_t g_benches[] = {
+  {"push", bench_queue_empty, bench_push, 0, MAX_PACKET_BUFFER},
+  {"pop", bench_queue_full, bench_pop, 0, MAX_PACKET_BUFFER},
+  {"in_pool/hit", bench_pool_full, bench_in_pool, BENCH_POOL_LAST, 8},
+  {"in_pool/miss", bench_pool_full, bench_in_pool, BENCH_POOL_MISS, 8},
+  {"update_pool", bench_pool_full, bench_update_pool, BENCH_POOL_LAST, 8},
+  {"parse_msg/data", bench_nothing, bench_parse, MSG_DATA, 8},
+  {"parse_msg/cmd", bench_nothing, bench_parse, MSG_CMD, 8},
+  {"parse_msg/cmd_group", bench_nothing, bench_parse, MSG_CMD_GROUP, 8},
+  {"parse_msg/cmdack", bench_nothing, bench_parse, MSG_CMDACK, 8},
+  {"parse_msg/hand", bench_nothing, bench_parse, MSG_HAND, 8},
+  {"parse_msg/handack", bench_nothing, bench_parse, MSG_HANDACK, 8},
+  {"parse_msg/heartbeat", bench_nothing, bench_parse, MSG_HEARTBEAT, 8},
+  {"parse_msg/energy", bench_nothing, bench_parse, MSG_ENERGY, 8},
+  {"parse_msg/config", bench_nothing, bench_parse, MSG_CONFIG, 8},
+  {"parse_msg/configack", bench_nothing, bench_parse, MSG_CONFIGACK, 8},
+  {"msg_view_init/data", bench_nothing, bench_view, MSG_DATA, 8},
+  {"msg_view_init/cmdack", bench_nothing, bench_view, MSG_CMDACK, 8},
+  {"msg_view_init/energy", bench_nothing, bench_view, MSG_ENERGY, 8},
+  {"assemble_packet/data", bench_nothing, bench_assemble, MSG_DATA, 8},
+  {"assemble_packet/cmd", bench_nothing, bench_assemble, MSG_CMD, 8},
+  {"assemble_packet/cmdack", bench_nothing, bench_assemble, MSG_CMDACK, 8},
+  {"assemble_packet/handack", bench_nothing, bench_assemble, MSG_HANDACK, 8},
+  {"assemble_packet/heartbeat", bench_nothing, bench_assemble, MSG_HEARTBEAT, 8},
+  {"assemble_packet/energy", bench_nothing, bench_assemble, MSG_ENERGY, 8},
+  {"assemble_packet/config", bench_nothing, bench_assemble, MSG_CONFIG, 8},
+  // sprintf is slow on the AVR, keep these batches short
+  {"assemble_serv_packet/lost", bench_nothing, bench_assemble_serv, MSG_LOST, 2},
+  {"assemble_serv_packet/data", bench_nothing, bench_assemble_serv, MSG_DATA, 2},
+  {"assemble_serv_packet/cmdack", bench_nothing, bench_assemble_serv, MSG_CMDACK, 2},
+  {"assemble_serv_packet/handack", bench_nothing, bench_assemble_serv, MSG_HANDACK, 2},
+  {"assemble_serv_packet/heartbeat", bench_nothing, bench_assemble_serv, MSG_HEARTBEAT, 2},
+  {"assemble_serv_packet/energy", bench_nothing, bench_assemble_serv, MSG_ENERGY, 2},
+  {"assemble_serv_packet/configack", bench_nothing, bench_assemble_serv, MSG_CONFIGACK, 2},
+};
+
+// bench_measure - time BENCH_ROUNDS batches of op, setting the total and
+//  the fastest batch
+void bench_measure(const bench_t *b, void (*op)(uint8_t), bench_sum_t *total, bench_sum_t *fastest)
+{
+  bench_time_t start, elapsed;
+  *total = 0;
+  *fastest = (bench_sum_t)-1;
+  for(uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+    b->setup(b->arg);
+    start = bench_now();
+    for(uint8_t i = 0; i < b->batch; i++) {
+      op(b->arg);
+    }
+    elapsed = (bench_time_t)(bench_now() - start);
+    *total += elapsed;
+    if(elapsed < *fastest) {
+      *fastest = elapsed;
+    }
+  }
+}
+
+// bench_print - print a time per operation (scaled by BENCH_DECIMAL)
+void bench_print(bench_sum_t t)
+{
+  if(1 < BENCH_DECIMAL) {
+    printf(" %lu.%lu", (unsigned long)(t / BENCH_DECIMAL), (unsigned long)(t % BENCH_DECIMAL));
+  } else {
+    printf(" %lu", (unsigned long)t);
+  }
+}
+
+// bench_run - run one benchmark and print its mean and minimum time per
+//  operation, less the cost of timing an empty batch of the same size
+void bench_run(const bench_t *b)
+{
+  bench_sum_t total, fastest, empty_total, empty_fastest;
+  bench_sum_t ops = (bench_sum_t)BENCH_ROUNDS * b->batch;
+
+  bench_measure(b, bench_nothing, &empty_total, &empty_fastest);
+  bench_measure(b, b->op, &total, &fastest);
+
+  printf("bench %s", b->name);
+  bench_print((total > empty_total) ?
+    ((total - empty_total) * BENCH_DECIMAL + ops / 2) / ops : 0);
+  bench_print((fastest > empty_fastest) ?
+    (fastest - empty_fastest) * BENCH_DECIMAL / b->batch : 0);
+  printf(" %s\r\n", BENCH_UNIT);
+}
+
+// bench_prepare - build the packets and network frames the benchmarks use
+void bench_prepare()
+{
+  for(uint8_t type = 0; type < BENCH_MSG_TYPES; type++) {
+    fill_packet(&g_tx[type], type);
+    g_frame_len[type] = assemble_packet(g_frame[type], &g_tx[type]);
+    if(0 == g_frame_len[type]) {
+      g_frame_len[type] = HEADER_SIZE;
+    }
+  }
+}
+
+int main()
+{
+#ifdef BENCH_SIMULAVR
+  stdout = &g_sim_out;
+#else
+  nrk_setup_ports();
+  nrk_setup_uart(UART_BAUDRATE_115K2);
+#endif
+
+  bench_prepare();
+  bench_timer_start();
+  printf("bench start %u rounds\r\n", BENCH_ROUNDS);
+  for(uint8_t i = 0; i < sizeof(g_benches) / sizeof(g_benches[0]); i++) {
+    bench_run(&g_benches[i]);
+  }
+  printf("bench done\r\n");
+
+#if defined(NRK_POSIX) || defined(BENCH_SIMULAVR)
+  // simulavr stops at exit (-T exit)
+  exit(0);
+#else
+  while(1);
+#endif
+  return 0;
+}
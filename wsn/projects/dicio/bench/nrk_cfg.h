@@ -0,0 +1,45 @@
+/***************************************************************
+*                            NanoRK CONFIG                     *
+***************************************************************/
+
+#ifndef __nrk_cfg_h	
+#define __nrk_cfg_h
+
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * nrk_cfg.h (bench)
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+// The benchmarks run from main() before the scheduler would start, so the
+// kernel only needs to be big enough to link.
+
+// NRK_REPORT_ERRORS will cause the kernel to print out information about
+// missed deadlines or reserve violations
+#define NRK_REPORT_ERRORS
+
+// Leave NRK_NO_POWER_DOWN define in if the target can not wake up from sleep 
+// because it has no asynchronously clocked
+#define NRK_NO_POWER_DOWN
+
+// This protects radio access to allow for multiple devices accessing
+// the radio
+#define RADIO_PRIORITY_CEILING		10
+
+// Max number of tasks in your application
+// Be sure to include the idle task
+#define NRK_MAX_TASKS       2
+#define	NRK_N_RES			1	
+
+#define NRK_TASK_IDLE_STK_SIZE 128   // Idle task stack size min=32 
+#define NRK_APP_STACKSIZE		256
+#define NRK_KERNEL_STACKSIZE    128
+
+ // number of semaphores in the system!
+#define NRK_MAX_RESOURCE_CNT           2
+
+#define NRK_MAX_DRIVER_CNT		1
+
+#endif
@@ -62,6 +62,72 @@ void pwr_read(uint16_t reg, uint8_t *read_buf) {
     read_buf[2] = send_receive_buf[4];
 }
 
+// pwr_burst_begin - select the sensor and start a read at reg. the sensor
+//  auto-increments the register address, so each register after it is just
+//  3 more clocked bytes until the chip select is released.
+static void pwr_burst_begin(uint16_t reg) {
+    nrk_gpio_clr(PWR_CS);
+    SPI_SendByte(0x01);                 // header
+    SPI_SendByte(GET_REG_ADDR(reg));    // address
+}
+
+// pwr_read_burst - read num_regs consecutive registers starting at reg in one
+//  chip select transaction. values are sign extended.
+void pwr_read_burst(uint16_t reg, uint8_t num_regs, int32_t *vals) {
+    uint8_t i;
+    int32_t val;
+
+    pwr_burst_begin(reg);
+    for(i = 0; i < num_regs; i++) {
+        val = (int32_t)SPI_SendByte(0x00) << 16;
+        val |= (int32_t)SPI_SendByte(0x00) << 8;
+        val |= (int32_t)SPI_SendByte(0x00);
+        // sign extend the 24 bit value
+        if(val & 0x800000) {
+            val |= 0xFF000000;
+        }
+        vals[i] = val;
+    }
+    nrk_gpio_set(PWR_CS);
+}
+
+// pwr_read_output - read the VA..PF output block
+void pwr_read_output(pwr_output_t *out) {
+    pwr_read_burst(VA, PWR_OUTPUT_REGS, (int32_t *)out);
+}
+
+// pwr_read_harm - read the VHARM..VAHARM harmonic block
+void pwr_read_harm(pwr_harm_t *harm) {
+    pwr_read_burst(VHARM, PWR_HARM_REGS, (int32_t *)harm);
+}
+
+// pwr_read_sg - read a list of registers straight into the callers buffers
+//  (chan = PWR_REG_CHAN(reg)). each run of consecutive channels is read in a
+//  single chip select burst. returns the number of entries filled.
+uint8_t pwr_read_sg(nrk_sg_entry_t *list, uint8_t count) {
+    uint8_t i;
+    for(i = 0; i < count; i++) {
+        if(PWR_READ_LEN > list[i].size) {
+            break;
+        }
+        // start a new burst unless this register follows the previous one
+        if((0 == i) || ((list[i-1].chan + 1) != list[i].chan)) {
+            if(0 < i) {
+                nrk_gpio_set(PWR_CS);
+            }
+            pwr_burst_begin(PWR_CHAN_REG(list[i].chan));
+        }
+        list[i].buf[0] = SPI_SendByte(0x00);
+        list[i].buf[1] = SPI_SendByte(0x00);
+        list[i].buf[2] = SPI_SendByte(0x00);
+        list[i].len = PWR_READ_LEN;
+    }
+    if(0 < i) {
+        nrk_gpio_set(PWR_CS);
+    }
+    return i;
+}
+
 // pwr_write - write to the power sensor
 void pwr_write(uint16_t reg, uint8_t *write_buf) {
     // initialize the message
@@ -76,9 +142,35 @@ void pwr_write(uint16_t reg, uint8_t *write_buf) {
     SPI_SendMessage(&send_receive_buf, &send_receive_buf, PWR_MSG_LEN, PWR_CS);
 }
 
-// transform_pwr - change power sensor reading to a fixed point value
-int16_t transform_pwr(int16_t counts) {
-    int16_t integer = (counts / PWR_MULT) * PWR_SCALE;
-    int16_t decimal = ((counts % PWR_MULT) * PWR_SCALE) / PWR_MULT;
-    return integer + decimal;
+// pwr_to_mw - power register (VA, VAR, WATT..) to milliwatts
+int32_t pwr_to_mw(int32_t raw) {
+    return (int32_t)(((int64_t)raw * PMAX) >> PWR_FRAC_BITS);
+}
+
+// pwr_to_mv - voltage register to millivolts
+int32_t pwr_to_mv(int32_t raw) {
+    return (int32_t)(((int64_t)raw * VMAX) >> PWR_FRAC_BITS);
+}
+
+// pwr_to_ma - current register to milliamps
+int32_t pwr_to_ma(int32_t raw) {
+    return (int32_t)(((int64_t)raw * IMAX) >> PWR_FRAC_BITS);
+}
+
+// pwr_to_pf_milli - power factor register to thousandths
+int16_t pwr_to_pf_milli(int32_t raw) {
+    return (int16_t)(((int64_t)raw * 1000) >> PWR_PF_FRAC_BITS);
+}
+
+// pwr_to_watts - magnitude of a power register in whole watts (for packets)
+uint16_t pwr_to_watts(int32_t raw) {
+    int32_t mw = pwr_to_mw(raw);
+    if(mw < 0) {
+        mw = -mw;
+    }
+    mw /= 1000;
+    if(mw > 0xFFFF) {
+        mw = 0xFFFF;
+    }
+    return (uint16_t)mw;
 }
\ No newline at end of file
@@ -10,10 +10,12 @@
 #define __power_sensor_h
 
 #include <type_defs.h>
+#include <nrk_driver.h>
 
 
 #define PWR_CS NRK_PORTB_5
 #define PWR_MSG_LEN 5
+#define PWR_READ_LEN 3
 
 // OUTPUT REGISTERS 
 #define COMMAND     0x00 // command register
@@ -99,8 +101,6 @@
 #define TC2         0x14D // temperature compensation 
 
 // scale constants
-#define PWR_MULT  55
-#define PWR_SCALE 10
 #define IMAX        0x002710 // 10 A
 #define VMAX        0x01D4C0 // 120 V
 #define PMAX        0x124F80 // 1200 VA
@@ -110,9 +110,48 @@
 
 #define GET_REG_ADDR(x) (((uint8_t)((uint16_t)x / 3)) & 0x3F) << 2
 
+// output registers are signed fractions of the full scale values above.
+//  power, voltage and current are S.23, power factor is S.22
+#define PWR_FRAC_BITS 23
+#define PWR_PF_FRAC_BITS 22
+
+// burst read blocks (registers must stay in address order)
+#define PWR_OUTPUT_REGS 7 // VA..PF
+#define PWR_HARM_REGS 5   // VHARM..VAHARM
+
+typedef struct {
+    int32_t va;
+    int32_t var;
+    int32_t vrms;
+    int32_t irms;
+    int32_t watt;
+    int32_t pa_average;
+    int32_t pf;
+} pwr_output_t;
+
+typedef struct {
+    int32_t vharm;
+    int32_t iharm;
+    int32_t pharm;
+    int32_t qharm;
+    int32_t vaharm;
+} pwr_harm_t;
+
+// register <-> scatter list channel (registers are 3 bytes wide)
+#define PWR_REG_CHAN(x) ((uint8_t)((uint16_t)(x) / 3))
+#define PWR_CHAN_REG(x) ((uint16_t)(x) * 3)
+
 void pwr_init();
 void pwr_read(uint16_t reg, uint8_t *read_buf);
 void pwr_write(uint16_t reg, uint8_t *write_buf);
-int16_t transform_pwr(int16_t counts);
+uint8_t pwr_read_sg(nrk_sg_entry_t *list, uint8_t count);
+void pwr_read_burst(uint16_t reg, uint8_t num_regs, int32_t *vals);
+void pwr_read_output(pwr_output_t *out);
+void pwr_read_harm(pwr_harm_t *harm);
+int32_t pwr_to_mw(int32_t raw);
+int32_t pwr_to_mv(int32_t raw);
+int32_t pwr_to_ma(int32_t raw);
+int16_t pwr_to_pf_milli(int32_t raw);
+uint16_t pwr_to_watts(int32_t raw);
 
 #endif
@@ -22,26 +22,47 @@
 #include <nrk_error.h>
 #include <nrk_sw_wdt.h>
 // this package
+#include <alive.h>
 #include <assembler.h>
+#include <cmd_table.h>
+#include <dedup.h>
 #include <packet_queue.h>
 #include <parser.h>
 #include <pool.h>
+#include <registry.h>
+#include <relay.h>
+#include <trace.h>
 #include <type_defs.h>
 
 // DEFINES
+#ifdef NRK_POSIX
+// simulated nodes share one build and take their address from NRK_POSIX_MAC
+#define MAC_ADDR _nrk_posix_mac_addr(1)
+#else
 #define MAC_ADDR 1
+#endif
 
 // FUNCTION DECLARATIONS
 uint8_t inline atomic_size(packet_queue *pq, nrk_sem_t *mux);
 void inline atomic_push(packet_queue *pq, packet *p, nrk_sem_t *mux);
 void inline atomic_pop(packet_queue *pq, packet *p, nrk_sem_t *mux);
 uint16_t inline atomic_increment_seq_num();
-uint8_t inline atomic_received_ack();
-void inline atomic_update_received_ack(uint8_t update);
+void inline atomic_track_cmd(packet *cmd);
+void inline atomic_sent_cmd(packet *cmd);
+uint8_t inline atomic_ack_cmd(packet *ack);
+void inline atomic_alive_heard(uint8_t node_id, msg_view_t *msg);
+uint8_t inline atomic_alive_tick(uint8_t *lost_ids);
+void inline atomic_registry_flush(void);
+void registry_restore(void);
+void inline atomic_request_sync(uint8_t sync_id);
+void send_sync(uint8_t sync_id);
 void tx_net_task(void);
 uint8_t get_server_input(void);
 void copy_packet(packet *dest, packet *src);
 void clear_serv_buf();
+void serv_unpack_7bit(uint8_t *field);
+uint8_t serv_unpack_block(uint8_t *buf, uint8_t len);
+void serv_forward_ota(void);
 void rx_node_task(void);
 void rx_serv_task(void);
 void tx_serv_task(void);
@@ -66,8 +87,9 @@ NRK_STK alive_task_stack[NRK_APP_STACKSIZE];
 
 // BUFFERS
 uint8_t g_net_rx_buf[RF_MAX_PAYLOAD_SIZE];
-uint8_t g_serv_rx_buf[MAX_RX_UART_BUF];
+uint8_t g_serv_rx_buf[RF_MAX_PAYLOAD_SIZE];
 uint8_t g_serv_rx_index = 0;
+uint8_t g_serv_rx_overflow = FALSE;
 uint8_t g_serv_tx_index = 0;
 uint8_t g_net_tx_buf[RF_MAX_PAYLOAD_SIZE];
 uint8_t g_net_tx_index = 0;
@@ -83,6 +105,7 @@ packet_queue g_serv_tx_queue;
 nrk_sem_t* g_serv_tx_queue_mux;
 packet_queue g_hand_rx_queue;
 nrk_sem_t* g_hand_rx_queue_mux;
+relay_queue_t g_ota_queue; // OTA frames from the server, protected by g_net_tx_queue_mux
 
 // DRIVERS
 void nrk_register_drivers();
@@ -91,24 +114,28 @@ void nrk_register_drivers();
 pool_t g_seq_pool;
 uint16_t g_seq_num = 0;
 nrk_sem_t* g_seq_num_mux;
-uint16_t g_cmd_id = 0;
 
-// ALIVE POOL
-pool_t g_alive_pool;
-nrk_sem_t* g_alive_pool_mux;
+// DUPLICATE SUPPRESSION (frames heard both directly and through relays)
+dedup_t g_dedup;
 
-// COMMAND FLAGS
-uint8_t g_cmd_ack_received = TRUE;
+// NODE LIVENESS
+alive_t g_alive;
+nrk_sem_t* g_alive_mux;
+
+// NODE REGISTRY (kept in EEPROM across reboots, shares g_alive_mux)
+registry_t g_registry;
+
+// SERVER STATE SYNC (requested by the server when it connects)
+uint8_t g_sync_pending = FALSE;
+uint8_t g_sync_id;
+
+// COMMANDS IN FLIGHT
+cmd_table_t g_cmd_table;
 nrk_sem_t * g_cmd_mux;
 
 // GLOBAL FLAG
 uint8_t g_verbose;
 
-// Global last cmd
-packet g_last_cmd;
-uint8_t g_retry_cmd_counter = 0;
-uint8_t g_retry_limit_counter = 0;
-
 /***** END PREABMLE *****/
 
 /***** MAIN *****/
@@ -135,7 +162,7 @@ int main () {
   g_serv_tx_queue_mux = nrk_sem_create(1, 9);
   g_hand_rx_queue_mux = nrk_sem_create(1, 9);
   g_seq_num_mux       = nrk_sem_create(1, 9);
-  g_alive_pool_mux    = nrk_sem_create(1, 9);
+  g_alive_mux         = nrk_sem_create(1, 9);
   g_cmd_mux           = nrk_sem_create(1, 9);
 
   // packet queues
@@ -143,11 +170,19 @@ int main () {
   packet_queue_init(&g_node_tx_queue);
   packet_queue_init(&g_serv_tx_queue);
   packet_queue_init(&g_hand_rx_queue);
+  relay_queue_init(&g_ota_queue);
+  dedup_init(&g_dedup);
+  cmd_table_init(&g_cmd_table);
+  alive_init(&g_alive);
+  registry_restore();
 
   nrk_time_set (0, 0);
   bmac_task_config();
   nrk_create_taskset();
   bmac_init (13);
+  bmac_addr_decode_set_my_mac(MAC_ADDR);
+  bmac_addr_decode_dest_mac(BROADCAST_ADDR);
+  bmac_addr_decode_enable();
   nrk_start ();
   return 0;
 }
@@ -183,25 +218,131 @@ void inline atomic_pop(packet_queue *pq, packet *p, nrk_sem_t *mux) {
   //nrk_sem_post(mux);
 }
 
-uint8_t inline atomic_received_ack(){
-  uint8_t returnVal;
+// atomic_track_cmd - track a command until the node acks it
+void inline atomic_track_cmd(packet *cmd){
+  int8_t slot;
   //nrk_sem_pend(g_cmd_mux); 
   {
-    returnVal = g_cmd_ack_received;
+    slot = cmd_table_add(&g_cmd_table, cmd);
   }
   //nrk_sem_post(g_cmd_mux);
 
-  return returnVal;
+  if(-1 == slot) {
+    nrk_kprintf(PSTR("Command table full, sending without retries\r\n"));
+  }
 }
 
-void inline atomic_update_received_ack(uint8_t update){
+// atomic_sent_cmd - note the first radio transmission of a command
+void inline atomic_sent_cmd(packet *cmd){
+  volatile uint16_t now_ms = trace_now_ms();
   //nrk_sem_pend(g_cmd_mux); 
   {
-    g_cmd_ack_received = update;
+    cmd_table_sent(&g_cmd_table, cmd, now_ms);
   }
   //nrk_sem_post(g_cmd_mux);
 }
 
+// atomic_ack_cmd - match a command ack against the commands in flight, and
+//  add the gateway's stages to the ack's latency trace
+uint8_t inline atomic_ack_cmd(packet *ack){
+  uint8_t returnVal;
+  uint16_t queue_ms, net_ms;
+  uint16_t cmd_id = ((uint16_t)ack->payload[CMDACK_CMDID_INDEX] << 8) | ack->payload[CMDACK_CMDID_INDEX + 1];
+  volatile uint16_t now_ms = trace_now_ms();
+  //nrk_sem_pend(g_cmd_mux); 
+  {
+    returnVal = cmd_table_ack(&g_cmd_table, ack->source_id, cmd_id,
+      ack->payload[CMDACK_STATE_INDEX], now_ms, &queue_ms, &net_ms);
+  }
+  //nrk_sem_post(g_cmd_mux);
+
+  trace_put_ms(&ack->payload[CMDACK_GW_QUEUE_INDEX], queue_ms);
+  trace_put_ms(&ack->payload[CMDACK_GW_NET_INDEX], net_ms);
+  return returnVal;
+}
+
+// atomic_alive_heard - restart a node's liveness timeout and note its
+//  sequence number and any outlet state it reports. a handshake also sets the
+//  node's class from the hardware revision it reports. the node's class and
+//  sequence number are noted in the registry too.
+void inline atomic_alive_heard(uint8_t node_id, msg_view_t *msg){
+  uint8_t tracked;
+  uint8_t count;
+  msg_type type = msg_type_of(msg);
+  nrk_sem_pend(g_alive_mux);
+  {
+    tracked = alive_heard(&g_alive, node_id, msg_seq_num(msg));
+    if(MSG_HAND == type) {
+      tracked = alive_set_class(&g_alive, node_id, msg_u8(msg, HAND_CONFIG_ID_INDEX + 3));
+    } else if(MSG_DATA == type) {
+      alive_set_state(&g_alive, node_id, msg_u8(msg, DATA_STATE_INDEX));
+    } else if(MSG_CMDACK == type) {
+      alive_set_state(&g_alive, node_id, msg_u8(msg, CMDACK_STATE_INDEX));
+    } else if(MSG_DATA_BATCH == type) {
+      // the newest set's state
+      count = msg_u8(msg, BATCH_COUNT_INDEX);
+      if((0 < count) && (BATCH_MAX_SETS >= count)) {
+        alive_set_state(&g_alive, node_id, (msg_u8(msg, BATCH_STATE_INDEX) & (1 << (count - 1))) ? ON : OFF);
+      }
+    }
+    if(TRUE == tracked) {
+      registry_note(&g_registry, node_id, alive_class_of(&g_alive, node_id), msg_seq_num(msg));
+    }
+  }
+  nrk_sem_post(g_alive_mux);
+  if((FALSE == tracked) && (TRUE == g_verbose)) {
+    nrk_kprintf(PSTR("Alive table full\r\n"));
+  }
+}
+
+// atomic_alive_tick - advance the liveness timers, returns the number of
+//  nodes lost (their ids are put in lost_ids)
+uint8_t inline atomic_alive_tick(uint8_t *lost_ids){
+  uint8_t returnVal;
+  nrk_sem_pend(g_alive_mux);
+  {
+    returnVal = alive_tick(&g_alive, lost_ids, MAX_LOST_BATCH);
+  }
+  nrk_sem_post(g_alive_mux);
+  return returnVal;
+}
+
+// atomic_registry_flush - write one due registry record to EEPROM
+void inline atomic_registry_flush(){
+  nrk_sem_pend(g_alive_mux);
+  {
+    registry_flush(&g_registry);
+  }
+  nrk_sem_post(g_alive_mux);
+}
+
+// registry_restore - reload the nodes known before the last reboot, so their
+//  duplicates are still dropped and their liveness class is known without a
+//  new handshake
+void registry_restore() {
+  uint8_t node_id, node_class;
+  uint16_t seq_num;
+
+  registry_load(&g_registry);
+  for(uint8_t i = 0; i < MAX_ALIVE_NODES; i++) {
+    if(TRUE == registry_entry(&g_registry, i, &node_id, &node_class, &seq_num)) {
+      add_to_pool(&g_seq_pool, node_id, seq_num);
+      alive_restore(&g_alive, node_id, node_class);
+    }
+  }
+  printf("Registry: %d nodes\r\n", g_registry.size);
+}
+
+// atomic_request_sync - have tx_serv_task send the server a state sync
+void inline atomic_request_sync(uint8_t sync_id){
+  //nrk_sem_pend(g_alive_mux); 
+  {
+    g_sync_id = sync_id;
+    g_sync_pending = TRUE;
+  }
+  //nrk_sem_post(g_alive_mux);
+}
+
 // atomic_increment_seq_num - increment sequence number atomically and return
 uint16_t inline atomic_increment_seq_num() {
   uint16_t returnVal;
@@ -220,36 +361,48 @@ void copy_packet(packet *dest, packet *src){
   dest->seq_num = src->seq_num;
   dest->num_hops = src->num_hops;
 
-  for(uint8_t i = 0; i < MAX_PACKET_BUFFER; i++){
+  for(uint8_t i = 0; i < MAX_PAYLOAD_SIZE; i++){
     dest->payload[i] = src->payload[i];
   }
 }
 
-// get_server_input() - get UART data from server - end of message noted by a '\r'
+// get_server_input() - frame UART data from the server out of the ISR ring
+//  buffer - end of message noted by a '\r'. Stops at the first complete message
+//  so any commands queued behind it stay in the ring buffer for the next call.
 uint8_t get_server_input() {
   volatile uint8_t received;
 
   // loop until all bytes have been received
   while(nrk_uart_data_ready(NRK_DEFAULT_UART)) {
 
-    // get UART byte and add to buffer
+    // get UART byte
     received = getchar();
 
-    // if there is room, add it to the buffer.
-    if((RF_MAX_PAYLOAD_SIZE -1) > g_serv_rx_index) {
+    // print if appropriate
+    if(TRUE == g_verbose) {
+      printf("!%d", received);
+    }
+
+    // a message longer than the buffer is corrupt - drop everything up to and
+    //  including its '\r' so the following message is framed cleanly
+    if(TRUE == g_serv_rx_overflow) {
+      if('\r' == received) {
+        g_serv_rx_overflow = FALSE;
+        clear_serv_buf();
+      }
+      continue;
+    }
+
+    // if there is room, add it to the buffer (leaving room for the '\n')
+    if((RF_MAX_PAYLOAD_SIZE - 1) > g_serv_rx_index) {
       g_serv_rx_buf[g_serv_rx_index] = received;
       g_serv_rx_index++;
     }
-    // if there is not room, clear the buffer and then add the new byte.
+    // if there is not room, discard the rest of this message
     else {
+      g_serv_rx_overflow = ('\r' == received) ? FALSE : TRUE;
       clear_serv_buf();
-      g_serv_rx_buf[g_serv_rx_index] = received;
-      g_serv_rx_index++;
-    }
-
-    // print if appropriate
-    if(TRUE == g_verbose) {
-      printf("!%d", received);
+      continue;
     }
 
     // message has been completed
@@ -265,6 +418,64 @@ uint8_t get_server_input() {
   return SERV_MSG_INCOMPLETE;
 }
 
+// serv_unpack_7bit - convert a 16-bit field sent by the server as two 7-bit
+//  bytes (so it can never contain '\r') into the network's big-endian form
+void serv_unpack_7bit(uint8_t *field) {
+  volatile uint16_t val;
+  val = ((uint16_t)(field[0] & SERV_7BIT_MASK) << SERV_7BIT_SHIFT) | (field[1] & SERV_7BIT_MASK);
+  field[0] = (val >> 8) & 0xFF;
+  field[1] = val & 0xFF;
+}
+
+// serv_unpack_block - convert the server's 7-bit packing of a message's
+//  payload back in place. each group of up to seven bytes is sent as a byte
+//  holding their high bits followed by the bytes with their high bit set.
+//  returns the length of the message (len includes the "\r\n").
+uint8_t serv_unpack_block(uint8_t *buf, uint8_t len) {
+  uint8_t in = HEADER_SIZE;
+  uint8_t out = HEADER_SIZE;
+  uint8_t high;
+
+  len -= 2;
+  while(in < len) {
+    high = buf[in];
+    in++;
+    for(uint8_t bit = 0; (bit < SERV_7BIT_SHIFT) && (in < len); bit++) {
+      buf[out] = (buf[in] & SERV_7BIT_MASK) | (((high >> bit) & 1) << SERV_7BIT_SHIFT);
+      in++;
+      out++;
+    }
+  }
+  return out;
+}
+
+// serv_forward_ota - queue the OTA message in g_serv_rx_buf for the network as
+//  a frame from the gateway. its payload is longer than a packet's, so it is
+//  relayed as a frame rather than parsed.
+void serv_forward_ota() {
+  msg_view_t view;
+  volatile uint16_t seq_num;
+  uint8_t len = serv_unpack_block(g_serv_rx_buf, g_serv_rx_index);
+
+  if(FALSE == msg_view_init(&view, g_serv_rx_buf, len)) {
+    nrk_kprintf(PSTR("Malformed OTA message\r\n"));
+    return;
+  }
+  seq_num = atomic_increment_seq_num();
+  g_serv_rx_buf[HEADER_SRC_ID_INDEX] = MAC_ADDR;
+  g_serv_rx_buf[HEADER_SEQ_NUM_INDEX] = (seq_num >> 8) & 0xFF;
+  g_serv_rx_buf[HEADER_SEQ_NUM_INDEX + 1] = seq_num & 0xFF;
+  g_serv_rx_buf[HEADER_NUM_HOPS_INDEX] = 0;
+  nrk_sem_pend(g_net_tx_queue_mux);
+  {
+    if(RELAY_QUEUE_SIZE <= g_ota_queue.size) {
+      nrk_kprintf(PSTR("OTA queue full\r\n"));
+    }
+    relay_push(&g_ota_queue, g_serv_rx_buf, len, 0);
+  }
+  nrk_sem_post(g_net_tx_queue_mux);
+}
+
 // clear_serv_buf - clear the server recieve buffer
 void clear_serv_buf() {
   for(uint8_t i = 0; i < g_serv_rx_index; i++) {
@@ -296,15 +507,18 @@ void rx_node_task() {
   // local variable instantiation
   volatile int8_t rssi;
   volatile int8_t in_seq_pool;
-  volatile int8_t in_alive_pool;
   volatile uint8_t len;
   volatile uint8_t new_node = NONE;
   volatile uint8_t rx_source_id;
   volatile uint8_t rx_num_hops;
   volatile uint16_t local_seq_num;
   volatile uint16_t rx_seq_num;
-  volatile packet rx_packet;
+  msg_view_t rx_msg;
+  packet rx_packet;
   volatile msg_type rx_type;
+  volatile int8_t batch_count;
+  sample_set_t batch_sets[BATCH_MAX_SETS];
+  packet data_packet;
 
   uint8_t *local_rx_buf;
   // print task pid
@@ -324,26 +538,32 @@ void rx_node_task() {
     if(bmac_rx_pkt_ready()) {
       nrk_led_set(BLUE_LED);
 
-      // get the packet, parse and release
+      // get the packet and check it against its type's layout. it is read in
+      //  place and only copied out if it is queued for another task.
       local_rx_buf = bmac_rx_pkt_get(&len, &rssi);
-      //parse_msg(&rx_packet, (uint8_t *)&g_net_rx_buf, len);
-      parse_msg(&rx_packet, local_rx_buf, len);
-      bmac_rx_pkt_release ();
+      if(FALSE == msg_view_init(&rx_msg, local_rx_buf, len)) {
+        bmac_rx_pkt_release();
+        nrk_led_clr(BLUE_LED);
+        nrk_wait_until_next_period();
+        continue;
+      }
 
       // print incoming packet if appropriate
       if(TRUE == g_verbose) {
+        msg_view_copy(&rx_packet, &rx_msg);
         nrk_kprintf(PSTR("RX network: "));
         print_packet(&rx_packet);
       }
 
       // get message parameters
-      rx_source_id = rx_packet.source_id;
-      rx_seq_num = rx_packet.seq_num;
-      rx_type = rx_packet.type;
-      rx_num_hops = rx_packet.num_hops;
+      rx_source_id = msg_source_id(&rx_msg);
+      rx_seq_num = msg_seq_num(&rx_msg);
+      rx_type = msg_type_of(&rx_msg);
+      rx_num_hops = msg_num_hops(&rx_msg);
 
-      // only receive the message if it's not from the myself      
-      if(MAC_ADDR != rx_source_id) {
+      // only receive the message if it's not from the myself, and hasn't
+      //  already been received through another relay
+      if((MAC_ADDR != rx_source_id) && (FALSE == dedup_seen(&g_dedup, rx_source_id, rx_seq_num))) {
 
         // check to see if this node is in the sequence pool, if not then add it
         in_seq_pool = in_pool(&g_seq_pool, rx_source_id);
@@ -357,14 +577,8 @@ void rx_node_task() {
 
         if((rx_seq_num > local_seq_num) || (NODE_FOUND == new_node) || (MSG_HAND == rx_type)) {
 
-          // check to see if this node is in the ALIVE pool, if not then add it,
-          // If it is in the alive pool, update the counter to HEART FACTOR
-          in_alive_pool = in_pool(&g_alive_pool, rx_source_id);
-          if(NOT_IN_POOL == in_alive_pool) {
-            add_to_pool(&g_alive_pool, rx_source_id, HEART_FACTOR);
-          } else {
-            update_pool(&g_alive_pool, rx_source_id, HEART_FACTOR);
-          }
+          // the node is alive - restart its liveness timeout
+          atomic_alive_heard(rx_source_id, &rx_msg);
 
           // update the sequence pool and reset the new_node flag
           update_pool(&g_seq_pool, rx_source_id, rx_seq_num);
@@ -374,19 +588,57 @@ void rx_node_task() {
           switch(rx_type) {
             // command ack -> forward to server
             case MSG_CMDACK: {
-              // set CMD_ACK_RECEIVED flag to true
+              // stop retrying the command. the ack is forwarded either way,
+              //  it carries the outlet's actual state
+              msg_view_copy(&rx_packet, &rx_msg);
+              if((FALSE == atomic_ack_cmd(&rx_packet)) && (TRUE == g_verbose)) {
+                nrk_kprintf(PSTR("Unmatched command ack\r\n"));
+              }
               rx_packet.num_hops = rx_num_hops+1;
               atomic_push(&g_serv_tx_queue, &rx_packet, g_serv_tx_queue_mux);
               break;
             }
             // data received  -> forward to server
-            case MSG_DATA: {
+            case MSG_DATA:
+            case MSG_ENERGY:
+            case MSG_CONFIGACK:
+            case MSG_OTA_REPORT: {
+              msg_view_copy(&rx_packet, &rx_msg);
               rx_packet.num_hops = rx_num_hops+1;
               atomic_push(&g_serv_tx_queue, &rx_packet, g_serv_tx_queue_mux);
               break;
             }
+            // batched data received -> forward each set to the server as a data message
+            case MSG_DATA_BATCH: {
+              batch_count = parse_batch(local_rx_buf, len, batch_sets, BATCH_MAX_SETS);
+              if(0 >= batch_count) {
+                nrk_kprintf(PSTR("Malformed data batch\r\n"));
+                break;
+              }
+              data_packet.source_id = rx_source_id;
+              data_packet.seq_num = rx_seq_num;
+              data_packet.type = MSG_DATA;
+              data_packet.num_hops = rx_num_hops+1;
+              for(uint8_t i = 0; i < batch_count; i++) {
+                data_packet.payload[DATA_PWR_INDEX] = (batch_sets[i].pwr >> 8) & 0xFF;
+                data_packet.payload[DATA_PWR_INDEX + 1] = batch_sets[i].pwr & 0xFF;
+                data_packet.payload[DATA_TEMP_INDEX] = (batch_sets[i].temp >> 8) & 0xFF;
+                data_packet.payload[DATA_TEMP_INDEX + 1] = batch_sets[i].temp & 0xFF;
+                data_packet.payload[DATA_LIGHT_INDEX] = (batch_sets[i].light >> 8) & 0xFF;
+                data_packet.payload[DATA_LIGHT_INDEX + 1] = batch_sets[i].light & 0xFF;
+                data_packet.payload[DATA_STATE_INDEX] = batch_sets[i].state;
+                data_packet.payload[DATA_AGE_INDEX] = batch_sets[i].age;
+                if(MAX_PACKET_BUFFER <= atomic_size(&g_serv_tx_queue, g_serv_tx_queue_mux)) {
+                  nrk_kprintf(PSTR("Server queue full, batch truncated\r\n"));
+                  break;
+                }
+                atomic_push(&g_serv_tx_queue, &data_packet, g_serv_tx_queue_mux);
+              }
+              break;
+            }
             // handshake message recieved -> deal with in handshake function
             case MSG_HAND: {
+              msg_view_copy(&rx_packet, &rx_msg);
               atomic_push(&g_hand_rx_queue, &rx_packet, g_hand_rx_queue_mux);
               break;
             }
@@ -400,6 +652,7 @@ void rx_node_task() {
           }
         }
       }
+      bmac_rx_pkt_release();
       nrk_led_clr(BLUE_LED);
     }
     nrk_wait_until_next_period();
@@ -424,11 +677,26 @@ void rx_serv_task() {
 
   // loop forever
   while (1) {
-    // only execute if a full server message has been received
+    // handle every full server message waiting in the ring buffer
     msg_received = get_server_input();
-    if(SERV_MSG_RECEIVED == msg_received) {
+    while(SERV_MSG_RECEIVED == msg_received) {
       nrk_led_set(ORANGE_LED);
 
+      // OTA messages go out to the network as they are
+      switch(g_serv_rx_buf[HEADER_TYPE_INDEX]) {
+        case MSG_OTA_BEGIN:
+        case MSG_OTA_DATA:
+        case MSG_OTA_POLL:
+        case MSG_OTA_END:
+          serv_forward_ota();
+          clear_serv_buf();
+          nrk_led_clr(ORANGE_LED);
+          msg_received = get_server_input();
+          continue;
+        default:
+          break;
+      }
+
       // parse message
       parse_msg(&rx_packet, (uint8_t *)&g_serv_rx_buf, g_serv_rx_index);
       clear_serv_buf();
@@ -449,9 +717,33 @@ void rx_serv_task() {
       switch(rx_type) {
         // command received
         case MSG_CMD: {
+          serv_unpack_7bit((uint8_t *)&rx_packet.payload[CMD_CMDID_INDEX]);
+          trace_put_ms((uint8_t *)&rx_packet.payload[CMD_RX_MS_INDEX], trace_now_ms());
+          atomic_track_cmd(&rx_packet);
+          atomic_push(&g_net_tx_queue, &rx_packet, g_net_tx_queue_mux);
+          break;
+        }
+        // group command received - a single broadcast frame that every member
+        //  acts on. not tracked for retries since the gateway doesn't know the
+        //  members; the server follows up on outlets that never ack.
+        case MSG_CMD_GROUP: {
+          serv_unpack_7bit((uint8_t *)&rx_packet.payload[CMDG_CMDID_INDEX]);
+          rx_packet.payload[CMDG_GROUP_INDEX] &= SERV_7BIT_MASK;
+          atomic_push(&g_net_tx_queue, &rx_packet, g_net_tx_queue_mux);
+          break;
+        }
+        // config received - repack the 7-bit server fields and forward
+        case MSG_CONFIG: {
+          serv_unpack_7bit((uint8_t *)&rx_packet.payload[CONFIG_CMDID_INDEX]);
+          serv_unpack_7bit((uint8_t *)&rx_packet.payload[CONFIG_VALUE_INDEX]);
           atomic_push(&g_net_tx_queue, &rx_packet, g_net_tx_queue_mux);
           break;
         }
+        // state sync request - the server has (re)connected
+        case MSG_SYNC: {
+          atomic_request_sync(rx_packet.payload[SYNC_ID_INDEX] & SERV_7BIT_MASK);
+          break;
+        }
         case MSG_CMDACK:
         case MSG_DATA:
         case MSG_HAND:
@@ -462,8 +754,19 @@ void rx_serv_task() {
           break;
       }
       nrk_led_clr(ORANGE_LED);
+      msg_received = get_server_input();
     }
-    nrk_wait_until_next_period();
+
+    // sleep until the UART ISR queues more bytes. the UART signal is only
+    //  delivered while this task is waiting, so the ring is checked with
+    //  interrupts off and stays that way until nrk_event_wait has marked the
+    //  task as waiting - a byte can't land in between and go unnoticed
+    nrk_int_disable();
+    if(nrk_uart_data_ready(NRK_DEFAULT_UART)) {
+      nrk_int_enable();
+      continue;
+    }
+    nrk_event_wait(SIG(uart_rx_signal));
   }
   nrk_kprintf(PSTR("Fallthrough: rx_serv_task\r\n"));
 }
@@ -472,7 +775,8 @@ void rx_serv_task() {
 void tx_net_task() {
   // local variable instantiation
   volatile uint8_t local_tx_net_queue_size;
-  volatile uint8_t local_cmd_ack_received = FALSE;
+  volatile uint8_t cmd_status;
+  packet retry_packet;
   volatile uint8_t local_tx_buf[RF_MAX_PAYLOAD_SIZE];
   volatile uint8_t tx_length = 0;
   volatile uint16_t val;
@@ -491,6 +795,24 @@ void tx_net_task() {
 
   // loop forever - run the task
   while(1){
+    // requeue commands whose ack is overdue. retries come from the gateway
+    //  with a fresh sequence number so nodes don't discard them as duplicates
+    //nrk_sem_pend(g_cmd_mux); 
+    {
+      cmd_table_tick(&g_cmd_table);
+      while(CMD_NONE_DUE != (cmd_status = cmd_table_poll(&g_cmd_table, &retry_packet))) {
+        if(CMD_RETRY == cmd_status) {
+          retry_packet.source_id = MAC_ADDR;
+          retry_packet.seq_num = atomic_increment_seq_num();
+          retry_packet.num_hops = 0;
+          atomic_push(&g_net_tx_queue, &retry_packet, g_net_tx_queue_mux);
+        } else {
+          printf("Command to node %d was never acked\r\n", retry_packet.payload[CMD_NODE_ID_INDEX]);
+        }
+      }
+    }
+    //nrk_sem_post(g_cmd_mux);
+
     // atomically get the queue size
     local_tx_net_queue_size = atomic_size(&g_net_tx_queue, g_net_tx_queue_mux);
 
@@ -505,6 +827,26 @@ void tx_net_task() {
       if(NRK_OK != val) {
         nrk_kprintf(PSTR( "tx fail!\r\n" ));
       }
+      if(MSG_CMD == tx_packet.type) {
+        atomic_sent_cmd(&tx_packet);
+      }
+    }
+
+    // OTA frames from the server, the server paces them to one queue's
+    //  worth per period
+    for(uint8_t i = 0; i < RELAY_QUEUE_SIZE; i++) {
+      nrk_sem_pend(g_net_tx_queue_mux);
+      {
+        tx_length = relay_pop(&g_ota_queue, g_net_tx_buf);
+      }
+      nrk_sem_post(g_net_tx_queue_mux);
+      if(0 == tx_length) {
+        break;
+      }
+      val = bmac_tx_pkt(g_net_tx_buf, tx_length);
+      if(NRK_OK != val) {
+        nrk_kprintf(PSTR( "OTA tx fail!\r\n" ));
+      }
     }
     nrk_wait_until_next_period();
     
@@ -556,18 +898,47 @@ void tx_serv_task() {
       printf("%s\r\n", g_serv_tx_buf);
     }
     clear_serv_tx_buf();
+
+    // answer a sync request after the queued messages, so they are not
+    //  applied on top of the snapshot
+    if(TRUE == g_sync_pending) {
+      g_sync_pending = FALSE;
+      send_sync(g_sync_id);
+    }
     nrk_wait_until_next_period();
   }
   nrk_kprintf(PSTR("Fallthrough: tx_serv_task\r\n"));
 }
 
+// send_sync - send the server every node that is alive, with the outlet state
+//  and sequence number last heard from it, as one message:
+//  "1:seq:16:0:sync_id,node_id,state,seq_num,node_id,state,seq_num,..."
+//  it is longer than a packet, so it is written out as it is built. each
+//  entry is read under g_alive_mux, but not printed under it.
+void send_sync(uint8_t sync_id) {
+  uint8_t node_id, state, found;
+  uint16_t seq_num;
+
+  printf("%d:%u:%d:0:%d,", MAC_ADDR, atomic_increment_seq_num(), MSG_SYNC, sync_id);
+  for(uint8_t i = 0; i < MAX_ALIVE_NODES; i++) {
+    nrk_sem_pend(g_alive_mux);
+    {
+      found = alive_entry(&g_alive, i, &node_id, &state, &seq_num);
+    }
+    nrk_sem_post(g_alive_mux);
+    if(TRUE == found) {
+      printf("%d,%d,%u,", node_id, state, seq_num);
+    }
+  }
+  printf("\r\n");
+}
+
 // alive_task 
 //  - send heartbeat message to the network and user (LEDS) 
 //  - check heartbeat status of all nodes in the network
 void alive_task() {
   volatile uint8_t LED_FLAG = 0;
-  volatile uint8_t temp_id;
-  volatile uint8_t local_alive_pool_size;
+  volatile uint8_t lost_count;
   volatile uint8_t gateway_reset_counter = 0;
   volatile packet heart_packet, lost_packet;
   // print task 
@@ -582,6 +953,9 @@ void alive_task() {
   heart_packet.source_id = MAC_ADDR;
   heart_packet.type = MSG_HEARTBEAT;
   heart_packet.num_hops = 0;
+  heart_packet.payload[HEART_RELAY_INDEX] = MAC_ADDR;
+  heart_packet.payload[HEART_COST_INDEX] = 0;
+  heart_packet.payload[HEART_COST_INDEX + 1] = 0;
 
   // loop forever - run task
   while(1) {
@@ -611,29 +985,16 @@ void alive_task() {
     // add to the g_serv_tx_queue -> send to the server
     atomic_push(&g_serv_tx_queue, &heart_packet, g_serv_tx_queue_mux);
 
-    // decrement all items in alive pool
-    decrement_all(&g_alive_pool);
-    local_alive_pool_size = g_alive_pool.size;
-
-    // check all items in the alive pool to determine if any 
-    //  counters have expired
-    for(uint8_t i = 0; i < local_alive_pool_size; i ++){
-      // set temp_id to an invalid id
-      temp_id = 0;
-
-      // if alive_pool[i] is NOT_ALIVE set temp_id flags
-      uint8_t temp_val = g_alive_pool.data_vals[i];
-      if(ALIVE_LIMIT == temp_val){
-        g_alive_pool.data_vals[i] = NOT_ALIVE;
-        temp_id = g_alive_pool.node_id[i];
-      }
-
-      // if alive_pool[i] is NOT_ALIVE - send message to the server
-      if(0 != temp_id){
-        lost_packet.payload[LOST_NODE_INDEX] = temp_id;
-        atomic_push(&g_serv_tx_queue, &lost_packet, g_serv_tx_queue_mux);
-      }
+    // report every node whose liveness timeout ran out this period, in one
+    //  message to the server
+    lost_count = atomic_alive_tick((uint8_t *)&lost_packet.payload[LOST_NODE_INDEX]);
+    if(0 < lost_count) {
+      lost_packet.payload[LOST_COUNT_INDEX] = lost_count;
+      atomic_push(&g_serv_tx_queue, &lost_packet, g_serv_tx_queue_mux);
     }
+
+    // persist registry changes a record at a time
+    atomic_registry_flush();
     nrk_wait_until_next_period();
   }
   nrk_kprintf(PSTR("Fallthrough: alive_task\r\n"));
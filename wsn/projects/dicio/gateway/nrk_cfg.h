@@ -41,7 +41,9 @@
 // Enable buffered and signal controlled serial RX
 #define NRK_UART_BUF   1
 
-#define MAX_RX_UART_BUF 16
+// UART ISR ring buffer - large enough for several back-to-back server commands
+//  or one packed OTA data message (83 bytes)
+#define MAX_RX_UART_BUF 128
 
 
 // Max number of tasks in your application
@@ -12,27 +12,44 @@
 #include <include.h>
 #include <ulib.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <avr/sleep.h>
 #include <hal.h>
 #include <nrk_error.h>
 #include <nrk_timer.h>
+#include <nrk_ext_int.h>
 #include <nrk_driver_list.h>
 #include <nrk_driver.h>
 #include <adc_driver.h>
 #include <bmac.h>
 #include <nrk_sw_wdt.h>
+#include <nrk_stack_check.h>
 // this package
 #include <adc.h>
 #include <assembler.h>
+#include <batch.h>
+#include <config.h>
+#include <dedup.h>
 #include <dicio_spi.h>
 #include <power_sensor.h>
 #include <packet_queue.h>
+#include <ota.h>
+#include <ota_flash.h>
 #include <parser.h>
+#include <report.h>
+#include <relay.h>
+#include <route.h>
+#include <trace.h>
 #include <pool.h>
 #include <type_defs.h>
 
 // DEFINES
+#ifdef NRK_POSIX
+// simulated nodes share one build and take their address from NRK_POSIX_MAC
+#define MAC_ADDR _nrk_posix_mac_addr(5)
+#else
 #define MAC_ADDR 5
+#endif
 #define HARDWARE_REV 0xD1C1000
 
 // FUNCTION DECLARATIONS
@@ -53,12 +70,18 @@ uint8_t inline atomic_kick_watchdog();
 void tx_cmds(void);
 void tx_data(void);
 void inline clear_tx_buf(void);
+void inline apply_config(void);
+uint8_t inline atomic_flush_batch(batch_t *b);
+uint8_t inline atomic_in_group(uint8_t group);
+void inline atomic_update_groups(uint16_t groups);
+void inline atomic_queue_cmd_ack(packet *ack, uint8_t delayed);
+void inline atomic_queue_ota_report(packet *report, uint8_t status);
+void inline set_ack_trace(packet *ack, packet *cmd, uint16_t act_ms, uint8_t button);
 
 // tasks
 void rx_msg_task(void);
 void tx_net_task(void);
 void sample_task(void);
-void button_task(void);
 void actuate_task(void);
 void heartbeat_task(void);
 
@@ -78,17 +101,11 @@ typedef enum {
   STATE_ACK_ON
 } act_state;
 
-typedef enum {
-  STATE_SNIFF,
-  STATE_WAIT,
-} button_pressed_state;
-
 // TASKS
 nrk_task_type RX_MSG_TASK;
 nrk_task_type TX_NET_TASK;
 nrk_task_type SAMPLE_TASK;
 nrk_task_type ACTUATE_TASK;
-nrk_task_type BUTTON_TASK;
 nrk_task_type HEARTBEAT_TASK;
 
 // TASK STACKS
@@ -96,7 +113,6 @@ NRK_STK rx_msg_task_stack[NRK_APP_STACKSIZE];
 NRK_STK tx_net_task_stack[NRK_APP_STACKSIZE*8];
 NRK_STK sample_task_stack[NRK_APP_STACKSIZE*4];
 NRK_STK actuate_task_stack[NRK_APP_STACKSIZE];
-NRK_STK button_task_stack[NRK_APP_STACKSIZE];
 NRK_STK heartbeat_task_stack[NRK_APP_STACKSIZE];
 
 // BUFFERS
@@ -115,12 +131,48 @@ nrk_sem_t* g_cmd_tx_queue_mux;
 packet_queue g_data_tx_queue;
 nrk_sem_t* g_data_tx_queue_mux;
 
+packet_queue g_config_queue;
+nrk_sem_t* g_config_queue_mux;
+
+// GROUPS
+uint16_t g_groups; // protected by g_act_queue_mux
+packet g_group_ack[GROUP_ACKS_HELD]; // g_group_ack* are protected by g_cmd_tx_queue_mux
+uint8_t g_group_ack_delay[GROUP_ACKS_HELD]; // 0 if the slot is free
+
+// batch built by sample_task, and the flushed batch waiting for tx_data
+//  (g_batch_tx* are protected by g_data_tx_queue_mux)
+batch_t g_batch;
+batch_t g_batch_tx;
+uint16_t g_batch_tx_seq_num;
+uint8_t g_batch_tx_ready = FALSE;
+
+// OVER-THE-AIR UPDATE (g_ota is owned by rx_msg_task, g_ota_report* are
+//  protected by g_cmd_tx_queue_mux)
+ota_t g_ota;
+packet g_ota_report;
+uint8_t g_ota_report_delay;
+uint8_t g_ota_report_pending = FALSE;
+uint8_t g_ota_activate = FALSE;
+
 // SENSOR VALUES
 uint8_t g_atmega_adc_fd;
 uint8_t g_pwr_period;
 uint8_t g_temp_period;
 uint8_t g_light_period;
 sensor_packet g_sensor_pkt;
+report_t g_report;
+
+// DUPLICATE SUPPRESSION / RELAY
+dedup_t g_dedup;
+#ifdef NODE_RELAY
+relay_queue_t g_relay_queue; // protected by g_cmd_tx_queue_mux
+#endif
+
+// ROUTING (written only by rx_msg_task)
+route_t g_route;
+
+// CONFIGURATION (owned by sample_task once the taskset has started)
+config_t g_config;
 
 // SEQUENCE POOLS/NUMBER
 pool_t g_seq_pool;
@@ -137,8 +189,8 @@ uint8_t g_network_joined;
 nrk_sem_t* g_network_joined_mux;
 uint8_t g_global_outlet_state;
 nrk_sem_t *g_global_outlet_state_mux;
-uint8_t g_button_pressed;
-nrk_sem_t* g_button_pressed_mux;
+volatile uint8_t g_button_pressed;
+nrk_sig_t g_button_signal;
 
 int main() {
   packet act_packet;
@@ -171,18 +223,44 @@ int main() {
   g_seq_num_mux             = nrk_sem_create(1, 8);
   g_network_joined_mux      = nrk_sem_create(1, 8);
   g_global_outlet_state_mux = nrk_sem_create(1, 8);
-  g_button_pressed_mux      = nrk_sem_create(1, 8);
   g_net_watchdog_mux        = nrk_sem_create(1, 8);
+  g_config_queue_mux        = nrk_sem_create(1, 8);
+
+  // reporting engine, then sensor periods/deadbands/heartbeat from the
+  //  stored configuration (or the defaults on first boot)
+  report_init(&g_report, REPORT_WINDOW);
+  batch_init(&g_batch, SAMPLE_PERIOD_SECS);
+  if(NRK_ERROR == config_load(&g_config)) {
+    nrk_kprintf(PSTR("No stored config, using defaults\r\n"));
+  }
+  apply_config();
+  g_groups = g_config.groups;
 
-  // sensor periods (in seconds / 2)
-  g_pwr_period = 2;
-  g_temp_period = 3;
-  g_light_period = 4;
+  // over-the-air updates, remembering an image installed by the last one
+  ota_init(&g_ota);
+  if(OTA_STATE_INSTALLED == g_ota.state) {
+    printf("OTA image %d installed\r\n", g_ota.image_id);
+  }
+
+  // group command acks are spread out by a per-node random delay
+  srand(MAC_ADDR);
 
   // packet queues
   packet_queue_init(&g_act_queue);
   packet_queue_init(&g_cmd_tx_queue);
   packet_queue_init(&g_data_tx_queue);
+  packet_queue_init(&g_config_queue);
+  dedup_init(&g_dedup);
+#ifdef NODE_RELAY
+  relay_queue_init(&g_relay_queue);
+#endif
+  route_init(&g_route);
+
+  // button presses wake actuate_task through this signal
+  g_button_signal = nrk_signal_create();
+  if(NRK_ERROR == g_button_signal) {
+    nrk_kprintf(PSTR("Failed to create button signal\r\n"));
+  }
 
   // ensure node is initially set to "OFF"
   act_packet.source_id = MAC_ADDR;
@@ -192,11 +270,15 @@ int main() {
   act_packet.payload[CMD_CMDID_INDEX] = (uint16_t)0;
   act_packet.payload[CMD_NODE_ID_INDEX] = MAC_ADDR;
   act_packet.payload[CMD_ACT_INDEX] = OFF;
-  atomic_push(&g_act_queue, &act_packet, g_act_queue_mux);
+  // no task is running yet, and nrk_sem_pend() needs a current task
+  push(&g_act_queue, &act_packet);
 
   // initialize bmac
   bmac_task_config ();
   bmac_init(13);
+  bmac_addr_decode_set_my_mac(MAC_ADDR);
+  bmac_addr_decode_dest_mac(BROADCAST_ADDR);
+  bmac_addr_decode_enable();
 
   nrk_register_drivers();
   nrk_set_gpio();
@@ -287,26 +369,86 @@ void inline atomic_update_network_joined(uint8_t update) {
   nrk_sem_post(g_network_joined_mux);  
 }
 
-// atomic_button_pressed - atomically return the button_pressed flag
+// atomic_button_pressed - return the button_pressed flag
+//  NOTE: the flag is set from the debounce ISR so it cannot be guarded by a
+//  semaphore - a single byte access is already atomic on the AVR.
 uint8_t inline atomic_button_pressed() {
-  uint8_t returnVal;
-  nrk_sem_pend(g_button_pressed_mux); 
-  {
-    returnVal = g_button_pressed;
-  }
-  nrk_sem_post(g_button_pressed_mux);
-  return returnVal;  
+  return g_button_pressed;
 }
 
-// atomic_update_button_pressed - atomically update button_pressed flag
+// atomic_update_button_pressed - update the button_pressed flag
 void inline atomic_update_button_pressed(uint8_t update) {
-  nrk_sem_pend(g_button_pressed_mux); 
-  {
-    g_button_pressed = update;
+  g_button_pressed = update;
+}
+
+// button_latch - take a debounced press unless the last one is still pending,
+//  and wake actuate_task
+void inline button_latch() {
+  if(FALSE == g_button_pressed) {
+    g_button_pressed = TRUE;
+    nrk_event_signal(g_button_signal);
+  }
+}
+
+#ifdef BTN_EXT_INT
+// button_isr - BTN_IN edge, mask the pin and let the debounce timer sample it
+void button_isr() {
+  nrk_ext_int_disable(BTN_INT);
+  nrk_timer_int_reset(NRK_APP_TIMER_0);
+#ifndef NRK_POSIX
+  // the timer keeps counting between presses, drop the match it latched
+  TIFR3 = BM(OCF3A);
+#endif
+  nrk_timer_int_start(NRK_APP_TIMER_0);
+}
+
+// button_debounce_isr - debounce time elapsed, latch the press if the button is
+//  still held and listen for the next edge
+void button_debounce_isr() {
+  nrk_timer_int_stop(NRK_APP_TIMER_0);
+  if(BUTTON_PRESSED == nrk_gpio_get(BTN_IN)) {
+    button_latch();
   }
-  nrk_sem_post(g_button_pressed_mux);  
+#ifndef NRK_POSIX
+  // drop the edges the bounce latched while the pin was masked
+  EIFR = BM(INTF1);
+#endif
+  nrk_ext_int_enable(BTN_INT);
+}
+#else
+void button_poll_isr(void);
+
+// button_poll_period - run button_poll_isr every ticks of the application timer
+void button_poll_period(uint16_t ticks) {
+  nrk_timer_int_configure(NRK_APP_TIMER_0, BTN_DEBOUNCE_PRESCALE, ticks, &button_poll_isr);
+  nrk_timer_int_reset(NRK_APP_TIMER_0);
 }
 
+// button_poll_isr - sample BTN_IN every poll period. a change of level is
+//  sampled again after the debounce period, and counts if it held.
+void button_poll_isr() {
+  static uint8_t stable = BUTTON_RELEASED;
+  static uint8_t debouncing = FALSE;
+  uint8_t level = nrk_gpio_get(BTN_IN);
+
+  if((level != stable) && (FALSE == debouncing)) {
+    debouncing = TRUE;
+    button_poll_period(BTN_DEBOUNCE_TICKS);
+    return;
+  }
+  if(level != stable) {
+    stable = level;
+    if(BUTTON_PRESSED == stable) {
+      button_latch();
+    }
+  }
+  if(TRUE == debouncing) {
+    debouncing = FALSE;
+    button_poll_period(BTN_POLL_TICKS);
+  }
+}
+#endif
+
 // atomic_decrement_watchdog - atomically decrement watchdog timer
 uint8_t inline atomic_decrement_watchdog() {
   uint8_t returnVal;
@@ -329,6 +471,127 @@ uint8_t inline atomic_kick_watchdog() {
   return HEART_FACTOR;  
 }
 
+// apply_config - copy g_config into the sampling and reporting state
+void inline apply_config() {
+  g_pwr_period = g_config.pwr_period;
+  g_temp_period = g_config.temp_period;
+  g_light_period = g_config.light_period;
+  g_report.pwr.deadband = g_config.pwr_deadband;
+  g_report.temp.deadband = g_config.temp_deadband;
+  g_report.light.deadband = g_config.light_deadband;
+  g_report.window = g_config.heartbeat;
+}
+
+// atomic_flush_batch - hand a batch to tx_data. returns FALSE if the last
+//  batch has not been sent yet. the batch only takes a sequence number once
+//  it has been queued, so a failed flush leaves no gap.
+uint8_t inline atomic_flush_batch(batch_t *b) {
+  volatile uint8_t returnVal = FALSE;
+  nrk_sem_pend(g_data_tx_queue_mux);
+  {
+    if(FALSE == g_batch_tx_ready) {
+      g_batch_tx = *b;
+      g_batch_tx_seq_num = atomic_increment_seq_num();
+      g_batch_tx_ready = TRUE;
+      returnVal = TRUE;
+    }
+  }
+  nrk_sem_post(g_data_tx_queue_mux);
+  return returnVal;
+}
+
+// atomic_in_group - returns TRUE if this node is a member of group
+uint8_t inline atomic_in_group(uint8_t group) {
+  uint8_t returnVal = FALSE;
+  if((0 == group) || (MAX_GROUPS < group)) {
+    return FALSE;
+  }
+  nrk_sem_pend(g_act_queue_mux);
+  {
+    if(0 != (g_groups & GROUP_MASK(group))) {
+      returnVal = TRUE;
+    }
+  }
+  nrk_sem_post(g_act_queue_mux);
+  return returnVal;
+}
+
+// atomic_update_groups - atomically update the group memberships
+void inline atomic_update_groups(uint16_t groups) {
+  nrk_sem_pend(g_act_queue_mux);
+  {
+    g_groups = groups;
+  }
+  nrk_sem_post(g_act_queue_mux);
+}
+
+// atomic_queue_cmd_ack - queue a command ack. acks to group commands are held
+//  for a random number of tx periods so the members don't all answer at once.
+//  if GROUP_ACKS_HELD acks are already held, the one due first goes out now
+//  to make room.
+void inline atomic_queue_cmd_ack(packet *ack, uint8_t delayed) {
+  uint8_t slot = 0;
+
+  nrk_sem_pend(g_cmd_tx_queue_mux);
+  {
+    if(TRUE == delayed) {
+      for(uint8_t i = 0; i < GROUP_ACKS_HELD; i++) {
+        if(g_group_ack_delay[i] < g_group_ack_delay[slot]) {
+          slot = i;
+        }
+      }
+      if(0 != g_group_ack_delay[slot]) {
+        push(&g_cmd_tx_queue, &g_group_ack[slot]);
+      }
+      g_group_ack[slot] = *ack;
+      g_group_ack_delay[slot] = 1 + (rand() % GROUP_ACK_WINDOW);
+    } else {
+      push(&g_cmd_tx_queue, ack);
+    }
+  }
+  nrk_sem_post(g_cmd_tx_queue_mux);
+}
+
+// atomic_queue_ota_report - hold an OTA report for a random number of tx
+//  periods so the nodes answering a poll don't all answer at once. a newer
+//  report replaces one still held. an ACTIVATING report has the image
+//  installed once it has been sent.
+void inline atomic_queue_ota_report(packet *report, uint8_t status) {
+  nrk_sem_pend(g_cmd_tx_queue_mux);
+  {
+    g_ota_report = *report;
+    g_ota_report_delay = 1 + (rand() % OTA_REPORT_WINDOW);
+    g_ota_report_pending = TRUE;
+    if(OTA_STATUS_ACTIVATING == status) {
+      g_ota_activate = TRUE;
+    }
+  }
+  nrk_sem_post(g_cmd_tx_queue_mux);
+}
+
+// set_ack_trace - fill in the node's latency trace of a command ack: command
+//  received -> coil driven, and coil driven -> ack. zero for button presses.
+void inline set_ack_trace(packet *ack, packet *cmd, uint16_t act_ms, uint8_t button) {
+  volatile uint16_t rx_act = 0;
+  volatile uint16_t act_ack = 0;
+  if(FALSE == button) {
+    rx_act = act_ms - trace_get_ms(&cmd->payload[CMD_RX_MS_INDEX]);
+    act_ack = trace_now_ms() - act_ms;
+  }
+  trace_put_ms(&ack->payload[CMDACK_RX_ACT_INDEX], rx_act);
+  trace_put_ms(&ack->payload[CMDACK_ACT_ACK_INDEX], act_ack);
+}
+
+// tx_dest - next hop for a message: upstream traffic is unicast to the parent
+//  once one is known, everything else is broadcast
+uint16_t inline tx_dest(uint8_t type) {
+  volatile uint8_t parent = route_parent(&g_route);
+  if((TRUE == route_is_upstream(type)) && (ROUTE_NO_PARENT != parent)) {
+    return parent;
+  }
+  return BROADCAST_ADDR;
+}
+
 void inline clear_tx_buf(){
   for(uint8_t i = 0; i < g_net_tx_index; i++) {
     g_net_tx_buf[i] = 0;
@@ -344,6 +607,27 @@ void tx_cmds() {
   volatile uint8_t tx_length = 0;
   volatile int8_t val = 0;
 
+  // release the held group command acks whose delay is up
+  nrk_sem_pend(g_cmd_tx_queue_mux);
+  {
+    for(uint8_t i = 0; i < GROUP_ACKS_HELD; i++) {
+      if(0 != g_group_ack_delay[i]) {
+        g_group_ack_delay[i]--;
+        if(0 == g_group_ack_delay[i]) {
+          push(&g_cmd_tx_queue, &g_group_ack[i]);
+        }
+      }
+    }
+    if(TRUE == g_ota_report_pending) {
+      g_ota_report_delay--;
+      if(0 == g_ota_report_delay) {
+        push(&g_cmd_tx_queue, &g_ota_report);
+        g_ota_report_pending = FALSE;
+      }
+    }
+  }
+  nrk_sem_post(g_cmd_tx_queue_mux);
+
   // atomically get the queue size
   local_tx_cmd_queue_size = atomic_size(&g_cmd_tx_queue, g_cmd_tx_queue_mux);
 
@@ -360,6 +644,7 @@ void tx_cmds() {
 
     // assemble the packet and senx
     tx_length = assemble_packet((uint8_t *)&g_net_tx_buf, &tx_packet);
+    bmac_addr_decode_dest_mac(tx_dest(tx_packet.type));
     val = bmac_tx_pkt(g_net_tx_buf, tx_length);
     if(NRK_OK != val){
       nrk_kprintf( PSTR( "NO ack or Reserve Violated!\r\n" ));
@@ -367,6 +652,30 @@ void tx_cmds() {
 
     nrk_led_clr(ORANGE_LED);
   }
+
+#ifdef NODE_RELAY
+  // relay frames from other nodes, one queue's worth per call
+  nrk_sem_pend(g_cmd_tx_queue_mux);
+  {
+    relay_tick(&g_relay_queue);
+  }
+  nrk_sem_post(g_cmd_tx_queue_mux);
+  for(uint8_t i = 0; i < RELAY_QUEUE_SIZE; i++) {
+    nrk_sem_pend(g_cmd_tx_queue_mux);
+    {
+      tx_length = relay_pop(&g_relay_queue, g_net_tx_buf);
+    }
+    nrk_sem_post(g_cmd_tx_queue_mux);
+    if(0 == tx_length) {
+      break;
+    }
+    bmac_addr_decode_dest_mac(tx_dest(g_net_tx_buf[HEADER_TYPE_INDEX]));
+    val = bmac_tx_pkt(g_net_tx_buf, tx_length);
+    if(NRK_OK != val){
+      nrk_kprintf( PSTR( "Relay failed!\r\n" ));
+    }
+  }
+#endif
   return;
 }
 
@@ -381,6 +690,27 @@ void tx_data() {
   volatile uint8_t local_tx_data_queue_size;
   volatile msg_type tx_type;
 
+  // send the batch flushed by sample_task, if there is one
+  tx_length = 0;
+  nrk_sem_pend(g_data_tx_queue_mux);
+  {
+    if(TRUE == g_batch_tx_ready) {
+      tx_length = assemble_batch_packet((uint8_t *)&g_net_tx_buf, MAC_ADDR, g_batch_tx_seq_num, &g_batch_tx);
+      g_batch_tx_ready = FALSE;
+    }
+  }
+  nrk_sem_post(g_data_tx_queue_mux);
+  if(0 < tx_length) {
+    if(TRUE == g_verbose) {
+      printf("tx batch: %d bytes\r\n", tx_length);
+    }
+    bmac_addr_decode_dest_mac(tx_dest(MSG_DATA_BATCH));
+    val = bmac_tx_pkt(g_net_tx_buf, tx_length);
+    if(NRK_OK != val){
+      nrk_kprintf( PSTR( "NO ack or Reserve Violated!\r\n" ));
+    }
+  }
+
   // atomically get the queue size
   local_tx_data_queue_size = atomic_size(&g_data_tx_queue, g_data_tx_queue_mux);
 
@@ -408,6 +738,7 @@ void tx_data() {
     if (TRUE == to_send) {
       // assembe and send packet
       tx_length = assemble_packet((uint8_t *)&g_net_tx_buf, &tx_packet);
+      bmac_addr_decode_dest_mac(tx_dest(tx_type));
       val = bmac_tx_pkt(g_net_tx_buf, tx_length);
       if(NRK_OK != val){
         nrk_kprintf( PSTR( "NO ack or Reserve Violated!\r\n" ));
@@ -428,12 +759,16 @@ void rx_msg_task() {
   // local variable instantiation
   int8_t rssi;
   uint8_t len;
+  msg_view_t rx_msg;
   packet rx_packet;
   uint8_t *local_rx_buf;
   volatile uint8_t local_network_joined = FALSE;
   volatile uint8_t rx_source_id = 0;
   volatile uint8_t node_id;
-  volatile uint8_t rx_payload = 0;
+  volatile uint8_t duplicate;
+  volatile uint16_t heart_cost;
+  volatile uint8_t ota_group;
+  volatile uint8_t ota_status;
   volatile msg_type rx_type;
   // print task PID
   printf("rx_msg PID: %d.\r\n", nrk_get_pid());
@@ -452,20 +787,70 @@ void rx_msg_task() {
     if(bmac_rx_pkt_ready()) {
       nrk_led_set(BLUE_LED);
 
-      // get the packet, parse and release
+      // get the packet and check it against its type's layout. it is read in
+      //  place and only copied out if it is queued for another task.
       local_rx_buf = bmac_rx_pkt_get(&len, &rssi);
-      parse_msg(&rx_packet, local_rx_buf, len);
-      bmac_rx_pkt_release();
+      if(FALSE == msg_view_init(&rx_msg, local_rx_buf, len)) {
+        bmac_rx_pkt_release();
+        nrk_led_clr(BLUE_LED);
+        nrk_wait_until_next_period();
+        continue;
+      }
+
+      // get message parameters
+      rx_source_id = msg_source_id(&rx_msg);
+      rx_type = msg_type_of(&rx_msg);
+
+      // drop anything already seen (e.g. heard again through a relay), and
+      //  queue new frames that still have hops left for relaying
+      duplicate = dedup_seen(&g_dedup, rx_source_id, msg_seq_num(&rx_msg));
+
+      // every copy of a heartbeat advertises a neighbor's cost to the gateway,
+      //  the first copy of each one also starts a new routing epoch
+      if((GATEWAY_MAC == rx_source_id) && ((MSG_HEARTBEAT == rx_type) || (MSG_RESET == rx_type))) {
+        if(FALSE == duplicate) {
+          route_epoch(&g_route);
+        }
+        heart_cost = msg_u16(&rx_msg, HEART_COST_INDEX);
+        route_heard(&g_route, msg_u8(&rx_msg, HEART_RELAY_INDEX), heart_cost);
+#ifdef NODE_RELAY
+        // advertise this node and its own cost to whoever hears the relay
+        heart_cost = route_cost(&g_route);
+        local_rx_buf[HEADER_SIZE + HEART_RELAY_INDEX] = MAC_ADDR;
+        local_rx_buf[HEADER_SIZE + HEART_COST_INDEX] = (heart_cost >> 8) & 0xFF;
+        local_rx_buf[HEADER_SIZE + HEART_COST_INDEX + 1] = heart_cost & 0xFF;
+#endif
+      }
+#ifdef NODE_RELAY
+      // upstream traffic from another node means this node is someone's parent
+      if((FALSE == duplicate) && (MAC_ADDR != rx_source_id) && (TRUE == route_is_upstream(rx_type))) {
+        route_child_heard(&g_route);
+      }
+      if((FALSE == duplicate) && (TRUE == relay_should_forward(local_rx_buf, len, MAC_ADDR)) &&
+        (TRUE == route_should_relay(&g_route, rx_type))) {
+        // every node that hears a flooded frame relays it, so each holds it
+        //  back a random number of tx periods (seeded by its MAC) to spread
+        //  the copies out
+        nrk_sem_pend(g_cmd_tx_queue_mux);
+        {
+          relay_push(&g_relay_queue, local_rx_buf, len, rand() % RELAY_JITTER_WINDOW);
+        }
+        nrk_sem_post(g_cmd_tx_queue_mux);
+      }
+#endif
+      if(TRUE == duplicate) {
+        bmac_rx_pkt_release();
+        nrk_led_clr(BLUE_LED);
+        nrk_wait_until_next_period();
+        continue;
+      }
 
       // print incoming packet if appropriate
       if(TRUE == g_verbose) {
+        msg_view_copy(&rx_packet, &rx_msg);
         nrk_kprintf(PSTR("RX: "));
         print_packet(&rx_packet);
       }
-
-      // get message parameters
-      rx_source_id = rx_packet.source_id;
-      rx_type = rx_packet.type;
  
       // only receive the message if it's not from this node
       if((GATEWAY_MAC == rx_source_id) || (SERVER_MAC == rx_source_id)) {
@@ -479,18 +864,72 @@ void rx_msg_task() {
             // command received -> actuate or ignore
             case MSG_CMD:
               // if command is for this node and add it to the action queue. 
-              node_id = rx_packet.payload[CMD_NODE_ID_INDEX];
+              node_id = msg_u8(&rx_msg, CMD_NODE_ID_INDEX);
               if(MAC_ADDR == node_id) {
+                msg_view_copy(&rx_packet, &rx_msg);
+                trace_put_ms(&rx_packet.payload[CMD_RX_MS_INDEX], trace_now_ms());
                 atomic_push(&g_act_queue, &rx_packet, g_act_queue_mux);
                 if (TRUE == g_verbose) {
                   nrk_kprintf(PSTR("Received command ^^^\r\n"));
                 }
               }
+            // config received -> hand to sample_task, which owns the config
+            case MSG_CONFIG:
+              if((MSG_CONFIG == rx_type) && (MAC_ADDR == msg_u8(&rx_msg, CONFIG_NODE_ID_INDEX))) {
+                msg_view_copy(&rx_packet, &rx_msg);
+                atomic_push(&g_config_queue, &rx_packet, g_config_queue_mux);
+                if (TRUE == g_verbose) {
+                  nrk_kprintf(PSTR("Received config ^^^\r\n"));
+                }
+              }
+            // group command received -> act on it as a command for this node if
+            //  this node is in the group. the type is kept so the ack is held back.
+            case MSG_CMD_GROUP:
+              if((MSG_CMD_GROUP == rx_type) && (TRUE == atomic_in_group(msg_u8(&rx_msg, CMDG_GROUP_INDEX)))) {
+                msg_view_copy(&rx_packet, &rx_msg);
+                rx_packet.payload[CMD_NODE_ID_INDEX] = MAC_ADDR;
+                rx_packet.payload[CMD_ACT_INDEX] = msg_u8(&rx_msg, CMDG_ACTION_INDEX);
+                trace_put_ms(&rx_packet.payload[CMD_RX_MS_INDEX], trace_now_ms());
+                atomic_push(&g_act_queue, &rx_packet, g_act_queue_mux);
+                if (TRUE == g_verbose) {
+                  nrk_kprintf(PSTR("Received group command ^^^\r\n"));
+                }
+              }
             case MSG_HANDACK:
             case MSG_HEARTBEAT:
             case MSG_RESET:
               atomic_kick_watchdog();
               break;
+            // over-the-air update - join it if this node is in its group
+            case MSG_OTA_BEGIN:
+              ota_group = msg_u8(&rx_msg, OTAB_GROUP_INDEX);
+              if((OTA_ALL_NODES == ota_group) || (TRUE == atomic_in_group(ota_group))) {
+                ota_begin(&g_ota, msg_u8(&rx_msg, OTA_IMAGE_INDEX),
+                  msg_u16(&rx_msg, OTAB_SIZE_INDEX), msg_u16(&rx_msg, OTAB_CRC_INDEX));
+              }
+              break;
+            // image chunk - copied straight from the receive buffer
+            case MSG_OTA_DATA:
+              ota_chunk(&g_ota, msg_u8(&rx_msg, OTA_IMAGE_INDEX), msg_u8(&rx_msg, OTAD_WINDOW_INDEX),
+                msg_u8(&rx_msg, OTAD_CHUNK_INDEX), &msg_payload(&rx_msg)[OTAD_DATA_INDEX]);
+              break;
+            // poll/end - report which chunks are missing, or the image's check
+            case MSG_OTA_POLL:
+            case MSG_OTA_END:
+              if(MSG_OTA_POLL == rx_type) {
+                ota_status = ota_poll(&g_ota, msg_u8(&rx_msg, OTA_IMAGE_INDEX), rx_packet.payload);
+              } else {
+                ota_status = ota_end(&g_ota, msg_u8(&rx_msg, OTA_IMAGE_INDEX),
+                  msg_u8(&rx_msg, OTAE_ACTION_INDEX), rx_packet.payload);
+              }
+              if(OTA_NO_REPORT != ota_status) {
+                rx_packet.source_id = MAC_ADDR;
+                rx_packet.seq_num = atomic_increment_seq_num();
+                rx_packet.type = MSG_OTA_REPORT;
+                rx_packet.num_hops = 0;
+                atomic_queue_ota_report(&rx_packet, ota_status);
+              }
+              break;
             case MSG_HAND:
             case MSG_DATA:
             case MSG_CMDACK: 
@@ -503,14 +942,14 @@ void rx_msg_task() {
         // if the local_network_joined flag hasn't been set yet, check status
         else {
           // if a handshake ack has been received, then set the network joined flag. Otherwise, ignore.
-          rx_payload = rx_packet.payload[HANDACK_NODE_ID_INDEX];
-          if((MSG_HANDACK == rx_type) && (MAC_ADDR == rx_payload)) {
+          if((MSG_HANDACK == rx_type) && (MAC_ADDR == msg_u8(&rx_msg, HANDACK_NODE_ID_INDEX))) {
             atomic_update_network_joined(TRUE);
             atomic_kick_watchdog();
             local_network_joined = atomic_network_joined();
           }
         }
       }
+      bmac_rx_pkt_release();
       nrk_led_clr(BLUE_LED);
     }
     nrk_wait_until_next_period();
@@ -522,6 +961,7 @@ void rx_msg_task() {
 void tx_net_task() {
   volatile uint8_t counter = 0;
   volatile uint8_t tx_data_flag;
+  volatile uint8_t activate;
   // print task pid
   printf("tx_net PID: %d.\r\n", nrk_get_pid());
 
@@ -544,6 +984,19 @@ void tx_net_task() {
     } else {
       tx_cmds();
     }
+
+    // install a verified image once the report that it is being activated
+    //  has gone out. does not return.
+    nrk_sem_pend(g_cmd_tx_queue_mux);
+    {
+      activate = (TRUE == g_ota_activate) && (FALSE == g_ota_report_pending) &&
+        (0 == g_cmd_tx_queue.size);
+    }
+    nrk_sem_post(g_cmd_tx_queue_mux);
+    if(TRUE == activate) {
+      nrk_kprintf(PSTR("Installing OTA image\r\n"));
+      ota_flash_activate(g_ota.image_id, g_ota.size);
+    }
     // nrk_kprintf(PSTR("OUT\r\n"));
     nrk_wait_until_next_period();
   }
@@ -555,19 +1008,34 @@ void sample_task() {
   // local variable instantiation
   packet tx_packet;
   packet hello_packet;
+  packet energy_packet;
+  packet config_packet;
+  packet config_ack_packet;
+  sample_set_t sample_set;
+  volatile uint8_t config_queue_size;
+  volatile uint8_t config_param;
+  volatile uint8_t config_status;
+  volatile uint16_t config_value;
   volatile int8_t val;
-  volatile int8_t pwr_back;
   volatile uint8_t hw_rev;
   volatile uint8_t local_network_joined = FALSE;
   volatile uint8_t pwr_period_count = 0;
   volatile uint8_t temp_period_count = 0;
   volatile uint8_t light_period_count = 0;
-  volatile uint8_t pwr_rcvd[3];
-  volatile uint8_t sensor_sampled = FALSE;
+  pwr_output_t pwr_out;
+  volatile uint8_t report_state = REPORT_NONE;
+  volatile uint16_t report_pwr_val;
+  volatile uint16_t report_temp_val;
+  volatile uint16_t report_light_val;
   volatile uint16_t local_pwr_val = 0;
   volatile uint16_t local_temp_val = 0;
   volatile uint16_t local_light_val = 0;
-  volatile uint16_t adc_buf[2];
+  volatile uint16_t adc_buf[SAMPLE_ADC_CHANNELS];
+  nrk_sg_entry_t adc_list[SAMPLE_ADC_CHANNELS];
+  volatile uint8_t adc_count = 0;
+  volatile int8_t temp_index;
+  volatile int8_t light_index;
+  uint8_t i;
 
   // print task pid
   printf("sample_task PID: %d.\r\n", nrk_get_pid());
@@ -582,6 +1050,16 @@ void sample_task() {
   tx_packet.type = MSG_DATA;
   tx_packet.num_hops = 0;
 
+  // initialize energy packet
+  energy_packet.source_id = MAC_ADDR;
+  energy_packet.type = MSG_ENERGY;
+  energy_packet.num_hops = 0;
+
+  // initialize config ack packet
+  config_ack_packet.source_id = MAC_ADDR;
+  config_ack_packet.type = MSG_CONFIGACK;
+  config_ack_packet.num_hops = 0;
+
   // initialize hello packet
   hello_packet.source_id = MAC_ADDR;
   hello_packet.type = MSG_HAND;
@@ -594,6 +1072,12 @@ void sample_task() {
   // get the hardware rev of this node
   hw_rev = GET_REV(HARDWARE_REV);
 
+  // point the ADC scatter list at the sample buffer
+  for(i = 0; i < SAMPLE_ADC_CHANNELS; i++) {
+    adc_list[i].buf = (uint8_t *)&adc_buf[i];
+    adc_list[i].size = sizeof(uint16_t);
+  }
+
   // Open the ATMEGA ADC device as read
   g_atmega_adc_fd = nrk_open(ADC_DEV_MANAGER,READ);
   if(NRK_ERROR == g_atmega_adc_fd) {
@@ -602,6 +1086,34 @@ void sample_task() {
 
   // loop forever - run th task
   while (1) {
+    // apply and persist any configuration received from the server, then ack
+    //  with the value now in use
+    config_queue_size = atomic_size(&g_config_queue, g_config_queue_mux);
+    for(i = 0; i < config_queue_size; i++) {
+      atomic_pop(&g_config_queue, &config_packet, g_config_queue_mux);
+      config_param = config_packet.payload[CONFIG_PARAM_INDEX];
+      config_value = (config_packet.payload[CONFIG_VALUE_INDEX] << 8) | config_packet.payload[CONFIG_VALUE_INDEX + 1];
+      config_status = config_set(&g_config, config_param, config_value);
+      if(CONFIG_OK == config_status) {
+        apply_config();
+        atomic_update_groups(g_config.groups);
+        config_save(&g_config);
+      }
+      config_value = config_get(&g_config, config_param);
+
+      config_ack_packet.seq_num = atomic_increment_seq_num();
+      config_ack_packet.payload[CONFIGACK_CMDID_INDEX] = config_packet.payload[CONFIG_CMDID_INDEX];
+      config_ack_packet.payload[CONFIGACK_CMDID_INDEX + 1] = config_packet.payload[CONFIG_CMDID_INDEX + 1];
+      config_ack_packet.payload[CONFIGACK_PARAM_INDEX] = config_param;
+      config_ack_packet.payload[CONFIGACK_VALUE_INDEX] = (uint8_t)((config_value >> 8) & 0xFF);
+      config_ack_packet.payload[CONFIGACK_VALUE_INDEX + 1] = (uint8_t)(config_value & 0xFF);
+      config_ack_packet.payload[CONFIGACK_STATUS_INDEX] = config_status;
+      atomic_push(&g_cmd_tx_queue, &config_ack_packet, g_cmd_tx_queue_mux);
+      if(TRUE == g_verbose) {
+        printf("CONFIG: %d = %u (%d)\r\n", config_param, config_value, config_status);
+      }
+    }
+
     // check if the network has been joined
     local_network_joined = atomic_network_joined();
 
@@ -614,88 +1126,131 @@ void sample_task() {
       pwr_period_count %= g_pwr_period;
       temp_period_count %= g_temp_period;
       light_period_count %= g_light_period;
-      sensor_sampled = FALSE;
 
       // sample power sensor if appropriate
       if((SAMPLE_SENSOR == pwr_period_count) && (HW_REV0 == hw_rev)) {
-        // read power
-        pwr_read(WATT, (uint8_t *)&pwr_rcvd);
-        pwr_back = pwr_rcvd[2];
-        if (pwr_back < 0) {
-          local_pwr_val = (~pwr_back) + 1;
-        } else {
-          local_pwr_val = pwr_back;
-        }
-        // // pull out dinner location
-        // local_pwr_val = (pwr_rcvd[0] << 8) | pwr_rcvd[1];
-        // printf("val1: %x:%x:%x\r\n", pwr_rcvd[0], pwr_rcvd[1], pwr_rcvd[2]);
-        // local_pwr_val = transform_pwr(local_pwr_val);
-        // printf("val2: %d\r\n", local_pwr_val);
+        // read the whole VA..PF output block in one transaction
+        pwr_read_output(&pwr_out);
+        local_pwr_val = pwr_to_watts(pwr_out.watt);
         g_sensor_pkt.pwr_val = local_pwr_val;
-        sensor_sampled = TRUE;
+        report_sample(&g_report.pwr, local_pwr_val);
       }
 
-      // sample temperature sensor if appropriate
+      // collect the ADC channels that are due this period so they can all
+      //  be sampled with a single driver call
+      adc_count = 0;
+      temp_index = -1;
+      light_index = -1;
       if(SAMPLE_SENSOR == temp_period_count) {
-        // sample analog temperature sensor via Atmega ADC
         if(HW_REV0 == hw_rev) {
-          val = nrk_set_status(g_atmega_adc_fd, ADC_CHAN, CHAN_6);
+          adc_list[adc_count].chan = CHAN_6;
+          temp_index = adc_count;
+          adc_count++;
         } else if(HW_REV1 == hw_rev) {
-          val = nrk_set_status(g_atmega_adc_fd, ADC_CHAN, CHAN_4);
+          adc_list[adc_count].chan = CHAN_4;
+          temp_index = adc_count;
+          adc_count++;
         }
-        if(NRK_ERROR == val) {
-          nrk_kprintf(PSTR("Failed to set ADC status\r\n"));
+      }
+      if((SAMPLE_SENSOR == light_period_count) && (HW_REV1 == hw_rev)) {
+        adc_list[adc_count].chan = CHAN_2;
+        light_index = adc_count;
+        adc_count++;
+      }
+
+      // sample temperature/light sensors via Atmega ADC
+      if(0 < adc_count) {
+        val = nrk_read_sg(g_atmega_adc_fd, adc_list, adc_count, NRK_SG_NO_SIGNAL);
+        if(adc_count != val)  {
+          nrk_kprintf(PSTR("Failed to read ADC\r\n"));
         } else {
-          val = nrk_read(g_atmega_adc_fd, (uint8_t *)&adc_buf[0],2);
-          if(NRK_ERROR == val)  {
-            nrk_kprintf(PSTR("Failed to read ADC\r\n"));
-          } else {
-            local_temp_val = (uint16_t)adc_buf[0];
+          if(0 <= temp_index) {
+            local_temp_val = adc_buf[temp_index];
             local_temp_val = transform_temp(local_temp_val);
             g_sensor_pkt.temp_val = local_temp_val;
-            sensor_sampled = TRUE;
+            report_sample(&g_report.temp, local_temp_val);
           }
-        }          
-      }
-
-      // sample light sensor if appropriate
-      if((SAMPLE_SENSOR == light_period_count) && (HW_REV1 == hw_rev)) {
-        val = nrk_set_status(g_atmega_adc_fd, ADC_CHAN, CHAN_2);
-        if(NRK_ERROR == val) {
-          nrk_kprintf(PSTR("Failed to set ADC status\r\n"));
-        } else {
-          val = nrk_read(g_atmega_adc_fd, (uint8_t *)&adc_buf[0],2);
-          if(NRK_ERROR == val)  {
-            nrk_kprintf(PSTR("Failed to read ADC\r\n"));
-          } else {
-            local_light_val = (uint16_t)adc_buf[0];
+          if(0 <= light_index) {
+            local_light_val = adc_buf[light_index];
             g_sensor_pkt.light_val = local_light_val;
-            sensor_sampled = TRUE;
+            report_sample(&g_report.light, local_light_val);
           }
         }
       }
 
-      // if a sensor has been sampled, send a packet out
-      if(TRUE == sensor_sampled) {
-        // update sequence number
-        tx_packet.seq_num = atomic_increment_seq_num();
-
-        // add data values to sensor packet
-        tx_packet.payload[DATA_PWR_INDEX] = (uint8_t)((g_sensor_pkt.pwr_val >> 8) & 0xFF);
-        tx_packet.payload[DATA_PWR_INDEX + 1] = (uint8_t)(g_sensor_pkt.pwr_val& 0xFF);
-        tx_packet.payload[DATA_TEMP_INDEX] = (uint8_t)((g_sensor_pkt.temp_val >> 8) & 0xFF);
-        tx_packet.payload[DATA_TEMP_INDEX + 1] = (uint8_t)(g_sensor_pkt.temp_val & 0xFF);
-        tx_packet.payload[DATA_LIGHT_INDEX] = (uint8_t)((g_sensor_pkt.light_val >> 8) & 0xFF);
-        tx_packet.payload[DATA_LIGHT_INDEX + 1] = (uint8_t)(g_sensor_pkt.light_val & 0xFF);
-        tx_packet.payload[DATA_STATE_INDEX] = atomic_outlet_state();
+      // integrate energy with the latest power reading and decide whether
+      //  anything needs to be reported this period
+      report_energy(&g_report, g_sensor_pkt.pwr_val, SAMPLE_PERIOD_SECS);
+      report_state = report_tick(&g_report);
+      batch_tick(&g_batch);
+
+      if(REPORT_NONE != report_state) {
+        // window expiry reports the window averages, a deadband crossing
+        //  reports the latest values
+        if(REPORT_WINDOW_EXPIRED == report_state) {
+          report_pwr_val = report_avg(&g_report.pwr);
+          report_temp_val = report_avg(&g_report.temp);
+          report_light_val = report_avg(&g_report.light);
+        } else {
+          report_pwr_val = g_sensor_pkt.pwr_val;
+          report_temp_val = g_sensor_pkt.temp_val;
+          report_light_val = g_sensor_pkt.light_val;
+        }
+        report_mark(&g_report.pwr, report_pwr_val);
+        report_mark(&g_report.temp, report_temp_val);
+        report_mark(&g_report.light, report_light_val);
 
         // print the sensor info
         if(TRUE == g_verbose) {
-          printf("P: %d, T: %d, L: %d\r\n", g_sensor_pkt.pwr_val, g_sensor_pkt.temp_val, g_sensor_pkt.light_val);
+          printf("P: %d, T: %d, L: %d\r\n", report_pwr_val, report_temp_val, report_light_val);
         }
 
-        // add packet to data queue
-        atomic_push(&g_data_tx_queue, &tx_packet, g_data_tx_queue_mux);
+        // add the values to the batch. if the batch is full (the last batch
+        //  is still waiting for tx_data) send them as a single data packet
+        sample_set.pwr = report_pwr_val;
+        sample_set.temp = report_temp_val;
+        sample_set.light = report_light_val;
+        sample_set.state = atomic_outlet_state();
+        if(FALSE == batch_add(&g_batch, &sample_set)) {
+          // update sequence number
+          tx_packet.seq_num = atomic_increment_seq_num();
+
+          // add data values to sensor packet
+          tx_packet.payload[DATA_PWR_INDEX] = (uint8_t)((report_pwr_val >> 8) & 0xFF);
+          tx_packet.payload[DATA_PWR_INDEX + 1] = (uint8_t)(report_pwr_val & 0xFF);
+          tx_packet.payload[DATA_TEMP_INDEX] = (uint8_t)((report_temp_val >> 8) & 0xFF);
+          tx_packet.payload[DATA_TEMP_INDEX + 1] = (uint8_t)(report_temp_val & 0xFF);
+          tx_packet.payload[DATA_LIGHT_INDEX] = (uint8_t)((report_light_val >> 8) & 0xFF);
+          tx_packet.payload[DATA_LIGHT_INDEX + 1] = (uint8_t)(report_light_val & 0xFF);
+          tx_packet.payload[DATA_STATE_INDEX] = sample_set.state;
+
+          // add packet to data queue
+          atomic_push(&g_data_tx_queue, &tx_packet, g_data_tx_queue_mux);
+        }
+
+        // at the end of a window also report energy and the power range
+        if(REPORT_WINDOW_EXPIRED == report_state) {
+          energy_packet.seq_num = atomic_increment_seq_num();
+          energy_packet.payload[ENERGY_WS_INDEX] = (uint8_t)((g_report.energy_ws >> 24) & 0xFF);
+          energy_packet.payload[ENERGY_WS_INDEX + 1] = (uint8_t)((g_report.energy_ws >> 16) & 0xFF);
+          energy_packet.payload[ENERGY_WS_INDEX + 2] = (uint8_t)((g_report.energy_ws >> 8) & 0xFF);
+          energy_packet.payload[ENERGY_WS_INDEX + 3] = (uint8_t)(g_report.energy_ws & 0xFF);
+          energy_packet.payload[ENERGY_PWR_MIN_INDEX] = (uint8_t)((report_min(&g_report.pwr) >> 8) & 0xFF);
+          energy_packet.payload[ENERGY_PWR_MIN_INDEX + 1] = (uint8_t)(report_min(&g_report.pwr) & 0xFF);
+          energy_packet.payload[ENERGY_PWR_MAX_INDEX] = (uint8_t)((report_max(&g_report.pwr) >> 8) & 0xFF);
+          energy_packet.payload[ENERGY_PWR_MAX_INDEX + 1] = (uint8_t)(report_max(&g_report.pwr) & 0xFF);
+          atomic_push(&g_data_tx_queue, &energy_packet, g_data_tx_queue_mux);
+          report_window_reset(&g_report);
+        }
+      }
+
+      // send the batch when it is full, at the end of a reporting window, or
+      //  once the oldest set has waited BATCH_MAX_AGE sample periods
+      if((0 < g_batch.count) && ((BATCH_MAX_SETS <= g_batch.count) ||
+          (REPORT_WINDOW_EXPIRED == report_state) || (BATCH_MAX_AGE <= g_batch.span))) {
+        if(TRUE == atomic_flush_batch(&g_batch)) {
+          batch_init(&g_batch, SAMPLE_PERIOD_SECS);
+        }
       }
     }
     // if the local_network_joined flag hasn't been set yet, send a hello packet
@@ -714,57 +1269,6 @@ void sample_task() {
   nrk_kprintf(PSTR("Fallthrough: sample_task\r\n"));
 }
 
-// button_task - check the state of the physical button
-void button_task() {
-  volatile uint8_t local_button_pressed = FALSE;
-  volatile button_pressed_state curr_state = STATE_SNIFF;
-  // print task pid
-  printf("button_task PID: %d.\r\n", nrk_get_pid());
-
-  // loop forever - run task
-  while(1) {
-    switch(curr_state) {
-      // STATE_SNIFF:
-      //    - if the button gets pressed set the flag and switch states
-      //    - otherwise, keep sniffing
-      case STATE_SNIFF: {
-        // get current button_pressed state
-        local_button_pressed = atomic_button_pressed();
-
-        // check button input
-        if((BUTTON_PRESSED == nrk_gpio_get(BTN_IN)) && (FALSE == local_button_pressed)) {
-          // set flag
-          atomic_update_button_pressed(TRUE);
-
-          // switch states
-          curr_state = STATE_WAIT;
-        }
-        // keep sniffing...
-        else {
-          curr_state = STATE_SNIFF;
-        }
-        break;
-      }
-
-      // STATE_WAIT:
-      //  - wait for button to be released and switch states
-      case STATE_WAIT: {
-        // if the button is released - start sniffing
-        if(BUTTON_RELEASED == nrk_gpio_get(BTN_IN)) {
-          curr_state = STATE_SNIFF;
-        }
-        // otherwise
-        else {
-          curr_state = STATE_WAIT;
-        }
-        break;
-      }
-    }
-    nrk_wait_until_next_period();
-  }
-  nrk_kprintf(PSTR("Fallthrough: button_task\r\n"));
-}
-
 // actuate_task() - actuate any commands that have been received for this node.
 void actuate_task() {
   packet act_packet;
@@ -774,11 +1278,18 @@ void actuate_task() {
   volatile uint8_t act_queue_size;
   volatile uint8_t local_network_joined = FALSE;
   volatile uint8_t local_button_pressed = FALSE;
+  volatile uint16_t act_ms = 0;
+  nrk_time_t act_timeout;
 
 
   // print task pid
   printf("actuate_task PID: %d.\r\n", nrk_get_pid());
 
+  // wake on debounced button presses as well as on the period
+  nrk_signal_register(g_button_signal);
+  act_timeout.secs = 0;
+  act_timeout.nano_secs = 500*NANOS_PER_MS;
+
   // CURRENT STATE
   // NOTE: set initially to "ON" so that when initial "OFF" commands come through
   //  they will actually be paid attention to.
@@ -820,6 +1331,7 @@ void actuate_task() {
           // get the action atomically
           atomic_pop(&g_act_queue, &act_packet, g_act_queue_mux);
           action = act_packet.payload[CMD_ACT_INDEX];
+          act_ms = trace_now_ms();
           if(TRUE == g_verbose) {
             printf("ACT: %d\r\n", action);
           }
@@ -851,6 +1363,7 @@ void actuate_task() {
         else if(0 < act_queue_size) {
           atomic_pop(&g_act_queue, &act_packet, g_act_queue_mux);
           action = act_packet.payload[CMD_ACT_INDEX];
+          act_ms = trace_now_ms();
         }
 
         // if the action is ON -> send ACK
@@ -872,6 +1385,7 @@ void actuate_task() {
       case STATE_ACT_OFF: {
         // ACTIVE LOW signal
         nrk_gpio_clr(OFF_COIL);
+        act_ms = trace_now_ms();
         curr_state = STATE_ACK_OFF;
         break;
       }
@@ -880,6 +1394,7 @@ void actuate_task() {
       case STATE_ACT_ON: {
         // ACTIVE_HIGH signal
         nrk_gpio_clr(ON_COIL);
+        act_ms = trace_now_ms();
         curr_state = STATE_ACK_ON;
         break;
       }
@@ -897,11 +1412,13 @@ void actuate_task() {
           tx_packet.seq_num = atomic_increment_seq_num();
 
           // set payload
-          tx_packet.payload[CMDACK_CMDID_INDEX] = (uint16_t)act_packet.payload[CMD_CMDID_INDEX];
+          tx_packet.payload[CMDACK_CMDID_INDEX] = act_packet.payload[CMD_CMDID_INDEX];
+          tx_packet.payload[CMDACK_CMDID_INDEX + 1] = act_packet.payload[CMD_CMDID_INDEX + 1];
           tx_packet.payload[CMDACK_STATE_INDEX] = OFF;
+          set_ack_trace(&tx_packet, &act_packet, act_ms, local_button_pressed);
 
-          // place message in the queue
-          atomic_push(&g_cmd_tx_queue, &tx_packet, g_cmd_tx_queue_mux);
+          // place message in the queue (held back if it answers a group command)
+          atomic_queue_cmd_ack(&tx_packet, ((MSG_CMD_GROUP == act_packet.type) && (FALSE == local_button_pressed)) ? TRUE : FALSE);
         }
 
         // update global outlet state
@@ -931,11 +1448,13 @@ void actuate_task() {
           tx_packet.seq_num = atomic_increment_seq_num();
 
           // set payload
-          tx_packet.payload[CMDACK_CMDID_INDEX] = (uint16_t)act_packet.payload[CMD_CMDID_INDEX];
+          tx_packet.payload[CMDACK_CMDID_INDEX] = act_packet.payload[CMD_CMDID_INDEX];
+          tx_packet.payload[CMDACK_CMDID_INDEX + 1] = act_packet.payload[CMD_CMDID_INDEX + 1];
           tx_packet.payload[CMDACK_STATE_INDEX] = ON;
+          set_ack_trace(&tx_packet, &act_packet, act_ms, local_button_pressed);
 
-          // place message in the queue
-          atomic_push(&g_cmd_tx_queue, &tx_packet, g_cmd_tx_queue_mux);
+          // place message in the queue (held back if it answers a group command)
+          atomic_queue_cmd_ack(&tx_packet, ((MSG_CMD_GROUP == act_packet.type) && (FALSE == local_button_pressed)) ? TRUE : FALSE);
         }
 
         // update global outlet state
@@ -952,7 +1471,27 @@ void actuate_task() {
         break;
       }
     }
-    nrk_wait_until_next_period();
+
+    switch(curr_state) {
+      // a press or command was just taken - actuate without waiting
+      case STATE_ACT_OFF:
+      case STATE_ACT_ON: {
+        break;
+      }
+      // the coil is energised - hold it for a full period regardless of where
+      //  in the period the press arrived
+      case STATE_ACK_OFF:
+      case STATE_ACK_ON: {
+        nrk_wait(act_timeout);
+        break;
+      }
+      // idle - sleep until the act queue is due to be checked or the button fires
+      default: {
+        nrk_set_next_wakeup(act_timeout);
+        nrk_event_wait(SIG(g_button_signal) | SIG(nrk_wakeup_signal));
+        break;
+      }
+    }
   }
   nrk_kprintf(PSTR("Fallthrough: actuate_task\r\n"));
 }
@@ -964,6 +1503,9 @@ void actuate_task() {
 void heartbeat_task() {
   volatile int8_t local_watchdog;
   volatile uint8_t local_network_joined = FALSE;
+#ifdef NRK_STACK_PROFILE
+  volatile uint8_t local_stack_report = 0;
+#endif
   // print task pid
   printf("heartbeat_task PID: %d.\r\n", nrk_get_pid());
 
@@ -994,6 +1536,17 @@ void heartbeat_task() {
       nrk_led_set(RED_LED);
       nrk_led_clr(GREEN_LED);
     }
+
+#ifdef NRK_STACK_PROFILE
+    // periodically print the stack high-water marks for sizing the taskset
+    local_stack_report++;
+    if(STACK_REPORT_PERIOD <= local_stack_report) {
+      local_stack_report = 0;
+      if(TRUE == g_verbose) {
+        nrk_stack_profile_display_all();
+      }
+    }
+#endif
     nrk_wait_until_next_period();
   }
   nrk_kprintf(PSTR("Fallthrough: heartbeat_task\r\n"));
@@ -1016,6 +1569,17 @@ void inline nrk_set_gpio() {
 
   nrk_gpio_set(ON_COIL);
   nrk_gpio_set(OFF_COIL);
+
+#ifdef BTN_EXT_INT
+  // button edge starts a one-shot debounce on the application timer
+  nrk_timer_int_configure(NRK_APP_TIMER_0, BTN_DEBOUNCE_PRESCALE, BTN_DEBOUNCE_TICKS, &button_debounce_isr);
+  nrk_ext_int_configure(BTN_INT, NRK_FALLING_EDGE, &button_isr);
+  nrk_ext_int_enable(BTN_INT);
+#else
+  // no edge interrupt on the button pin, the application timer polls it
+  button_poll_period(BTN_POLL_TICKS);
+  nrk_timer_int_start(NRK_APP_TIMER_0);
+#endif
 }
 
 void inline nrk_register_drivers() {
@@ -1027,19 +1591,6 @@ void inline nrk_register_drivers() {
 
 void inline nrk_create_taskset () {
 
-  BUTTON_TASK.task = button_task;
-  nrk_task_set_stk(&BUTTON_TASK, button_task_stack, NRK_APP_STACKSIZE);
-  BUTTON_TASK.prio = 7;
-  BUTTON_TASK.FirstActivation = TRUE;
-  BUTTON_TASK.Type = BASIC_TASK;
-  BUTTON_TASK.SchType = NONPREEMPTIVE;
-  BUTTON_TASK.period.secs = 0;
-  BUTTON_TASK.period.nano_secs = 100*NANOS_PER_MS;
-  BUTTON_TASK.cpu_reserve.secs = 0;
-  BUTTON_TASK.cpu_reserve.nano_secs = 50*NANOS_PER_MS;
-  BUTTON_TASK.offset.secs = 0;
-  BUTTON_TASK.offset.nano_secs = 0;
-
   RX_MSG_TASK.task = rx_msg_task;
   nrk_task_set_stk(&RX_MSG_TASK, rx_msg_task_stack, NRK_APP_STACKSIZE);
   RX_MSG_TASK.prio = 6; 
@@ -1085,7 +1636,7 @@ void inline nrk_create_taskset () {
   SAMPLE_TASK.FirstActivation = TRUE;
   SAMPLE_TASK.Type = BASIC_TASK;
   SAMPLE_TASK.SchType = NONPREEMPTIVE;
-  SAMPLE_TASK.period.secs = 5;
+  SAMPLE_TASK.period.secs = SAMPLE_PERIOD_SECS;
   SAMPLE_TASK.period.nano_secs = 0;
   SAMPLE_TASK.cpu_reserve.secs = 0;
   SAMPLE_TASK.cpu_reserve.nano_secs = 100*NANOS_PER_MS;
@@ -1105,7 +1656,6 @@ void inline nrk_create_taskset () {
   HEARTBEAT_TASK.offset.secs = 0;
   HEARTBEAT_TASK.offset.nano_secs = 0;
 
-  nrk_activate_task(&BUTTON_TASK);
   nrk_activate_task(&RX_MSG_TASK);
   nrk_activate_task(&ACTUATE_TASK);
   nrk_activate_task(&TX_NET_TASK);
@@ -28,6 +28,22 @@
 // has been over written on all suspend calls
 #define NRK_STACK_CHECK
 
+// NRK_STACK_PROFILE paints task stacks at activation so that the high-water
+// mark of each task can be read with nrk_stack_profile_get() and a sizing
+// table printed with nrk_stack_profile_display_all()
+//#define NRK_STACK_PROFILE
+
+// NRK_EDF_SCHEDULER orders the ready queue by the end of each task's current
+// period (earliest deadline first) instead of by fixed priority.  Priorities
+// are still used to break ties and for aperiodic tasks.  Deadline misses are
+// counted by NRK_STATS_TRACKER.
+//#define NRK_EDF_SCHEDULER
+
+// NRK_TRACE records context switches, semaphore and signal events and ISR
+// entries into a RAM ring buffer (NRK_TRACE_BUF_SIZE entries).  Dump it with
+// nrk_trace_dump() and decode with tools/TraceScope.
+//#define NRK_TRACE
+
 // Leave NRK_NO_POWER_DOWN define in if the target can not wake up from sleep 
 // because it has no asynchronously clocked
 #define NRK_NO_POWER_DOWN
@@ -60,7 +76,7 @@
 #define NRK_KERNEL_STACKSIZE    256
 
  // number of semaphores in the system!
-#define NRK_MAX_RESOURCE_CNT           11
+#define NRK_MAX_RESOURCE_CNT           12
 
 #define NRK_MAX_DRIVER_CNT		1
 
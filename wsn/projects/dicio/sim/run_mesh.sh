@@ -0,0 +1,67 @@
+#!/bin/bash
+## Dicio - A Smart Outlet Mesh Network
+## run_mesh.sh
+##
+## Runs a gateway and N outlets as host processes on the simulated radio
+## medium and sums up the radio counters when they exit.
+##
+## usage: run_mesh.sh [nodes] [seconds] [link matrix]
+##
+## The gateway is MAC 1 and its UART is a pty linked at $OUT/gateway.tty,
+## outlets are MAC 2..nodes+1.  Logs go to $OUT (default /tmp/dicio-sim).
+## The gateway's EEPROM is kept in $OUT/gw.eeprom, so its node registry
+## carries over to the next run like it does across a reboot.
+
+NODES=${1:-10}
+SECS=${2:-60}
+LINKS=$3
+OUT=${OUT:-/tmp/dicio-sim}
+DICIO=$(cd "$(dirname "$0")/.." && pwd)
+
+make -s -C "$DICIO/gateway" PLATFORM=posix > /dev/null || exit 1
+make -s -C "$DICIO/node" PLATFORM=posix > /dev/null || exit 1
+
+mkdir -p "$OUT"
+rm -f "$OUT"/*.log "$OUT"/gateway.tty
+
+export NRK_POSIX_ETHER=${NRK_POSIX_ETHER:-239.255.21.54:$((15404 + $$ % 1000))}
+[ -n "$LINKS" ] && export NRK_POSIX_LINKS=$(realpath "$LINKS")
+
+PIDS=""
+NRK_POSIX_MAC=1 NRK_POSIX_NAME=gw NRK_POSIX_PTY_LINK="$OUT/gateway.tty" \
+	NRK_POSIX_EEPROM="$OUT/gw.eeprom" \
+	"$DICIO/gateway/main" > "$OUT/gw.log" 2>&1 &
+PIDS="$PIDS $!"
+for i in $(seq 2 $((NODES + 1))); do
+	NRK_POSIX_MAC=$i NRK_POSIX_NAME=n$i NRK_POSIX_UART=stdio \
+		"$DICIO/node/main" < /dev/null > "$OUT/n$i.log" 2>&1 &
+	PIDS="$PIDS $!"
+done
+
+echo "gateway on $OUT/gateway.tty, $NODES outlets on $NRK_POSIX_ETHER for $SECS s"
+sleep "$SECS"
+kill -TERM $PIDS 2> /dev/null
+wait
+
+# "[name t] rf tx F frames A ms air N no-ack C cca-fail rx R frames K acks X collided L lost M missed O overrun B cca-busy"
+grep -h '\] rf tx ' "$OUT"/*.log | awk -v secs="$SECS" '
+{
+	for(i = 1; i < NF; i++) {
+		if($(i+1) == "frames" && $(i-1) == "tx") tx += $i
+		if($(i+1) == "ms") air += $i
+		if($(i+1) == "frames" && $(i-1) == "rx") rx += $i
+		if($(i+1) == "collided") col += $i
+		if($(i+1) == "lost") lost += $i
+		if($(i+1) == "missed") miss += $i
+		if($(i+1) == "cca-busy") busy += $i
+	}
+	n++
+}
+END {
+	if(n == 0) { print "no radio statistics"; exit 1 }
+	heard = rx + col + lost
+	printf "%d radios, %d frames sent (%.1f%% channel use), %d delivered\n", n, tx, air / (secs * 10), rx
+	if(heard > 0)
+		printf "collision rate %.2f%%, loss rate %.2f%% of frames heard while listening\n", 100 * col / heard, 100 * lost / heard
+	printf "%d frames missed by sleeping or busy radios, %d busy CCA samples\n", miss, busy
+}'
@@ -0,0 +1,185 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * alive.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <alive.h>
+
+#if (ALIVE_FACTOR_REV0 >= ALIVE_WHEEL_SLOTS) || (ALIVE_FACTOR_REV1 >= ALIVE_WHEEL_SLOTS)
+#error "ALIVE_WHEEL_SLOTS must be larger than every ALIVE_FACTOR"
+#endif
+
+// alive_factor - liveness timeout of each class (in alive_task periods)
+static const uint8_t alive_factor[ALIVE_CLASSES] = {
+    ALIVE_FACTOR_REV0,
+    ALIVE_FACTOR_REV1,
+};
+
+// alive_ahead - ticks from now until tick (wrapping)
+static uint8_t alive_ahead(alive_t *a, uint8_t tick) {
+    return (uint8_t)(tick - a->now);
+}
+
+// alive_link - list node index i in the slot for tick
+static void alive_link(alive_t *a, uint8_t i, uint8_t tick) {
+    uint8_t s = tick & (ALIVE_WHEEL_SLOTS - 1);
+    a->at[i] = tick;
+    a->next[i] = a->slot[s];
+    a->slot[s] = i;
+}
+
+// alive_unlink - take node index i out of its slot's list
+static void alive_unlink(alive_t *a, uint8_t i) {
+    uint8_t *link = &a->slot[a->at[i] & (ALIVE_WHEEL_SLOTS - 1)];
+    while(ALIVE_NONE != *link) {
+        if(i == *link) {
+            *link = a->next[i];
+            return;
+        }
+        link = &a->next[*link];
+    }
+}
+
+// alive_find - index of node_id, adding it (in class 0) if it is new.
+//  returns ALIVE_NONE if it is new and the table is full.
+static uint8_t alive_find(alive_t *a, uint8_t node_id) {
+    uint8_t i;
+    for(i = 0; i < a->size; i++) {
+        if(node_id == a->node_id[i]) {
+            return i;
+        }
+    }
+    if(MAX_ALIVE_NODES <= a->size) {
+        return ALIVE_NONE;
+    }
+    a->size++;
+    a->node_id[i] = node_id;
+    a->node_class[i] = 0;
+    a->state[i] = ALIVE_STATE_UNKNOWN;
+    a->seq_num[i] = 0;
+    a->lost[i] = TRUE; // not listed yet
+    return i;
+}
+
+// alive_arm - restart node index i's timeout
+static void alive_arm(alive_t *a, uint8_t i) {
+    a->expiry[i] = a->now + alive_factor[a->node_class[i]] - ALIVE_LIMIT;
+    if(TRUE == a->lost[i]) {
+        a->lost[i] = FALSE;
+        alive_link(a, i, a->expiry[i]);
+    }
+    // a shorter timeout (after a class change) can't wait for the later slot
+    else if(alive_ahead(a, a->expiry[i]) < alive_ahead(a, a->at[i])) {
+        alive_unlink(a, i);
+        alive_link(a, i, a->expiry[i]);
+    }
+}
+
+// alive_init - forget every node
+void alive_init(alive_t *a) {
+    uint8_t s;
+    a->size = 0;
+    a->now = 0;
+    for(s = 0; s < ALIVE_WHEEL_SLOTS; s++) {
+        a->slot[s] = ALIVE_NONE;
+    }
+}
+
+// alive_heard - seq_num was just heard from node_id, restart its timeout.
+//  returns FALSE if the node is new and there is no room to track it.
+uint8_t alive_heard(alive_t *a, uint8_t node_id, uint16_t seq_num) {
+    uint8_t i = alive_find(a, node_id);
+    if(ALIVE_NONE == i) {
+        return FALSE;
+    }
+    a->seq_num[i] = seq_num;
+    alive_arm(a, i);
+    return TRUE;
+}
+
+// alive_set_class - set node_id's class from the hardware revision in its
+//  handshake and restart its timeout. returns FALSE if there is no room.
+uint8_t alive_set_class(alive_t *a, uint8_t node_id, uint8_t hw_rev) {
+    uint8_t i = alive_find(a, node_id);
+    if(ALIVE_NONE == i) {
+        return FALSE;
+    }
+    a->node_class[i] = (ALIVE_CLASSES > hw_rev) ? hw_rev : 0;
+    alive_arm(a, i);
+    return TRUE;
+}
+
+// alive_restore - add node_id with the class it had before a reboot. it isn't
+//  timed (or listed in syncs) until it is heard again.
+void alive_restore(alive_t *a, uint8_t node_id, uint8_t node_class) {
+    uint8_t i = alive_find(a, node_id);
+    if((ALIVE_NONE != i) && (ALIVE_CLASSES > node_class)) {
+        a->node_class[i] = node_class;
+    }
+}
+
+// alive_class_of - liveness class of node_id (0 if it isn't tracked)
+uint8_t alive_class_of(alive_t *a, uint8_t node_id) {
+    uint8_t i;
+    for(i = 0; i < a->size; i++) {
+        if(node_id == a->node_id[i]) {
+            return a->node_class[i];
+        }
+    }
+    return 0;
+}
+
+// alive_set_state - record the outlet state node_id last reported
+void alive_set_state(alive_t *a, uint8_t node_id, uint8_t state) {
+    uint8_t i;
+    for(i = 0; i < a->size; i++) {
+        if(node_id == a->node_id[i]) {
+            a->state[i] = state;
+            return;
+        }
+    }
+}
+
+// alive_tick - advance one alive_task period and put the nodes that expired
+//  in lost_ids. returns how many; any beyond max_lost are reported next tick.
+uint8_t alive_tick(alive_t *a, uint8_t *lost_ids, uint8_t max_lost) {
+    uint8_t s, i, next;
+    uint8_t count = 0;
+
+    a->now++;
+    s = a->now & (ALIVE_WHEEL_SLOTS - 1);
+    i = a->slot[s];
+    a->slot[s] = ALIVE_NONE;
+
+    // every node in this slot either expired or was heard since it was listed
+    while(ALIVE_NONE != i) {
+        next = a->next[i];
+        if(a->now != a->expiry[i]) {
+            alive_link(a, i, a->expiry[i]);
+        } else if(max_lost > count) {
+            a->lost[i] = TRUE;
+            lost_ids[count] = a->node_id[i];
+            count++;
+        } else {
+            a->expiry[i] = a->now + 1;
+            alive_link(a, i, a->expiry[i]);
+        }
+        i = next;
+    }
+    return count;
+}
+
+// alive_entry - get entry i of the table (0 to MAX_ALIVE_NODES - 1). returns
+//  FALSE if there is no node there or it has been reported lost.
+uint8_t alive_entry(alive_t *a, uint8_t i, uint8_t *node_id, uint8_t *state, uint16_t *seq_num) {
+    if((a->size <= i) || (TRUE == a->lost[i])) {
+        return FALSE;
+    }
+    *node_id = a->node_id[i];
+    *state = a->state[i];
+    *seq_num = a->seq_num[i];
+    return TRUE;
+}
@@ -0,0 +1,23 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * alive.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __alive_h
+#define __alive_h
+
+#include <type_defs.h>
+
+void alive_init(alive_t *a);
+uint8_t alive_heard(alive_t *a, uint8_t node_id, uint16_t seq_num);
+uint8_t alive_set_class(alive_t *a, uint8_t node_id, uint8_t hw_rev);
+void alive_restore(alive_t *a, uint8_t node_id, uint8_t node_class);
+uint8_t alive_class_of(alive_t *a, uint8_t node_id);
+void alive_set_state(alive_t *a, uint8_t node_id, uint8_t state);
+uint8_t alive_tick(alive_t *a, uint8_t *lost_ids, uint8_t max_lost);
+uint8_t alive_entry(alive_t *a, uint8_t i, uint8_t *node_id, uint8_t *state, uint16_t *seq_num);
+
+#endif
@@ -23,12 +23,17 @@ void assemble_serv_packet(uint8_t *tx_buf, packet *tx)
         {
             break;
         }
-        // lost node message - indicate the loss of a particular node in the system
+        // lost node message - indicate the loss of one or more nodes in the system
         case MSG_LOST:
         {
-            volatile uint8_t tx_lost_id = tx->payload[LOST_NODE_INDEX];
-            sprintf((char *)tx_buf, "%d:%d:%d:%d:%d,", tx_source_id, tx_seq_num, tx_type, tx_num_hops,
-                tx_lost_id);
+            uint8_t tx_lost_count = tx->payload[LOST_COUNT_INDEX];
+            uint8_t length = sprintf((char *)tx_buf, "%d:%d:%d:%d:", tx_source_id, tx_seq_num, tx_type, tx_num_hops);
+            if(MAX_LOST_BATCH < tx_lost_count) {
+                tx_lost_count = MAX_LOST_BATCH;
+            }
+            for(uint8_t i = 0; i < tx_lost_count; i++) {
+                length += sprintf((char *)&tx_buf[length], "%d,", tx->payload[LOST_NODE_INDEX + i]);
+            }
             break;
         }
         // mesage from gateway -> undefined
@@ -43,9 +48,10 @@ void assemble_serv_packet(uint8_t *tx_buf, packet *tx)
             uint16_t data_temp = ((tx->payload[DATA_TEMP_INDEX] << 8) | (tx->payload[DATA_TEMP_INDEX + 1]));
             uint16_t data_light = ((tx->payload[DATA_LIGHT_INDEX] << 8) | (tx->payload[DATA_LIGHT_INDEX + 1]));
             uint8_t tx_data_state = tx->payload[DATA_STATE_INDEX];
+            uint8_t tx_data_age = tx->payload[DATA_AGE_INDEX];
 
-            sprintf((char *)tx_buf, "%d:%d:%d:%d:%d,%d,%d,%d", tx_source_id, (uint16_t)tx_seq_num, tx_type,
-             tx_num_hops, data_pwr, data_temp, data_light, tx_data_state);
+            sprintf((char *)tx_buf, "%d:%d:%d:%d:%d,%d,%d,%d,%d", tx_source_id, (uint16_t)tx_seq_num, tx_type,
+             tx_num_hops, data_pwr, data_temp, data_light, tx_data_state, tx_data_age);
             break;
         }
         // command message ... this will never happen. (Commands come from the server!)
@@ -56,10 +62,16 @@ void assemble_serv_packet(uint8_t *tx_buf, packet *tx)
         // command acknowledgement
         case MSG_CMDACK:
         {
-            uint16_t tx_cmdAck_cmdID = (uint16_t)tx->payload[CMDACK_CMDID_INDEX];
+            uint16_t tx_cmdAck_cmdID = ((uint16_t)tx->payload[CMDACK_CMDID_INDEX] << 8) | tx->payload[CMDACK_CMDID_INDEX + 1];
             uint8_t tx_cmdAck_state = tx->payload[CMDACK_STATE_INDEX];
-            sprintf((char *)tx_buf, "%d:%d:%d:%d:%d,%d", tx_source_id, tx_seq_num, tx_type, tx_num_hops,
-                tx_cmdAck_cmdID, tx_cmdAck_state);
+            // latency trace (ms): node rx->coil, coil->ack, gateway queue, gateway->ack
+            uint16_t tx_cmdAck_rxAct = ((uint16_t)tx->payload[CMDACK_RX_ACT_INDEX] << 8) | tx->payload[CMDACK_RX_ACT_INDEX + 1];
+            uint16_t tx_cmdAck_actAck = ((uint16_t)tx->payload[CMDACK_ACT_ACK_INDEX] << 8) | tx->payload[CMDACK_ACT_ACK_INDEX + 1];
+            uint16_t tx_cmdAck_gwQueue = ((uint16_t)tx->payload[CMDACK_GW_QUEUE_INDEX] << 8) | tx->payload[CMDACK_GW_QUEUE_INDEX + 1];
+            uint16_t tx_cmdAck_gwNet = ((uint16_t)tx->payload[CMDACK_GW_NET_INDEX] << 8) | tx->payload[CMDACK_GW_NET_INDEX + 1];
+            sprintf((char *)tx_buf, "%d:%d:%d:%d:%u,%d,%u,%u,%u,%u", tx_source_id, tx_seq_num, tx_type, tx_num_hops,
+                tx_cmdAck_cmdID, tx_cmdAck_state, tx_cmdAck_rxAct, tx_cmdAck_actAck,
+                tx_cmdAck_gwQueue, tx_cmdAck_gwNet);
             break;
         }
         // handshake request ... this will never happend (Server only receives HANDACKs)
@@ -90,11 +102,64 @@ void assemble_serv_packet(uint8_t *tx_buf, packet *tx)
             sprintf((char *)tx_buf, "%d:%d:%d:%d:,", tx_source_id, tx_seq_num, tx_type, tx_num_hops);
             break;
         }
+        // energy message - cumulative energy and the window's power range
+        case MSG_ENERGY:
+        {
+            uint32_t energy_ws = ((uint32_t)tx->payload[ENERGY_WS_INDEX] << 24) |
+                ((uint32_t)tx->payload[ENERGY_WS_INDEX + 1] << 16) |
+                ((uint32_t)tx->payload[ENERGY_WS_INDEX + 2] << 8) |
+                (uint32_t)tx->payload[ENERGY_WS_INDEX + 3];
+            uint16_t pwr_min = ((tx->payload[ENERGY_PWR_MIN_INDEX] << 8) | (tx->payload[ENERGY_PWR_MIN_INDEX + 1]));
+            uint16_t pwr_max = ((tx->payload[ENERGY_PWR_MAX_INDEX] << 8) | (tx->payload[ENERGY_PWR_MAX_INDEX + 1]));
+            sprintf((char *)tx_buf, "%d:%d:%d:%d:%lu,%u,%u", tx_source_id, tx_seq_num, tx_type, tx_num_hops,
+                (unsigned long)energy_ws, pwr_min, pwr_max);
+            break;
+        }
+        // config message ... this will never happen. (Config comes from the server!)
+        case MSG_CONFIG:
+        {
+            break;
+        }
+        // config acknowledgement - the parameter value now in use and whether it was accepted
+        case MSG_CONFIGACK:
+        {
+            uint16_t cmd_id = ((tx->payload[CONFIGACK_CMDID_INDEX] << 8) | (tx->payload[CONFIGACK_CMDID_INDEX + 1]));
+            uint16_t value = ((tx->payload[CONFIGACK_VALUE_INDEX] << 8) | (tx->payload[CONFIGACK_VALUE_INDEX + 1]));
+            sprintf((char *)tx_buf, "%d:%d:%d:%d:%u,%d,%u,%d", tx_source_id, tx_seq_num, tx_type, tx_num_hops,
+                cmd_id, tx->payload[CONFIGACK_PARAM_INDEX], value, tx->payload[CONFIGACK_STATUS_INDEX]);
+            break;
+        }
+        // OTA report - a node's progress on an update, or the result of checking it
+        case MSG_OTA_REPORT:
+        {
+            uint16_t missing = ((tx->payload[OTAR_MISSING_INDEX] << 8) | (tx->payload[OTAR_MISSING_INDEX + 1]));
+            uint16_t next = ((tx->payload[OTAR_NEXT_INDEX] << 8) | (tx->payload[OTAR_NEXT_INDEX + 1]));
+            sprintf((char *)tx_buf, "%d:%d:%d:%d:%d,%d,%d,%u,%u", tx_source_id, tx_seq_num, tx_type, tx_num_hops,
+                tx->payload[OTA_IMAGE_INDEX], tx->payload[OTAR_STATUS_INDEX],
+                tx->payload[OTAR_WINDOW_INDEX], missing, next);
+            break;
+        }
         default:
             break;
     }
 }
 
+// assemble_batch_packet - assemble a MSG_DATA_BATCH message for the network
+uint8_t assemble_batch_packet(uint8_t *tx_buf, uint8_t source_id, uint16_t seq_num, batch_t *b)
+{
+    tx_buf[0] = source_id;
+    tx_buf[1] = (seq_num >> 8) & 0xff;
+    tx_buf[2] = seq_num & 0xff;
+    tx_buf[3] = MSG_DATA_BATCH;
+    tx_buf[4] = 0;
+    for(uint8_t i = 0; i < b->len; i++) {
+        tx_buf[HEADER_SIZE + i] = b->buf[i];
+    }
+    // sample periods since the newest set, so the receiver can date every set
+    tx_buf[HEADER_SIZE + BATCH_AGE_INDEX] = b->age;
+    return HEADER_SIZE + b->len;
+}
+
 // assemble_packet - assemble backet to for the network
 uint8_t assemble_packet(uint8_t *tx_buf, packet *tx)
 {
@@ -142,16 +207,35 @@ uint8_t assemble_packet(uint8_t *tx_buf, packet *tx)
             tx_buf[HEADER_SIZE + 3] = tx->payload[CMD_ACT_INDEX];
             break;
         }
+        // group command - one frame that every member of a group acts on
+        case MSG_CMD_GROUP:
+        {
+            length = 9;
+
+            // command ID (2 bytes)
+            tx_buf[HEADER_SIZE] = tx->payload[CMDG_CMDID_INDEX];
+            tx_buf[HEADER_SIZE + 1] = tx->payload[CMDG_CMDID_INDEX + 1];
+            // group ID (1 byte)
+            tx_buf[HEADER_SIZE + 2] = tx->payload[CMDG_GROUP_INDEX];
+            // action (1 byte)
+            tx_buf[HEADER_SIZE + 3] = tx->payload[CMDG_ACTION_INDEX];
+            break;
+        }
         // command acknowledgment - send from a node back to the server to confirm actuation 
         case MSG_CMDACK:
         {
-            length = 8;
+            length = 12;
             
             // command ID (2 bytes)
             tx_buf[HEADER_SIZE] = tx->payload[CMDACK_CMDID_INDEX];
             tx_buf[HEADER_SIZE + 1] = tx->payload[CMDACK_CMDID_INDEX + 1];
             // node state (1 byte)
             tx_buf[HEADER_SIZE + 2] = tx->payload[CMDACK_STATE_INDEX];
+            // node latency trace: rx->coil, coil->ack (2 bytes each)
+            tx_buf[HEADER_SIZE + 3] = tx->payload[CMDACK_RX_ACT_INDEX];
+            tx_buf[HEADER_SIZE + 4] = tx->payload[CMDACK_RX_ACT_INDEX + 1];
+            tx_buf[HEADER_SIZE + 5] = tx->payload[CMDACK_ACT_ACK_INDEX];
+            tx_buf[HEADER_SIZE + 6] = tx->payload[CMDACK_ACT_ACK_INDEX + 1];
             break;
         }
         // handshake request - send to the gateway to gain access to the network
@@ -180,17 +264,74 @@ uint8_t assemble_packet(uint8_t *tx_buf, packet *tx)
             break;
         }
         // heartbeat message - from gateway to nodes so the nodes know they 
-        //  are still part of the system
+        //  are still part of the system. also carries the routing gradient.
         case MSG_HEARTBEAT:
+        case MSG_RESET:
         {
-            // no payload!
-            length = 5;
+            length = 8;
+            // relaying node (1 byte) and its path cost to the gateway (2 bytes)
+            tx_buf[HEADER_SIZE] = tx->payload[HEART_RELAY_INDEX];
+            tx_buf[HEADER_SIZE + 1] = tx->payload[HEART_COST_INDEX];
+            tx_buf[HEADER_SIZE + 2] = tx->payload[HEART_COST_INDEX + 1];
             break;
         }
 
-        case MSG_RESET:
+        // energy message - cumulative watt-seconds (4 bytes), window min/max power (2 bytes each)
+        case MSG_ENERGY:
+        {
+            length = 13;
+            tx_buf[HEADER_SIZE] = tx->payload[ENERGY_WS_INDEX];
+            tx_buf[HEADER_SIZE + 1] = tx->payload[ENERGY_WS_INDEX + 1];
+            tx_buf[HEADER_SIZE + 2] = tx->payload[ENERGY_WS_INDEX + 2];
+            tx_buf[HEADER_SIZE + 3] = tx->payload[ENERGY_WS_INDEX + 3];
+            tx_buf[HEADER_SIZE + 4] = tx->payload[ENERGY_PWR_MIN_INDEX];
+            tx_buf[HEADER_SIZE + 5] = tx->payload[ENERGY_PWR_MIN_INDEX + 1];
+            tx_buf[HEADER_SIZE + 6] = tx->payload[ENERGY_PWR_MAX_INDEX];
+            tx_buf[HEADER_SIZE + 7] = tx->payload[ENERGY_PWR_MAX_INDEX + 1];
+            break;
+        }
+        // config message - set one configuration parameter on a particular node
+        case MSG_CONFIG:
         {
-            length = 5;
+            length = 11;
+            // command ID (2 bytes)
+            tx_buf[HEADER_SIZE] = tx->payload[CONFIG_CMDID_INDEX];
+            tx_buf[HEADER_SIZE + 1] = tx->payload[CONFIG_CMDID_INDEX + 1];
+            // node ID (1 byte)
+            tx_buf[HEADER_SIZE + 2] = tx->payload[CONFIG_NODE_ID_INDEX];
+            // parameter (1 byte) and value (2 bytes)
+            tx_buf[HEADER_SIZE + 3] = tx->payload[CONFIG_PARAM_INDEX];
+            tx_buf[HEADER_SIZE + 4] = tx->payload[CONFIG_VALUE_INDEX];
+            tx_buf[HEADER_SIZE + 5] = tx->payload[CONFIG_VALUE_INDEX + 1];
+            break;
+        }
+        // config acknowledgement - sent from a node back to the server
+        case MSG_CONFIGACK:
+        {
+            length = 11;
+            // command ID (2 bytes)
+            tx_buf[HEADER_SIZE] = tx->payload[CONFIGACK_CMDID_INDEX];
+            tx_buf[HEADER_SIZE + 1] = tx->payload[CONFIGACK_CMDID_INDEX + 1];
+            // parameter (1 byte), value in use (2 bytes), status (1 byte)
+            tx_buf[HEADER_SIZE + 2] = tx->payload[CONFIGACK_PARAM_INDEX];
+            tx_buf[HEADER_SIZE + 3] = tx->payload[CONFIGACK_VALUE_INDEX];
+            tx_buf[HEADER_SIZE + 4] = tx->payload[CONFIGACK_VALUE_INDEX + 1];
+            tx_buf[HEADER_SIZE + 5] = tx->payload[CONFIGACK_STATUS_INDEX];
+            break;
+        }
+        // OTA report - sent from a node back to the server
+        case MSG_OTA_REPORT:
+        {
+            length = 12;
+            // image ID (1 byte), status (1 byte), oldest incomplete window (1 byte)
+            tx_buf[HEADER_SIZE] = tx->payload[OTA_IMAGE_INDEX];
+            tx_buf[HEADER_SIZE + 1] = tx->payload[OTAR_STATUS_INDEX];
+            tx_buf[HEADER_SIZE + 2] = tx->payload[OTAR_WINDOW_INDEX];
+            // chunks missing from that window and the next (2 bytes each)
+            tx_buf[HEADER_SIZE + 3] = tx->payload[OTAR_MISSING_INDEX];
+            tx_buf[HEADER_SIZE + 4] = tx->payload[OTAR_MISSING_INDEX + 1];
+            tx_buf[HEADER_SIZE + 5] = tx->payload[OTAR_NEXT_INDEX];
+            tx_buf[HEADER_SIZE + 6] = tx->payload[OTAR_NEXT_INDEX + 1];
             break;
         }
         default:
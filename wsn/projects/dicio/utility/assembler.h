@@ -13,5 +13,6 @@
 
 void assemble_serv_packet(uint8_t *tx_buf, packet *tx);
 uint8_t assemble_packet(uint8_t *tx_buf, packet *tx);
+uint8_t assemble_batch_packet(uint8_t *tx_buf, uint8_t source_id, uint16_t seq_num, batch_t *b);
 
 #endif
\ No newline at end of file
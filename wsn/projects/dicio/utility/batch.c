@@ -0,0 +1,77 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * batch.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <batch.h>
+
+// put_varint - append an unsigned varint (7 bits per byte, LSB first)
+static void put_varint(batch_t *b, uint16_t val) {
+    while(VARINT_MASK < val) {
+        b->buf[b->len] = (val & VARINT_MASK) | VARINT_MORE;
+        b->len++;
+        val >>= VARINT_SHIFT;
+    }
+    b->buf[b->len] = (uint8_t)val;
+    b->len++;
+}
+
+// put_delta - append the zigzag encoded difference between two values
+static void put_delta(batch_t *b, uint16_t val, uint16_t prev) {
+    int16_t delta = (int16_t)(val - prev);
+    put_varint(b, (uint16_t)((delta << 1) ^ (delta >> 15)));
+}
+
+// batch_init - start an empty batch
+void batch_init(batch_t *b, uint8_t period_secs) {
+    b->buf[BATCH_COUNT_INDEX] = 0;
+    b->buf[BATCH_STATE_INDEX] = 0;
+    b->buf[BATCH_PERIOD_INDEX] = period_secs;
+    b->buf[BATCH_AGE_INDEX] = 0;
+    b->len = BATCH_SETS_INDEX;
+    b->count = 0;
+    b->age = 0;
+    b->span = 0;
+    b->prev.pwr = 0;
+    b->prev.temp = 0;
+    b->prev.light = 0;
+    b->prev.state = OFF;
+}
+
+// batch_add - add a set to the batch. returns FALSE if the batch is full.
+uint8_t batch_add(batch_t *b, sample_set_t *s) {
+    if(BATCH_MAX_SETS <= b->count) {
+        return FALSE;
+    }
+
+    // the first set is a delta from zero, i.e. its absolute value
+    put_varint(b, b->age);
+    put_delta(b, s->pwr, b->prev.pwr);
+    put_delta(b, s->temp, b->prev.temp);
+    put_delta(b, s->light, b->prev.light);
+    if(ON == s->state) {
+        b->buf[BATCH_STATE_INDEX] |= (1 << b->count);
+    }
+
+    b->prev = *s;
+    b->count++;
+    b->buf[BATCH_COUNT_INDEX] = b->count;
+    b->age = 0;
+    return TRUE;
+}
+
+// batch_tick - advance the batch by one sample period
+void batch_tick(batch_t *b) {
+    if(0 == b->count) {
+        return;
+    }
+    if(0xFF > b->age) {
+        b->age++;
+    }
+    if(0xFF > b->span) {
+        b->span++;
+    }
+}
@@ -0,0 +1,18 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * batch.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __batch_h
+#define __batch_h
+
+#include <type_defs.h>
+
+void batch_init(batch_t *b, uint8_t period_secs);
+uint8_t batch_add(batch_t *b, sample_set_t *s);
+void batch_tick(batch_t *b);
+
+#endif
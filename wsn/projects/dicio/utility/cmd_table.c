@@ -0,0 +1,138 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * cmd_table.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <cmd_table.h>
+
+// copy_cmd - copy a command packet
+static void copy_cmd(packet *dest, packet *src) {
+    dest->source_id = src->source_id;
+    dest->type = src->type;
+    dest->seq_num = src->seq_num;
+    dest->num_hops = src->num_hops;
+    for(uint8_t i = 0; i < MAX_PAYLOAD_SIZE; i++) {
+        dest->payload[i] = src->payload[i];
+    }
+}
+
+// cmd_id_of - the 2 byte command id of a command packet
+static uint16_t cmd_id_of(packet *cmd) {
+    return ((uint16_t)cmd->payload[CMD_CMDID_INDEX] << 8) | cmd->payload[CMD_CMDID_INDEX + 1];
+}
+
+// cmd_table_init - start with no commands in flight
+void cmd_table_init(cmd_table_t *t) {
+    for(uint8_t i = 0; i < MAX_INFLIGHT_CMDS; i++) {
+        t->in_use[i] = FALSE;
+    }
+}
+
+// cmd_table_add - track a command that has just been queued. replaces any
+//  command still in flight to the same node. its retry deadline only starts
+//  once cmd_table_sent sees it go out. returns the slot, or -1 if full.
+int8_t cmd_table_add(cmd_table_t *t, packet *cmd) {
+    int8_t slot = -1;
+
+    for(uint8_t i = 0; i < MAX_INFLIGHT_CMDS; i++) {
+        if((TRUE == t->in_use[i]) &&
+            (cmd->payload[CMD_NODE_ID_INDEX] == t->cmd[i].payload[CMD_NODE_ID_INDEX])) {
+            slot = i;
+            break;
+        }
+        if((-1 == slot) && (FALSE == t->in_use[i])) {
+            slot = i;
+        }
+    }
+    if(-1 == slot) {
+        return -1;
+    }
+
+    copy_cmd(&t->cmd[slot], cmd);
+    t->in_use[slot] = TRUE;
+    t->backoff[slot] = RETRY_CMD_PERIOD;
+    t->deadline[slot] = 0;
+    t->retries[slot] = 0;
+    t->sent[slot] = FALSE;
+    return slot;
+}
+
+// cmd_table_sent - note when a command first went out on the radio and arm
+//  its retry deadline
+void cmd_table_sent(cmd_table_t *t, packet *cmd, uint16_t now_ms) {
+    for(uint8_t i = 0; i < MAX_INFLIGHT_CMDS; i++) {
+        if((TRUE == t->in_use[i]) && (FALSE == t->sent[i]) &&
+            (cmd->payload[CMD_NODE_ID_INDEX] == t->cmd[i].payload[CMD_NODE_ID_INDEX]) &&
+            (cmd_id_of(cmd) == cmd_id_of(&t->cmd[i]))) {
+            t->sent[i] = TRUE;
+            t->tx_ms[i] = now_ms;
+            t->deadline[i] = t->backoff[i];
+            return;
+        }
+    }
+}
+
+// cmd_table_ack - match an ack from node_id. the command is only done if the
+//  node reports the state it was told to be in. returns TRUE on a match, with
+//  the time the command waited at the gateway (from CMD_RX_MS_INDEX to its
+//  first transmission) and the time from then until the ack (0 otherwise).
+uint8_t cmd_table_ack(cmd_table_t *t, uint8_t node_id, uint16_t cmd_id, uint8_t state,
+    uint16_t now_ms, uint16_t *queue_ms, uint16_t *net_ms) {
+    uint16_t rx_ms;
+
+    *queue_ms = 0;
+    *net_ms = 0;
+    for(uint8_t i = 0; i < MAX_INFLIGHT_CMDS; i++) {
+        if((TRUE == t->in_use[i]) &&
+            (node_id == t->cmd[i].payload[CMD_NODE_ID_INDEX]) &&
+            (cmd_id == cmd_id_of(&t->cmd[i])) &&
+            (state == t->cmd[i].payload[CMD_ACT_INDEX])) {
+            if(TRUE == t->sent[i]) {
+                rx_ms = ((uint16_t)t->cmd[i].payload[CMD_RX_MS_INDEX] << 8) | t->cmd[i].payload[CMD_RX_MS_INDEX + 1];
+                *queue_ms = t->tx_ms[i] - rx_ms;
+                *net_ms = now_ms - t->tx_ms[i];
+            }
+            t->in_use[i] = FALSE;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// cmd_table_tick - one period has passed, move every armed deadline closer
+void cmd_table_tick(cmd_table_t *t) {
+    for(uint8_t i = 0; i < MAX_INFLIGHT_CMDS; i++) {
+        if((TRUE == t->in_use[i]) && (TRUE == t->sent[i]) && (0 < t->deadline[i])) {
+            t->deadline[i]--;
+        }
+    }
+}
+
+// cmd_table_poll - copy out one sent command whose deadline has passed.
+//  CMD_RETRY - resend it, its next deadline is twice as far away
+//  CMD_EXPIRED - it ran out of retries and has been removed
+//  CMD_NONE_DUE - nothing to do this period
+uint8_t cmd_table_poll(cmd_table_t *t, packet *cmd) {
+    for(uint8_t i = 0; i < MAX_INFLIGHT_CMDS; i++) {
+        if((FALSE == t->in_use[i]) || (FALSE == t->sent[i]) || (0 < t->deadline[i])) {
+            continue;
+        }
+        copy_cmd(cmd, &t->cmd[i]);
+        if(RETRY_LIMIT <= t->retries[i]) {
+            t->in_use[i] = FALSE;
+            return CMD_EXPIRED;
+        }
+        t->retries[i]++;
+        if((RETRY_BACKOFF_MAX / 2) >= t->backoff[i]) {
+            t->backoff[i] <<= 1;
+        } else {
+            t->backoff[i] = RETRY_BACKOFF_MAX;
+        }
+        t->deadline[i] = t->backoff[i];
+        return CMD_RETRY;
+    }
+    return CMD_NONE_DUE;
+}
@@ -0,0 +1,22 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * cmd_table.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __cmd_table_h
+#define __cmd_table_h
+
+#include <type_defs.h>
+
+void cmd_table_init(cmd_table_t *t);
+int8_t cmd_table_add(cmd_table_t *t, packet *cmd);
+void cmd_table_sent(cmd_table_t *t, packet *cmd, uint16_t now_ms);
+uint8_t cmd_table_ack(cmd_table_t *t, uint8_t node_id, uint16_t cmd_id, uint8_t state,
+    uint16_t now_ms, uint16_t *queue_ms, uint16_t *net_ms);
+void cmd_table_tick(cmd_table_t *t);
+uint8_t cmd_table_poll(cmd_table_t *t, packet *cmd);
+
+#endif
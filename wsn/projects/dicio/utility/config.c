@@ -0,0 +1,152 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * config.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <config.h>
+#include <nrk_eeprom.h>
+
+// EEPROM image: magic byte, config_t bytes, checksum
+#define CONFIG_EE_DATA_ADDR (CONFIG_EE_ADDR + 1)
+#define CONFIG_EE_CHKSUM_ADDR (CONFIG_EE_DATA_ADDR + sizeof(config_t))
+
+// config_defaults - fill in the compiled-in configuration
+void config_defaults(config_t *c) {
+    c->pwr_period = DEFAULT_PWR_PERIOD;
+    c->temp_period = DEFAULT_TEMP_PERIOD;
+    c->light_period = DEFAULT_LIGHT_PERIOD;
+    c->pwr_deadband = REPORT_PWR_DEADBAND;
+    c->temp_deadband = REPORT_TEMP_DEADBAND;
+    c->light_deadband = REPORT_LIGHT_DEADBAND;
+    c->heartbeat = REPORT_WINDOW;
+    c->groups = 0;
+}
+
+// config_load - read the configuration from EEPROM. falls back to the defaults
+//  and returns NRK_ERROR if the stored image is missing or corrupt.
+int8_t config_load(config_t *c) {
+    uint8_t *buf = (uint8_t *)c;
+    uint8_t checksum = 0;
+
+    if(CONFIG_EE_MAGIC != nrk_eeprom_read_byte(CONFIG_EE_ADDR)) {
+        config_defaults(c);
+        return NRK_ERROR;
+    }
+    for(uint8_t i = 0; i < sizeof(config_t); i++) {
+        buf[i] = nrk_eeprom_read_byte(CONFIG_EE_DATA_ADDR + i);
+        checksum += buf[i];
+    }
+    if(checksum != nrk_eeprom_read_byte(CONFIG_EE_CHKSUM_ADDR)) {
+        config_defaults(c);
+        return NRK_ERROR;
+    }
+
+    // never trust a stored value that config_set would have rejected
+    if((CONFIG_INVALID == config_set(c, CONFIG_PWR_PERIOD, c->pwr_period)) ||
+        (CONFIG_INVALID == config_set(c, CONFIG_TEMP_PERIOD, c->temp_period)) ||
+        (CONFIG_INVALID == config_set(c, CONFIG_LIGHT_PERIOD, c->light_period)) ||
+        (CONFIG_INVALID == config_set(c, CONFIG_HEARTBEAT, c->heartbeat)) ||
+        (CONFIG_INVALID == config_set(c, CONFIG_GROUPS, c->groups))) {
+        config_defaults(c);
+        return NRK_ERROR;
+    }
+    return NRK_OK;
+}
+
+// config_save - write the configuration to EEPROM. only bytes that changed
+//  are written to save EEPROM wear.
+void config_save(config_t *c) {
+    uint8_t *buf = (uint8_t *)c;
+    uint8_t checksum = 0;
+
+    for(uint8_t i = 0; i < sizeof(config_t); i++) {
+        if(buf[i] != nrk_eeprom_read_byte(CONFIG_EE_DATA_ADDR + i)) {
+            nrk_eeprom_write_byte(CONFIG_EE_DATA_ADDR + i, buf[i]);
+        }
+        checksum += buf[i];
+    }
+    if(checksum != nrk_eeprom_read_byte(CONFIG_EE_CHKSUM_ADDR)) {
+        nrk_eeprom_write_byte(CONFIG_EE_CHKSUM_ADDR, checksum);
+    }
+    if(CONFIG_EE_MAGIC != nrk_eeprom_read_byte(CONFIG_EE_ADDR)) {
+        nrk_eeprom_write_byte(CONFIG_EE_ADDR, CONFIG_EE_MAGIC);
+    }
+}
+
+// config_set - validate and set a single parameter. returns CONFIG_OK or
+//  CONFIG_INVALID (configuration left unchanged).
+uint8_t config_set(config_t *c, uint8_t param, uint16_t value) {
+    switch(param) {
+        case CONFIG_PWR_PERIOD:
+        case CONFIG_TEMP_PERIOD:
+        case CONFIG_LIGHT_PERIOD: {
+            if((0 == value) || (CONFIG_PERIOD_MAX < value)) {
+                return CONFIG_INVALID;
+            }
+            if(CONFIG_PWR_PERIOD == param) {
+                c->pwr_period = (uint8_t)value;
+            } else if(CONFIG_TEMP_PERIOD == param) {
+                c->temp_period = (uint8_t)value;
+            } else {
+                c->light_period = (uint8_t)value;
+            }
+            break;
+        }
+        case CONFIG_PWR_DEADBAND: {
+            c->pwr_deadband = value;
+            break;
+        }
+        case CONFIG_TEMP_DEADBAND: {
+            c->temp_deadband = value;
+            break;
+        }
+        case CONFIG_LIGHT_DEADBAND: {
+            c->light_deadband = value;
+            break;
+        }
+        case CONFIG_HEARTBEAT: {
+            if((0 == value) || (CONFIG_HEARTBEAT_MAX < value)) {
+                return CONFIG_INVALID;
+            }
+            c->heartbeat = (uint8_t)value;
+            break;
+        }
+        case CONFIG_GROUPS: {
+            if((1 << MAX_GROUPS) <= value) {
+                return CONFIG_INVALID;
+            }
+            c->groups = value;
+            break;
+        }
+        default:
+            return CONFIG_INVALID;
+    }
+    return CONFIG_OK;
+}
+
+// config_get - get a single parameter (0 for unknown parameters)
+uint16_t config_get(config_t *c, uint8_t param) {
+    switch(param) {
+        case CONFIG_PWR_PERIOD:
+            return c->pwr_period;
+        case CONFIG_TEMP_PERIOD:
+            return c->temp_period;
+        case CONFIG_LIGHT_PERIOD:
+            return c->light_period;
+        case CONFIG_PWR_DEADBAND:
+            return c->pwr_deadband;
+        case CONFIG_TEMP_DEADBAND:
+            return c->temp_deadband;
+        case CONFIG_LIGHT_DEADBAND:
+            return c->light_deadband;
+        case CONFIG_HEARTBEAT:
+            return c->heartbeat;
+        case CONFIG_GROUPS:
+            return c->groups;
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,20 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * config.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __config_h
+#define __config_h
+
+#include <type_defs.h>
+
+void config_defaults(config_t *c);
+int8_t config_load(config_t *c);
+void config_save(config_t *c);
+uint8_t config_set(config_t *c, uint8_t param, uint16_t value);
+uint16_t config_get(config_t *c, uint8_t param);
+
+#endif
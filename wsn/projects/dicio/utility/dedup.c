@@ -0,0 +1,44 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * dedup.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <dedup.h>
+
+// dedup_init - clear the duplicate cache
+void dedup_init(dedup_t *d) {
+    d->size = 0;
+}
+
+// dedup_seen - returns TRUE if (source_id, seq_num) is already in the cache.
+//  either way the pair ends up at the front (most recently seen) of the cache.
+uint8_t dedup_seen(dedup_t *d, uint8_t source_id, uint16_t seq_num) {
+    uint8_t found = FALSE;
+    uint8_t i;
+
+    // find the pair, or fall off the end (the LRU slot when full)
+    for(i = 0; i < d->size; i++) {
+        if((source_id == d->source_id[i]) && (seq_num == d->seq_num[i])) {
+            found = TRUE;
+            break;
+        }
+    }
+    if((FALSE == found) && (DEDUP_CACHE_SIZE > d->size)) {
+        d->size++;
+    }
+    if(DEDUP_CACHE_SIZE <= i) {
+        i = DEDUP_CACHE_SIZE - 1;
+    }
+
+    // move everything in front of slot i back one, then put the pair in front
+    for(; i > 0; i--) {
+        d->source_id[i] = d->source_id[i - 1];
+        d->seq_num[i] = d->seq_num[i - 1];
+    }
+    d->source_id[0] = source_id;
+    d->seq_num[0] = seq_num;
+    return found;
+}
@@ -0,0 +1,17 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * dedup.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __dedup_h
+#define __dedup_h
+
+#include <type_defs.h>
+
+void dedup_init(dedup_t *d);
+uint8_t dedup_seen(dedup_t *d, uint8_t source_id, uint16_t seq_num);
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * ota.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <ota.h>
+#include <ota_flash.h>
+
+// ota_crc_byte - add byte to a CRC-16/CCITT
+uint16_t ota_crc_byte(uint16_t crc, uint8_t byte) {
+    crc ^= (uint16_t)byte << 8;
+    for(uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? ((crc << 1) ^ OTA_CRC_POLY) : (crc << 1);
+    }
+    return crc;
+}
+
+// ota_window_mask - one bit for each chunk in window (the last is short)
+static uint16_t ota_window_mask(ota_t *o, uint8_t window) {
+    uint16_t left;
+    uint8_t chunks;
+
+    if(o->windows <= window) {
+        return 0;
+    }
+    left = o->size - ((uint16_t)window * OTA_WINDOW_SIZE);
+    if(OTA_WINDOW_SIZE <= left) {
+        chunks = OTA_WINDOW_CHUNKS;
+    } else {
+        chunks = (left + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+    }
+    return (uint16_t)((1UL << chunks) - 1);
+}
+
+// ota_clear_slot - empty the slot window will be held in
+static void ota_clear_slot(ota_t *o, uint8_t window) {
+    uint8_t s = window % OTA_WINDOWS_HELD;
+    o->have[s] = 0;
+    for(uint16_t i = 0; i < OTA_WINDOW_SIZE; i++) {
+        o->buf[s][i] = 0xFF;
+    }
+}
+
+// ota_restart - start receiving the image from its first window
+static void ota_restart(ota_t *o) {
+    o->state = OTA_STATE_RECEIVING;
+    o->window = 0;
+    o->crc_run = OTA_CRC_INIT;
+    for(uint8_t w = 0; w < OTA_WINDOWS_HELD; w++) {
+        ota_clear_slot(o, w);
+    }
+}
+
+// ota_complete - the oldest window is complete. add what was written to
+//  flash to the running CRC and move on to the next window.
+static void ota_complete(ota_t *o) {
+    uint16_t offset = (uint16_t)o->window * OTA_WINDOW_SIZE;
+    uint16_t end = offset + OTA_WINDOW_SIZE;
+
+    if(o->size < end) {
+        end = o->size;
+    }
+    for(; offset < end; offset++) {
+        o->crc_run = ota_crc_byte(o->crc_run, ota_flash_read_byte(offset));
+    }
+    ota_clear_slot(o, o->window);
+    o->window++;
+}
+
+// ota_report - fill in a MSG_OTA_REPORT payload. returns status.
+static uint8_t ota_report(ota_t *o, uint8_t status, uint8_t *report) {
+    uint16_t missing = 0;
+    uint16_t next = 0;
+
+    if(OTA_STATE_RECEIVING == o->state) {
+        missing = ota_window_mask(o, o->window) & ~o->have[o->window % OTA_WINDOWS_HELD];
+        next = ota_window_mask(o, o->window + 1) & ~o->have[(o->window + 1) % OTA_WINDOWS_HELD];
+    }
+    report[OTA_IMAGE_INDEX] = o->image_id;
+    report[OTAR_STATUS_INDEX] = status;
+    report[OTAR_WINDOW_INDEX] = o->window;
+    report[OTAR_MISSING_INDEX] = (missing >> 8) & 0xFF;
+    report[OTAR_MISSING_INDEX + 1] = missing & 0xFF;
+    report[OTAR_NEXT_INDEX] = (next >> 8) & 0xFF;
+    report[OTAR_NEXT_INDEX + 1] = next & 0xFF;
+    return status;
+}
+
+// ota_state_report - report the state of the current image
+static uint8_t ota_state_report(ota_t *o, uint8_t *report) {
+    switch(o->state) {
+        case OTA_STATE_VERIFIED:
+            return ota_report(o, OTA_STATUS_VERIFIED, report);
+        case OTA_STATE_REJECTED:
+            return ota_report(o, OTA_STATUS_REJECTED, report);
+        case OTA_STATE_INSTALLED:
+            return ota_report(o, OTA_STATUS_INSTALLED, report);
+        default:
+            return ota_report(o, OTA_STATUS_RECEIVING, report);
+    }
+}
+
+// ota_init - no update in progress. the image installed over the air, if
+//  any, is remembered so a repeated update of it is answered as installed.
+void ota_init(ota_t *o) {
+    o->state = OTA_STATE_IDLE;
+    o->image_id = 0;
+    o->size = 0;
+    o->windows = 0;
+    if(TRUE == ota_flash_installed(&o->image_id)) {
+        o->state = OTA_STATE_INSTALLED;
+    }
+}
+
+// ota_begin - an update of a size byte image is starting. a BEGIN for the
+//  image already being received (it is repeated) keeps what has arrived.
+void ota_begin(ota_t *o, uint8_t image_id, uint16_t size, uint16_t crc) {
+    if(image_id == o->image_id) {
+        if(OTA_STATE_INSTALLED == o->state) {
+            return;
+        }
+        if((OTA_STATE_IDLE != o->state) && (size == o->size) && (crc == o->crc)) {
+            return;
+        }
+    }
+    o->image_id = image_id;
+    o->size = size;
+    o->crc = crc;
+    if((0 == size) || (OTA_BANK_SIZE < size)) {
+        o->state = OTA_STATE_REJECTED;
+        o->windows = 0;
+        return;
+    }
+    o->windows = (size + OTA_WINDOW_SIZE - 1) / OTA_WINDOW_SIZE;
+    ota_restart(o);
+}
+
+// ota_chunk - chunk of window arrived. each flash page is written as soon as
+//  all of its chunks are in, and each window is checked once it is complete.
+//  chunks of windows that aren't held are dropped, the server resends them.
+void ota_chunk(ota_t *o, uint8_t image_id, uint8_t window, uint8_t chunk, uint8_t *data) {
+    uint8_t s = window % OTA_WINDOWS_HELD;
+    uint16_t mask, bit, page_mask;
+    uint8_t page;
+
+    if((OTA_STATE_RECEIVING != o->state) || (image_id != o->image_id) ||
+        ((uint8_t)(window - o->window) >= OTA_WINDOWS_HELD)) {
+        return;
+    }
+    mask = ota_window_mask(o, window);
+    bit = (OTA_WINDOW_CHUNKS > chunk) ? (1U << chunk) : 0;
+    if((0 == (mask & bit)) || (0 != (o->have[s] & bit))) {
+        return;
+    }
+    for(uint8_t i = 0; i < OTA_CHUNK_SIZE; i++) {
+        o->buf[s][(chunk * OTA_CHUNK_SIZE) + i] = data[i];
+    }
+    o->have[s] |= bit;
+
+    page = chunk / OTA_PAGE_CHUNKS;
+    page_mask = mask & (((1U << OTA_PAGE_CHUNKS) - 1) << (page * OTA_PAGE_CHUNKS));
+    if(page_mask == (o->have[s] & page_mask)) {
+        ota_flash_write_page(((uint16_t)window * OTA_WINDOW_SIZE) + (page * OTA_PAGE_SIZE),
+            &o->buf[s][page * OTA_PAGE_SIZE]);
+    }
+
+    // the window after the oldest may have been completed first
+    while((o->window < o->windows) &&
+        (ota_window_mask(o, o->window) == o->have[o->window % OTA_WINDOWS_HELD])) {
+        ota_complete(o);
+    }
+}
+
+// ota_poll - fill in the report on image_id. returns the status reported,
+//  OTA_NO_REPORT if this node isn't taking part in that update.
+uint8_t ota_poll(ota_t *o, uint8_t image_id, uint8_t *report) {
+    if((OTA_STATE_IDLE == o->state) || (image_id != o->image_id)) {
+        return OTA_NO_REPORT;
+    }
+    return ota_state_report(o, report);
+}
+
+// ota_end - the server sent every window of image_id. a complete image is
+//  checked against its CRC; one that fails is received again from the start.
+//  OTA_ACTIVATE is answered with OTA_STATUS_ACTIVATING once the image is
+//  verified, the caller then installs it. returns the status reported,
+//  OTA_NO_REPORT if this node isn't taking part in that update.
+uint8_t ota_end(ota_t *o, uint8_t image_id, uint8_t action, uint8_t *report) {
+    if((OTA_STATE_IDLE == o->state) || (image_id != o->image_id)) {
+        return OTA_NO_REPORT;
+    }
+    if((OTA_STATE_RECEIVING == o->state) && (o->windows == o->window)) {
+        if(o->crc != o->crc_run) {
+            ota_restart(o);
+            return ota_report(o, OTA_STATUS_BAD_CRC, report);
+        }
+        o->state = OTA_STATE_VERIFIED;
+    }
+    if((OTA_STATE_VERIFIED == o->state) && (OTA_ACTIVATE == action)) {
+        return ota_report(o, OTA_STATUS_ACTIVATING, report);
+    }
+    return ota_state_report(o, report);
+}
@@ -0,0 +1,21 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * ota.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __ota_h
+#define __ota_h
+
+#include <type_defs.h>
+
+void ota_init(ota_t *o);
+void ota_begin(ota_t *o, uint8_t image_id, uint16_t size, uint16_t crc);
+void ota_chunk(ota_t *o, uint8_t image_id, uint8_t window, uint8_t chunk, uint8_t *data);
+uint8_t ota_poll(ota_t *o, uint8_t image_id, uint8_t *report);
+uint8_t ota_end(ota_t *o, uint8_t image_id, uint8_t action, uint8_t *report);
+uint16_t ota_crc_byte(uint16_t crc, uint8_t byte);
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * ota_flash.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <ota_flash.h>
+#include <nrk_eeprom.h>
+#include <avr/wdt.h>
+#ifndef NRK_POSIX
+#include <avr/boot.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#endif
+
+#if (OTA_BANK_ADDR < OTA_BANK_SIZE) || ((OTA_BANK_ADDR % OTA_PAGE_SIZE) != 0) || (OTA_WINDOW_CHUNKS > 16)
+#error "the OTA bank must be page aligned and clear of the application, and a window at most 16 chunks"
+#endif
+
+#ifdef NRK_POSIX
+// the simulated bank. the copy can't replace the running program, so an
+//  activation only records the image and reboots.
+static uint8_t ota_bank[OTA_BANK_SIZE];
+
+// ota_flash_write_page - write the page at offset in the spare bank
+void ota_flash_write_page(uint16_t offset, uint8_t *buf) {
+    for(uint16_t i = 0; i < OTA_PAGE_SIZE; i++) {
+        ota_bank[offset + i] = buf[i];
+    }
+}
+
+// ota_flash_read_byte - read the byte at offset in the spare bank
+uint8_t ota_flash_read_byte(uint16_t offset) {
+    return ota_bank[offset];
+}
+
+// ota_flash_copy - install the image in the spare bank and reset
+static void ota_flash_copy(uint16_t size) {
+    wdt_enable(WDTO_15MS);
+    while(1);
+}
+#else
+// the SPM instructions only run from the boot section, and the copy has to
+//  keep running once the application under it has been overwritten, so
+//  neither may call into the application (see phoenix's bootloader.c)
+static void ota_flash_page(uint32_t addr, uint8_t *buf) BOOTLOADER_SECTION;
+static void ota_flash_copy(uint16_t size) BOOTLOADER_SECTION __attribute__((noreturn));
+
+// ota_flash_page - erase and write the flash page at addr
+static void ota_flash_page(uint32_t addr, uint8_t *buf) {
+    uint8_t sreg = SREG;
+    uint16_t word;
+
+    cli();
+    eeprom_busy_wait();
+    boot_page_erase(addr);
+    boot_spm_busy_wait();
+    for(uint16_t i = 0; i < OTA_PAGE_SIZE; i += 2) {
+        word = buf[i] | ((uint16_t)buf[i + 1] << 8);
+        boot_page_fill(addr + i, word);
+    }
+    boot_page_write(addr);
+    boot_spm_busy_wait();
+    boot_rww_enable();
+    SREG = sreg;
+}
+
+// ota_flash_copy - copy the first size bytes of the spare bank over the
+//  application and reset into it. interrupts stay off, nothing of the old
+//  application may run again.
+static void ota_flash_copy(uint16_t size) {
+    uint8_t page[OTA_PAGE_SIZE];
+    uint32_t addr;
+
+    cli();
+    for(addr = 0; addr < size; addr += OTA_PAGE_SIZE) {
+        wdt_reset();
+        for(uint16_t i = 0; i < OTA_PAGE_SIZE; i++) {
+            page[i] = pgm_read_byte_far(OTA_BANK_ADDR + addr + i);
+        }
+        ota_flash_page(OTA_APP_ADDR + addr, page);
+    }
+    wdt_enable(WDTO_15MS);
+    while(1);
+}
+
+// ota_flash_write_page - write the page at offset in the spare bank
+void ota_flash_write_page(uint16_t offset, uint8_t *buf) {
+    ota_flash_page((uint32_t)OTA_BANK_ADDR + offset, buf);
+}
+
+// ota_flash_read_byte - read the byte at offset in the spare bank
+uint8_t ota_flash_read_byte(uint16_t offset) {
+    return pgm_read_byte_far((uint32_t)OTA_BANK_ADDR + offset);
+}
+#endif
+
+// ota_flash_activate - record image_id as pending and install the size byte
+//  image in the spare bank. does not return.
+void ota_flash_activate(uint8_t image_id, uint16_t size) {
+    nrk_eeprom_write_byte(OTA_EE_ADDR + OTA_EE_IMAGE_INDEX, image_id);
+    nrk_eeprom_write_byte(OTA_EE_ADDR + OTA_EE_STATE_INDEX, OTA_EE_PENDING);
+    nrk_eeprom_write_byte(OTA_EE_ADDR + OTA_EE_MAGIC_INDEX, OTA_EE_MAGIC);
+    ota_flash_copy(size);
+}
+
+// ota_flash_installed - get the id of the image installed over the air. the
+//  first boot after the copy marks it installed. returns FALSE if the
+//  running image was not installed over the air.
+uint8_t ota_flash_installed(uint8_t *image_id) {
+    if(OTA_EE_MAGIC != nrk_eeprom_read_byte(OTA_EE_ADDR + OTA_EE_MAGIC_INDEX)) {
+        return FALSE;
+    }
+    if(OTA_EE_PENDING == nrk_eeprom_read_byte(OTA_EE_ADDR + OTA_EE_STATE_INDEX)) {
+        nrk_eeprom_write_byte(OTA_EE_ADDR + OTA_EE_STATE_INDEX, OTA_EE_INSTALLED);
+    }
+    *image_id = nrk_eeprom_read_byte(OTA_EE_ADDR + OTA_EE_IMAGE_INDEX);
+    return TRUE;
+}
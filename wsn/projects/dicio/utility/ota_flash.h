@@ -0,0 +1,19 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * ota_flash.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __ota_flash_h
+#define __ota_flash_h
+
+#include <type_defs.h>
+
+void ota_flash_write_page(uint16_t offset, uint8_t *buf);
+uint8_t ota_flash_read_byte(uint16_t offset);
+void ota_flash_activate(uint8_t image_id, uint16_t size);
+uint8_t ota_flash_installed(uint8_t *image_id);
+
+#endif
@@ -30,7 +30,7 @@ void push(packet_queue *pq, packet *p) {
 		pq->buffer[pq->back].num_hops = p->num_hops;
 
 		// copy the payload
-		for(uint8_t i = 0; i < MAX_PACKET_BUFFER; i++) {
+		for(uint8_t i = 0; i < MAX_PAYLOAD_SIZE; i++) {
 			pq->buffer[pq->back].payload[i]	= p->payload[i];
 		}
 
@@ -55,7 +55,7 @@ void pop(packet_queue *pq, packet *p) {
 		p->num_hops = pq->buffer[pq->front].num_hops;
 
 		// copy the payload
-		for(uint8_t i = 0; i < MAX_PACKET_BUFFER; i++) {
+		for(uint8_t i = 0; i < MAX_PAYLOAD_SIZE; i++) {
 			p->payload[i] = pq->buffer[pq->front].payload[i];
 		}
 
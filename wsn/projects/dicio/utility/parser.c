@@ -27,8 +27,10 @@ void print_packet(packet *p)
         }
         case MSG_LOST:
         {
-            printf("[%d]\r\n", 
-                        payload[LOST_NODE_INDEX]);
+            for(uint8_t i = 0; (i < payload[LOST_COUNT_INDEX]) && (i < MAX_LOST_BATCH); i++) {
+                printf("[%d]", payload[LOST_NODE_INDEX + i]);
+            }
+            printf("\r\n");
             break;
         }
 
@@ -42,9 +44,14 @@ void print_packet(packet *p)
             uint16_t data_pwr = ((payload[DATA_PWR_INDEX] << 8) | (payload[DATA_PWR_INDEX + 1]));
             uint16_t data_temp = ((payload[DATA_TEMP_INDEX] << 8) | (payload[DATA_TEMP_INDEX + 1]));
             uint16_t data_light = ((payload[DATA_LIGHT_INDEX] << 8) | (payload[DATA_LIGHT_INDEX + 1]));
-            printf("[%d, %d, %d, %d]\r\n",
+            printf("[%d, %d, %d, %d, %d]\r\n",
                         data_pwr, data_temp, data_light, 
-                        payload[DATA_STATE_INDEX]);
+                        payload[DATA_STATE_INDEX], payload[DATA_AGE_INDEX]);
+            break;
+        }
+        case MSG_DATA_BATCH:
+        {
+            printf("[BATCH]\r\n");
             break;
         }
         case MSG_CMD:
@@ -53,12 +60,21 @@ void print_packet(packet *p)
             printf("[%d, %d, %d\r\n]", cmd_id, payload[2], payload[3]);
             break;
         }
+        case MSG_CMD_GROUP:
+        {
+            uint16_t cmd_id = ((payload[CMDG_CMDID_INDEX] << 8) | (payload[CMDG_CMDID_INDEX + 1]));
+            printf("[%u, G%d, %d]\r\n", cmd_id, payload[CMDG_GROUP_INDEX], payload[CMDG_ACTION_INDEX]);
+            break;
+        }
         case MSG_CMDACK:
         {
             uint16_t cmd_id = ((payload[CMDACK_CMDID_INDEX] << 8) | (payload[CMDACK_CMDID_INDEX + 1]));
-            printf("[%d, %d]\r\n", 
+            uint16_t rx_act = ((payload[CMDACK_RX_ACT_INDEX] << 8) | (payload[CMDACK_RX_ACT_INDEX + 1]));
+            uint16_t act_ack = ((payload[CMDACK_ACT_ACK_INDEX] << 8) | (payload[CMDACK_ACT_ACK_INDEX + 1]));
+            printf("[%d, %d, %ums, %ums]\r\n", 
                         cmd_id, 
-                        payload[CMDACK_STATE_INDEX]);
+                        payload[CMDACK_STATE_INDEX],
+                        rx_act, act_ack);
             break;
         }
         case MSG_HAND:
@@ -81,98 +97,237 @@ void print_packet(packet *p)
             break;
         }
         case MSG_HEARTBEAT: {
-            printf("\r\n"); 
+            uint16_t cost = ((payload[HEART_COST_INDEX] << 8) | (payload[HEART_COST_INDEX + 1]));
+            printf("[%d, %u]\r\n", payload[HEART_RELAY_INDEX], cost);
             break;
         }
-        default:{
+        case MSG_ENERGY:
+        {
+            uint32_t energy_ws = ((uint32_t)payload[ENERGY_WS_INDEX] << 24) |
+                ((uint32_t)payload[ENERGY_WS_INDEX + 1] << 16) |
+                ((uint32_t)payload[ENERGY_WS_INDEX + 2] << 8) |
+                (uint32_t)payload[ENERGY_WS_INDEX + 3];
+            uint16_t pwr_min = ((payload[ENERGY_PWR_MIN_INDEX] << 8) | (payload[ENERGY_PWR_MIN_INDEX + 1]));
+            uint16_t pwr_max = ((payload[ENERGY_PWR_MAX_INDEX] << 8) | (payload[ENERGY_PWR_MAX_INDEX + 1]));
+            printf("[%lu, %u, %u]\r\n", (unsigned long)energy_ws, pwr_min, pwr_max);
             break;
         }
-    }
-}
-
-// parse message - parse message src into parsed_packet
-void parse_msg(packet *parsed_packet, uint8_t *src, uint8_t len)
-{
-    parsed_packet->source_id = src[HEADER_SRC_ID_INDEX];
-    parsed_packet->seq_num = (src[HEADER_SEQ_NUM_INDEX] << 8) | (src[HEADER_SEQ_NUM_INDEX + 1]);
-    parsed_packet->type = src[HEADER_TYPE_INDEX];
-    parsed_packet->num_hops = src[HEADER_NUM_HOPS_INDEX];
-    volatile msg_type type = parsed_packet->type;
-    switch(type)
-    {
-        case MSG_NO_MESSAGE: 
+        case MSG_CONFIG:
         {
-            // undefined message - should throw an error
+            uint16_t cmd_id = ((payload[CONFIG_CMDID_INDEX] << 8) | (payload[CONFIG_CMDID_INDEX + 1]));
+            uint16_t value = ((payload[CONFIG_VALUE_INDEX] << 8) | (payload[CONFIG_VALUE_INDEX + 1]));
+            printf("[%u, %d, %d, %u]\r\n", cmd_id,
+                        payload[CONFIG_NODE_ID_INDEX],
+                        payload[CONFIG_PARAM_INDEX], value);
             break;
         }
-        case MSG_LOST:
+        case MSG_CONFIGACK:
         {
-            parsed_packet->payload[LOST_NODE_INDEX] = src[HEADER_SIZE];
+            uint16_t cmd_id = ((payload[CONFIGACK_CMDID_INDEX] << 8) | (payload[CONFIGACK_CMDID_INDEX + 1]));
+            uint16_t value = ((payload[CONFIGACK_VALUE_INDEX] << 8) | (payload[CONFIGACK_VALUE_INDEX + 1]));
+            printf("[%u, %d, %u, %d]\r\n", cmd_id,
+                        payload[CONFIGACK_PARAM_INDEX], value,
+                        payload[CONFIGACK_STATUS_INDEX]);
             break;
         }
-        case MSG_GATEWAY:
+        case MSG_SYNC:
         {
-            // undefined message
+            printf("[%d]\r\n", payload[SYNC_ID_INDEX] & SERV_7BIT_MASK);
             break;
         }
-        case MSG_DATA:
+        case MSG_OTA_BEGIN:
         {
-            parsed_packet->payload[DATA_PWR_INDEX] = src[HEADER_SIZE];
-            parsed_packet->payload[DATA_PWR_INDEX+1] = src[HEADER_SIZE + 1];
-            parsed_packet->payload[DATA_TEMP_INDEX] = src[HEADER_SIZE + 2];
-            parsed_packet->payload[DATA_TEMP_INDEX+1] = src[HEADER_SIZE + 3];
-            parsed_packet->payload[DATA_LIGHT_INDEX] = src[HEADER_SIZE + 4];
-            parsed_packet->payload[DATA_LIGHT_INDEX+1] = src[HEADER_SIZE + 5];
-            parsed_packet->payload[DATA_STATE_INDEX]   = src[HEADER_SIZE + 6];
+            uint16_t size = ((payload[OTAB_SIZE_INDEX] << 8) | (payload[OTAB_SIZE_INDEX + 1]));
+            uint16_t crc = ((payload[OTAB_CRC_INDEX] << 8) | (payload[OTAB_CRC_INDEX + 1]));
+            printf("[%d, G%d, %u, %04x]\r\n", payload[OTA_IMAGE_INDEX], payload[OTAB_GROUP_INDEX], size, crc);
             break;
         }
-        case MSG_CMD:
+        case MSG_OTA_DATA:
         {
-            parsed_packet->payload[CMD_CMDID_INDEX] = src[HEADER_SIZE];
-            parsed_packet->payload[CMD_CMDID_INDEX+1] = src[HEADER_SIZE + 1];
-            parsed_packet->payload[CMD_NODE_ID_INDEX] = src[HEADER_SIZE + 2];
-            parsed_packet->payload[CMD_ACT_INDEX] = src[HEADER_SIZE + 3];
+            printf("[%d, %d, %d]\r\n", payload[OTA_IMAGE_INDEX], payload[OTAD_WINDOW_INDEX], payload[OTAD_CHUNK_INDEX]);
             break;
         }
-        case MSG_CMDACK:
+        case MSG_OTA_POLL:
         {
-            parsed_packet->payload[CMDACK_CMDID_INDEX] = src[HEADER_SIZE];
-            parsed_packet->payload[CMDACK_CMDID_INDEX+1] = src[HEADER_SIZE + 1];
-            parsed_packet->payload[CMDACK_STATE_INDEX] = src[HEADER_SIZE + 2];
+            printf("[%d]\r\n", payload[OTA_IMAGE_INDEX]);
             break;
         }
-
-        case MSG_HAND:
+        case MSG_OTA_END:
         {
-            parsed_packet->payload[HAND_CONFIG_ID_INDEX] = src[HEADER_SIZE];
-            parsed_packet->payload[HAND_CONFIG_ID_INDEX+1] = src[HEADER_SIZE + 1];
-            parsed_packet->payload[HAND_CONFIG_ID_INDEX+2] = src[HEADER_SIZE + 2];
-            parsed_packet->payload[HAND_CONFIG_ID_INDEX+3] = src[HEADER_SIZE + 3];
+            printf("[%d, %d]\r\n", payload[OTA_IMAGE_INDEX], payload[OTAE_ACTION_INDEX]);
             break;
         }
-
-        case MSG_HANDACK:
+        case MSG_OTA_REPORT:
         {
-            parsed_packet->payload[HANDACK_NODE_ID_INDEX] = src[HEADER_SIZE];
-            parsed_packet->payload[HANDACK_CONFIG_ID_INDEX] = src[HEADER_SIZE + 1];
-            parsed_packet->payload[HANDACK_CONFIG_ID_INDEX+1] = src[HEADER_SIZE + 2];
-            parsed_packet->payload[HANDACK_CONFIG_ID_INDEX+2] = src[HEADER_SIZE + 3];
-            parsed_packet->payload[HANDACK_CONFIG_ID_INDEX+3] = src[HEADER_SIZE + 4];
+            uint16_t missing = ((payload[OTAR_MISSING_INDEX] << 8) | (payload[OTAR_MISSING_INDEX + 1]));
+            uint16_t next = ((payload[OTAR_NEXT_INDEX] << 8) | (payload[OTAR_NEXT_INDEX + 1]));
+            printf("[%d, %d, %d, %04x, %04x]\r\n", payload[OTA_IMAGE_INDEX], payload[OTAR_STATUS_INDEX],
+                        payload[OTAR_WINDOW_INDEX], missing, next);
             break;
         }
-
-        case MSG_HEARTBEAT:
-        {
+        default:{
             break;
         }
+    }
+}
 
-        case MSG_RESET:
-        {
-            break;
+// get_varint - read an unsigned varint at src[*index], stopping at len.
+//  returns FALSE if the varint runs past the end of the message.
+static uint8_t get_varint(uint8_t *src, uint8_t len, uint8_t *index, uint16_t *val)
+{
+    uint8_t shift = 0;
+    uint8_t byte;
+    *val = 0;
+    do {
+        if((*index >= len) || (16 <= shift)) {
+            return FALSE;
         }
+        byte = src[*index];
+        (*index)++;
+        *val |= (uint16_t)(byte & VARINT_MASK) << shift;
+        shift += VARINT_SHIFT;
+    } while(byte & VARINT_MORE);
+    return TRUE;
+}
 
-        default:{
-            printf("invalid msg_type \r\n");
+// get_delta - read a zigzag encoded delta and apply it to val
+static uint8_t get_delta(uint8_t *src, uint8_t len, uint8_t *index, uint16_t *val)
+{
+    uint16_t zz;
+    if(FALSE == get_varint(src, len, index, &zz)) {
+        return FALSE;
+    }
+    *val += (uint16_t)((zz >> 1) ^ (-(zz & 1)));
+    return TRUE;
+}
+
+// parse_batch - expand a MSG_DATA_BATCH message (src is the whole message)
+//  into sets, oldest first. returns the number of sets or -1 if malformed.
+int8_t parse_batch(uint8_t *src, uint8_t len, sample_set_t *sets, uint8_t max_sets)
+{
+    uint8_t *payload = &src[HEADER_SIZE];
+    uint8_t payload_len;
+    uint8_t count, period, index;
+    uint16_t gap, age;
+    uint16_t pwr = 0, temp = 0, light = 0;
+    int8_t i;
+
+    if((HEADER_SIZE + BATCH_SETS_INDEX) > len) {
+        return -1;
+    }
+    payload_len = len - HEADER_SIZE;
+    count = payload[BATCH_COUNT_INDEX];
+    period = payload[BATCH_PERIOD_INDEX];
+    if((0 == count) || (max_sets < count) || (0 == period)) {
+        return -1;
+    }
+
+    // decode the sets, keeping each set's gap (in sample periods) in age
+    index = BATCH_SETS_INDEX;
+    for(i = 0; i < count; i++) {
+        if((FALSE == get_varint(payload, payload_len, &index, &gap)) ||
+            (FALSE == get_delta(payload, payload_len, &index, &pwr)) ||
+            (FALSE == get_delta(payload, payload_len, &index, &temp)) ||
+            (FALSE == get_delta(payload, payload_len, &index, &light))) {
+            return -1;
         }
+        sets[i].pwr = pwr;
+        sets[i].temp = temp;
+        sets[i].light = light;
+        sets[i].state = (payload[BATCH_STATE_INDEX] & (1 << i)) ? ON : OFF;
+        sets[i].age = (0xFF < gap) ? 0xFF : (uint8_t)gap;
+    }
+
+    // walk back from the newest set to turn gaps into ages in seconds
+    age = payload[BATCH_AGE_INDEX];
+    for(i = count - 1; i >= 0; i--) {
+        gap = sets[i].age;
+        sets[i].age = ((0xFF / period) < age) ? 0xFF : (uint8_t)(age * period);
+        age += gap;
+    }
+    return count;
+}
+
+// msg_payload_len - payload bytes every message of each type carries (see
+//  assemble_packet), 0 for types that are never received. longer messages
+//  are accepted: server frames keep their line ending and batches vary.
+static const uint8_t msg_payload_len[MSG_TYPE_MAX + 1] PROGMEM = {
+    [MSG_LOST] = LOST_NODE_INDEX + 1,
+    [MSG_RESET] = HEART_COST_INDEX + 2,
+    [MSG_DATA] = DATA_STATE_INDEX + 1,
+    [MSG_CMD] = CMD_ACT_INDEX + 1,
+    [MSG_CMDACK] = CMDACK_ACT_ACK_INDEX + 2,
+    [MSG_HAND] = HAND_CONFIG_ID_INDEX + 4,
+    [MSG_HANDACK] = HANDACK_CONFIG_ID_INDEX + 4,
+    [MSG_HEARTBEAT] = HEART_COST_INDEX + 2,
+    [MSG_ENERGY] = ENERGY_PWR_MAX_INDEX + 2,
+    [MSG_CONFIG] = CONFIG_VALUE_INDEX + 2,
+    [MSG_CONFIGACK] = CONFIGACK_STATUS_INDEX + 1,
+    [MSG_DATA_BATCH] = BATCH_SETS_INDEX,
+    [MSG_CMD_GROUP] = CMDG_ACTION_INDEX + 1,
+    [MSG_SYNC] = SYNC_ID_INDEX + 1,
+    [MSG_OTA_BEGIN] = OTAB_CRC_INDEX + 2,
+    [MSG_OTA_DATA] = OTAD_DATA_INDEX + OTA_CHUNK_SIZE,
+    [MSG_OTA_POLL] = OTA_IMAGE_INDEX + 1,
+    [MSG_OTA_END] = OTAE_ACTION_INDEX + 1,
+    [MSG_OTA_REPORT] = OTAR_NEXT_INDEX + 2,
+};
+
+// msg_view_init - check message src against the layout of its type and point
+//  view at it. returns FALSE if the type is unknown or src is too short.
+uint8_t msg_view_init(msg_view_t *view, uint8_t *src, uint8_t len)
+{
+    uint8_t type, payload_len;
+
+    if(HEADER_SIZE > len) {
+        return FALSE;
+    }
+    type = src[HEADER_TYPE_INDEX];
+    if(MSG_TYPE_MAX < type) {
+        return FALSE;
+    }
+    payload_len = pgm_read_byte(&msg_payload_len[type]);
+    if((0 == payload_len) || ((HEADER_SIZE + payload_len) > len)) {
+        return FALSE;
+    }
+    view->buf = src;
+    view->len = len;
+    return TRUE;
+}
+
+// msg_view_copy - copy a viewed message into dest, for the paths that queue
+//  it. payload bytes past the type's layout (local fields such as the
+//  latency trace) are cleared.
+void msg_view_copy(packet *dest, msg_view_t *view)
+{
+    uint8_t i;
+    uint8_t payload_len = pgm_read_byte(&msg_payload_len[msg_type_of(view)]);
+
+    dest->source_id = msg_source_id(view);
+    dest->seq_num = msg_seq_num(view);
+    dest->type = msg_type_of(view);
+    dest->num_hops = msg_num_hops(view);
+    if(MAX_PAYLOAD_SIZE < payload_len) {
+        payload_len = MAX_PAYLOAD_SIZE;
+    }
+    for(i = 0; i < payload_len; i++) {
+        dest->payload[i] = view->buf[HEADER_SIZE + i];
+    }
+    for(; i < MAX_PAYLOAD_SIZE; i++) {
+        dest->payload[i] = 0;
+    }
+}
+
+// parse message - parse message src into parsed_packet. returns FALSE (with
+//  the type set to MSG_NO_MESSAGE) if src is not a valid message.
+uint8_t parse_msg(packet *parsed_packet, uint8_t *src, uint8_t len)
+{
+    msg_view_t view;
+
+    if(FALSE == msg_view_init(&view, src, len)) {
+        parsed_packet->type = MSG_NO_MESSAGE;
+        return FALSE;
     }
+    msg_view_copy(parsed_packet, &view);
+    return TRUE;
 }
@@ -13,6 +13,52 @@
 #include <type_defs.h>
 
 void print_packet(packet *p);
-void parse_msg(packet *parsed_packet, uint8_t *src, uint8_t len);
+uint8_t parse_msg(packet *parsed_packet, uint8_t *src, uint8_t len);
+int8_t parse_batch(uint8_t *src, uint8_t len, sample_set_t *sets, uint8_t max_sets);
+uint8_t msg_view_init(msg_view_t *view, uint8_t *src, uint8_t len);
+void msg_view_copy(packet *dest, msg_view_t *view);
+
+// accessors for a view filled in by msg_view_init(). payload indexes are the
+//  *_INDEX values in type_defs.h and must lie inside the message type's layout.
+static inline uint8_t msg_source_id(msg_view_t *view)
+{
+    return view->buf[HEADER_SRC_ID_INDEX];
+}
+
+static inline uint16_t msg_seq_num(msg_view_t *view)
+{
+    return ((uint16_t)view->buf[HEADER_SEQ_NUM_INDEX] << 8) | view->buf[HEADER_SEQ_NUM_INDEX + 1];
+}
+
+static inline msg_type msg_type_of(msg_view_t *view)
+{
+    return (msg_type)view->buf[HEADER_TYPE_INDEX];
+}
+
+static inline uint8_t msg_num_hops(msg_view_t *view)
+{
+    return view->buf[HEADER_NUM_HOPS_INDEX];
+}
+
+static inline uint8_t *msg_payload(msg_view_t *view)
+{
+    return &view->buf[HEADER_SIZE];
+}
+
+static inline uint8_t msg_u8(msg_view_t *view, uint8_t index)
+{
+    return view->buf[HEADER_SIZE + index];
+}
+
+// big-endian, as assemble_packet() writes them
+static inline uint16_t msg_u16(msg_view_t *view, uint8_t index)
+{
+    return ((uint16_t)view->buf[HEADER_SIZE + index] << 8) | view->buf[HEADER_SIZE + index + 1];
+}
+
+static inline uint32_t msg_u32(msg_view_t *view, uint8_t index)
+{
+    return ((uint32_t)msg_u16(view, index) << 16) | msg_u16(view, index + 2);
+}
 
 #endif
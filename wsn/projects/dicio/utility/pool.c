@@ -37,21 +37,6 @@ int8_t inline in_pool(pool_t *pool, uint8_t node_address) {
     return (int8_t)-1;
 }
 
-// decrement_all - decrement every index in the pool
-void inline decrement_all(pool_t *pool) {
-    // initialize
-    uint16_t data_val;
-    uint8_t pool_size = pool->size;
-
-    // loop through all nodes
-    for(uint8_t i = 0; i < pool_size; i++) {
-        data_val = pool->data_vals[i];
-        if(ALIVE_LIMIT < data_val) {
-            pool->data_vals[i] = data_val-1;
-        }
-    }
-}
-
 // get_pool_index - return the index of the node_address in the sequence pool
 int8_t inline get_pool_index(pool_t *pool, uint8_t node_address) {
     // initialize
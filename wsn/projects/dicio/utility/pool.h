@@ -13,7 +13,6 @@
 
 void inline clear_pool(pool_t *pool);
 int8_t inline in_pool(pool_t *pool, uint8_t node_address);
-void inline decrement_all(pool_t *pool);
 int8_t inline get_pool_index(pool_t *pool, uint8_t node_address);
 uint16_t inline get_data_val(pool_t *pool, uint8_t node_address);
 int8_t inline add_to_pool(pool_t *pool, uint8_t node_address, uint16_t data_val);
@@ -0,0 +1,218 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * registry.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <registry.h>
+#include <nrk_eeprom.h>
+
+#if (REGISTRY_EE_SLOTS <= MAX_ALIVE_NODES) || (REGISTRY_EE_SLOTS >= REGISTRY_NONE)
+#error "REGISTRY_EE_SLOTS must be larger than MAX_ALIVE_NODES and smaller than REGISTRY_NONE"
+#endif
+#if (REGISTRY_EE_ADDR + (REGISTRY_EE_SLOTS * REGISTRY_RECORD_SIZE)) > OTA_EE_ADDR
+#error "the registry ring runs into the OTA image record"
+#endif
+
+// registry_addr - EEPROM address of byte index of the record in slot
+static uint16_t registry_addr(uint8_t slot, uint8_t index) {
+    return REGISTRY_EE_ADDR + ((uint16_t)slot * REGISTRY_RECORD_SIZE) + index;
+}
+
+// registry_checksum - checksum of a record (never matches an erased slot)
+static uint8_t registry_checksum(uint8_t *rec) {
+    uint8_t checksum = REGISTRY_EE_MAGIC;
+    for(uint8_t i = 0; i < REGISTRY_CHKSUM_INDEX; i++) {
+        checksum += rec[i];
+    }
+    return checksum;
+}
+
+// registry_read - read the record in slot. returns FALSE if it is erased,
+//  torn or was replaced by a newer record.
+static uint8_t registry_read(uint8_t slot, uint8_t *rec) {
+    for(uint8_t i = 0; i < REGISTRY_RECORD_SIZE; i++) {
+        rec[i] = nrk_eeprom_read_byte(registry_addr(slot, i));
+    }
+    return (registry_checksum(rec) == rec[REGISTRY_CHKSUM_INDEX]) ? TRUE : FALSE;
+}
+
+// registry_kill - mark the record in slot as replaced
+static void registry_kill(uint8_t slot) {
+    uint8_t checksum = nrk_eeprom_read_byte(registry_addr(slot, REGISTRY_CHKSUM_INDEX));
+    nrk_eeprom_write_byte(registry_addr(slot, REGISTRY_CHKSUM_INDEX), ~checksum);
+}
+
+// registry_stamp - the stamp of a record
+static uint16_t registry_stamp(uint8_t *rec) {
+    return ((uint16_t)rec[REGISTRY_STAMP_INDEX] << 8) | rec[REGISTRY_STAMP_INDEX + 1];
+}
+
+// registry_newer - TRUE if stamp a was written after stamp b. only holds while
+//  the two are less than half the stamp range apart, so registry_flush
+//  re-stamps records before they fall REGISTRY_STAMP_REFRESH writes behind.
+static uint8_t registry_newer(uint16_t a, uint16_t b) {
+    uint16_t ahead = a - b;
+    return ((0 < ahead) && (0x8000 > ahead)) ? TRUE : FALSE;
+}
+
+// registry_live - TRUE if slot holds some node's record
+static uint8_t registry_live(registry_t *r, uint8_t slot) {
+    for(uint8_t i = 0; i < r->size; i++) {
+        if(slot == r->slot[i]) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// registry_find - index of node_id, ALIVE_NONE if it isn't in the registry
+static uint8_t registry_find(registry_t *r, uint8_t node_id) {
+    for(uint8_t i = 0; i < r->size; i++) {
+        if(node_id == r->node_id[i]) {
+            return i;
+        }
+    }
+    return ALIVE_NONE;
+}
+
+// registry_write - append node index i's record at the head of the ring,
+//  then retire its old record. a reboot between the two leaves both, and
+//  registry_load keeps the newer one.
+static void registry_write(registry_t *r, uint8_t i) {
+    uint8_t rec[REGISTRY_RECORD_SIZE];
+
+    // skip over the records still in use
+    while(TRUE == registry_live(r, r->head)) {
+        r->head = (r->head + 1) % REGISTRY_EE_SLOTS;
+    }
+
+    r->stamp++;
+    rec[REGISTRY_STAMP_INDEX] = (r->stamp >> 8) & 0xFF;
+    rec[REGISTRY_STAMP_INDEX + 1] = r->stamp & 0xFF;
+    rec[REGISTRY_NODE_INDEX] = r->node_id[i];
+    rec[REGISTRY_CLASS_INDEX] = r->node_class[i];
+    rec[REGISTRY_SEQ_INDEX] = (r->seq_num[i] >> 8) & 0xFF;
+    rec[REGISTRY_SEQ_INDEX + 1] = r->seq_num[i] & 0xFF;
+    rec[REGISTRY_CHKSUM_INDEX] = registry_checksum(rec);
+    for(uint8_t j = 0; j < REGISTRY_RECORD_SIZE; j++) {
+        nrk_eeprom_write_byte(registry_addr(r->head, j), rec[j]);
+    }
+
+    if(REGISTRY_NONE != r->slot[i]) {
+        registry_kill(r->slot[i]);
+    }
+    r->slot[i] = r->head;
+    r->dirty[i] = FALSE;
+    r->written[i] = r->stamp;
+    r->head = (r->head + 1) % REGISTRY_EE_SLOTS;
+}
+
+// registry_load - rebuild the registry from the records in EEPROM. returns the
+//  number of nodes found.
+uint8_t registry_load(registry_t *r) {
+    uint8_t rec[REGISTRY_RECORD_SIZE];
+    uint8_t old[REGISTRY_RECORD_SIZE];
+    uint8_t found = FALSE;
+    uint8_t slot, i;
+
+    r->size = 0;
+    r->head = 0;
+    r->stamp = 0;
+    for(slot = 0; slot < REGISTRY_EE_SLOTS; slot++) {
+        if(FALSE == registry_read(slot, rec)) {
+            continue;
+        }
+
+        // carry on writing after the newest record
+        if((FALSE == found) || (TRUE == registry_newer(registry_stamp(rec), r->stamp))) {
+            found = TRUE;
+            r->stamp = registry_stamp(rec);
+            r->head = (slot + 1) % REGISTRY_EE_SLOTS;
+        }
+
+        // a node with two records was interrupted while being rewritten
+        i = registry_find(r, rec[REGISTRY_NODE_INDEX]);
+        if(ALIVE_NONE != i) {
+            registry_read(r->slot[i], old);
+            if(TRUE == registry_newer(registry_stamp(old), registry_stamp(rec))) {
+                registry_kill(slot);
+                continue;
+            }
+            registry_kill(r->slot[i]);
+        } else if(MAX_ALIVE_NODES > r->size) {
+            i = r->size;
+            r->size++;
+        } else {
+            continue;
+        }
+        r->node_id[i] = rec[REGISTRY_NODE_INDEX];
+        r->node_class[i] = rec[REGISTRY_CLASS_INDEX];
+        r->seq_num[i] = ((uint16_t)rec[REGISTRY_SEQ_INDEX] << 8) | rec[REGISTRY_SEQ_INDEX + 1];
+        r->slot[i] = slot;
+        r->dirty[i] = FALSE;
+        r->written[i] = registry_stamp(rec);
+    }
+    return r->size;
+}
+
+// registry_note - node_id (of node_class) was heard with seq_num. its record
+//  is due for a rewrite if it is new, its class changed, its sequence number
+//  went back (it rebooted) or moved REGISTRY_SEQ_STEP ahead. returns FALSE if
+//  it is new and the registry is full.
+uint8_t registry_note(registry_t *r, uint8_t node_id, uint8_t node_class, uint16_t seq_num) {
+    uint8_t i = registry_find(r, node_id);
+
+    if(ALIVE_NONE == i) {
+        if(MAX_ALIVE_NODES <= r->size) {
+            return FALSE;
+        }
+        i = r->size;
+        r->size++;
+        r->node_id[i] = node_id;
+        r->slot[i] = REGISTRY_NONE;
+    } else if((node_class == r->node_class[i]) &&
+        (REGISTRY_SEQ_STEP > (uint16_t)(seq_num - r->seq_num[i]))) {
+        return TRUE;
+    }
+    r->node_class[i] = node_class;
+    r->seq_num[i] = seq_num;
+    r->dirty[i] = TRUE;
+    return TRUE;
+}
+
+// registry_flush - write one record that is due. EEPROM writes are slow, so
+//  the rest wait for later calls. a record that hasn't changed in
+//  REGISTRY_STAMP_REFRESH writes goes first, so a busy node can't keep its
+//  stamp from being refreshed. returns TRUE if a record was written.
+uint8_t registry_flush(registry_t *r) {
+    uint8_t i;
+
+    for(i = 0; i < r->size; i++) {
+        if((REGISTRY_NONE != r->slot[i]) && (REGISTRY_STAMP_REFRESH <= (uint16_t)(r->stamp - r->written[i]))) {
+            registry_write(r, i);
+            return TRUE;
+        }
+    }
+    for(i = 0; i < r->size; i++) {
+        if(TRUE == r->dirty[i]) {
+            registry_write(r, i);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// registry_entry - get entry i of the registry (0 to MAX_ALIVE_NODES - 1).
+//  returns FALSE if there is no node there.
+uint8_t registry_entry(registry_t *r, uint8_t i, uint8_t *node_id, uint8_t *node_class, uint16_t *seq_num) {
+    if(r->size <= i) {
+        return FALSE;
+    }
+    *node_id = r->node_id[i];
+    *node_class = r->node_class[i];
+    *seq_num = r->seq_num[i];
+    return TRUE;
+}
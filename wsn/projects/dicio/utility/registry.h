@@ -0,0 +1,19 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * registry.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __registry_h
+#define __registry_h
+
+#include <type_defs.h>
+
+uint8_t registry_load(registry_t *r);
+uint8_t registry_note(registry_t *r, uint8_t node_id, uint8_t node_class, uint16_t seq_num);
+uint8_t registry_flush(registry_t *r);
+uint8_t registry_entry(registry_t *r, uint8_t i, uint8_t *node_id, uint8_t *node_class, uint16_t *seq_num);
+
+#endif
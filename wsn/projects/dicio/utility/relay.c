@@ -0,0 +1,85 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * relay.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <relay.h>
+
+// relay_queue_init - initialize a relay queue
+void relay_queue_init(relay_queue_t *rq) {
+    rq->front = 0;
+    rq->back = 0;
+    rq->size = 0;
+}
+
+// relay_should_forward - returns TRUE if a (not duplicate) frame should be
+//  flooded on: it has hops left and did not come from, or is not only meant
+//  for, this node.
+uint8_t relay_should_forward(uint8_t *frame, uint8_t len, uint8_t mac_addr) {
+    if((HEADER_SIZE > len) || (RF_MAX_PAYLOAD_SIZE < len)) {
+        return FALSE;
+    }
+    if(mac_addr == frame[HEADER_SRC_ID_INDEX]) {
+        return FALSE;
+    }
+    if(MAX_HOPS <= frame[HEADER_NUM_HOPS_INDEX]) {
+        return FALSE;
+    }
+    switch(frame[HEADER_TYPE_INDEX]) {
+        case MSG_CMD:
+            return (mac_addr == frame[HEADER_SIZE + CMD_NODE_ID_INDEX]) ? FALSE : TRUE;
+        case MSG_CONFIG:
+            return (mac_addr == frame[HEADER_SIZE + CONFIG_NODE_ID_INDEX]) ? FALSE : TRUE;
+        default:
+            return TRUE;
+    }
+}
+
+// relay_push - copy a frame onto the queue with its hop count incremented, to
+//  be held back for delay calls to relay_tick. the frame is dropped if the
+//  queue is full.
+void relay_push(relay_queue_t *rq, uint8_t *frame, uint8_t len, uint8_t delay) {
+    if(RELAY_QUEUE_SIZE <= rq->size) {
+        return;
+    }
+    for(uint8_t i = 0; i < len; i++) {
+        rq->buf[rq->back][i] = frame[i];
+    }
+    rq->buf[rq->back][HEADER_NUM_HOPS_INDEX]++;
+    rq->len[rq->back] = len;
+    rq->delay[rq->back] = delay;
+    rq->size++;
+    rq->back++;
+    rq->back %= RELAY_QUEUE_SIZE;
+}
+
+// relay_tick - count down the delay of every frame on the queue
+void relay_tick(relay_queue_t *rq) {
+    uint8_t j = rq->front;
+    for(uint8_t i = 0; i < rq->size; i++) {
+        if(0 < rq->delay[j]) {
+            rq->delay[j]--;
+        }
+        j = (j + 1) % RELAY_QUEUE_SIZE;
+    }
+}
+
+// relay_pop - copy the oldest frame into frame, once it is no longer held
+//  back. returns its length (0 if there is none to send)
+uint8_t relay_pop(relay_queue_t *rq, uint8_t *frame) {
+    uint8_t len;
+    if((0 == rq->size) || (0 < rq->delay[rq->front])) {
+        return 0;
+    }
+    len = rq->len[rq->front];
+    for(uint8_t i = 0; i < len; i++) {
+        frame[i] = rq->buf[rq->front][i];
+    }
+    rq->size--;
+    rq->front++;
+    rq->front %= RELAY_QUEUE_SIZE;
+    return len;
+}
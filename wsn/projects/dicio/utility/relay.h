@@ -0,0 +1,20 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * relay.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __relay_h
+#define __relay_h
+
+#include <type_defs.h>
+
+void relay_queue_init(relay_queue_t *rq);
+uint8_t relay_should_forward(uint8_t *frame, uint8_t len, uint8_t mac_addr);
+void relay_push(relay_queue_t *rq, uint8_t *frame, uint8_t len, uint8_t delay);
+void relay_tick(relay_queue_t *rq);
+uint8_t relay_pop(relay_queue_t *rq, uint8_t *frame);
+
+#endif
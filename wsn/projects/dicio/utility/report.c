@@ -0,0 +1,118 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * report.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <report.h>
+
+// clear_stat - clear the window statistics of a single sensor
+static void clear_stat(report_stat_t *s) {
+    s->min = 0xFFFF;
+    s->max = 0;
+    s->sum = 0;
+    s->count = 0;
+}
+
+// report_init - initialize the reporting engine with default deadbands
+void report_init(report_t *r, uint8_t window) {
+    r->pwr.cur = 0;
+    r->pwr.last_reported = 0;
+    r->pwr.deadband = REPORT_PWR_DEADBAND;
+    r->temp.cur = 0;
+    r->temp.last_reported = 0;
+    r->temp.deadband = REPORT_TEMP_DEADBAND;
+    r->light.cur = 0;
+    r->light.last_reported = 0;
+    r->light.deadband = REPORT_LIGHT_DEADBAND;
+    r->energy_ws = 0;
+    r->window = window;
+    report_window_reset(r);
+}
+
+// report_window_reset - start a new reporting window
+void report_window_reset(report_t *r) {
+    clear_stat(&r->pwr);
+    clear_stat(&r->temp);
+    clear_stat(&r->light);
+    r->samples = 0;
+}
+
+// report_sample - add a new sample to a sensor's window
+void report_sample(report_stat_t *s, uint16_t val) {
+    s->cur = val;
+    if(val < s->min) {
+        s->min = val;
+    }
+    if(val > s->max) {
+        s->max = val;
+    }
+    s->sum += val;
+    s->count++;
+}
+
+// report_avg - average of the current window (latest value if no samples)
+uint16_t report_avg(report_stat_t *s) {
+    if(0 == s->count) {
+        return s->cur;
+    }
+    return (uint16_t)(s->sum / s->count);
+}
+
+// report_min - minimum of the current window (latest value if no samples)
+uint16_t report_min(report_stat_t *s) {
+    if(0 == s->count) {
+        return s->cur;
+    }
+    return s->min;
+}
+
+// report_max - maximum of the current window (latest value if no samples)
+uint16_t report_max(report_stat_t *s) {
+    if(0 == s->count) {
+        return s->cur;
+    }
+    return s->max;
+}
+
+// report_crossed - returns TRUE if the latest sample moved out of the deadband
+uint8_t report_crossed(report_stat_t *s) {
+    uint16_t diff;
+    if(0 == s->count) {
+        return FALSE;
+    }
+    if(s->cur > s->last_reported) {
+        diff = s->cur - s->last_reported;
+    } else {
+        diff = s->last_reported - s->cur;
+    }
+    return (diff >= s->deadband) ? TRUE : FALSE;
+}
+
+// report_mark - record the value that was transmitted for a sensor
+void report_mark(report_stat_t *s, uint16_t val) {
+    s->last_reported = val;
+}
+
+// report_energy - integrate power over secs seconds
+void report_energy(report_t *r, uint16_t watts, uint8_t secs) {
+    r->energy_ws += (uint32_t)watts * secs;
+}
+
+// report_tick - advance the window by one sample period. returns
+//  REPORT_WINDOW_EXPIRED when the window is complete, REPORT_DELTA if any
+//  sensor crossed its deadband, REPORT_NONE otherwise.
+uint8_t report_tick(report_t *r) {
+    r->samples++;
+    if(r->samples >= r->window) {
+        return REPORT_WINDOW_EXPIRED;
+    }
+    if((TRUE == report_crossed(&r->pwr)) ||
+        (TRUE == report_crossed(&r->temp)) ||
+        (TRUE == report_crossed(&r->light))) {
+        return REPORT_DELTA;
+    }
+    return REPORT_NONE;
+}
@@ -0,0 +1,25 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * report.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __report_h
+#define __report_h
+
+#include <type_defs.h>
+
+void report_init(report_t *r, uint8_t window);
+void report_window_reset(report_t *r);
+void report_sample(report_stat_t *s, uint16_t val);
+uint16_t report_avg(report_stat_t *s);
+uint16_t report_min(report_stat_t *s);
+uint16_t report_max(report_stat_t *s);
+uint8_t report_crossed(report_stat_t *s);
+void report_mark(report_stat_t *s, uint16_t val);
+void report_energy(report_t *r, uint16_t watts, uint8_t secs);
+uint8_t report_tick(report_t *r);
+
+#endif
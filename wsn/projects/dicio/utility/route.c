@@ -0,0 +1,187 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * route.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <route.h>
+
+// link_etx - expected transmissions to a neighbor from its reception ratio
+static uint16_t link_etx(uint8_t prr) {
+    uint16_t etx;
+    if(0 == prr) {
+        return ROUTE_LINK_ETX_MAX;
+    }
+    etx = (uint16_t)(ROUTE_ETX_ONE * ROUTE_PRR_MAX) / prr;
+    return (ROUTE_LINK_ETX_MAX < etx) ? ROUTE_LINK_ETX_MAX : etx;
+}
+
+// path_cost - cost of reaching the gateway through neighbor i
+static uint16_t path_cost(route_t *r, uint8_t i) {
+    uint32_t cost = (uint32_t)r->cost[i] + link_etx(r->prr[i]);
+    return (ROUTE_COST_MAX < cost) ? ROUTE_COST_MAX : (uint16_t)cost;
+}
+
+// remove_neighbor - remove neighbor i, keeping the table packed
+static void remove_neighbor(route_t *r, uint8_t i) {
+    r->size--;
+    r->node_id[i] = r->node_id[r->size];
+    r->cost[i] = r->cost[r->size];
+    r->prr[i] = r->prr[r->size];
+    r->silent[i] = r->silent[r->size];
+    r->heard[i] = r->heard[r->size];
+}
+
+// choose_parent - pick the cheapest neighbor, only leaving the current parent
+//  if another neighbor is better by ROUTE_SWITCH_HYSTERESIS
+static void choose_parent(route_t *r) {
+    int8_t best = -1;
+    uint16_t best_cost = ROUTE_COST_MAX;
+    uint16_t cost;
+    uint16_t current_cost = ROUTE_COST_MAX;
+    int8_t current = -1;
+
+    for(uint8_t i = 0; i < r->size; i++) {
+        cost = path_cost(r, i);
+        if(r->node_id[i] == r->parent) {
+            current = i;
+            current_cost = cost;
+        }
+        if(cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+
+    if((0 <= current) && ((current_cost <= ROUTE_SWITCH_HYSTERESIS) ||
+        (best_cost >= (current_cost - ROUTE_SWITCH_HYSTERESIS)))) {
+        r->parent_cost = current_cost;
+    } else if((0 <= best) && (ROUTE_COST_MAX > best_cost)) {
+        r->parent = r->node_id[best];
+        r->parent_cost = best_cost;
+    } else {
+        r->parent = ROUTE_NO_PARENT;
+        r->parent_cost = ROUTE_COST_MAX;
+    }
+}
+
+// route_init - start with no neighbors and no parent
+void route_init(route_t *r) {
+    r->size = 0;
+    r->parent = ROUTE_NO_PARENT;
+    r->parent_cost = ROUTE_COST_MAX;
+    r->child_epochs = 0;
+}
+
+// route_epoch - start a new heartbeat epoch. updates each neighbor's reception
+//  ratio, drops neighbors that have gone silent and re-chooses the parent.
+void route_epoch(route_t *r) {
+    uint8_t sample;
+    uint8_t i = 0;
+
+    while(i < r->size) {
+        sample = (TRUE == r->heard[i]) ? ROUTE_PRR_MAX : 0;
+        r->prr[i] = r->prr[i] - (r->prr[i] >> ROUTE_PRR_SHIFT) + (sample >> ROUTE_PRR_SHIFT);
+        if(TRUE == r->heard[i]) {
+            r->silent[i] = 0;
+        } else {
+            r->silent[i]++;
+        }
+        r->heard[i] = FALSE;
+
+        if(ROUTE_NEIGHBOR_TIMEOUT < r->silent[i]) {
+            remove_neighbor(r, i);
+        } else {
+            i++;
+        }
+    }
+    if(0 < r->child_epochs) {
+        r->child_epochs--;
+    }
+    choose_parent(r);
+}
+
+// route_heard - record a heartbeat relayed by node_id advertising cost
+void route_heard(route_t *r, uint8_t node_id, uint16_t cost) {
+    uint8_t i;
+    uint8_t worst = 0;
+
+    for(i = 0; i < r->size; i++) {
+        if(node_id == r->node_id[i]) {
+            break;
+        }
+        if(r->cost[i] > r->cost[worst]) {
+            worst = i;
+        }
+    }
+
+    // new neighbor - add it, or replace the worst one if this one is cheaper
+    if(i == r->size) {
+        if(MAX_ROUTE_NEIGHBORS > r->size) {
+            r->size++;
+        } else if((cost < r->cost[worst]) && (r->node_id[worst] != r->parent)) {
+            i = worst;
+        } else {
+            return;
+        }
+        r->node_id[i] = node_id;
+        r->prr[i] = ROUTE_PRR_INIT;
+        r->silent[i] = 0;
+    }
+    r->cost[i] = cost;
+    r->heard[i] = TRUE;
+
+    // join the gradient straight away rather than waiting for the next epoch
+    if(ROUTE_NO_PARENT == r->parent) {
+        choose_parent(r);
+    }
+}
+
+// route_parent - id of the current parent (ROUTE_NO_PARENT if none)
+uint8_t route_parent(route_t *r) {
+    return r->parent;
+}
+
+// route_cost - this node's path cost, advertised when relaying heartbeats
+uint16_t route_cost(route_t *r) {
+    return r->parent_cost;
+}
+
+// route_child_heard - an upstream message from another node was received for
+//  relaying, so some node routes through this one
+void route_child_heard(route_t *r) {
+    r->child_epochs = ROUTE_CHILD_EPOCHS;
+}
+
+// route_should_relay - returns FALSE for OTA frames (long, and sent back to
+//  back) unless a child has routed through this node lately, so nodes at the
+//  edge of the mesh don't flood them. everything else is always relayed.
+uint8_t route_should_relay(route_t *r, uint8_t type) {
+    switch(type) {
+        case MSG_OTA_BEGIN:
+        case MSG_OTA_DATA:
+        case MSG_OTA_POLL:
+        case MSG_OTA_END:
+            return (0 < r->child_epochs) ? TRUE : FALSE;
+        default:
+            return TRUE;
+    }
+}
+
+// route_is_upstream - returns TRUE for messages that travel toward the gateway
+uint8_t route_is_upstream(uint8_t type) {
+    switch(type) {
+        case MSG_DATA:
+        case MSG_DATA_BATCH:
+        case MSG_ENERGY:
+        case MSG_CMDACK:
+        case MSG_CONFIGACK:
+        case MSG_HAND:
+        case MSG_OTA_REPORT:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
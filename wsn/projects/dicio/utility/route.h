@@ -0,0 +1,23 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * route.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __route_h
+#define __route_h
+
+#include <type_defs.h>
+
+void route_init(route_t *r);
+void route_epoch(route_t *r);
+void route_heard(route_t *r, uint8_t node_id, uint16_t cost);
+uint8_t route_parent(route_t *r);
+uint16_t route_cost(route_t *r);
+void route_child_heard(route_t *r);
+uint8_t route_should_relay(route_t *r, uint8_t type);
+uint8_t route_is_upstream(uint8_t type);
+
+#endif
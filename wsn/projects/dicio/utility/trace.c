@@ -0,0 +1,29 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * trace.c
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#include <trace.h>
+#include <nrk_time.h>
+
+// trace_now_ms - low 16 bits of the time since boot in ms. only differences
+//  are meaningful (they wrap after ~65 seconds).
+uint16_t trace_now_ms() {
+    nrk_time_t t;
+    nrk_time_get(&t);
+    return (uint16_t)((t.secs * 1000) + (t.nano_secs / NANOS_PER_MS));
+}
+
+// trace_put_ms - store a time or duration in a payload (2 bytes, big endian)
+void trace_put_ms(uint8_t *buf, uint16_t ms) {
+    buf[0] = (ms >> 8) & 0xFF;
+    buf[1] = ms & 0xFF;
+}
+
+// trace_get_ms - read a time or duration stored with trace_put_ms
+uint16_t trace_get_ms(uint8_t *buf) {
+    return ((uint16_t)buf[0] << 8) | buf[1];
+}
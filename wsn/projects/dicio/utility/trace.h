@@ -0,0 +1,18 @@
+/**
+ * 18-748 Wireless Sensor Networks
+ * Spring 2016
+ * Dicio - A Smart Outlet Mesh Network
+ * trace.h
+ * Kedar Amladi // kamladi. Daniel Santoro // ddsantor. Adam Selevan // aselevan.
+ */
+
+#ifndef __trace_h
+#define __trace_h
+
+#include <type_defs.h>
+
+uint16_t trace_now_ms(void);
+void trace_put_ms(uint8_t *buf, uint16_t ms);
+uint16_t trace_get_ms(uint8_t *buf);
+
+#endif
@@ -52,14 +52,13 @@
 
 // MISC
 #define MAX_BUF_SIZE 24
-#define MAX_PAYLOAD_SIZE 8
+#define MAX_PAYLOAD_SIZE 12
 #define MAX_NEIGHBOR_BUF_SIZE 4
 #define MAX_NUM_HOPS 3
 #define MAX_PACKET_BUFFER 8
 #define GATEWAY_ID 1
 #define HEART_FACTOR 12
 #define ALIVE_LIMIT 1
-#define NOT_ALIVE 0
 #define TX_CMD_FLAG 1
 #define NODE_TX_DATA_FLAG 20
 #define GATE_TX_DATA_FLAG 10
@@ -70,6 +69,11 @@
 #define MAX_NEIGHBOR_TABLE 3
 #define MAX_POOL 4
 #define MAX_GRAPH 8
+#define DEDUP_CACHE_SIZE 12 // recently seen (source, seq) pairs
+#define MAX_ROUTE_NEIGHBORS 4 // candidate parents
+#define RELAY_QUEUE_SIZE 4 // frames waiting to be relayed
+#define RELAY_JITTER_WINDOW 3 // tx periods a relayed frame may be held back
+#define MAX_INFLIGHT_CMDS 8 // unacknowledged commands tracked by the gateway
 
 // payload indexes
 #define HEADER_SRC_ID_INDEX 0
@@ -77,22 +81,61 @@
 #define HEADER_TYPE_INDEX 3
 #define HEADER_NUM_HOPS_INDEX 4
 #define HEADER_SIZE 5
+#define MSG_TYPE_MAX 21 // highest msg_type value
 #define CMD_CMDID_INDEX 0
 #define CMD_NODE_ID_INDEX 2
 #define CMD_ACT_INDEX 3
+#define CMD_RX_MS_INDEX 4 // local receipt time for latency tracing, never sent
 #define CMDG_CMDID_INDEX 0
 #define CMDG_GROUP_INDEX 2
 #define CMDG_ACTION_INDEX 3
 #define CMDACK_CMDID_INDEX 0
 #define CMDACK_STATE_INDEX 2
+#define CMDACK_RX_ACT_INDEX 3 // node: command received -> coil driven (ms)
+#define CMDACK_ACT_ACK_INDEX 5 // node: coil driven -> ack queued (ms)
+#define CMDACK_GW_QUEUE_INDEX 7 // gateway: serial received -> radio sent (ms)
+#define CMDACK_GW_NET_INDEX 9 // gateway: radio sent -> ack received (ms)
 #define DATA_PWR_INDEX 0
 #define DATA_TEMP_INDEX 2
 #define DATA_LIGHT_INDEX 4
 #define DATA_STATE_INDEX 6
+#define DATA_AGE_INDEX 7
 #define HANDACK_NODE_ID_INDEX 0
 #define HANDACK_CONFIG_ID_INDEX 1
 #define HAND_CONFIG_ID_INDEX 0
-#define LOST_NODE_INDEX 0
+#define LOST_COUNT_INDEX 0
+#define LOST_NODE_INDEX 1
+#define HEART_RELAY_INDEX 0
+#define HEART_COST_INDEX 1
+#define ENERGY_WS_INDEX 0
+#define ENERGY_PWR_MIN_INDEX 4
+#define ENERGY_PWR_MAX_INDEX 6
+#define CONFIG_CMDID_INDEX 0
+#define CONFIG_NODE_ID_INDEX 2
+#define CONFIG_PARAM_INDEX 3
+#define CONFIG_VALUE_INDEX 4
+#define CONFIGACK_CMDID_INDEX 0
+#define CONFIGACK_PARAM_INDEX 2
+#define CONFIGACK_VALUE_INDEX 3
+#define CONFIGACK_STATUS_INDEX 5
+#define BATCH_COUNT_INDEX 0
+#define BATCH_STATE_INDEX 1
+#define BATCH_PERIOD_INDEX 2
+#define BATCH_AGE_INDEX 3
+#define BATCH_SETS_INDEX 4
+#define SYNC_ID_INDEX 0
+#define OTA_IMAGE_INDEX 0 // every OTA message starts with the image id
+#define OTAB_GROUP_INDEX 1
+#define OTAB_SIZE_INDEX 2
+#define OTAB_CRC_INDEX 4
+#define OTAD_WINDOW_INDEX 1
+#define OTAD_CHUNK_INDEX 2
+#define OTAD_DATA_INDEX 3
+#define OTAE_ACTION_INDEX 1
+#define OTAR_STATUS_INDEX 1
+#define OTAR_WINDOW_INDEX 2
+#define OTAR_MISSING_INDEX 3 // chunks missing from the window (2 bytes)
+#define OTAR_NEXT_INDEX 5 // chunks missing from the window after it (2 bytes)
 
 // hardware
 #define GET_REV(R) R & 0xFF;
@@ -102,11 +145,185 @@
 // GPIOs
 #define ON_COIL NRK_PORTB_6
 #define OFF_COIL NRK_PORTB_7
+
+// button - the outlet board wires it to PE3, which has no external or pin
+//  change interrupt, so it is polled from the application timer. boards with
+//  the button on the firefly3 line (PD1/INT1, also the host port's SIGUSR1
+//  button) define BTN_EXT_INT to take an edge interrupt instead.
+#if defined(NRK_POSIX) && !defined(BTN_EXT_INT)
+#define BTN_EXT_INT
+#endif
+#ifdef BTN_EXT_INT
+#define BTN_IN NRK_PORTD_1
+#define BTN_INT NRK_EXT_INT_1 // external interrupt wired to BTN_IN
+#else
 #define BTN_IN NRK_PORTE_3
+#endif
+
+// button timing on the application timer (16MHz / 1024). the button is
+//  polled every ~100ms, as button_task used to, and sampled again ~20ms after
+//  a change of level (or an edge) to debounce it.
+#define BTN_DEBOUNCE_PRESCALE 5
+#define BTN_POLL_TICKS 1563
+#define BTN_DEBOUNCE_TICKS 313
+
+// command retries (in gateway tx_net_task periods), the wait doubles after
+//  every retransmission up to RETRY_BACKOFF_MAX
+#define RETRY_CMD_PERIOD 2
+#define RETRY_BACKOFF_MAX 16
+#define RETRY_LIMIT 4 // retransmissions before the gateway gives up on a command
+
+// cmd_table_poll return values
+#define CMD_NONE_DUE 0
+#define CMD_RETRY 1
+#define CMD_EXPIRED 2
+
+// gateway liveness tracking (in alive_task periods). a node is reported lost
+//  ALIVE_FACTOR - ALIVE_LIMIT periods after it was last heard, where the
+//  factor depends on its class: the hardware revision in its handshake
+#define MAX_ALIVE_NODES 16
+#define ALIVE_WHEEL_SLOTS 16 // power of two, larger than every ALIVE_FACTOR
+#define ALIVE_CLASSES 2 // one per hardware revision, unknown revisions use 0
+#define ALIVE_FACTOR_REV0 HEART_FACTOR // power sensing outlet
+#define ALIVE_FACTOR_REV1 HEART_FACTOR // light sensing outlet
+#define ALIVE_NONE 0xFF // end of a wheel slot's list
+#define MAX_LOST_BATCH (MAX_PAYLOAD_SIZE - LOST_NODE_INDEX) // nodes per MSG_LOST
+#define ALIVE_STATE_UNKNOWN 0xFF // no data or ack heard since the node was added
+
+// stack profile report period (in heartbeat periods)
+#define STACK_REPORT_PERIOD 12
+
+// number of ADC channels sampled by sample_task (temperature, light)
+#define SAMPLE_ADC_CHANNELS 2
+
+// reporting engine
+#define SAMPLE_PERIOD_SECS 5 // period of sample_task
+#define REPORT_WINDOW 6 // samples per window, keep below HEART_FACTOR * alive period
+#define REPORT_PWR_DEADBAND 5 // W
+#define REPORT_TEMP_DEADBAND 5 // 0.1 C
+#define REPORT_LIGHT_DEADBAND 20 // raw adc counts
+#define REPORT_NONE 0
+#define REPORT_DELTA 1
+#define REPORT_WINDOW_EXPIRED 2
+
+// batched data (MSG_DATA_BATCH)
+#define BATCH_MAX_SETS 6 // keep below MAX_PACKET_BUFFER, the gateway expands each set
+#define BATCH_MAX_AGE 3 // sample periods the oldest set may wait before sending
+#define BATCH_SET_MAX_BYTES 11 // sample period gap (2) + three zigzag deltas (3 each)
+#define BATCH_MAX_BYTES (BATCH_SETS_INDEX + (BATCH_MAX_SETS * BATCH_SET_MAX_BYTES))
+#define VARINT_MORE 0x80
+#define VARINT_MASK 0x7F
+#define VARINT_SHIFT 7
+
+// gradient routing (costs are ETX * ROUTE_ETX_ONE)
+#define BROADCAST_ADDR 0xFFFF
+#define ROUTE_NO_PARENT 0
+#define ROUTE_ETX_ONE 10
+#define ROUTE_COST_MAX 0xFFFF
+#define ROUTE_LINK_ETX_MAX 255
+#define ROUTE_PRR_MAX 255 // reception ratio of heartbeats, 255 = every one heard
+#define ROUTE_PRR_INIT 192
+#define ROUTE_PRR_SHIFT 2 // EWMA weight of the newest heartbeat epoch (1/4)
+#define ROUTE_NEIGHBOR_TIMEOUT 3 // heartbeat epochs a neighbor may be silent
+#define ROUTE_SWITCH_HYSTERESIS 5 // cost improvement needed to change parent
+#define ROUTE_CHILD_EPOCHS 3 // heartbeat epochs a node relays OTA frames after last relaying for a child
 
-//retry period
-#define RETRY_CMD_PERIOD 10
-#define RETRY_LIMIT 2 // only send it twice, if node hasnt seen it.. too bad
+// configuration parameters (MSG_CONFIG)
+#define CONFIG_PWR_PERIOD 1
+#define CONFIG_TEMP_PERIOD 2
+#define CONFIG_LIGHT_PERIOD 3
+#define CONFIG_PWR_DEADBAND 4
+#define CONFIG_TEMP_DEADBAND 5
+#define CONFIG_LIGHT_DEADBAND 6
+#define CONFIG_HEARTBEAT 7
+#define CONFIG_GROUPS 8
+#define CONFIG_OK 0
+#define CONFIG_INVALID 1
+#define CONFIG_PERIOD_MAX 60 // sample periods
+#define CONFIG_HEARTBEAT_MAX (HEART_FACTOR - 2) // stay inside the gateway liveness timeout
+
+// groups - ids 1..MAX_GROUPS, a node's memberships are one bit each in
+//  CONFIG_GROUPS (kept within the 14 bits the server can send)
+#define MAX_GROUPS 14
+#define GROUP_MASK(G) (1 << ((G) - 1))
+#define GROUP_ACK_WINDOW 6 // tx periods a group command ack may be held back
+#define GROUP_ACKS_HELD 3 // group command acks held back at once
+#define DEFAULT_PWR_PERIOD 2 // sample periods
+#define DEFAULT_TEMP_PERIOD 3
+#define DEFAULT_LIGHT_PERIOD 4
+
+// configuration EEPROM image (after the platform's MAC/channel/key entries)
+#define CONFIG_EE_ADDR 64
+#define CONFIG_EE_MAGIC 0xC5
+
+// gateway node registry: an append-only ring of REGISTRY_RECORD_SIZE byte
+//  records in the ee_log layout (one record per write, checksum last) so the
+//  node table survives a watchdog reboot. a node's record moves to the next
+//  free slot each time it is rewritten, spreading the wear over the ring.
+#define REGISTRY_EE_ADDR 0x400 // clear of the node config and the error log (0x200)
+#define REGISTRY_EE_SLOTS 128
+#define REGISTRY_RECORD_SIZE 7
+#define REGISTRY_EE_MAGIC 0x5A
+#define REGISTRY_STAMP_INDEX 0 // 2 bytes
+#define REGISTRY_NODE_INDEX 2
+#define REGISTRY_CLASS_INDEX 3
+#define REGISTRY_SEQ_INDEX 4 // 2 bytes
+#define REGISTRY_CHKSUM_INDEX 6
+#define REGISTRY_SEQ_STEP 256 // sequence numbers heard before a node is rewritten
+#define REGISTRY_STAMP_REFRESH 0x4000 // writes before an unchanged record is re-stamped
+#define REGISTRY_NONE 0xFF // no slot
+
+// over-the-air update. the image is sent in windows of OTA_WINDOW_CHUNKS
+//  chunks, and the server starts on the next window while it waits for the
+//  reports on the last one. a node holds OTA_WINDOWS_HELD windows in RAM,
+//  writes each flash page as soon as the page is complete and, when polled,
+//  reports the chunks it is missing (one bit each). a verified image is
+//  copied over the application by the routines in the boot section (see
+//  ota_flash.c).
+#define OTA_CHUNK_SIZE 64
+#define OTA_PAGE_SIZE 256 // SPM page
+#define OTA_WINDOW_PAGES 4
+#define OTA_WINDOW_SIZE (OTA_PAGE_SIZE * OTA_WINDOW_PAGES)
+#define OTA_WINDOW_CHUNKS (OTA_WINDOW_SIZE / OTA_CHUNK_SIZE) // at most 16
+#define OTA_PAGE_CHUNKS (OTA_PAGE_SIZE / OTA_CHUNK_SIZE)
+#define OTA_WINDOWS_HELD 2 // the oldest incomplete window and the one after it
+// flash addresses are past 16 bits of int on the AVR, keep them unsigned long
+#define OTA_APP_ADDR 0x00000UL
+#define OTA_BANK_ADDR 0x0F000UL // spare bank, between the application and the boot section
+#define OTA_BANK_SIZE 0x0F000
+#define OTA_CRC_POLY 0x1021 // CRC-16/CCITT, as the server computes it
+#define OTA_CRC_INIT 0xFFFF
+#define OTA_ALL_NODES 0 // BEGIN group that every node joins
+#define OTA_VERIFY 0 // END actions
+#define OTA_ACTIVATE 1
+#define OTA_STATE_IDLE 0
+#define OTA_STATE_RECEIVING 1
+#define OTA_STATE_VERIFIED 2
+#define OTA_STATE_REJECTED 3
+#define OTA_STATE_INSTALLED 4
+#define OTA_STATUS_RECEIVING 0 // MSG_OTA_REPORT status
+#define OTA_STATUS_VERIFIED 1
+#define OTA_STATUS_BAD_CRC 2
+#define OTA_STATUS_ACTIVATING 3
+#define OTA_STATUS_REJECTED 4
+#define OTA_STATUS_INSTALLED 5
+#define OTA_NO_REPORT 0xFF // the message was for another image
+#define OTA_REPORT_WINDOW 6 // tx periods a poll report may be held back
+
+// image record in EEPROM, written before the copy and marked installed by the
+//  new image when it boots
+#define OTA_EE_ADDR 0x780 // after the gateway registry
+#define OTA_EE_MAGIC 0xA7
+#define OTA_EE_MAGIC_INDEX 0
+#define OTA_EE_IMAGE_INDEX 1
+#define OTA_EE_STATE_INDEX 2
+#define OTA_EE_PENDING 1
+#define OTA_EE_INSTALLED 2
+
+// the server sends 16-bit config fields as two 7-bit bytes so '\r' never
+//  appears inside a message
+#define SERV_7BIT_MASK 0x7F
+#define SERV_7BIT_SHIFT 7
 
 /*** ENUMERATIONS ***/
 typedef enum {
@@ -120,8 +337,32 @@ typedef enum {
   MSG_HAND = 8,
   MSG_HANDACK = 9,
   MSG_HEARTBEAT = 10,
+  MSG_ENERGY = 11,
+  MSG_CONFIG = 12,
+  MSG_CONFIGACK = 13,
+  MSG_DATA_BATCH = 14,
+  MSG_CMD_GROUP = 15,
+  MSG_SYNC = 16,
+  MSG_OTA_BEGIN = 17,
+  MSG_OTA_DATA = 18,
+  MSG_OTA_POLL = 19,
+  MSG_OTA_END = 20,
+  MSG_OTA_REPORT = 21,
 } msg_type;
 
+/**
+ * msg_view_t struct - a received message left in place in its buffer. only
+ *  msg_view_init() fills one in, after checking the message is long enough
+ *  for its type, so the accessors in parser.h never read past len.
+ *
+ * @param buf - the message, starting at its header
+ * @param len - length of the message
+ */
+typedef struct {
+  uint8_t *buf;
+  uint8_t len;
+} msg_view_t;
+
 /**
  * sequence_pool_t struct - hold all neighbor id's and the last seen sequence
  *  number for that neighbor
@@ -183,4 +424,276 @@ typedef struct {
   uint16_t light_val;
 } sensor_packet;
 
+/**
+ * report_stat_t struct - per sensor state for the reporting engine
+ *
+ * @param cur - most recent sample
+ * @param last_reported - value in the last transmitted data packet
+ * @param deadband - change from last_reported that triggers a report
+ * @param min - minimum sample in the current window
+ * @param max - maximum sample in the current window
+ * @param sum - sum of the samples in the current window
+ * @param count - number of samples in the current window
+ */
+typedef struct {
+  uint16_t cur;
+  uint16_t last_reported;
+  uint16_t deadband;
+  uint16_t min;
+  uint16_t max;
+  uint32_t sum;
+  uint8_t count;
+} report_stat_t;
+
+/**
+ * report_t struct - reporting engine state
+ *
+ * @param pwr - power statistics
+ * @param temp - temperature statistics
+ * @param light - light statistics
+ * @param energy_ws - energy used since boot (watt-seconds)
+ * @param window - number of sample periods in a reporting window
+ * @param samples - sample periods elapsed in the current window
+ */
+typedef struct {
+  report_stat_t pwr;
+  report_stat_t temp;
+  report_stat_t light;
+  uint32_t energy_ws;
+  uint8_t window;
+  uint8_t samples;
+} report_t;
+
+/**
+ * dedup_t struct - recently seen (source_id, seq_num) pairs, most recently
+ *  seen first. the least recently seen pair is dropped when the cache is full.
+ *
+ * @param size - number of pairs in the cache
+ * @param source_id - array of source ids
+ * @param seq_num - array of sequence numbers (maps directly to source_id)
+ */
+typedef struct {
+  uint8_t size;
+  uint8_t source_id[DEDUP_CACHE_SIZE];
+  uint16_t seq_num[DEDUP_CACHE_SIZE];
+} dedup_t;
+
+/**
+ * relay_queue_t struct - raw network frames waiting to be relayed
+ *
+ * @param buf - frame buffers
+ * @param len - length of each frame (maps directly to buf)
+ * @param delay - tx periods each frame is still held back
+ * @param front - front of the queue
+ * @param back - back of the queue
+ * @param size - size of the queue
+ */
+typedef struct {
+  uint8_t buf[RELAY_QUEUE_SIZE][RF_MAX_PAYLOAD_SIZE];
+  uint8_t len[RELAY_QUEUE_SIZE];
+  uint8_t delay[RELAY_QUEUE_SIZE];
+  uint8_t front;
+  uint8_t back;
+  uint8_t size;
+} relay_queue_t;
+
+/**
+ * route_t struct - gradient toward the gateway learned from heartbeats. each
+ *  neighbor that relays a heartbeat advertises its own path cost; the parent
+ *  is the neighbor with the lowest advertised cost plus link ETX.
+ *
+ * @param size - number of neighbors
+ * @param node_id - array of neighbor ids
+ * @param cost - path cost advertised by each neighbor
+ * @param prr - heartbeat reception ratio from each neighbor (EWMA)
+ * @param silent - heartbeat epochs since each neighbor was last heard
+ * @param heard - TRUE if each neighbor was heard in the current epoch
+ * @param parent - id of the current parent (ROUTE_NO_PARENT if none)
+ * @param parent_cost - path cost through the parent
+ * @param child_epochs - heartbeat epochs left in which this node relays OTA
+ *  frames (some child has sent upstream traffic through it)
+ */
+typedef struct {
+  uint8_t size;
+  uint8_t node_id[MAX_ROUTE_NEIGHBORS];
+  uint16_t cost[MAX_ROUTE_NEIGHBORS];
+  uint8_t prr[MAX_ROUTE_NEIGHBORS];
+  uint8_t silent[MAX_ROUTE_NEIGHBORS];
+  uint8_t heard[MAX_ROUTE_NEIGHBORS];
+  uint8_t parent;
+  uint16_t parent_cost;
+  uint8_t child_epochs;
+} route_t;
+
+/**
+ * cmd_table_t struct - commands sent by the gateway that have not been
+ *  acknowledged yet. at most one entry per node; a newer command for a node
+ *  replaces the older one.
+ *
+ * @param cmd - the command packets
+ * @param in_use - TRUE if the slot holds a command
+ * @param deadline - periods left until the command is retransmitted (armed
+ *  once it has been sent)
+ * @param backoff - current wait between retransmissions
+ * @param retries - number of retransmissions so far
+ * @param sent - TRUE once the command has first gone out on the radio
+ * @param tx_ms - time of that first transmission (latency tracing)
+ */
+typedef struct {
+  packet cmd[MAX_INFLIGHT_CMDS];
+  uint8_t in_use[MAX_INFLIGHT_CMDS];
+  uint8_t deadline[MAX_INFLIGHT_CMDS];
+  uint8_t backoff[MAX_INFLIGHT_CMDS];
+  uint8_t retries[MAX_INFLIGHT_CMDS];
+  uint8_t sent[MAX_INFLIGHT_CMDS];
+  uint16_t tx_ms[MAX_INFLIGHT_CMDS];
+} cmd_table_t;
+
+/**
+ * alive_t struct - the gateway's view of each node (server syncs are built from
+ *  it), and when it last heard from each one, as a timer
+ *  wheel of alive_task periods. every tracked node that isn't lost sits in the
+ *  list of the slot for its scheduled tick. hearing from a node only moves
+ *  its expiry later; the node is moved on when its scheduled tick comes up,
+ *  so each tick only touches the nodes in one slot.
+ *
+ * @param size - number of nodes tracked
+ * @param node_id - array of node ids
+ * @param node_class - liveness class of each node (maps directly to node_id)
+ * @param state - last outlet state (ON/OFF) each node reported
+ * @param seq_num - last sequence number heard from each node
+ * @param expiry - tick at which each node is lost
+ * @param at - tick of the slot each node is listed in (never after expiry)
+ * @param next - next node in the same slot (ALIVE_NONE at the end)
+ * @param lost - TRUE once a node has been reported lost
+ * @param slot - first node in each slot's list
+ * @param now - current tick
+ */
+typedef struct {
+  uint8_t size;
+  uint8_t node_id[MAX_ALIVE_NODES];
+  uint8_t node_class[MAX_ALIVE_NODES];
+  uint8_t state[MAX_ALIVE_NODES];
+  uint16_t seq_num[MAX_ALIVE_NODES];
+  uint8_t expiry[MAX_ALIVE_NODES];
+  uint8_t at[MAX_ALIVE_NODES];
+  uint8_t next[MAX_ALIVE_NODES];
+  uint8_t lost[MAX_ALIVE_NODES];
+  uint8_t slot[ALIVE_WHEEL_SLOTS];
+  uint8_t now;
+} alive_t;
+
+/**
+ * registry_t struct - the gateway's copy of the node registry kept in EEPROM.
+ *  each node has one live record in the ring, the newest one written for it.
+ *
+ * @param size - number of nodes in the registry
+ * @param node_id - array of node ids
+ * @param node_class - liveness class of each node (maps directly to node_id)
+ * @param seq_num - sequence number in each node's record
+ * @param slot - ring slot holding each node's record
+ * @param dirty - TRUE if a node's record has to be rewritten
+ * @param written - stamp of each node's record
+ * @param head - next slot to write (skipping live records)
+ * @param stamp - stamp of the last record written
+ */
+typedef struct {
+  uint8_t size;
+  uint8_t node_id[MAX_ALIVE_NODES];
+  uint8_t node_class[MAX_ALIVE_NODES];
+  uint16_t seq_num[MAX_ALIVE_NODES];
+  uint8_t slot[MAX_ALIVE_NODES];
+  uint8_t dirty[MAX_ALIVE_NODES];
+  uint16_t written[MAX_ALIVE_NODES];
+  uint8_t head;
+  uint16_t stamp;
+} registry_t;
+
+/**
+ * sample_set_t struct - one set of reported sensor values
+ *
+ * @param pwr - power value
+ * @param temp - temperature value
+ * @param light - light value
+ * @param state - outlet state (ON/OFF)
+ * @param age - seconds since the set was sampled (filled in by parse_batch)
+ */
+typedef struct {
+  uint16_t pwr;
+  uint16_t temp;
+  uint16_t light;
+  uint8_t state;
+  uint8_t age;
+} sample_set_t;
+
+/**
+ * batch_t struct - MSG_DATA_BATCH payload under construction. each set is
+ *  encoded as a varint of the sample periods since the previous set followed
+ *  by zigzag varint deltas from the previous set's values.
+ *
+ * @param buf - encoded payload
+ * @param len - bytes used in buf
+ * @param count - number of sets in the batch
+ * @param age - sample periods since the newest set was added
+ * @param span - sample periods since the oldest set was added
+ * @param prev - values of the newest set (base for the next deltas)
+ */
+typedef struct {
+  uint8_t buf[BATCH_MAX_BYTES];
+  uint8_t len;
+  uint8_t count;
+  uint8_t age;
+  uint8_t span;
+  sample_set_t prev;
+} batch_t;
+
+/**
+ * config_t struct - node configuration set by the server, persisted in EEPROM
+ *
+ * @param pwr_period - power sample period (in sample task periods)
+ * @param temp_period - temperature sample period (in sample task periods)
+ * @param light_period - light sample period (in sample task periods)
+ * @param pwr_deadband - power reporting deadband
+ * @param temp_deadband - temperature reporting deadband
+ * @param light_deadband - light reporting deadband
+ * @param heartbeat - sample periods between guaranteed (window) reports
+ * @param groups - groups this node is a member of (GROUP_MASK of each)
+ */
+typedef struct {
+  uint8_t pwr_period;
+  uint8_t temp_period;
+  uint8_t light_period;
+  uint16_t pwr_deadband;
+  uint16_t temp_deadband;
+  uint16_t light_deadband;
+  uint8_t heartbeat;
+  uint16_t groups;
+} config_t;
+
+/**
+ * ota_t struct - a node's side of an over-the-air update
+ *
+ * @param image_id - image being received (or last installed)
+ * @param state - OTA_STATE_*
+ * @param size - image size in bytes
+ * @param crc - CRC-16 of the image sent in its BEGIN
+ * @param crc_run - CRC-16 of the windows completed so far, read back from flash
+ * @param windows - number of windows in the image
+ * @param window - oldest incomplete window (windows once the image is complete)
+ * @param have - chunks received of each held window (one bit each). window w
+ *    is held in slot w % OTA_WINDOWS_HELD
+ * @param buf - the held windows
+ */
+typedef struct {
+  uint8_t image_id;
+  uint8_t state;
+  uint16_t size;
+  uint16_t crc;
+  uint16_t crc_run;
+  uint8_t windows;
+  uint8_t window;
+  uint16_t have[OTA_WINDOWS_HELD];
+  uint8_t buf[OTA_WINDOWS_HELD][OTA_WINDOW_SIZE];
+} ota_t;
+
 #endif
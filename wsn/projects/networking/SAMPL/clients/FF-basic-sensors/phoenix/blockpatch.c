@@ -0,0 +1,173 @@
+#include <nrk.h>
+#include <stdio.h>
+#include <avr/interrupt.h>
+#include <nrk_eeprom.h>
+#include <avr/wdt.h>
+#include "bootloader.h"
+#include "globals.h"
+
+/* blockdiff patch (UpdateMode 3), as stored in the update section. binder
+ * keeps the old image checksum out of the image and sends it in INIT.
+ *
+ *   byte 0      checksum of the new image
+ *   byte 1,2    new image size (big endian)
+ *   ops         until the new image is complete
+ *     0lllllll                      INSERT l+1 bytes, which follow
+ *     1lllllll llllllll aaaa aaaa   COPY l bytes from load section offset a
+ */
+
+#define BP_HEADER	3
+#define BP_COPY		0x80
+#define BP_MAX_IMAGE	(UPDATE_SECTION - LOAD_SECTION)
+
+static uint32_t bp_patch_addr;
+static uint32_t bp_patch_end;
+static uint32_t bp_new_addr;
+static uint16_t bp_pagepos;
+
+static uint8_t bp_read_patch(uint8_t *data);
+static void bp_write_newfile(uint8_t data);
+static void bp_reboot(void);
+
+void BlockPatch(uint16_t ee_update_section_byte_size, uint16_t ee_load_section_byte_size);
+
+/*$PAGE*/
+/*
+**********************************************************************
+*                        BLOCK PATCH SECTION
+*   rebuilds the new image in the scratch section from runs of the
+*   running image and the literal bytes in the patch, then loads it
+**********************************************************************
+*/
+
+void BlockPatch(uint16_t ee_update_section_byte_size, uint16_t ee_load_section_byte_size)
+{
+  uint8_t op, data, newChecksum, checksum, newfile_page_size;
+  uint8_t b[3];
+  uint16_t new_size, written, len, src;
+
+  bp_patch_addr = UPDATE_SECTION;
+  bp_patch_end = UPDATE_SECTION + (uint32_t)ee_update_section_byte_size;
+  bp_new_addr = SCRATCH_SECTION;
+  bp_pagepos = 0;
+
+  cli();
+  wdt_disable();
+
+  if(ee_update_section_byte_size < BP_HEADER)
+    bp_reboot();
+
+  bp_read_patch(&newChecksum);
+  bp_read_patch(&b[0]);
+  bp_read_patch(&b[1]);
+  new_size = ((uint16_t)b[0] << 8) | b[1];
+  if(new_size > BP_MAX_IMAGE)
+    bp_reboot();
+
+  written = 0;
+  while(written < new_size)
+  {
+    if(bp_read_patch(&op) == 0)
+      bp_reboot();
+
+    if(op & BP_COPY)
+    {
+      if(bp_read_patch(&b[0]) == 0 || bp_read_patch(&b[1]) == 0 || bp_read_patch(&b[2]) == 0)
+        bp_reboot();
+      len = ((uint16_t)(op & ~BP_COPY) << 8) | b[0];
+      src = ((uint16_t)b[1] << 8) | b[2];
+      if((uint32_t)src + len > ee_load_section_byte_size || (uint32_t)written + len > new_size)
+        bp_reboot();
+      for(; len > 0; len--, src++, written++)
+      {
+        ws_flash_read_byte((uint32_t)LOAD_SECTION + src, &data);
+        bp_write_newfile(data);
+      }
+    }
+    else
+    {
+      len = (uint16_t)op + 1;
+      if((uint32_t)written + len > new_size)
+        bp_reboot();
+      for(; len > 0; len--, written++)
+      {
+        if(bp_read_patch(&data) == 0)
+          bp_reboot();
+        bp_write_newfile(data);
+      }
+    }
+  }
+
+  if(bp_pagepos != 0)
+    commit_page(bp_new_addr, ph_buf);
+
+  // The running image is untouched until the rebuilt one checks out
+  checksum = 0;
+  for(written = 0; written < new_size; written++)
+  {
+    ws_flash_read_byte(SCRATCH_SECTION + written, &data);
+    checksum += data;
+  }
+  if(checksum != newChecksum)
+  {
+    nrk_kprintf(PSTR("PATCHED IMAGE CHECKSUM FAILED\r\n"));
+    bp_reboot();
+  }
+
+  newfile_page_size = new_size / PAGESIZE;
+  if((new_size % PAGESIZE) > 0) newfile_page_size ++;
+
+  // Write the new image size in pages
+  write_eeprom_load_img_pages(&newfile_page_size);
+
+  // Write the new checksum
+  write_eeprom_current_image_checksum(&newChecksum);
+
+  nrk_kprintf(PSTR("NOW COPYING...\r\n"));
+  printf("New Load Pages: %X\r\n", newfile_page_size);
+
+  copy_section(SCRATCH_SECTION, LOAD_SECTION, newfile_page_size, ph_buf);
+
+  while(1);
+}
+
+/*$PAGE*/
+/*
+**********************************************************************
+*         FUNC to read the patch and write the new image pagewise
+*
+**********************************************************************
+*/
+
+// Returns 0 past the end of the patch
+static uint8_t bp_read_patch(uint8_t *data)
+{
+  if(bp_patch_addr >= bp_patch_end)
+    return 0;
+
+  ws_flash_read_byte(bp_patch_addr, data);
+  bp_patch_addr++;
+
+  return 1;
+}
+
+static void bp_write_newfile(uint8_t data)
+{
+  ph_buf[bp_pagepos] = data;
+  bp_pagepos++;
+
+  if(bp_pagepos == PAGESIZE)
+  {
+    commit_page(bp_new_addr, ph_buf);
+    bp_new_addr += PAGESIZE;
+    bp_pagepos = 0;
+  }
+}
+
+// Malformed patch: restart on the running image, which was never touched
+static void bp_reboot(void)
+{
+  nrk_kprintf(PSTR("BLOCK PATCH FAILED\r\n"));
+  wdt_enable(20);
+  while(1);
+}
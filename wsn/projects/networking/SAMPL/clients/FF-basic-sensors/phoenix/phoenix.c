@@ -35,6 +35,10 @@
 #define PG_OFF           PKT_TYPE + 3
 #define DATA_HEAD        PKT_TYPE + 4
 
+// UpdateMode, set by binder
+#define PATCH_MODE       1
+#define FULL_BIN_MODE    2
+#define BLOCK_PATCH_MODE 3
 
 static int8_t v, val;
 static uint8_t rssi,len,i;
@@ -58,6 +62,7 @@ static uint8_t pgNumber = 0;
 static uint8_t pgOffset = 0;
 
 extern void NanoPatch(uint16_t ee_update_section_byte_size, uint16_t ee_load_section_byte_size, uint8_t newChecksum);
+extern void BlockPatch(uint16_t ee_update_section_byte_size, uint16_t ee_load_section_byte_size);
 
 uint8_t msgHandler(void);
 
@@ -217,7 +222,6 @@ uint8_t msgHandler()
         if(pgNumber >= UpdatePages)
         {
           nrk_kprintf(PSTR("PROGRAMMING COMPLETE\r\n"));
-          /* UpdateMode can be used to do a patch/full image update */
           nrk_led_set (ORANGE_LED);
           nrk_led_set (GREEN_LED);
           nrk_led_set (RED_LED);
@@ -236,10 +240,16 @@ uint8_t msgHandler()
           printf("ImgSize: %X\r\n", (uint16_t)LoadPages * (uint16_t)PAGESIZE);
           printf("UpdSize: %X\r\n", ((uint16_t)UpdatePages * (uint16_t)PAGESIZE) - UpdateLessBytes);
             
-          NanoPatch( ((uint16_t)UpdatePages * (uint16_t)PAGESIZE) - UpdateLessBytes,
-                      (uint16_t)LoadPages * (uint16_t)PAGESIZE,
+          // Rebuild the image from the running one and the acquired patch
+          if(UpdateMode == BLOCK_PATCH_MODE)
+            BlockPatch( ((uint16_t)UpdatePages * (uint16_t)PAGESIZE) - UpdateLessBytes,
+                        (uint16_t)LoadPages * (uint16_t)PAGESIZE
+                      );
+          else
+            NanoPatch( ((uint16_t)UpdatePages * (uint16_t)PAGESIZE) - UpdateLessBytes,
+                       (uint16_t)LoadPages * (uint16_t)PAGESIZE,
                        UpdateChecksum
-                  );
+                     );
         }
         else
           nrk_kprintf(PSTR("Wireless Update Error\r\n"));
@@ -20,7 +20,7 @@ int main(int argc, char **argv)
 	
   if(argc < 3)
   {
-    printf("USAGE: binder <filename.bin> <update_mode, 1:PATCH, 2:FULL_BIN_FLASH> \r\n");
+    printf("USAGE: binder <filename.bin> <update_mode, 1:PATCH, 2:FULL_BIN_FLASH, 3:BLOCK_PATCH> \r\n");
     return 1;
   }
   else
@@ -77,6 +77,8 @@ uint8_t count=0;
 uint8_t key=opt;
 uint8_t value=size;
 uint16_t val;
+nrk_sg_entry_t *list;
+uint8_t prev_channel;
 
      switch(action)
      {
@@ -111,6 +113,22 @@ uint16_t val;
 			      buffer[count]=(val>>8)  & 0xFF;
 			      count++;
                       return count;
+             case READ_SG:
+			      /* opt holds the number of entries, chan is the ADC channel */
+			      list=(nrk_sg_entry_t *)buffer;
+			      prev_channel=channel;
+			      for(count=0; count<opt; count++)
+			      {
+				      if(list[count].size<2) break;
+				      ADC_SET_CHANNEL (list[count].chan);
+				      val=get_adc_val();
+				      list[count].buf[0]=val & 0xFF;
+				      list[count].buf[1]=(val>>8) & 0xFF;
+				      list[count].len=2;
+			      }
+			      channel=prev_channel;
+			      ADC_SET_CHANNEL (channel);
+                      return count;
 
              case CLOSE:
                         return NRK_OK;
@@ -0,0 +1,163 @@
+/******************************************************************************
+*  Nano-RK, a real-time operating system for sensor networks.
+*  Copyright (C) 2007, Real-Time and Multimedia Lab, Carnegie Mellon University
+*  All rights reserved.
+*
+*  This is the Open Source Version of Nano-RK included as part of a Dual
+*  Licensing Model. If you are unsure which license to use please refer to:
+*  http://www.nanork.org/nano-RK/wiki/Licensing
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, version 2.0 of the License.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*  Contributing Authors (specific to this file):
+*  Zane Starr
+*  Anthony Rowe
+*******************************************************************************/
+
+
+#include <nrk_driver_list.h>
+#include <nrk_driver.h>
+#include <adc_driver.h>
+#include <include.h>
+#include <stdio.h>
+#include <ulib.h>
+#include <nrk_error.h>
+#include <nrk.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <nrk_timer.h>
+
+#define ADC_SETUP_DELAY  500
+
+uint8_t channel;
+
+// The host has no converter.  Each channel reads a fixed 10 bit value that
+// defaults to mid scale and can be set per channel from the environment,
+// e.g. NRK_POSIX_ADC2=700 for the light sensor on CHAN_2.
+#define ADC_CHANNELS	8
+#define ADC_DEFAULT	512
+
+static uint8_t adc_mux;
+static uint16_t adc_val[ADC_CHANNELS];
+
+#define ADC_SET_CHANNEL(channel) do { adc_mux = (channel) & (ADC_CHANNELS-1); } while (0)
+
+uint8_t dev_manager_adc(uint8_t action,uint8_t opt,uint8_t *buffer,uint8_t size)
+{
+uint8_t count=0;
+// key and value get passed as opt and size
+uint8_t key=opt;
+uint8_t value=size;
+uint16_t val;
+nrk_sg_entry_t *list;
+uint8_t prev_channel;
+
+     switch(action)
+     {
+            case INIT: 
+	     		init_adc();  
+		      return 1;
+	     
+	    case OPEN:   
+		    if(opt&READ_FLAG)
+		    {
+		   	return NRK_OK; 
+		    }
+		    if(opt&WRITE_FLAG)
+		    {
+		   	return NRK_ERROR; 
+		    }
+		    if(opt&APPEND_FLAG)
+		    {
+		   	return NRK_ERROR; 
+		    }
+		    if((opt&(READ_FLAG|WRITE_FLAG|APPEND_FLAG))==0)
+		    	return NRK_ERROR;
+		    else return NRK_OK;
+		
+	    
+
+             case READ:
+			      /* Conversion to 8-bit value*/
+			      val=get_adc_val();
+			      buffer[count]=val & 0xFF;
+			      count++;
+			      buffer[count]=(val>>8)  & 0xFF;
+			      count++;
+                      return count;
+             case READ_SG:
+			      /* opt holds the number of entries, chan is the ADC channel */
+			      list=(nrk_sg_entry_t *)buffer;
+			      prev_channel=channel;
+			      for(count=0; count<opt; count++)
+			      {
+				      if(list[count].size<2) break;
+				      ADC_SET_CHANNEL (list[count].chan);
+				      val=get_adc_val();
+				      list[count].buf[0]=val & 0xFF;
+				      list[count].buf[1]=(val>>8) & 0xFF;
+				      list[count].len=2;
+			      }
+			      channel=prev_channel;
+			      ADC_SET_CHANNEL (channel);
+                      return count;
+
+             case CLOSE:
+                        return NRK_OK;
+             
+	     case GET_STATUS:
+	     		// use "key" here 
+			if(key==ADC_CHAN) return channel;
+	     		return NRK_ERROR;
+			
+             case SET_STATUS:
+	     		// use "key" and "value" here
+  			if(key==ADC_CHAN) 
+			{
+				channel=value;
+				ADC_SET_CHANNEL (channel);
+				return NRK_OK;
+			}
+			return NRK_ERROR;
+	     default:
+		nrk_kernel_error_add(NRK_DEVICE_DRIVER,0);
+		 return 0;
+	}
+}
+
+void init_adc()
+{
+char name[16];
+char *env;
+uint8_t i;
+
+  // Initialize values here
+  for(i=0; i<ADC_CHANNELS; i++ )
+	{
+	sprintf(name,"NRK_POSIX_ADC%d",i);
+	env=getenv(name);
+	adc_val[i]=(env!=NULL) ? (uint16_t)(atoi(env) & 0x3FF) : ADC_DEFAULT;
+	}
+  channel=0;
+  ADC_SET_CHANNEL (0);
+}
+
+uint16_t get_adc_val()
+{                         
+	delay();
+	return adc_val[adc_mux];
+}
+void delay()
+{
+  nrk_spin_wait_us(ADC_SETUP_DELAY);
+}
@@ -0,0 +1,69 @@
+/*
+ * Host (POSIX) stand-in for the TWI (I2C) base calls.
+ *
+ * There is no I2C bus on the host: the bus can be opened and closed, but
+ * no slave ever answers its selection, so every transfer fails the same
+ * way the FireFly3 code does after MAX_ITER unanswered selections.
+ */
+
+#include <nrk.h>
+#include <include.h>
+#include <ulib.h>
+#include <stdio.h>
+#include <hal.h>
+#include <nrk_error.h>
+
+#include <inttypes.h>
+#include <twi_base_calls.h>
+
+/* TW_MT_SLA_NACK, the status an absent slave leaves behind */
+#define TWI_NO_SLAVE	0x20
+
+/*
+ * Saved TWI status register, for error messages only.
+ */
+uint8_t twst;
+
+uint8_t i2c_address; // The address of the slave node to write to
+
+void set_i2c_device(uint8_t address)
+{
+    i2c_address = address;
+}
+
+void init_i2c(void)
+{
+  PRR0 = PRR0 & 0x7F;
+}
+
+void close_i2c(void)
+{
+}
+
+int
+ee24xx_read_bytes(uint16_t eeaddr, int len, uint8_t *buf)
+{
+  twst = TWI_NO_SLAVE;
+  return -1;
+}
+
+int
+ee24xx_write_page(uint16_t eeaddr, int len, uint8_t *buf)
+{
+  twst = TWI_NO_SLAVE;
+  return -1;
+}
+
+int
+ee24xx_write_bytes(uint16_t eeaddr, int len, uint8_t *buf)
+{
+  return ee24xx_write_page(eeaddr, len, buf);
+}
+
+void
+error(void)
+{
+
+  printf("error: TWI status %#x\n", twst);
+
+}
@@ -29,6 +29,7 @@
 #include <nrk_ext_int.h>
 #include <nrk_error.h>
 #include <nrk_cfg.h>
+#include <nrk_trace.h>
 
 
 int8_t  nrk_ext_int_enable(uint8_t pin )
@@ -113,6 +114,7 @@ return NRK_ERROR;
 
 #ifndef NRK_DISABLE_EXT_INT
 SIGNAL(PCINT0_vect) {
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_PC_INT0);
 	if(pc_int0_callback!=NULL) pc_int0_callback();
 	else
 	nrk_kernel_error_add(NRK_SEG_FAULT,0);
@@ -121,6 +123,7 @@ SIGNAL(PCINT0_vect) {
 
 
 SIGNAL(INT0_vect) {
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_EXT_INT0);
 	if(ext_int0_callback!=NULL) ext_int0_callback();
 	else
 	nrk_kernel_error_add(NRK_SEG_FAULT,0);
@@ -128,6 +131,7 @@ SIGNAL(INT0_vect) {
 }
 
 SIGNAL(INT1_vect) {
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_EXT_INT1);
 	if(ext_int1_callback!=NULL) ext_int1_callback();
 	else
 	nrk_kernel_error_add(NRK_SEG_FAULT,0);
@@ -135,6 +139,7 @@ SIGNAL(INT1_vect) {
 }
 
 SIGNAL(INT2_vect) {
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_EXT_INT2);
 	if(ext_int2_callback!=NULL) ext_int2_callback();
 	else
 	nrk_kernel_error_add(NRK_SEG_FAULT,0);
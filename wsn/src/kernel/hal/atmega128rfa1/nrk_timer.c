@@ -29,6 +29,7 @@
 #include <nrk_timer.h>
 #include <nrk_error.h>
 #include <nrk_cfg.h>
+#include <nrk_trace.h>
 
 void nrk_spin_wait_us(uint16_t timeout)
 {
@@ -363,6 +364,7 @@ asm volatile (
 
 
 SIGNAL(TIMER3_COMPA_vect) {
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_APP_TIMER);
 	if(app_timer0_callback!=NULL) app_timer0_callback();
 	else
 	nrk_kernel_error_add(NRK_SEG_FAULT,0);
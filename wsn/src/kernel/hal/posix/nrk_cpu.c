@@ -0,0 +1,369 @@
+/*
+ * Host (POSIX) port of the Nano-RK CPU layer.
+ *
+ * Each task runs on its own ucontext with a host sized stack.  The NRK
+ * stack that the application hands to nrk_task_set_stk() only carries the
+ * canary, so that nrk_stack_check() keeps working, and its top address is
+ * the key used to find the task's context again from OSTaskStkPtr.
+ *
+ * The process is single threaded.  The global interrupt enable is a flag,
+ * and interrupt sources (registered file descriptors, the emulated timers
+ * and pin change logic) are sampled whenever the kernel re-enables
+ * interrupts, spins or idles.  An OS tick that comes due swaps the running
+ * task out to a fresh kernel context that calls _nrk_timer_tick(), just as
+ * TIMER2_COMPA_vect does on the AVR.
+ */
+
+#define _GNU_SOURCE
+#include <include.h>
+#include <nrk.h>
+#include <avr/sleep.h>
+#include <nrk_stack_check.h>
+#include <nrk_task.h>
+#include <nrk_defs.h>
+#include <nrk_cfg.h>
+#include <nrk_timer.h>
+#include <nrk_error.h>
+#include <nrk_scheduler.h>
+#include <ucontext.h>
+#include <poll.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Host stack for each task and for the kernel; NRK stack sizes are tuned
+// for the AVR and are far too small for glibc's printf
+#define POSIX_TASK_STK_SIZE	(64*1024)
+#define POSIX_KERNEL_STK_SIZE	(64*1024)
+
+#define POSIX_MAX_IRQ_SRC	8
+
+// File descriptors are checked at most this often outside of idle, so that
+// a busy task calling nrk_int_enable() does not turn into a syscall storm
+#define POSIX_FD_POLL_NS	1000000ULL
+
+// Upper bound on a single idle sleep so that sources without a file
+// descriptor (button release, GPIO edges) are still serviced promptly
+#define POSIX_IDLE_MAX_NS	10000000ULL
+
+typedef struct {
+    void *ptos;
+    void (*task)();
+    ucontext_t ctx;
+    uint8_t stk[POSIX_TASK_STK_SIZE];
+} posix_task_ctx_t;
+
+typedef struct {
+    int fd;
+    void (*isr)(void);
+} posix_irq_src_t;
+
+static posix_task_ctx_t _nrk_posix_task[NRK_MAX_TASKS];
+static ucontext_t _nrk_posix_kernel_ctx;
+static uint8_t _nrk_posix_kernel_stk[POSIX_KERNEL_STK_SIZE];
+
+static posix_irq_src_t _nrk_posix_irq_src[POSIX_MAX_IRQ_SRC];
+static uint8_t _nrk_posix_irq_cnt;
+static uint64_t _nrk_posix_fd_last;
+static uint64_t _nrk_posix_wake_ns = ~0ULL;	// earliest wake asked for by a source
+static volatile sig_atomic_t _nrk_posix_exit_req;
+
+static volatile uint8_t _nrk_posix_int_on;	// I bit of SREG
+static uint8_t _nrk_posix_in_isr;		// an ISR body is running
+static uint8_t _nrk_posix_in_kernel;		// the scheduler owns the CPU
+
+static void _nrk_posix_dispatch(uint8_t block, uint64_t timeout_ns);
+
+
+void nrk_battery_save()
+{
+}
+
+void nrk_sleep()
+{
+    nrk_idle();
+}
+
+void nrk_idle()
+{
+    uint64_t now, deadline, timeout;
+
+    // Sleeping with interrupts off would never wake on the AVR either
+    if(!_nrk_posix_int_on || _nrk_posix_in_isr) return;
+
+    now=_nrk_posix_now_ns();
+    deadline=_nrk_posix_timer_deadline();
+    if(_nrk_posix_wake_ns<deadline) deadline=_nrk_posix_wake_ns;
+    timeout=(deadline>now) ? deadline-now : 0;
+    if(timeout>POSIX_IDLE_MAX_NS) timeout=POSIX_IDLE_MAX_NS;
+    _nrk_posix_dispatch(1, timeout);
+}
+
+void nrk_task_set_entry_function( nrk_task_type *task, void *func )
+{
+task->task=func;
+}
+
+void nrk_task_set_stk( nrk_task_type *task, NRK_STK stk_base[], uint16_t stk_size )
+{
+
+if(stk_size<32) nrk_error_add(NRK_STACK_TOO_SMALL);
+task->Ptos = (void *) &stk_base[stk_size-1];
+task->Pbos = (void *) &stk_base[0];
+
+}
+
+static posix_task_ctx_t *_nrk_posix_task_ctx(void *ptos)
+{
+uint8_t i;
+
+for(i=0; i<NRK_MAX_TASKS; i++ )
+	if(_nrk_posix_task[i].ptos==ptos) return &_nrk_posix_task[i];
+return NULL;
+}
+
+static void _nrk_posix_task_entry(int slot)
+{
+    // The first dispatch comes straight from nrk_start_high_ready_task(),
+    // so pick up anything that arrived while the scheduler ran
+    _nrk_posix_irq_poll();
+    _nrk_posix_task[slot].task();
+
+    // Nano-RK tasks never return; on the AVR this would pop garbage
+    nrk_kernel_error_add(NRK_SEG_FAULT,nrk_cur_task_TCB->task_ID);
+    exit(EXIT_FAILURE);
+}
+
+void *nrk_task_stk_init (void (*task)(), void *ptos, void *pbos)
+{
+    posix_task_ctx_t *t;
+
+    *((uint8_t *)pbos) = STK_CANARY_VAL;  // Flag for Stack Overflow
+
+    // Re-activating a task reuses its slot, otherwise take a free one
+    t=_nrk_posix_task_ctx(ptos);
+    if(t==NULL) t=_nrk_posix_task_ctx(NULL);
+    if(t==NULL)
+	{
+	nrk_kernel_error_add(NRK_EXTRA_TASK,0);
+	return ptos;
+	}
+
+    t->ptos=ptos;
+    t->task=task;
+    getcontext(&t->ctx);
+    t->ctx.uc_stack.ss_sp=t->stk;
+    t->ctx.uc_stack.ss_size=sizeof(t->stk);
+    t->ctx.uc_link=NULL;
+    makecontext(&t->ctx,(void (*)())_nrk_posix_task_entry,1,(int)(t-_nrk_posix_task));
+
+    return ptos;
+}
+
+inline void nrk_stack_pointer_init()
+{
+        nrk_kernel_stk[0]=STK_CANARY_VAL;
+        nrk_kernel_stk_ptr = &nrk_kernel_stk[NRK_KERNEL_STACKSIZE-1];
+}
+
+inline void nrk_stack_pointer_restore()
+{
+	// The kernel context is rebuilt on every tick
+}
+
+void nrk_start_high_ready_task()
+{
+    posix_task_ctx_t *t;
+
+    t=_nrk_posix_task_ctx(nrk_high_ready_TCB->OSTaskStkPtr);
+    if(t==NULL)
+	{
+	nrk_kernel_error_add(NRK_INVALID_STACK_POINTER,nrk_high_ready_TCB->task_ID);
+	exit(EXIT_FAILURE);
+	}
+    // reti
+    _nrk_posix_in_kernel=0;
+    _nrk_posix_int_on=1;
+    setcontext(&t->ctx);
+}
+
+static void _nrk_posix_exit_signal(int sig)
+{
+    _nrk_posix_exit_req=1;
+}
+
+static void _nrk_posix_kernel_entry()
+{
+    // _nrk_scheduler() ends in nrk_start_high_ready_task() and never returns
+    _nrk_timer_tick();
+}
+
+// This is the SUSPEND for the OS timer Tick
+static void _nrk_posix_os_tick()
+{
+    posix_task_ctx_t *t;
+
+    t=_nrk_posix_task_ctx(nrk_cur_task_TCB->OSTaskStkPtr);
+    if(t==NULL) return;
+    _nrk_posix_int_on=0;
+    _nrk_posix_in_kernel=1;
+    _nrk_posix_os_timer_ack();
+
+    getcontext(&_nrk_posix_kernel_ctx);
+    _nrk_posix_kernel_ctx.uc_stack.ss_sp=_nrk_posix_kernel_stk;
+    _nrk_posix_kernel_ctx.uc_stack.ss_size=sizeof(_nrk_posix_kernel_stk);
+    _nrk_posix_kernel_ctx.uc_link=NULL;
+    makecontext(&_nrk_posix_kernel_ctx,_nrk_posix_kernel_entry,0);
+    swapcontext(&t->ctx,&_nrk_posix_kernel_ctx);
+}
+
+int8_t _nrk_posix_irq_register(int fd, void (*isr)(void))
+{
+    if(_nrk_posix_irq_cnt>=POSIX_MAX_IRQ_SRC) return NRK_ERROR;
+    _nrk_posix_irq_src[_nrk_posix_irq_cnt].fd=fd;
+    _nrk_posix_irq_src[_nrk_posix_irq_cnt].isr=isr;
+    _nrk_posix_irq_cnt++;
+    return NRK_OK;
+}
+
+void _nrk_posix_irq_unregister(void (*isr)(void))
+{
+    uint8_t i;
+
+    // The slot stays in place and is skipped from now on
+    for(i=0; i<_nrk_posix_irq_cnt; i++ )
+	if(_nrk_posix_irq_src[i].isr==isr)
+		{
+		_nrk_posix_irq_src[i].fd=-1;
+		_nrk_posix_irq_src[i].isr=NULL;
+		}
+}
+
+static void _nrk_posix_dispatch(uint8_t block, uint64_t timeout_ns)
+{
+    struct pollfd pfd[POSIX_MAX_IRQ_SRC];
+    struct timespec ts;
+    uint64_t now;
+    uint8_t i,n;
+    int r;
+
+    // SIGTERM and SIGINT end the process here, where exit() is safe to call
+    if(_nrk_posix_exit_req) exit(EXIT_SUCCESS);
+
+    now=_nrk_posix_now_ns();
+    r=0;
+    if(block || now-_nrk_posix_fd_last>=POSIX_FD_POLL_NS)
+	{
+	n=0;
+	for(i=0; i<_nrk_posix_irq_cnt; i++ )
+		{
+		pfd[i].fd=_nrk_posix_irq_src[i].fd;
+		pfd[i].events=POLLIN;
+		pfd[i].revents=0;
+		if(pfd[i].fd>=0) n++;
+		}
+	ts.tv_sec=block ? timeout_ns/1000000000ULL : 0;
+	ts.tv_nsec=block ? timeout_ns%1000000000ULL : 0;
+	// ppoll() ignores negative descriptors, and a signal (the button)
+	// cuts the sleep short with EINTR
+	if(n>0 || block) r=ppoll(pfd,_nrk_posix_irq_cnt,&ts,NULL);
+	if(r<0) r=0;
+	_nrk_posix_fd_last=now;
+	}
+
+    // ISR bodies run with interrupts disabled, as on the AVR.  Sources that
+    // still need a wake up ask for it again from their ISR.
+    _nrk_posix_in_isr=1;
+    _nrk_posix_int_on=0;
+    _nrk_posix_wake_ns=~0ULL;
+    for(i=0; i<_nrk_posix_irq_cnt; i++ )
+	{
+	if(_nrk_posix_irq_src[i].isr==NULL) continue;
+	if(_nrk_posix_irq_src[i].fd<0 ||
+	   (r>0 && (pfd[i].revents & (POLLIN|POLLHUP|POLLERR))))
+		_nrk_posix_irq_src[i].isr();
+	}
+    _nrk_posix_ext_int_isr();
+    _nrk_posix_app_timer_isr();
+    _nrk_posix_in_isr=0;
+    _nrk_posix_int_on=1;
+
+    if(!_nrk_posix_in_kernel && nrk_cur_task_TCB!=NULL && _nrk_posix_os_timer_due())
+	_nrk_posix_os_tick();
+}
+
+void _nrk_posix_irq_wake(uint64_t t)
+{
+    if(t<_nrk_posix_wake_ns) _nrk_posix_wake_ns=t;
+}
+
+void _nrk_posix_sleep_until(uint64_t t)
+{
+    struct timespec ts;
+    uint64_t now,deadline;
+
+    while((now=_nrk_posix_now_ns())<t)
+	{
+	if(!_nrk_posix_int_on || _nrk_posix_in_isr)
+		{
+		// Nothing can be delivered, so there is nothing to wake up for
+		ts.tv_sec=t/1000000000ULL;
+		ts.tv_nsec=t%1000000000ULL;
+		clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&ts,NULL);
+		continue;
+		}
+	deadline=_nrk_posix_timer_deadline();
+	if(_nrk_posix_wake_ns<deadline) deadline=_nrk_posix_wake_ns;
+	if(t<deadline) deadline=t;
+	_nrk_posix_dispatch(1,(deadline>now) ? deadline-now : 0);
+	}
+}
+
+void _nrk_posix_irq_poll()
+{
+    if(!_nrk_posix_int_on || _nrk_posix_in_isr) return;
+    _nrk_posix_dispatch(0,0);
+}
+
+void _nrk_posix_int_enable()
+{
+    _nrk_posix_int_on=1;
+    _nrk_posix_irq_poll();
+}
+
+void _nrk_posix_int_disable()
+{
+    _nrk_posix_int_on=0;
+}
+
+uint8_t _nrk_posix_int_save()
+{
+    uint8_t state=_nrk_posix_int_on;
+
+    _nrk_posix_int_on=0;
+    return state;
+}
+
+void _nrk_posix_int_restore(uint8_t state)
+{
+    if(state) _nrk_posix_int_enable();
+    else _nrk_posix_int_on=0;
+}
+
+/* start the target running */
+void nrk_target_start(void)
+{
+  struct sigaction sa;
+
+  // Let atexit() handlers (e.g. the radio statistics) run on a kill
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler=_nrk_posix_exit_signal;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGTERM,&sa,NULL);
+  sigaction(SIGINT,&sa,NULL);
+
+  _nrk_setup_timer();
+  nrk_int_enable();
+
+}
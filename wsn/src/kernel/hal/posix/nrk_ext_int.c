@@ -0,0 +1,130 @@
+/*
+ * Host (POSIX) port of the Nano-RK external interrupts.
+ *
+ * INT0-INT2 sit on PD0-PD2 and PCINT0-7 on PB0-PB7, as on the FireFly3.
+ * ulib.c reports every level change on those pins through
+ * _nrk_posix_ext_int_pin(), which latches the interrupt flags the way EIFR
+ * and PCIFR do; nrk_cpu.c then runs the handlers of the unmasked ones.
+ */
+
+#include <include.h>
+#include <ulib.h>
+#include <nrk_ext_int.h>
+#include <nrk_error.h>
+#include <nrk_cfg.h>
+#include <nrk_trace.h>
+
+static uint8_t _nrk_posix_eimsk;	// INT0-INT2 enables
+static uint8_t _nrk_posix_eifr;		// INT0-INT2 flags
+static uint8_t _nrk_posix_eicra[3];	// trigger mode of each INTn
+static uint8_t _nrk_posix_pcmsk0;	// PCINT0-7 enables
+static uint8_t _nrk_posix_pcie0;
+static uint8_t _nrk_posix_pcif0;
+
+
+int8_t  nrk_ext_int_enable(uint8_t pin )
+{
+if(pin==NRK_EXT_INT_0 || pin==NRK_EXT_INT_1 || pin==NRK_EXT_INT_2)
+	{
+	_nrk_posix_eimsk |= BM(pin);
+	return NRK_OK;
+	}
+if(pin>=NRK_PC_INT_0 && pin<=NRK_PC_INT_7)
+	{
+	_nrk_posix_pcmsk0 |= BM(pin-NRK_PC_INT_0);
+	return NRK_OK;
+	}
+return NRK_ERROR;
+}
+
+int8_t  nrk_ext_int_disable(uint8_t pin )
+{
+if(pin==NRK_EXT_INT_0 || pin==NRK_EXT_INT_1 || pin==NRK_EXT_INT_2)
+	{
+	_nrk_posix_eimsk &= ~BM(pin);
+	return NRK_OK;
+	}
+if(pin>=NRK_PC_INT_0 && pin<=NRK_PC_INT_7)
+	{
+	_nrk_posix_pcmsk0 &= ~BM(pin-NRK_PC_INT_0);
+	return NRK_OK;
+	}
+return NRK_ERROR;
+}
+
+
+
+int8_t  nrk_ext_int_configure(uint8_t pin, uint8_t mode, void *callback_func)
+{
+if(pin==NRK_EXT_INT_0 || pin==NRK_EXT_INT_1 || pin==NRK_EXT_INT_2)
+	{
+	if(pin==NRK_EXT_INT_0) ext_int0_callback=callback_func;
+	if(pin==NRK_EXT_INT_1) ext_int1_callback=callback_func;
+	if(pin==NRK_EXT_INT_2) ext_int2_callback=callback_func;
+	_nrk_posix_eicra[pin]=mode;
+	return NRK_OK;
+	}
+
+if(pin>=NRK_PC_INT_0 && pin<=NRK_PC_INT_7)
+	{
+	_nrk_posix_pcie0=1;
+	pc_int0_callback=callback_func;
+	return NRK_OK;
+	}
+return NRK_ERROR;
+}
+
+void _nrk_posix_ext_int_pin(uint8_t port, uint8_t bit, uint8_t level)
+{
+uint8_t mode;
+
+if(port==NRK_PORTD && bit<=2)
+	{
+	mode=_nrk_posix_eicra[bit];
+	// The low level trigger is sampled in the ISR dispatch below
+	if((mode==NRK_LEVEL_TRIGGER) ||
+	   (mode==NRK_FALLING_EDGE && level==0) ||
+	   (mode==NRK_RISING_EDGE && level!=0))
+		_nrk_posix_eifr |= BM(bit);
+	}
+if(port==NRK_PORTB && (_nrk_posix_pcmsk0 & BM(bit)))
+	_nrk_posix_pcif0=1;
+}
+
+static void (*_nrk_posix_ext_int_callback(uint8_t n))(void)
+{
+if(n==NRK_EXT_INT_0) return ext_int0_callback;
+if(n==NRK_EXT_INT_1) return ext_int1_callback;
+return ext_int2_callback;
+}
+
+void _nrk_posix_ext_int_isr()
+{
+#ifndef NRK_DISABLE_EXT_INT
+void (*callback)(void);
+uint8_t n;
+
+for(n=0; n<3; n++ )
+	{
+	if(_nrk_posix_eicra[n]==NRK_LOW_TRIGGER && (_nrk_posix_eimsk & BM(n)) &&
+	   (PIND & BM(n))==0)
+		_nrk_posix_eifr |= BM(n);
+	if((_nrk_posix_eimsk & _nrk_posix_eifr & BM(n))==0) continue;
+	_nrk_posix_eifr &= ~BM(n);
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_EXT_INT0+n);
+	callback=_nrk_posix_ext_int_callback(n);
+	if(callback!=NULL) callback();
+	else
+	nrk_kernel_error_add(NRK_SEG_FAULT,0);
+	}
+
+if(_nrk_posix_pcie0 && _nrk_posix_pcif0)
+	{
+	_nrk_posix_pcif0=0;
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_PC_INT0);
+	if(pc_int0_callback!=NULL) pc_int0_callback();
+	else
+	nrk_kernel_error_add(NRK_SEG_FAULT,0);
+	}
+#endif
+}
@@ -0,0 +1,27 @@
+/*
+ * Host (POSIX) port of the Nano-RK startup status check.
+ *
+ * A host process always starts from a clean power-on, except when the
+ * emulated watchdog re-executed it (see nrk_watchdog.c), which is reported
+ * the same way the atmega128rfa1 reports WDRF.
+ */
+
+#include <include.h>
+#include <nrk_status.h>
+#include <nrk_watchdog.h>
+#include <nrk_error.h>
+
+uint8_t _nrk_startup_error()
+{
+uint8_t error;
+error=0;
+
+// Check Watchdog timer
+if(nrk_watchdog_check()==NRK_ERROR)
+	{
+	// don't clear wdt
+	error|=0x10;
+	}
+
+return error;
+}
@@ -0,0 +1,353 @@
+/*
+ * Host (POSIX) port of the Nano-RK timers.
+ *
+ * All timers are derived from CLOCK_MONOTONIC and keep the FireFly3
+ * (atmega128rfa1) semantics:
+ *   - the OS tick timer is timer 2 in CTC mode at TICKS_PER_SEC, and a
+ *     compare match restarts the count from zero,
+ *   - the precision timer is timer 5 counting 16 MHz cycles within a tick,
+ *   - the high speed timer is the free running 16 bit timer 1 at 16 MHz,
+ *   - application timer 0 is timer 3 in CTC mode behind the usual
+ *     /1, /8, /64, /256, /1024 prescaler codes.
+ * Compare matches are delivered by nrk_cpu.c through the hooks at the end.
+ */
+
+#define _GNU_SOURCE
+#include <include.h>
+#include <ulib.h>
+#include <nrk_timer.h>
+#include <nrk_error.h>
+#include <nrk_cfg.h>
+#include <nrk_trace.h>
+#include <nrk_platform_time.h>
+#include <time.h>
+
+#define POSIX_CPU_HZ		16000000ULL
+#define POSIX_NS_PER_SEC	1000000000ULL
+
+// How far the OS tick may fall behind (a stopped debugger, a loaded host)
+// before the count restarts from now instead of replaying missed ticks
+#define POSIX_OS_TIMER_MAX_LAG	250
+
+// CPU cycles between two host time stamps
+#define POSIX_CYCLES(dt)	(((dt)*(POSIX_CPU_HZ/1000000ULL))/1000ULL)
+
+static const uint16_t _nrk_posix_app_prescale[6] = { 0, 1, 8, 64, 256, 1024 };
+
+// Timer 2: OS tick
+static uint64_t _nrk_posix_os_base;	// host time at which TCNT2 was 0
+static uint8_t _nrk_posix_os_ocr;	// OCR2A
+static uint8_t _nrk_posix_os_run;	// clock selected
+static uint8_t _nrk_posix_os_int;	// OCIE2A
+static uint8_t _nrk_posix_os_held;	// TCNT2 while the clock is stopped
+
+// Timer 5: precision OS timer
+static uint64_t _nrk_posix_prec_base;
+static uint8_t _nrk_posix_prec_run;
+static uint16_t _nrk_posix_prec_held;
+
+// Timer 1: high speed timer
+static uint64_t _nrk_posix_hs_base;
+static uint8_t _nrk_posix_hs_run;
+static uint16_t _nrk_posix_hs_held;
+
+// Timer 3: application timer 0
+static uint64_t _nrk_posix_app_base;
+static uint16_t _nrk_posix_app_ocr;
+static uint8_t _nrk_posix_app_int;
+
+uint64_t _nrk_posix_now_ns()
+{
+struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (uint64_t)ts.tv_sec*POSIX_NS_PER_SEC+(uint64_t)ts.tv_nsec;
+}
+
+void nrk_spin_wait_us(uint16_t timeout)
+{
+uint64_t end;
+
+  end=_nrk_posix_now_ns()+(uint64_t)timeout*1000ULL;
+  // Interrupts are taken while spinning, as they would be on the AVR, but
+  // the host sleeps in between instead of burning a core
+  _nrk_posix_sleep_until(end);
+}
+
+
+void _nrk_setup_timer() {
+  _nrk_prev_timer_val=254;
+  _nrk_posix_os_ocr=_nrk_prev_timer_val;
+
+  _nrk_high_speed_timer_reset();
+  _nrk_high_speed_timer_start();
+
+  _nrk_os_timer_reset();
+  _nrk_precision_os_timer_reset();
+  _nrk_os_timer_start();
+  _nrk_precision_os_timer_start();
+  _nrk_time_trigger=0;
+}
+
+void _nrk_precision_os_timer_stop()
+{
+  _nrk_posix_prec_held=_nrk_precision_os_timer_get();
+  _nrk_posix_prec_run=0;
+}
+
+void _nrk_precision_os_timer_start()
+{
+  if(_nrk_posix_prec_run) return;
+  _nrk_posix_prec_base=_nrk_posix_now_ns()-
+	(uint64_t)_nrk_posix_prec_held*POSIX_NS_PER_SEC/POSIX_CPU_HZ;
+  _nrk_posix_prec_run=1;
+}
+
+void _nrk_precision_os_timer_reset()
+{
+  _nrk_posix_prec_base=_nrk_posix_now_ns();
+  _nrk_posix_prec_held=0;
+}
+
+inline uint16_t _nrk_precision_os_timer_get()
+{
+  if(!_nrk_posix_prec_run) return _nrk_posix_prec_held;
+  // Counts up to PRECISION_TICKS_PER_TICK and then restarts at 0
+  return POSIX_CYCLES(_nrk_posix_now_ns()-_nrk_posix_prec_base)%(PRECISION_TICKS_PER_TICK+1);
+}
+
+void _nrk_high_speed_timer_stop()
+{
+  _nrk_posix_hs_held=_nrk_high_speed_timer_get();
+  _nrk_posix_hs_run=0;
+}
+
+void _nrk_high_speed_timer_start()
+{
+  if(_nrk_posix_hs_run) return;
+  _nrk_posix_hs_base=_nrk_posix_now_ns()-
+	(uint64_t)_nrk_posix_hs_held*POSIX_NS_PER_SEC/POSIX_CPU_HZ;
+  _nrk_posix_hs_run=1;
+}
+
+void _nrk_high_speed_timer_reset()
+{
+  _nrk_posix_hs_base=_nrk_posix_now_ns();
+  _nrk_posix_hs_held=0;
+}
+
+/**
+  This function blocks for n ticks of the high speed timer after the
+  start number of ticks.  It will handle the overflow that can occur.
+  Do not use this for delays longer than 8ms!
+*/
+void nrk_high_speed_timer_wait( uint16_t start, uint16_t ticks )
+{
+uint32_t tmp;
+
+// Adjust for 16MHz clock
+// Copy into tmp to avoid overflow problem
+tmp=start*2;
+if(tmp>65400) start=0;
+else start=tmp;
+tmp=(uint32_t)start+(uint32_t)ticks;
+if(tmp>65536)
+	{
+	tmp-=65536;
+	do{}while(_nrk_high_speed_timer_get()>start);
+	}
+
+ticks=tmp;
+do{}while(_nrk_high_speed_timer_get()<ticks);
+}
+
+inline uint16_t _nrk_high_speed_timer_get()
+{
+  if(!_nrk_posix_hs_run) return _nrk_posix_hs_held;
+  return (uint16_t)POSIX_CYCLES(_nrk_posix_now_ns()-_nrk_posix_hs_base);
+}
+
+static uint16_t _nrk_posix_os_count(uint64_t now)
+{
+uint64_t n;
+
+  if(!_nrk_posix_os_run) return _nrk_posix_os_held;
+  if(now<_nrk_posix_os_base) return 0;
+  n=(now-_nrk_posix_os_base)/NANOS_PER_TICK;
+  return (n>0xFFFF) ? 0xFFFF : (uint16_t)n;
+}
+
+inline void _nrk_os_timer_stop()
+{
+  _nrk_posix_os_held=_nrk_os_timer_get();
+  _nrk_posix_os_run=0;
+  _nrk_posix_os_int=0;
+}
+
+inline void _nrk_os_timer_set(uint8_t v)
+{
+  _nrk_posix_os_base=_nrk_posix_now_ns()-(uint64_t)v*NANOS_PER_TICK;
+  _nrk_posix_os_held=v;
+}
+
+inline void _nrk_os_timer_start()
+{
+  _nrk_posix_os_int=1;
+  if(_nrk_posix_os_run) return;
+  _nrk_os_timer_set(_nrk_posix_os_held);
+  _nrk_posix_os_run=1;
+}
+
+inline void _nrk_os_timer_reset()
+{
+    _nrk_posix_os_base=_nrk_posix_now_ns();
+    _nrk_posix_os_held=0;
+    _nrk_time_trigger=0;
+    _nrk_prev_timer_val=0;
+}
+
+
+uint8_t _nrk_get_next_wakeup()
+{
+	return (uint8_t)(_nrk_posix_os_ocr+1);
+}
+
+void _nrk_set_next_wakeup(uint8_t nw)
+{
+   _nrk_posix_os_ocr = nw-1;
+}
+
+int8_t nrk_timer_int_stop(uint8_t timer )
+{
+if(timer==NRK_APP_TIMER_0)
+	{
+	_nrk_posix_app_int=0;
+	return NRK_OK;
+	}
+return NRK_ERROR;
+}
+
+int8_t nrk_timer_int_reset(uint8_t timer )
+{
+if(timer==NRK_APP_TIMER_0)
+	{
+	_nrk_posix_app_base=_nrk_posix_now_ns();
+	return NRK_OK;
+	}
+return NRK_ERROR;
+}
+
+static uint64_t _nrk_posix_app_tick_ns(uint16_t ticks)
+{
+  return (uint64_t)ticks*_nrk_posix_app_prescale[app_timer0_prescale]*POSIX_NS_PER_SEC/POSIX_CPU_HZ;
+}
+
+uint16_t nrk_timer_int_read(uint8_t timer )
+{
+uint64_t dt;
+
+if(timer==NRK_APP_TIMER_0)
+	{
+	if(app_timer0_prescale==0) return 0;
+	dt=_nrk_posix_now_ns()-_nrk_posix_app_base;
+	return (uint16_t)(dt/_nrk_posix_app_tick_ns(1));
+	}
+return 0;
+
+}
+
+int8_t  nrk_timer_int_start(uint8_t timer)
+{
+if(timer==NRK_APP_TIMER_0)
+	{
+	_nrk_posix_app_int=1;
+	return NRK_OK;
+	}
+return NRK_ERROR;
+}
+
+int8_t  nrk_timer_int_configure(uint8_t timer, uint16_t prescaler, uint16_t compare_value, void *callback_func)
+{
+if(timer==NRK_APP_TIMER_0)
+	{
+	if(prescaler>0 && prescaler<6 ) app_timer0_prescale=prescaler;
+	_nrk_posix_app_ocr=compare_value;
+	app_timer0_callback=callback_func;
+	_nrk_posix_app_base=_nrk_posix_now_ns();
+	return NRK_OK;
+	}
+
+return NRK_ERROR;
+}
+
+
+inline uint8_t _nrk_os_timer_get()
+{
+uint16_t n;
+
+  n=_nrk_posix_os_count(_nrk_posix_now_ns());
+  return (n>0xFF) ? 0xFF : (uint8_t)n;
+}
+
+//--------------------------------------------------------------------------------------
+//  Interrupt hooks used by nrk_cpu.c
+//--------------------------------------------------------------------------------------
+
+static uint64_t _nrk_posix_os_compare_time()
+{
+  return _nrk_posix_os_base+((uint64_t)_nrk_posix_os_ocr+1)*NANOS_PER_TICK;
+}
+
+static uint64_t _nrk_posix_app_compare_time()
+{
+  return _nrk_posix_app_base+_nrk_posix_app_tick_ns(_nrk_posix_app_ocr+1);
+}
+
+// Host time of the next enabled compare match, or ~0 if there is none
+uint64_t _nrk_posix_timer_deadline()
+{
+uint64_t d,t;
+
+  d=~0ULL;
+  if(_nrk_posix_os_run && _nrk_posix_os_int) d=_nrk_posix_os_compare_time();
+  if(_nrk_posix_app_int && app_timer0_prescale!=0)
+	{
+	t=_nrk_posix_app_compare_time();
+	if(t<d) d=t;
+	}
+  return d;
+}
+
+uint8_t _nrk_posix_os_timer_due()
+{
+  if(!_nrk_posix_os_run || !_nrk_posix_os_int) return 0;
+  return _nrk_posix_now_ns()>=_nrk_posix_os_compare_time();
+}
+
+// Compare match in CTC mode: the count restarts from zero at the match
+void _nrk_posix_os_timer_ack()
+{
+uint64_t now;
+
+  now=_nrk_posix_now_ns();
+  _nrk_posix_os_base=_nrk_posix_os_compare_time();
+  if(now>_nrk_posix_os_base+(uint64_t)POSIX_OS_TIMER_MAX_LAG*NANOS_PER_TICK)
+	_nrk_posix_os_base=now;
+}
+
+void _nrk_posix_app_timer_isr()
+{
+uint64_t now;
+
+  if(!_nrk_posix_app_int || app_timer0_prescale==0) return;
+  now=_nrk_posix_now_ns();
+  if(now<_nrk_posix_app_compare_time()) return;
+  _nrk_posix_app_base=_nrk_posix_app_compare_time();
+  if(now>=_nrk_posix_app_compare_time()) _nrk_posix_app_base=now;
+
+	NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_APP_TIMER);
+	if(app_timer0_callback!=NULL) app_timer0_callback();
+	else
+	nrk_kernel_error_add(NRK_SEG_FAULT,0);
+	return;
+}
@@ -0,0 +1,108 @@
+/*
+ * Host (POSIX) port of the Nano-RK watchdog.
+ *
+ * The watchdog is a one-shot SIGALRM interval timer that every
+ * nrk_watchdog_reset() re-arms.  When it expires the process re-executes
+ * itself, which is the closest host equivalent of a watchdog reset: all
+ * RAM state is lost, while the EEPROM image and the UART pty (see ulib.c)
+ * survive.  The new image sees the reset cause through
+ * nrk_watchdog_check(), just like WDRF in MCUSR on the AVR.
+ *
+ * The timeout is longer than the 0.5 s of the FireFly3 to allow for host
+ * scheduling jitter.
+ */
+
+#define _GNU_SOURCE
+#include <include.h>
+#include <nrk_watchdog.h>
+#include <nrk_error.h>
+#include <nrk.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#define POSIX_WDT_TIMEOUT_SEC	1
+
+// MCUSR.WDRF for the next image; patched in place from the signal handler
+// "NRK_POSIX_RESET=" is 16 characters long
+#define POSIX_RESET_VAR		"NRK_POSIX_RESET"
+static char _nrk_posix_reset_env[]=POSIX_RESET_VAR "=por";
+#define POSIX_RESET_CAUSE	(_nrk_posix_reset_env+sizeof(POSIX_RESET_VAR))
+
+static uint8_t _nrk_posix_wdrf;
+static uint8_t _nrk_posix_wdt_on;
+static char **_nrk_posix_argv;
+
+// glibc passes the program arguments to ELF constructors
+static void __attribute__ ((constructor)) _nrk_posix_wdt_boot(int argc, char **argv)
+{
+char *cause;
+sigset_t set;
+
+_nrk_posix_argv=argv;
+cause=getenv(POSIX_RESET_VAR);
+if(cause!=NULL && strcmp(cause,"wdt")==0) _nrk_posix_wdrf=1;
+putenv(_nrk_posix_reset_env);
+
+// A mask inherited across the re-exec would silence the next watchdog
+sigemptyset(&set);
+sigaddset(&set,SIGALRM);
+sigprocmask(SIG_UNBLOCK,&set,NULL);
+}
+
+static void _nrk_posix_wdt_expired(int sig)
+{
+static const char msg[]="nrk: watchdog reset\n";
+
+if(write(STDERR_FILENO,msg,sizeof(msg)-1)<0) { }
+memcpy(POSIX_RESET_CAUSE,"wdt",3);
+execv("/proc/self/exe",_nrk_posix_argv);
+_exit(EXIT_FAILURE);
+}
+
+static void _nrk_posix_wdt_arm(time_t sec)
+{
+struct itimerval it;
+
+memset(&it,0,sizeof(it));
+it.it_value.tv_sec=sec;
+setitimer(ITIMER_REAL,&it,NULL);
+}
+
+void nrk_watchdog_disable()
+{
+nrk_int_disable();
+_nrk_posix_wdt_on=0;
+_nrk_posix_wdt_arm(0);
+_nrk_posix_wdrf=0;
+nrk_int_enable();
+}
+
+void nrk_watchdog_enable()
+{
+struct sigaction sa;
+
+nrk_int_disable();
+memset(&sa,0,sizeof(sa));
+sa.sa_handler=_nrk_posix_wdt_expired;
+sigemptyset(&sa.sa_mask);
+sigaction(SIGALRM,&sa,NULL);
+_nrk_posix_wdrf=0;
+_nrk_posix_wdt_on=1;
+nrk_watchdog_reset();
+nrk_int_enable();
+}
+
+int8_t nrk_watchdog_check()
+{
+
+if(_nrk_posix_wdrf==0) return NRK_OK;
+return NRK_ERROR;
+}
+
+inline void nrk_watchdog_reset()
+{
+if(_nrk_posix_wdt_on) _nrk_posix_wdt_arm(POSIX_WDT_TIMEOUT_SEC);
+}
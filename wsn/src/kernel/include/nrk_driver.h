@@ -43,6 +43,10 @@
 #define SET_STATUS	4
 #define READ		5
 #define WRITE		6
+#define READ_SG		7
+
+// No completion signal for nrk_read_sg()
+#define NRK_SG_NO_SIGNAL	-1
 
 // Access Privileges Bits
 #define READ_FLAG 	1
@@ -61,11 +65,23 @@ typedef struct nrk_driver
 
 } NRKDriver;
 
+// One element of a scatter list passed to nrk_read_sg().  The meaning of
+// chan is driver specific (ADC channel, register address...).  The driver
+// fills buf directly and sets len to the number of bytes written.
+typedef struct nrk_sg_entry
+{
+	uint8_t chan;
+	uint8_t *buf;
+	uint8_t size;
+	uint8_t len;
+} nrk_sg_entry_t;
+
 
 int8_t nrk_register_driver(void *devicemanager,uint8_t driver_name);
 int8_t nrk_open(uint8_t dev_id,uint8_t opt); // options provide the ablility to set_status
 int8_t nrk_read(uint8_t dev_fd,uint8_t *buffer,uint8_t size);
 int8_t nrk_write(uint8_t dev_fd,uint8_t *buffer, uint8_t size);
+int8_t nrk_read_sg(uint8_t dev_fd,nrk_sg_entry_t *list,uint8_t count,int8_t done_sig);
 int8_t nrk_close(uint8_t dev_fd); // options provide the ablility to set_status
 int8_t nrk_set_status(uint8_t dev_fd,uint8_t key,uint8_t value);
 int8_t nrk_get_status(uint8_t dev_fd,uint8_t key);
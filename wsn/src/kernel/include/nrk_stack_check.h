@@ -31,9 +31,31 @@
 
 #define STK_CANARY_VAL		0x55 
 
+// NRK_STACK_PROFILE paints each task stack with STK_PAINT_VAL when the
+// task is first activated so that the deepest point ever reached can be
+// measured at runtime.
+#define STK_PAINT_VAL		0xAA
+
+// Bytes of head room added to the measured usage when recommending a
+// stack size.  Can be overridden from nrk_cfg.h.
+#ifndef NRK_STACK_PROFILE_MARGIN
+#define NRK_STACK_PROFILE_MARGIN	32
+#endif
+
+typedef struct stack_profile {
+	uint16_t size;		// total bytes from bottom to initial top of stack
+	uint16_t used;		// high-water mark in bytes
+	uint16_t free;		// bytes that have never been touched
+	uint16_t recommended;	// used + margin rounded up to 16 bytes
+} nrk_stack_profile_t;
+
 
 void dump_stack_info();
 inline void nrk_stack_check();
 int8_t nrk_stack_check_pid(int8_t pid);
 
+void _nrk_stack_paint(NRK_STK *pbos, NRK_STK *ptos);
+int8_t nrk_stack_profile_get(int8_t pid, nrk_stack_profile_t *p);
+void nrk_stack_profile_display_all();
+
 #endif
@@ -13,6 +13,7 @@ typedef struct task_stat {
 	uint32_t cur_ticks;
 	uint32_t preempted;
 	uint8_t violations;
+	uint16_t deadline_misses;
 	uint8_t overflow;
 } nrk_task_stat_t;
 
@@ -23,6 +24,7 @@ nrk_time_t _nrk_stats_sleep_time;
 void nrk_stats_reset();
 void _nrk_stats_sleep(uint8_t t);
 void _nrk_stats_add_violation(uint8_t task_id);
+void _nrk_stats_add_deadline_miss(uint8_t task_id);
 void _nrk_stats_task_start(uint8_t task_id);
 void _nrk_stats_task_preempted(uint8_t task_id, uint8_t ticks);
 void _nrk_stats_task_suspend(uint8_t task_id, uint8_t ticks);
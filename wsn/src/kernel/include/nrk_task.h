@@ -49,6 +49,9 @@ typedef EventMaskType*	EventMaskRefType;
 typedef struct os_tcb {
 	NRK_STK        *OSTaskStkPtr;        /* Pointer to current top of stack */
 	NRK_STK        *OSTCBStkBottom;     /* Pointer to bottom of stack    */
+#ifdef NRK_STACK_PROFILE
+	NRK_STK        *OSTCBStkTop;        /* Pointer to initial top of stack */
+#endif
 
 
 	bool      elevated_prio_flag;
@@ -175,6 +178,9 @@ typedef struct node {
 void nrk_rem_from_readyQ(int8_t task_ID);
 uint8_t nrk_get_high_ready_task_ID(void);
 void nrk_add_to_readyQ(int8_t task_ID);
+#ifdef NRK_EDF_SCHEDULER
+uint8_t _nrk_edf_precedes(int8_t a, int8_t b);
+#endif
 void nrk_add_to_readyQ_Before(int8_t task_ID);
 void nrk_print_readyQ(void);
 
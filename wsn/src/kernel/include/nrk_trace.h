@@ -0,0 +1,69 @@
+#ifndef NRK_TRACE_H
+#define NRK_TRACE_H
+#include <nrk_cfg.h>
+
+// Event types stored in the trace ring
+#define NRK_TRACE_SWITCH	1	// arg = task ID that is switched in
+#define NRK_TRACE_SEM_PEND	2	// arg = semaphore index
+#define NRK_TRACE_SEM_BLOCK	3	// arg = semaphore index
+#define NRK_TRACE_SEM_POST	4	// arg = semaphore index
+#define NRK_TRACE_SIG_SEND	5	// arg = signal number
+#define NRK_TRACE_SIG_WAIT	6	// arg = lowest signal number in the mask
+#define NRK_TRACE_ISR		7	// arg = NRK_TRACE_IRQ_* below
+#define NRK_TRACE_USER		8	// arg = application defined
+
+// ISR identifiers for NRK_TRACE_ISR
+#define NRK_TRACE_IRQ_UART0_RX	1
+#define NRK_TRACE_IRQ_EXT_INT0	2
+#define NRK_TRACE_IRQ_EXT_INT1	3
+#define NRK_TRACE_IRQ_EXT_INT2	4
+#define NRK_TRACE_IRQ_PC_INT0	5
+#define NRK_TRACE_IRQ_APP_TIMER	6
+
+#define NRK_TRACE_VERSION	1
+#define NRK_TRACE_ENTRY_SIZE	7	// bytes per entry in a dump, not sizeof()
+
+#ifdef NRK_TRACE
+
+// Number of events kept in RAM (at most 255), older events are overwritten
+#ifndef NRK_TRACE_BUF_SIZE
+#define NRK_TRACE_BUF_SIZE	64
+#endif
+
+// Rate of the high speed timer in Hz (clk I/O with no prescaler)
+#ifndef NRK_TRACE_HS_HZ
+#ifdef F_CPU
+#define NRK_TRACE_HS_HZ		F_CPU
+#else
+#define NRK_TRACE_HS_HZ		16000000UL
+#endif
+#endif
+
+// tick is the OS tick count (low 16 bits) when the event happened and hs
+// is the high speed timer value, which is reset on every scheduler entry.
+// Together they give sub-microsecond event times without a 32 bit counter.
+typedef struct trace_entry {
+	uint8_t type;
+	int8_t pid;
+	uint8_t arg;
+	uint16_t tick;
+	uint16_t hs;
+} nrk_trace_entry_t;
+
+#define NRK_TRACE_EVENT(type,arg)	_nrk_trace_add(type,arg)
+
+void _nrk_trace_add(uint8_t type, uint8_t arg);
+void _nrk_trace_sched_enter();
+void nrk_trace_reset();
+void nrk_trace_enable();
+void nrk_trace_disable();
+uint8_t nrk_trace_count();
+void nrk_trace_dump();
+
+#else
+
+#define NRK_TRACE_EVENT(type,arg)
+
+#endif
+
+#endif
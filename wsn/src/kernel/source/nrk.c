@@ -43,6 +43,7 @@
 #include <nrk_reserve.h>
 #include <nrk_cfg.h>
 #include <nrk_stats.h>
+#include <nrk_trace.h>
 
 inline void nrk_int_disable(void) {
   DISABLE_GLOBAL_INT();
@@ -150,6 +151,11 @@ void nrk_init()
 	nrk_stats_reset();
    #endif
 
+   #ifdef NRK_TRACE
+	nrk_trace_reset();
+	nrk_trace_enable();
+   #endif
+
     #ifdef NRK_MAX_RESERVES 
     // Setup the reserve structures
     _nrk_reserve_init();
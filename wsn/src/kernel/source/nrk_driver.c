@@ -135,6 +135,33 @@ int8_t nrk_read(uint8_t dev_fd,uint8_t *buffer,uint8_t size)
     return nrk_drivers[dev_fd].devicemanager(READ,0,buffer,size);
 
 }
+/*
+ * nrk_read_sg()
+ *
+ * Reads a list of samples in one driver call.  Each entry selects a channel
+ * and points at the caller's buffer so the driver writes the samples in
+ * place.  Returns the number of entries that were filled.  If done_sig is
+ * not NRK_SG_NO_SIGNAL it is signaled once the list is complete so that
+ * another task can wait on the result with nrk_event_wait().
+ *
+ */
+int8_t nrk_read_sg(uint8_t dev_fd,nrk_sg_entry_t *list,uint8_t count,int8_t done_sig)
+{
+    int8_t done;
+
+    if(dev_fd>_nrk_driver_count)
+    {
+        _nrk_errno_set(1);  // invalid device
+        return NRK_ERROR;
+    }
+
+    done=nrk_drivers[dev_fd].devicemanager(READ_SG,count,(uint8_t *)list,0);
+    if(done!=NRK_ERROR && done_sig!=NRK_SG_NO_SIGNAL)
+        nrk_event_signal(done_sig);
+
+    return done;
+}
+
 /*if key is 0 then assumed to create a frequency setting*/
 int8_t nrk_set_status(uint8_t dev_fd,uint8_t key,uint8_t value)
 {
@@ -36,6 +36,7 @@
 #include <nrk_cfg.h>
 #include <nrk_cpu.h>
 #include <nrk_defs.h>
+#include <nrk_trace.h>
 
 int8_t nrk_signal_create()
 {
@@ -133,6 +134,8 @@ int8_t nrk_event_signal(int8_t sig_id)
 	// Check if signal was created
 	// Signal was not created
 	if((sig_mask & _nrk_signal_list)==0 ) { _nrk_errno_set(1); return NRK_ERROR;}
+
+	NRK_TRACE_EVENT(NRK_TRACE_SIG_SEND,sig_id);
 	
 	//needs to be atomic otherwise run the risk of multiple tasks being scheduled late and not in order of priority.  
 	nrk_int_disable();
@@ -181,6 +184,11 @@ int8_t nrk_event_signal(int8_t sig_id)
 
 uint32_t nrk_event_wait(uint32_t event_mask)
 {
+#ifdef NRK_TRACE
+	uint8_t i;
+	for(i=0;i<31 && !(event_mask & SIG(i));i++);
+	NRK_TRACE_EVENT(NRK_TRACE_SIG_WAIT,i);
+#endif
 
 	// FIXME: Should go through list and check that all masks are registered, not just 1
 	if(event_mask &  nrk_cur_task_TCB->registered_signal_mask)
@@ -220,6 +228,7 @@ int8_t nrk_sem_pend(nrk_sem_t *rsrc )
 	if(id==-1) { _nrk_errno_set(1); return NRK_ERROR;}
 	if(id==NRK_MAX_RESOURCE_CNT) { _nrk_errno_set(2); return NRK_ERROR; }
 	
+	NRK_TRACE_EVENT(NRK_TRACE_SEM_PEND,id);
 	nrk_int_disable();
 	if(nrk_sem_list[id].value==0)
 	{
@@ -227,6 +236,7 @@ int8_t nrk_sem_pend(nrk_sem_t *rsrc )
 		nrk_cur_task_TCB->active_signal_mask=id;
 		// Wait on suspend event
 		nrk_int_enable();
+		NRK_TRACE_EVENT(NRK_TRACE_SEM_BLOCK,id);
 		nrk_wait_until_ticks(0);
 	}
 
@@ -247,6 +257,7 @@ int8_t nrk_sem_post(nrk_sem_t *rsrc)
 	if(id==-1) { _nrk_errno_set(1); return NRK_ERROR;}
 	if(id==NRK_MAX_RESOURCE_CNT) { _nrk_errno_set(2); return NRK_ERROR; }
 
+	NRK_TRACE_EVENT(NRK_TRACE_SEM_POST,id);
 	if(nrk_sem_list[id].value<nrk_sem_list[id].count)
 	{
 		// Signal RSRC Event		
@@ -41,6 +41,7 @@
 #include <nrk_platform_time.h>
 #include <nrk_stats.h>
 #include <nrk_sw_wdt.h>
+#include <nrk_trace.h>
 
 
 // This define was moved into nrk_platform_time.h since it needs to be different based on the clk speed
@@ -56,10 +57,14 @@ void inline _nrk_scheduler()
     int8_t task_ID;
     uint16_t next_wake;
     uint16_t start_time_stamp;
+    uint8_t deadline_passed;
 
     _nrk_precision_os_timer_reset();
     nrk_int_enable();   // this should be removed...  Not needed
 
+#ifdef NRK_TRACE
+    _nrk_trace_sched_enter();
+#endif
 
 #ifndef NRK_NO_BOUNDED_CONTEXT_SWAP
     _nrk_high_speed_timer_reset();
@@ -201,6 +206,7 @@ void inline _nrk_scheduler()
             // Do next period book keeping.
             // next_period needs to be set such that the period is kept consistent even if other
             // wait until functions are called.
+            deadline_passed = (nrk_task_TCB[task_ID].period!=0 && nrk_task_TCB[task_ID].next_period <= _nrk_prev_timer_val);
             if( nrk_task_TCB[task_ID].next_period >= _nrk_prev_timer_val )
                 nrk_task_TCB[task_ID].next_period-=_nrk_prev_timer_val;
             else
@@ -212,6 +218,19 @@ void inline _nrk_scheduler()
             }
             if(nrk_task_TCB[task_ID].next_period==0) nrk_task_TCB[task_ID].next_period=nrk_task_TCB[task_ID].period;
 
+            // A task that is still READY when its period ends has missed
+            // the implicit deadline of that job.
+            if(deadline_passed && nrk_task_TCB[task_ID].task_state==READY)
+            {
+#ifdef NRK_STATS_TRACKER
+                _nrk_stats_add_deadline_miss(task_ID);
+#endif
+#ifdef NRK_EDF_SCHEDULER
+                // The deadline moved out by a period, so re-sort the task
+                nrk_rem_from_readyQ(task_ID);
+                nrk_add_to_readyQ(task_ID);
+#endif
+            }
         }
 
 
@@ -343,6 +362,7 @@ void inline _nrk_scheduler()
     if(next_wake>MAX_SCHED_WAKEUP_TIME)  next_wake=MAX_SCHED_WAKEUP_TIME;
 #endif
     //printf( "nw = %d %d %d\r\n",task_ID,_nrk_cpu_state,next_wake);
+    NRK_TRACE_EVENT(NRK_TRACE_SWITCH,task_ID);
     nrk_cur_task_prio = nrk_high_ready_prio;
     nrk_cur_task_TCB  = nrk_high_ready_TCB;
 
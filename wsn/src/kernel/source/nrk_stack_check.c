@@ -28,6 +28,7 @@
 #include <nrk_error.h>
 #include <nrk_stack_check.h>
 #include <stdio.h>
+#include <stdint.h>
 
 void dump_stack_info()
 {
@@ -40,23 +41,23 @@ void dump_stack_info()
     printf( "cur: %d ",nrk_cur_task_TCB->task_ID);
     stk= (unsigned int *)nrk_cur_task_TCB->OSTCBStkBottom;
     stkc = (unsigned char*)stk;
-    printf( "bottom = %x ",(uint16_t)stkc );
+    printf( "bottom = %lx ",(unsigned long)(uintptr_t)stkc );
     printf( "canary = %x ",*stkc );
     stk= (unsigned int *)nrk_cur_task_TCB->OSTaskStkPtr;
     stkc = (unsigned char*)stk;
-    printf( "stk = %x ",(uint16_t)stkc );
-    printf( "tcb addr = %x\r\n",(uint16_t)nrk_cur_task_TCB);
+    printf( "stk = %lx ",(unsigned long)(uintptr_t)stkc );
+    printf( "tcb addr = %lx\r\n",(unsigned long)(uintptr_t)nrk_cur_task_TCB);
 
     for(i=0; i<NRK_MAX_TASKS; i++ )
     {
         stk= (unsigned int *)nrk_task_TCB[i].OSTCBStkBottom;
         stkc = (unsigned char*)stk;
-        printf( "%d: bottom = %x ",i,(uint16_t)stkc );
+        printf( "%d: bottom = %lx ",i,(unsigned long)(uintptr_t)stkc );
         printf( "canary = %x ",*stkc );
         stk= (unsigned int *)nrk_task_TCB[i].OSTaskStkPtr;
         stkc = (unsigned char*)stk;
-        printf( "stk = %x ",(uint16_t)stkc );
-        printf( "tcb addr = %x\r\n",(uint16_t)&nrk_task_TCB[i]);
+        printf( "stk = %lx ",(unsigned long)(uintptr_t)stkc );
+        printf( "tcb addr = %lx\r\n",(unsigned long)(uintptr_t)&nrk_task_TCB[i]);
 
     }
 
@@ -128,3 +129,67 @@ int8_t nrk_stack_check_pid(int8_t pid)
     return NRK_OK;
 }
 
+
+/*
+ * Stack high-water mark profiling.
+ * Every byte between the canary and the initial top of stack is painted
+ * with STK_PAINT_VAL before the task first runs.  Stacks grow down, so the
+ * run of untouched paint bytes directly above the canary is the amount of
+ * stack that the task has never used.
+ *
+ * */
+void _nrk_stack_paint(NRK_STK *pbos, NRK_STK *ptos)
+{
+#ifdef NRK_STACK_PROFILE
+    unsigned char *stkc;
+
+    for(stkc=(unsigned char *)pbos+1; stkc<=(unsigned char *)ptos; stkc++ )
+        *stkc=STK_PAINT_VAL;
+#endif
+}
+
+int8_t nrk_stack_profile_get(int8_t pid, nrk_stack_profile_t *p)
+{
+#ifdef NRK_STACK_PROFILE
+    unsigned char *bottom;
+    unsigned char *top;
+    unsigned char *stkc;
+
+    if(pid<0 || pid>=NRK_MAX_TASKS ) return NRK_ERROR;
+    if(nrk_task_TCB[pid].task_ID==-1 ) return NRK_ERROR;
+
+    bottom = (unsigned char *)nrk_task_TCB[pid].OSTCBStkBottom;
+    top = (unsigned char *)nrk_task_TCB[pid].OSTCBStkTop;
+    if(top==NULL || top<=bottom ) return NRK_ERROR;
+
+    stkc=bottom+1;
+    while(stkc<=top && *stkc==STK_PAINT_VAL ) stkc++;
+
+    p->size=(uint16_t)(top-bottom)+1;
+    p->free=(uint16_t)(stkc-bottom)-1;
+    p->used=p->size-p->free;
+    p->recommended=(p->used+NRK_STACK_PROFILE_MARGIN+15) & ~0x0F;
+    return NRK_OK;
+#else
+    return NRK_ERROR;
+#endif
+}
+
+void nrk_stack_profile_display_all()
+{
+#ifdef NRK_STACK_PROFILE
+    nrk_stack_profile_t p;
+    uint8_t i;
+
+    nrk_kprintf( PSTR("\r\nSTACK PROFILE\r\n"));
+    nrk_kprintf( PSTR("pid\tsize\tused\tfree\trecommended\r\n"));
+    for(i=0; i<NRK_MAX_TASKS; i++ )
+    {
+        if(nrk_stack_profile_get(i,&p)==NRK_ERROR ) continue;
+        printf( "%d\t%u\t%u\t%u\t%u",i,p.size,p.used,p.free,p.recommended );
+        if(p.free==0 ) nrk_kprintf( PSTR("\t<- overflow"));
+        else if(p.recommended>p.size ) nrk_kprintf( PSTR("\t<- grow"));
+        nrk_kprintf( PSTR("\r\n"));
+    }
+#endif
+}
@@ -21,6 +21,7 @@ void nrk_stats_reset()
         cur_task_stats[i].swapped_in=0;
         cur_task_stats[i].preempted=0;
         cur_task_stats[i].violations=0;
+        cur_task_stats[i].deadline_misses=0;
         cur_task_stats[i].overflow=0;
     }
 
@@ -47,6 +48,13 @@ void _nrk_stats_add_violation(uint8_t task_id)
     if(cur_task_stats[task_id].violations==255) cur_task_stats[task_id].overflow=1;
 }
 
+void _nrk_stats_add_deadline_miss(uint8_t task_id)
+{
+    if( cur_task_stats[task_id].overflow==1) return;
+    cur_task_stats[task_id].deadline_misses++;
+    if(cur_task_stats[task_id].deadline_misses==UINT16_MAX) cur_task_stats[task_id].overflow=1;
+}
+
 
 // task_id is the PID of the task in question
 void _nrk_stats_task_start(uint8_t task_id)
@@ -115,6 +123,8 @@ void nrk_stats_display_pid(uint8_t pid)
     printf( "%lu",cur_task_stats[pid].preempted);
     nrk_kprintf( PSTR( "\r\n   Kernel Violations: "));
     printf( "%u",cur_task_stats[pid].violations);
+    nrk_kprintf( PSTR( "\r\n   Deadline Misses: "));
+    printf( "%u",cur_task_stats[pid].deadline_misses);
     nrk_kprintf( PSTR( "\r\n   Overflow Error Status: "));
     printf( "%u",cur_task_stats[pid].overflow);
     nrk_kprintf( PSTR("\r\n") );
@@ -144,6 +154,7 @@ int8_t nrk_stats_get(uint8_t pid, nrk_task_stat_t *t)
     t->cur_ticks=cur_task_stats[pid].cur_ticks;
     t->preempted=cur_task_stats[pid].preempted;
     t->violations=cur_task_stats[pid].violations;
+    t->deadline_misses=cur_task_stats[pid].deadline_misses;
     t->overflow=cur_task_stats[pid].overflow;
 
     return NRK_OK;
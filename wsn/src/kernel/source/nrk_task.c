@@ -57,6 +57,53 @@ void nrk_print_readyQ ()
 }
 
 
+#ifdef NRK_EDF_SCHEDULER
+/*
+ * Returns 1 if task a should be placed ahead of task b in the readyQ.
+ * next_period is the number of ticks until the end of the current period,
+ * which is the implicit deadline of the current job.  All next_period
+ * values are decremented together by the scheduler so comparing them is
+ * the same as comparing absolute deadlines.
+ *
+ * - The idle task always runs last.
+ * - Tasks holding a resource run first (ordered by ceiling) so that the
+ *   priority ceiling protocol still bounds blocking.
+ * - Aperiodic tasks (period 0) are treated as urgent and are ordered by
+ *   their fixed priority ahead of the periodic tasks.
+ * - Periodic tasks are ordered by deadline, with ties broken by priority.
+ * */
+uint8_t _nrk_edf_precedes (int8_t a, int8_t b)
+{
+    if (b == NRK_IDLE_TASK_ID)
+        return 1;
+    if (a == NRK_IDLE_TASK_ID)
+        return 0;
+
+    if (nrk_task_TCB[a].elevated_prio_flag || nrk_task_TCB[b].elevated_prio_flag)
+    {
+        if (!nrk_task_TCB[b].elevated_prio_flag)
+            return 1;
+        if (!nrk_task_TCB[a].elevated_prio_flag)
+            return 0;
+        return (nrk_task_TCB[a].task_prio_ceil > nrk_task_TCB[b].task_prio_ceil);
+    }
+
+    if (nrk_task_TCB[a].period == 0 || nrk_task_TCB[b].period == 0)
+    {
+        if (nrk_task_TCB[b].period != 0)
+            return 1;
+        if (nrk_task_TCB[a].period != 0)
+            return 0;
+        return (nrk_task_TCB[a].task_prio > nrk_task_TCB[b].task_prio);
+    }
+
+    if (nrk_task_TCB[a].next_period != nrk_task_TCB[b].next_period)
+        return (nrk_task_TCB[a].next_period < nrk_task_TCB[b].next_period);
+    return (nrk_task_TCB[a].task_prio > nrk_task_TCB[b].task_prio);
+}
+#endif
+
+
 void nrk_add_to_readyQ (int8_t task_ID)
 {
     nrk_queue *NextNode;
@@ -78,6 +125,10 @@ void nrk_add_to_readyQ (int8_t task_ID)
 
         while (NextNode != NULL)
         {
+#ifdef NRK_EDF_SCHEDULER
+            if (_nrk_edf_precedes (task_ID, NextNode->task_ID))
+                break;
+#else
             if (nrk_task_TCB[NextNode->task_ID].elevated_prio_flag)
                 if (nrk_task_TCB[NextNode->task_ID].task_prio_ceil <
                         nrk_task_TCB[task_ID].task_prio)
@@ -89,6 +140,7 @@ void nrk_add_to_readyQ (int8_t task_ID)
             if (nrk_task_TCB[NextNode->task_ID].task_prio <
                     nrk_task_TCB[task_ID].task_prio)
                 break;
+#endif
 
             NextNode = NextNode->Next;
         }
@@ -230,6 +282,13 @@ nrk_status_t nrk_activate_task (nrk_task_type * Task)
     uint8_t rtype;
     void *topOfStackPtr;
 
+#ifdef NRK_STACK_PROFILE
+    // Paint the unused stack before the initial context is built so that
+    // nrk_stack_profile_get() can later find the high-water mark
+    if (Task->FirstActivation == TRUE)
+        _nrk_stack_paint (Task->Pbos, Task->Ptos);
+#endif
+
     topOfStackPtr =
         (void *) nrk_task_stk_init (Task->task, Task->Ptos, Task->Pbos);
 
@@ -238,6 +297,9 @@ nrk_status_t nrk_activate_task (nrk_task_type * Task)
     {
         rtype = nrk_TCB_init (Task, topOfStackPtr, Task->Pbos, 0, (void *) 0, 0);
         Task->FirstActivation = FALSE;
+#ifdef NRK_STACK_PROFILE
+        nrk_task_TCB[Task->task_ID].OSTCBStkTop = Task->Ptos;
+#endif
 
     }
     else
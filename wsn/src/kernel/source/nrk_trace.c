@@ -0,0 +1,155 @@
+#include <nrk.h>
+#include <nrk_trace.h>
+#include <nrk_timer.h>
+#include <nrk_defs.h>
+#include <nrk_platform_time.h>
+#include <stdio.h>
+
+#ifdef NRK_TRACE
+
+/*
+ * Trace ring buffer.
+ *
+ * Dump format (little endian, read by tools/TraceScope):
+ *   "NRKT" version(1) entry_size(1) count(2) nanos_per_tick(4) hs_hz(4)
+ *   followed by count entries of type(1) pid(1) arg(1) tick(2) hs(2)
+ *   ordered oldest first.
+ * */
+
+static nrk_trace_entry_t _nrk_trace_buf[NRK_TRACE_BUF_SIZE];
+static uint8_t _nrk_trace_head;
+static uint8_t _nrk_trace_cnt;
+static uint8_t _nrk_trace_on;
+static uint16_t _nrk_trace_tick;
+
+// The trace is touched from tasks, the scheduler, ISRs and nrk_init, so
+// the interrupt state is saved and restored rather than forced on. Ports
+// without an SREG (msp430) fall back to re-enabling interrupts.
+static uint8_t _nrk_trace_int_save()
+{
+    uint8_t state;
+
+#if defined(NRK_POSIX)
+    state=_nrk_posix_int_save();
+#elif defined(SREG)
+    state=SREG;
+#else
+    state=0;
+#endif
+    nrk_int_disable();
+    return state;
+}
+
+static void _nrk_trace_int_restore(uint8_t state)
+{
+#if defined(NRK_POSIX)
+    _nrk_posix_int_restore(state);
+#elif defined(SREG)
+    SREG=state;
+#else
+    nrk_int_enable();
+#endif
+}
+
+void nrk_trace_reset()
+{
+    uint8_t state;
+
+    state=_nrk_trace_int_save();
+    _nrk_trace_head=0;
+    _nrk_trace_cnt=0;
+    _nrk_trace_int_restore(state);
+}
+
+void nrk_trace_enable()
+{
+    _nrk_trace_on=1;
+}
+
+void nrk_trace_disable()
+{
+    _nrk_trace_on=0;
+}
+
+uint8_t nrk_trace_count()
+{
+    return _nrk_trace_cnt;
+}
+
+// Called at the top of the scheduler before the high speed timer is reset.
+// _nrk_prev_timer_val holds the number of ticks since the last scheduler call.
+void _nrk_trace_sched_enter()
+{
+    _nrk_trace_tick+=_nrk_prev_timer_val;
+#ifdef NRK_NO_BOUNDED_CONTEXT_SWAP
+    _nrk_high_speed_timer_reset();
+#endif
+}
+
+void _nrk_trace_add(uint8_t type, uint8_t arg)
+{
+    nrk_trace_entry_t *e;
+    uint8_t state;
+
+    if(_nrk_trace_on==0) return;
+
+    state=_nrk_trace_int_save();
+    e=&_nrk_trace_buf[_nrk_trace_head];
+    e->type=type;
+    e->pid=(nrk_cur_task_TCB==NULL) ? -1 : nrk_cur_task_TCB->task_ID;
+    e->arg=arg;
+    e->tick=_nrk_trace_tick+_nrk_os_timer_get();
+    e->hs=_nrk_high_speed_timer_get();
+    _nrk_trace_head++;
+    if(_nrk_trace_head==NRK_TRACE_BUF_SIZE) _nrk_trace_head=0;
+    if(_nrk_trace_cnt<NRK_TRACE_BUF_SIZE) _nrk_trace_cnt++;
+    _nrk_trace_int_restore(state);
+}
+
+static void _nrk_trace_put16(uint16_t v)
+{
+    putchar(v&0xFF);
+    putchar(v>>8);
+}
+
+static void _nrk_trace_put32(uint32_t v)
+{
+    _nrk_trace_put16(v&0xFFFF);
+    _nrk_trace_put16(v>>16);
+}
+
+// Writes the trace over the UART in binary and clears it.  Tracing is
+// paused while dumping so the dump does not trace itself.
+void nrk_trace_dump()
+{
+    uint8_t on,i,index;
+    nrk_trace_entry_t *e;
+
+    on=_nrk_trace_on;
+    _nrk_trace_on=0;
+
+    putchar('N'); putchar('R'); putchar('K'); putchar('T');
+    putchar(NRK_TRACE_VERSION);
+    putchar(NRK_TRACE_ENTRY_SIZE);
+    _nrk_trace_put16(_nrk_trace_cnt);
+    _nrk_trace_put32(NANOS_PER_TICK);
+    _nrk_trace_put32(NRK_TRACE_HS_HZ);
+
+    index=(_nrk_trace_head+NRK_TRACE_BUF_SIZE-_nrk_trace_cnt)%NRK_TRACE_BUF_SIZE;
+    for(i=0; i<_nrk_trace_cnt; i++ )
+    {
+        e=&_nrk_trace_buf[index];
+        putchar(e->type);
+        putchar(e->pid);
+        putchar(e->arg);
+        _nrk_trace_put16(e->tick);
+        _nrk_trace_put16(e->hs);
+        index++;
+        if(index==NRK_TRACE_BUF_SIZE) index=0;
+    }
+
+    nrk_trace_reset();
+    _nrk_trace_on=on;
+}
+
+#endif
@@ -34,6 +34,7 @@
 #include <nrk_pin_define.h>
 #include <nrk_error.h>
 #include <nrk_events.h>
+#include <nrk_trace.h>
 
 #ifdef NANORK
 #include <nrk_cfg.h>
@@ -55,6 +56,7 @@ SIGNAL(USART0_RX_vect)
 {
 char c;
 uint8_t sig;
+NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_UART0_RX);
 nrk_int_disable();
 // cli();
 //DISABLE_UART0_RX_INT(); //this will enable nrk int
@@ -0,0 +1,18 @@
+/*
+ * avr/eeprom.h stand-in for the host (POSIX) platform.
+ * The EEPROM image is kept by platform/posix/source/nrk_eeprom.c.
+ */
+
+#ifndef _POSIX_AVR_EEPROM_H_
+#define _POSIX_AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+uint8_t eeprom_read_byte(const uint8_t *addr);
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+void eeprom_update_byte(uint8_t *addr, uint8_t value);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_write_block(const void *src, void *dst, size_t n);
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * avr/interrupt.h stand-in for the host (POSIX) platform.
+ *
+ * Interrupt vectors are not wired up by name on the host; the host HAL
+ * registers its handlers with _nrk_posix_irq_register() instead.  SIGNAL
+ * and ISR still declare an ordinary function so that shared sources that
+ * define a vector keep compiling.
+ */
+
+#ifndef _POSIX_AVR_INTERRUPT_H_
+#define _POSIX_AVR_INTERRUPT_H_
+
+#include <hal.h>
+
+#define sei()		ENABLE_GLOBAL_INT()
+#define cli()		DISABLE_GLOBAL_INT()
+
+#define SIGNAL(vector)	void vector(void); void vector(void)
+#define ISR(vector)	SIGNAL(vector)
+
+#endif
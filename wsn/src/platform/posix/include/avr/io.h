@@ -0,0 +1,55 @@
+/*
+ * avr/io.h stand-in for the host (POSIX) platform.
+ *
+ * GPIO ports are plain byte arrays owned by ulib.c, indexed with the
+ * NRK_PORTx numbers from nrk_pin_define.h.  SPDR and SPSR are accessor
+ * calls so that the SPI model can run a transfer when a driver writes
+ * SPDR and then polls SPSR for SPIF, as the FireFly3 drivers do.
+ */
+
+#ifndef _POSIX_AVR_IO_H_
+#define _POSIX_AVR_IO_H_
+
+#include <stdint.h>
+
+// There is no memory ceiling on the host
+#define RAMEND		UINTPTR_MAX
+#define E2END		4095
+
+extern volatile uint8_t _nrk_posix_port[7];
+extern volatile uint8_t _nrk_posix_ddr[7];
+extern volatile uint8_t _nrk_posix_pin[7];
+
+#define PORTA	_nrk_posix_port[0]
+#define PORTB	_nrk_posix_port[1]
+#define PORTC	_nrk_posix_port[2]
+#define PORTD	_nrk_posix_port[3]
+#define PORTE	_nrk_posix_port[4]
+#define PORTF	_nrk_posix_port[5]
+#define PORTG	_nrk_posix_port[6]
+
+#define DDRA	_nrk_posix_ddr[0]
+#define DDRB	_nrk_posix_ddr[1]
+#define DDRC	_nrk_posix_ddr[2]
+#define DDRD	_nrk_posix_ddr[3]
+#define DDRE	_nrk_posix_ddr[4]
+#define DDRF	_nrk_posix_ddr[5]
+#define DDRG	_nrk_posix_ddr[6]
+
+#define PINA	_nrk_posix_pin[0]
+#define PINB	_nrk_posix_pin[1]
+#define PINC	_nrk_posix_pin[2]
+#define PIND	_nrk_posix_pin[3]
+#define PINE	_nrk_posix_pin[4]
+#define PINF	_nrk_posix_pin[5]
+#define PING	_nrk_posix_pin[6]
+
+// Power reduction and SPI
+extern volatile uint8_t PRR0;
+extern volatile uint8_t SPCR;
+volatile uint8_t *_nrk_posix_spdr(void);
+volatile uint8_t *_nrk_posix_spsr(void);
+#define SPDR	(*_nrk_posix_spdr())
+#define SPSR	(*_nrk_posix_spsr())
+
+#endif
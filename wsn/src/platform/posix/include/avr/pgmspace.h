@@ -0,0 +1,30 @@
+/*
+ * avr/pgmspace.h stand-in for the host (POSIX) platform.
+ * Program memory is ordinary memory on the host.
+ */
+
+#ifndef _POSIX_AVR_PGMSPACE_H_
+#define _POSIX_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PSTR(s)			(s)
+#define PGM_P			const char *
+
+#define pgm_read_byte(addr)	(*(const uint8_t *)(addr))
+#define pgm_read_word(addr)	(*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)	(*(const uint32_t *)(addr))
+
+#define memcpy_P		memcpy
+#define strcpy_P		strcpy
+#define strncpy_P		strncpy
+#define strcmp_P		strcmp
+#define strncmp_P		strncmp
+#define strlen_P		strlen
+#define printf_P		printf
+#define sprintf_P		sprintf
+
+#endif
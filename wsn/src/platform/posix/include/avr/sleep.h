@@ -0,0 +1,24 @@
+/*
+ * avr/sleep.h stand-in for the host (POSIX) platform.
+ * Every sleep mode blocks the process until the next host event.
+ */
+
+#ifndef _POSIX_AVR_SLEEP_H_
+#define _POSIX_AVR_SLEEP_H_
+
+#define SLEEP_MODE_IDLE		0
+#define SLEEP_MODE_ADC		1
+#define SLEEP_MODE_PWR_DOWN	2
+#define SLEEP_MODE_PWR_SAVE	3
+#define SLEEP_MODE_STANDBY	6
+#define SLEEP_MODE_EXT_STANDBY	7
+
+void nrk_idle(void);
+
+#define set_sleep_mode(mode)	do { } while (0)
+#define sleep_enable()		do { } while (0)
+#define sleep_disable()		do { } while (0)
+#define sleep_cpu()		nrk_idle()
+#define sleep_mode()		nrk_idle()
+
+#endif
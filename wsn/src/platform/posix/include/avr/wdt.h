@@ -0,0 +1,15 @@
+/*
+ * avr/wdt.h stand-in for the host (POSIX) platform.
+ * The watchdog itself lives in kernel/hal/posix/nrk_watchdog.c.
+ */
+
+#ifndef _POSIX_AVR_WDT_H_
+#define _POSIX_AVR_WDT_H_
+
+#include <nrk_watchdog.h>
+
+#define wdt_reset()		nrk_watchdog_reset()
+#define wdt_enable(timeout)	nrk_watchdog_enable()
+#define wdt_disable()		nrk_watchdog_disable()
+
+#endif
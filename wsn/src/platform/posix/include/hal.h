@@ -0,0 +1,94 @@
+/*
+ * Host (POSIX) hardware abstraction.
+ *
+ * Only the parts of the FireFly3 hal.h that portable code relies on are
+ * kept: the stack type, the global interrupt switch and the UART option
+ * codes.  The interrupt switch drives the virtual interrupt flag kept by
+ * kernel/hal/posix/nrk_cpu.c, and enabling interrupts is where pending
+ * host events (pty input, timers, GPIO edges) get delivered.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+typedef uint8_t   NRK_STK;                   // Each stack entry is 8-bit wide
+
+/*******************************************************************************************************
+ *******************************************************************************************************
+ **************************                    INTERRUPTS                     **************************
+ *******************************************************************************************************
+ *******************************************************************************************************/
+
+void _nrk_posix_int_enable(void);
+void _nrk_posix_int_disable(void);
+
+//-------------------------------------------------------------------------------------------------------
+// General
+#define ENABLE_GLOBAL_INT()         do { _nrk_posix_int_enable(); } while (0)
+#define DISABLE_GLOBAL_INT()        do { _nrk_posix_int_disable(); } while (0)
+//-------------------------------------------------------------------------------------------------------
+
+
+/*******************************************************************************************************
+ *******************************************************************************************************
+ **************************                       UART                        **************************
+ *******************************************************************************************************
+ *******************************************************************************************************/
+
+// The baud rate is ignored by the pty backed UART, but the codes are kept
+// so that nrk_setup_uart() calls compile unchanged.
+#define UART_BAUDRATE_2K4           832
+#define UART_BAUDRATE_4K8           416
+#define UART_BAUDRATE_9K6           207
+#define UART_BAUDRATE_14K4          138
+#define UART_BAUDRATE_19K2          103
+#define UART_BAUDRATE_28K8          68
+#define UART_BAUDRATE_38K4          51
+#define UART_BAUDRATE_57K6          34
+#define UART_BAUDRATE_115K2         16
+#define UART_BAUDRATE_230K4         8
+#define UART_BAUDRATE_250K          4
+#define UART_BAUDRATE_500K          2
+
+#define UART_OPT_ONE_STOP_BIT       0
+#define UART_OPT_TWO_STOP_BITS      0x08
+#define UART_OPT_NO_PARITY          0
+#define UART_OPT_EVEN_PARITY        0x20
+#define UART_OPT_ODD_PARITY         0x30
+#define UART_OPT_5_BITS_PER_CHAR    0
+#define UART_OPT_6_BITS_PER_CHAR    0x02
+#define UART_OPT_7_BITS_PER_CHAR    0x04
+#define UART_OPT_8_BITS_PER_CHAR    0x06
+#define UART_OPT_9_BITS_PER_CHAR    0x0406
+//-------------------------------------------------------------------------------------------------------
+
+
+/*******************************************************************************************************
+ *******************************************************************************************************
+ **************************                   USEFUL STUFF                    **************************
+ *******************************************************************************************************
+ *******************************************************************************************************/
+
+//-------------------------------------------------------------------------------------------------------
+// Useful stuff
+#define NOP() do { } while (0)
+//-------------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------------
+//  void halWait(uint16_t timeout)
+//
+//  DESCRIPTION:
+//      Runs an idle loop for [timeout] microseconds.
+//
+//  ARGUMENTS:
+//      uint16_t timeout
+//          The timeout in microseconds
+//-------------------------------------------------------------------------------------------------------
+void halWait(uint16_t timeout);
+//-------------------------------------------------------------------------------------------------------
+
+
+#endif
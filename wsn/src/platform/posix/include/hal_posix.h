@@ -0,0 +1,97 @@
+/*
+ * Host (POSIX) platform definitions.
+ *
+ * The host platform keeps the FireFly3 LED, button and pin map so that the
+ * same application sources run on a workstation.  The functions declared
+ * at the bottom are the glue between the emulated peripherals in ulib.c
+ * and the virtual interrupt controller in kernel/hal/posix.
+ */
+
+#ifndef HAL_POSIX_H
+#define HAL_POSIX_H
+
+#include <stdint.h>
+
+#define POSIX_PLATFORM
+
+#define NRK_DEFAULT_UART 0
+
+#define RED_LED         0
+#define GREEN_LED       1
+#define BLUE_LED        3  // Nothing
+#define ORANGE_LED      2
+
+#define LED_RED         0
+#define LED_GREEN       1
+#define LED_BLUE	3  // Nothing
+#define LED_ORANGE	2
+
+
+// Moved to ulib.c file
+void PORT_INIT(void);
+
+
+//-------------------------------------------------------------------------------------------------------
+// Host clock and virtual interrupts (kernel/hal/posix)
+
+// Monotonic host time in nanoseconds
+uint64_t _nrk_posix_now_ns(void);
+
+// Deliver any pending interrupt if interrupts are enabled.  Called from
+// every HAL entry point that would let an AVR take an interrupt.
+void _nrk_posix_irq_poll(void);
+
+// Disable interrupts and return the previous state, for code that would
+// save and restore SREG on the AVR
+uint8_t _nrk_posix_int_save(void);
+void _nrk_posix_int_restore(uint8_t state);
+
+// Register an interrupt source.  The isr runs whenever fd is readable, or
+// on every poll when fd is -1 (for sources that check their own state).
+int8_t _nrk_posix_irq_register(int fd, void (*isr)(void));
+void _nrk_posix_irq_unregister(void (*isr)(void));
+
+// Make sure the polled sources run again no later than host time t, even
+// if the CPU is idle.  The request only lasts until the next dispatch.
+void _nrk_posix_irq_wake(uint64_t t);
+
+// Wait until host time t, taking interrupts on the way like a spin loop
+void _nrk_posix_sleep_until(uint64_t t);
+
+// Pin change hooks for INT0-INT2 and PCINT0-7 (kernel/hal/posix/nrk_ext_int.c)
+void _nrk_posix_ext_int_pin(uint8_t port, uint8_t bit, uint8_t level);
+void _nrk_posix_ext_int_isr(void);
+
+// Timer hooks (kernel/hal/posix/nrk_timer.c)
+uint64_t _nrk_posix_timer_deadline(void);
+uint8_t _nrk_posix_os_timer_due(void);
+void _nrk_posix_os_timer_ack(void);
+void _nrk_posix_app_timer_isr(void);
+
+// Precision OS timer (timer 5) controls the scheduler uses that the shared
+// nrk_timer.h does not declare
+void _nrk_precision_os_timer_reset(void);
+void _nrk_precision_os_timer_start(void);
+//-------------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------------
+// Emulated peripherals (platform/posix/source/ulib.c)
+
+// Diagnostic output on stderr, time stamped and tagged with the node.
+// Silenced by setting NRK_POSIX_QUIET in the environment.
+void _nrk_posix_log(const char *fmt, ...) __attribute__ ((format (printf, 1, 2)));
+
+// Drive an input pin from the host side (e.g. the simulated button)
+void _nrk_posix_gpio_input(uint8_t pin, uint8_t level);
+
+// Address of this node: NRK_POSIX_MAC from the environment, or def.  Lets
+// one build of a project run as many simulated nodes.
+uint16_t _nrk_posix_mac_addr(uint16_t def);
+
+// SPI slave model: called with each byte the master shifts out and
+// returns the byte shifted back in.  Defaults to an idle (0x00) bus.
+extern uint8_t (*_nrk_posix_spi_xfer)(uint8_t out);
+//-------------------------------------------------------------------------------------------------------
+
+#endif
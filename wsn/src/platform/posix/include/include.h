@@ -0,0 +1,55 @@
+/*
+ * Host (POSIX) platform include file.
+ *
+ * Mirrors the FireFly3 include.h so that kernel, driver and application
+ * sources build unchanged on Linux.  The avr/ headers in this directory
+ * stand in for avr-libc and map the few registers those sources touch
+ * onto the emulated peripherals in ulib.c.
+ */
+
+#ifndef INCLUDE_H
+#define INCLUDE_H
+
+#include <stdint.h>
+
+// Common values
+#ifndef FALSE
+	#define FALSE 0
+#endif
+#ifndef TRUE
+	#define TRUE 1
+#endif
+#ifndef NULL
+	#define NULL 0
+#endif
+
+// Useful stuff
+#define BM(n) (1 << (n))
+#define BF(x,b,s) (((x) & (b)) >> (s))
+#ifndef MIN
+#define MIN(n,m) (((n) < (m)) ? (n) : (m))
+#endif
+#ifndef MAX
+#define MAX(n,m) (((n) < (m)) ? (m) : (n))
+#endif
+#define ABS(n) ((n < 0) ? -(n) : (n))
+
+// Dynamic function pointer
+typedef void (*VFPTR)(void);
+//-----------------------------------------------------------------------------------------------
+
+
+//-----------------------------------------------------------------------------------------------
+// avr-libc stand-ins
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include <string.h>
+
+
+// HAL include files
+#include <hal.h>
+#include <hal_posix.h>
+//-----------------------------------------------------------------------------------------------
+
+#endif
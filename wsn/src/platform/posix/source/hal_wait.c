@@ -0,0 +1,23 @@
+/*
+ * Host (POSIX) halWait().
+ */
+
+#include <include.h>
+#include <nrk_timer.h>
+
+
+//-------------------------------------------------------------------------------------------------------
+//	void halWait(uint16_t timeout)
+//
+//	DESCRIPTION:
+//		Runs an idle loop for [timeout] microseconds.
+//
+//  ARGUMENTS:
+//      uint16_t timeout
+//          The timeout in microseconds
+//-------------------------------------------------------------------------------------------------------
+void halWait(uint16_t timeout) {
+
+    nrk_spin_wait_us(timeout);
+
+} // halWait
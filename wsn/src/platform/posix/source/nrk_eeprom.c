@@ -0,0 +1,173 @@
+/*
+ * Host (POSIX) EEPROM.
+ *
+ * The 4 KiB EEPROM of the atmega128rfa1 is a RAM image that starts out
+ * erased (0xFF).  When NRK_POSIX_EEPROM names a file the image is loaded
+ * from it and every write goes straight back to it, so configuration
+ * survives restarts just like it does on a node.  Give each simulated node
+ * its own file.
+ */
+
+#define _GNU_SOURCE
+#include <nrk_eeprom.h>
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <nrk_error.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static uint8_t _nrk_posix_eeprom[E2END+1];
+static int _nrk_posix_eeprom_fd = -1;
+static uint8_t _nrk_posix_eeprom_loaded;
+
+static void _nrk_posix_eeprom_load(void)
+{
+char *path;
+
+if(_nrk_posix_eeprom_loaded) return;
+_nrk_posix_eeprom_loaded=1;
+memset(_nrk_posix_eeprom,0xFF,sizeof(_nrk_posix_eeprom));
+
+path=getenv("NRK_POSIX_EEPROM");
+if(path==NULL) return;
+_nrk_posix_eeprom_fd=open(path,O_RDWR|O_CREAT,0644);
+if(_nrk_posix_eeprom_fd<0)
+	{
+	perror(path);
+	return;
+	}
+// A short (or new) file leaves the rest of the image erased
+if(pread(_nrk_posix_eeprom_fd,_nrk_posix_eeprom,sizeof(_nrk_posix_eeprom),0)<0)
+	perror(path);
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+uint16_t a;
+
+_nrk_posix_eeprom_load();
+a=(uint16_t)(uintptr_t)addr;
+if(a>E2END) return 0xFF;
+return _nrk_posix_eeprom[a];
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+uint16_t a;
+
+_nrk_posix_eeprom_load();
+a=(uint16_t)(uintptr_t)addr;
+if(a>E2END) return;
+_nrk_posix_eeprom[a]=value;
+if(_nrk_posix_eeprom_fd>=0 && pwrite(_nrk_posix_eeprom_fd,&value,1,a)!=1)
+	perror("eeprom");
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+if(eeprom_read_byte(addr)!=value) eeprom_write_byte(addr,value);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+size_t i;
+
+for(i=0; i<n; i++ )
+	((uint8_t *)dst)[i]=eeprom_read_byte((const uint8_t *)src+i);
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+size_t i;
+
+for(i=0; i<n; i++ )
+	eeprom_write_byte((uint8_t *)dst+i,((const uint8_t *)src)[i]);
+}
+
+uint8_t nrk_eeprom_read_byte( uint16_t addr )
+{
+uint8_t v;
+v=eeprom_read_byte((uint8_t*)(uintptr_t)addr);
+return v;
+}
+
+int8_t nrk_eeprom_write_byte( uint16_t addr, uint8_t value )
+{
+eeprom_write_byte( (uint8_t*)(uintptr_t)addr, value );
+return NRK_OK;
+}
+
+int8_t read_eeprom_mac_address(uint32_t *mac_addr)
+{
+uint8_t checksum,ct;
+uint8_t *buf;
+buf=(uint8_t *)mac_addr;
+checksum=buf[0]+buf[1]+buf[2]+buf[3];
+buf[3]=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_MAC_ADDR_0);
+buf[2]=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_MAC_ADDR_1);
+buf[1]=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_MAC_ADDR_2);
+buf[0]=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_MAC_ADDR_3);
+checksum=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_MAC_ADDR_CHKSUM);
+ct=buf[0];
+ct+=buf[1];
+ct+=buf[2];
+ct+=buf[3];
+if(checksum==ct) return NRK_OK;
+
+return NRK_ERROR;
+}
+
+int8_t read_eeprom_channel(uint8_t *channel)
+{
+  *channel=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_CHANNEL);
+return NRK_OK;
+}
+
+int8_t write_eeprom_load_img_pages(uint8_t *load_pages)
+{
+  eeprom_write_byte ((uint8_t*)(uintptr_t)EE_LOAD_IMG_PAGES, *load_pages);
+  return NRK_OK;
+}
+
+int8_t read_eeprom_load_img_pages(uint8_t *load_pages)
+{
+  *load_pages=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_LOAD_IMG_PAGES);
+  return NRK_OK;
+}
+
+int8_t read_eeprom_aes_key(uint8_t *aes_key)
+{
+uint8_t i;
+for(i=0; i<16; i++ )
+  {
+  aes_key[i]=eeprom_read_byte ((uint8_t*)(uintptr_t)(EE_AES_KEY+i));
+  }
+  return NRK_OK;
+}
+
+int8_t write_eeprom_aes_key(uint8_t *aes_key)
+{
+uint8_t i;
+for(i=0; i<16; i++ )
+  {
+  eeprom_write_byte ((uint8_t*)(uintptr_t)(EE_AES_KEY+i),aes_key[i]);
+  }
+  return NRK_OK;
+}
+
+int8_t read_eeprom_current_image_checksum(uint8_t *image_checksum)
+{
+  *image_checksum=eeprom_read_byte ((uint8_t*)(uintptr_t)EE_CURRENT_IMAGE_CHECKSUM);
+  return NRK_OK;
+}
+
+int8_t write_eeprom_current_image_checksum(uint8_t *image_checksum)
+{
+  eeprom_write_byte ((uint8_t*)(uintptr_t)EE_CURRENT_IMAGE_CHECKSUM, *image_checksum);
+  return NRK_OK;
+}
+
+
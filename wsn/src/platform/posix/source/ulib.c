@@ -0,0 +1,704 @@
+/*
+ * Host (POSIX) platform library.
+ *
+ * UART0 is a pseudo terminal: the slave path is printed on stderr (and
+ * optionally symlinked to $NRK_POSIX_PTY_LINK) so that the dicio server, or
+ * a terminal program, can open it like the FireFly's USB serial port.
+ * Setting NRK_POSIX_UART=stdio uses the process' own stdin/stdout instead.
+ * Received bytes go through the same ring buffer and rx signal as on the
+ * FireFly3, so the NRK_UART_BUF code paths are exercised unchanged.
+ *
+ * GPIO ports are byte arrays (see avr/io.h); output changes are logged on
+ * stderr, and SIGUSR1 presses the button on PD1 (INT1) for a moment.
+ */
+
+#define _GNU_SOURCE
+#include <include.h>
+#include <ulib.h>
+#include <nrk_timer.h>  // before errno.h, nrk_task.h has an errno field
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <hal.h>
+#include <hal_posix.h>
+#include <nrk_cpu.h>
+#include <avr/interrupt.h>
+#include <nrk_pin_define.h>
+#include <nrk_error.h>
+#include <nrk_events.h>
+#include <nrk_trace.h>
+
+#ifdef NANORK
+#include <nrk_cfg.h>
+#endif
+
+// How long a SIGUSR1 button press holds the button down
+#define POSIX_BUTTON_HOLD_NS	250000000ULL
+
+volatile uint8_t _nrk_posix_port[7];
+volatile uint8_t _nrk_posix_ddr[7];
+volatile uint8_t _nrk_posix_pin[7];
+volatile uint8_t PRR0;
+volatile uint8_t SPCR;
+
+// Level driven onto each input pin from outside; pulled up by default
+static uint8_t _nrk_posix_ext[7] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+static uint8_t _nrk_posix_spi_dr;
+static uint8_t _nrk_posix_spi_sr;
+static uint8_t _nrk_posix_spi_busy;
+
+static int _nrk_posix_uart_rx_fd = -1;
+static int _nrk_posix_uart_tx_fd = -1;
+
+static uint64_t _nrk_posix_boot_ns;
+static uint8_t _nrk_posix_quiet;
+static const char *_nrk_posix_name;
+
+static volatile sig_atomic_t _nrk_posix_button_req;
+static uint64_t _nrk_posix_button_release;
+
+static uint8_t _nrk_posix_spi_idle(uint8_t out)
+{
+return 0x00;
+}
+
+uint8_t (*_nrk_posix_spi_xfer)(uint8_t out) = _nrk_posix_spi_idle;
+
+void _nrk_posix_log(const char *fmt, ...)
+{
+va_list ap;
+uint64_t t;
+
+if(_nrk_posix_quiet) return;
+t=(_nrk_posix_now_ns()-_nrk_posix_boot_ns)/1000000ULL;
+fprintf(stderr,"[%s %lu.%03lu] ",_nrk_posix_name,
+	(unsigned long)(t/1000),(unsigned long)(t%1000));
+va_start(ap,fmt);
+vfprintf(stderr,fmt,ap);
+va_end(ap);
+fputc('\n',stderr);
+}
+
+uint16_t _nrk_posix_mac_addr(uint16_t def)
+{
+static int32_t mac=-1;
+char *s;
+
+if(mac<0)
+	{
+	s=getenv("NRK_POSIX_MAC");
+	mac=(s!=NULL) ? (int32_t)(strtoul(s,NULL,0) & 0xFFFF) : def;
+	}
+return (uint16_t)mac;
+}
+
+static void _nrk_posix_button_signal(int sig)
+{
+_nrk_posix_button_req=1;
+}
+
+static void __attribute__ ((constructor)) _nrk_posix_ulib_boot(void)
+{
+struct sigaction sa;
+
+_nrk_posix_boot_ns=_nrk_posix_now_ns();
+_nrk_posix_quiet=(getenv("NRK_POSIX_QUIET")!=NULL);
+_nrk_posix_name=getenv("NRK_POSIX_NAME");
+if(_nrk_posix_name==NULL) _nrk_posix_name="nrk";
+
+// No SA_RESTART: the signal has to cut an idle ppoll() short
+memset(&sa,0,sizeof(sa));
+sa.sa_handler=_nrk_posix_button_signal;
+sigemptyset(&sa.sa_mask);
+sigaction(SIGUSR1,&sa,NULL);
+}
+
+//---------------------------------------------------------------------------------------------
+// UART0 on a pseudo terminal
+
+static void _nrk_posix_uart_write(const char *buf, size_t len)
+{
+ssize_t n;
+
+while(len>0)
+	{
+	n=write(_nrk_posix_uart_tx_fd,buf,len);
+	// Nobody draining the pty is an unplugged cable: drop the bytes
+	if(n<0 && errno==EINTR) continue;
+	if(n<=0) return;
+	buf+=n;
+	len-=n;
+	}
+}
+
+static void _nrk_posix_uart_open(void)
+{
+struct termios t;
+char *s,*name,*link;
+char fd_str[12];
+int fd,slave;
+
+if(_nrk_posix_uart_tx_fd>=0) return;
+
+// A watchdog reset re-executes the process; keep the same pty so that the
+// host side stays connected across it
+s=getenv("NRK_POSIX_UART_FD");
+if(s!=NULL)
+	{
+	fd=atoi(s);
+	if(fcntl(fd,F_GETFD)!=-1)
+		{
+		_nrk_posix_uart_rx_fd=_nrk_posix_uart_tx_fd=fd;
+		return;
+		}
+	}
+
+s=getenv("NRK_POSIX_UART");
+if(s!=NULL && strcmp(s,"stdio")==0)
+	{
+	_nrk_posix_uart_rx_fd=STDIN_FILENO;
+	_nrk_posix_uart_tx_fd=STDOUT_FILENO;
+	return;
+	}
+
+fd=posix_openpt(O_RDWR|O_NOCTTY);
+if(fd<0 || grantpt(fd)<0 || unlockpt(fd)<0 || (name=ptsname(fd))==NULL)
+	{
+	_nrk_posix_log("uart0: no pty (%s)",strerror(errno));
+	exit(EXIT_FAILURE);
+	}
+
+// Hold the slave open so that the master never reads a hangup when the
+// host side closes the port, and make it a raw 8N1 line
+slave=open(name,O_RDWR|O_NOCTTY);
+if(slave>=0 && tcgetattr(slave,&t)==0)
+	{
+	cfmakeraw(&t);
+	tcsetattr(slave,TCSANOW,&t);
+	}
+fcntl(fd,F_SETFL,fcntl(fd,F_GETFL)|O_NONBLOCK);
+
+link=getenv("NRK_POSIX_PTY_LINK");
+if(link!=NULL)
+	{
+	unlink(link);
+	if(symlink(name,link)<0) _nrk_posix_log("uart0: cannot link %s (%s)",link,strerror(errno));
+	}
+_nrk_posix_log("uart0 on %s",name);
+
+snprintf(fd_str,sizeof(fd_str),"%d",fd);
+setenv("NRK_POSIX_UART_FD",fd_str,1);
+_nrk_posix_uart_rx_fd=_nrk_posix_uart_tx_fd=fd;
+}
+
+#ifdef NRK_UART_BUF
+#include <nrk_events.h>
+
+#ifndef MAX_RX_UART_BUF
+#define MAX_RX_UART_BUF    16
+#endif
+
+
+static uint16_t uart_rx_buf_start,uart_rx_buf_end;
+static char uart_rx_buf[MAX_RX_UART_BUF];
+static nrk_sig_t uart_rx_signal;
+
+static void _nrk_posix_uart0_rx_isr(void)
+{
+char c[MAX_RX_UART_BUF];
+ssize_t n,i;
+NRK_TRACE_EVENT(NRK_TRACE_ISR,NRK_TRACE_IRQ_UART0_RX);
+nrk_int_disable();
+   n=read(_nrk_posix_uart_rx_fd,c,sizeof(c));
+   if(n==0)
+	{
+	// End of input (stdio mode): nothing more will arrive
+	_nrk_posix_irq_unregister(_nrk_posix_uart0_rx_isr);
+	_nrk_posix_log("uart0 input closed");
+	}
+   // Bytes land in the ring one at a time, overrunning it as the AVR would
+   for(i=0; i<n; i++ )
+	{
+	uart_rx_buf[uart_rx_buf_end]=c[i];
+	uart_rx_buf_end++;
+	if(uart_rx_buf_end==MAX_RX_UART_BUF) {
+		uart_rx_buf_end=0;
+		}
+	}
+   if(n>0) nrk_event_signal(uart_rx_signal);
+nrk_int_enable();
+}
+
+char getc0()
+{
+char tmp;
+int8_t v;
+
+v=NRK_OK;
+if(uart_rx_buf_start==uart_rx_buf_end) { nrk_signal_register(uart_rx_signal); v=nrk_event_wait(uart_rx_signal); }
+if(v==NRK_ERROR ) nrk_kprintf(PSTR("uart rx sig failed\r\n" ));
+   tmp=uart_rx_buf[uart_rx_buf_start];
+   uart_rx_buf_start++;
+   if(uart_rx_buf_start>=MAX_RX_UART_BUF) { uart_rx_buf_start=0; }
+
+   return tmp;
+}
+
+uint8_t nrk_uart_data_ready(uint8_t uart_num)
+{
+if(uart_num==0)
+        {
+	if(uart_rx_buf_start!=uart_rx_buf_end) return 1;
+        }
+return 0;
+}
+
+nrk_sig_t nrk_uart_rx_signal_get()
+{
+   if(uart_rx_signal==NRK_ERROR) nrk_error_add(NRK_SIGNAL_CREATE_ERROR);
+   return uart_rx_signal;
+}
+
+#else
+
+nrk_sig_t nrk_uart_rx_signal_get()
+{
+   return NRK_ERROR;
+}
+
+
+uint8_t nrk_uart_data_ready(uint8_t uart_num)
+{
+struct pollfd pfd;
+
+if(uart_num==0 && _nrk_posix_uart_rx_fd>=0)
+        {
+	pfd.fd=_nrk_posix_uart_rx_fd;
+	pfd.events=POLLIN;
+	if(poll(&pfd,1,0)>0 && (pfd.revents & POLLIN)) return 1;
+        }
+return 0;
+}
+
+char getc0(void){
+        char tmp;
+        while(read(_nrk_posix_uart_rx_fd,&tmp,1)!=1) nrk_spin_wait_us(1000);
+        return tmp;
+}
+
+#endif
+
+void nrk_kprintf( const char *addr)
+{
+ char c;
+   while((c=pgm_read_byte(addr++)))
+        putchar(c);
+}
+
+void nrk_setup_ports()
+{
+PORT_INIT();
+}
+
+//---------------------------------------------------------------------------------------------
+// GPIO related definitions
+//---------------------------------------------------------------------------------------------
+// Define high-level nrk pins mappings to hardware pins and ports
+// This is used for nrk_gpio_... functions.
+// Raw GPIO mapping can be found in the nrk_pin_define.h file.
+//---------------------------------------------------------------------------------------------
+
+//-------------------------------
+// Port A
+NRK_INVALID_PIN(PORTA_0);
+NRK_INVALID_PIN(PORTA_1);
+NRK_INVALID_PIN(PORTA_2);
+NRK_INVALID_PIN(PORTA_3);
+NRK_INVALID_PIN(PORTA_4);
+NRK_INVALID_PIN(PORTA_5);
+NRK_INVALID_PIN(PORTA_6);
+NRK_INVALID_PIN(PORTA_7);
+NRK_INVALID_PIN(DEBUG_0);
+NRK_INVALID_PIN(DEBUG_1);
+NRK_INVALID_PIN(DEBUG_2);
+NRK_INVALID_PIN(DEBUG_3);
+
+//-------------------------------
+// Port B
+NRK_PIN( SPI_SS,SPI_SS, NRK_PORTB )
+NRK_PIN( SCK,SCK, NRK_PORTB )
+NRK_PIN( MOSI,MOSI, NRK_PORTB )
+NRK_PIN( MISO,MISO, NRK_PORTB )
+
+NRK_PIN( PORTB_0,PORTB_0, NRK_PORTB )
+NRK_PIN( PORTB_1,PORTB_1, NRK_PORTB )
+NRK_PIN( PORTB_2,PORTB_2, NRK_PORTB )
+NRK_PIN( PORTB_3,PORTB_3, NRK_PORTB )
+NRK_PIN( PORTB_4,PORTB_4, NRK_PORTB )
+NRK_PIN( PORTB_5,PORTB_5, NRK_PORTB )
+NRK_PIN( PORTB_6,PORTB_6, NRK_PORTB )
+NRK_PIN( PORTB_7,PORTB_7, NRK_PORTB )
+
+
+NRK_INVALID_PIN(PORTC_0);
+NRK_INVALID_PIN(PORTC_1);
+NRK_INVALID_PIN(PORTC_2);
+NRK_INVALID_PIN(PORTC_3);
+NRK_INVALID_PIN(PORTC_4);
+NRK_INVALID_PIN(PORTC_5);
+NRK_INVALID_PIN(PORTC_6);
+NRK_INVALID_PIN(PORTC_7);
+
+
+//-------------------------------
+// Port D
+
+NRK_PIN( PORTD_0,PORTD_0, NRK_PORTD )
+NRK_PIN( PORTD_1,PORTD_1, NRK_PORTD )
+NRK_PIN( PORTD_2,PORTD_2, NRK_PORTD )
+NRK_PIN( PORTD_3,PORTD_3, NRK_PORTD )
+NRK_PIN( PORTD_4,PORTD_4, NRK_PORTD )
+NRK_PIN( PORTD_5,PORTD_5, NRK_PORTD )
+NRK_PIN( PORTD_6,PORTD_6, NRK_PORTD )
+NRK_PIN( PORTD_7,PORTD_7, NRK_PORTD )
+
+
+NRK_PIN( BUTTON,BUTTON, NRK_PORTD )
+NRK_PIN( UART1_RXD,UART1_RXD, NRK_PORTD )
+NRK_PIN( UART1_TXD,UART1_TXD, NRK_PORTD )
+NRK_PIN( LED_0,LED_0, NRK_PORTD )
+NRK_PIN( LED_1,LED_1, NRK_PORTD )
+NRK_PIN( LED_2,LED_2, NRK_PORTD )
+NRK_PIN( LED_3,LED_3, NRK_PORTD )
+
+//-------------------------------
+// Port E
+NRK_PIN( PORTE_0,PORTE_0, NRK_PORTE )
+NRK_PIN( PORTE_1,PORTE_1, NRK_PORTE )
+NRK_PIN( PORTE_2,PORTE_2, NRK_PORTE )
+NRK_PIN( PORTE_3,PORTE_3, NRK_PORTE )
+NRK_PIN( PORTE_4,PORTE_4, NRK_PORTE )
+NRK_PIN( PORTE_5,PORTE_5, NRK_PORTE )
+NRK_PIN( PORTE_6,PORTE_6, NRK_PORTE )
+NRK_PIN( PORTE_7,PORTE_7, NRK_PORTE )
+
+NRK_PIN( UART0_RXD,UART0_RXD, NRK_PORTE )
+NRK_PIN( UART0_TXD,UART0_TXD, NRK_PORTE )
+
+NRK_INVALID_PIN( ANT_0 )
+NRK_INVALID_PIN( ANT_1 )
+
+NRK_PIN( PORTG_0,PORTG_0, NRK_PORTG )
+NRK_PIN( PORTG_1,PORTG_1, NRK_PORTG )
+NRK_PIN( PORTG_2,PORTG_2, NRK_PORTG )
+NRK_PIN( PORTG_3,PORTG_3, NRK_PORTG )
+NRK_PIN( PORTG_4,PORTG_4, NRK_PORTG )
+NRK_PIN( PORTG_5,PORTG_5, NRK_PORTG )
+
+//-------------------------------
+// Port F
+NRK_PIN( PORTF_0, PORTF_0, NRK_PORTF )
+NRK_PIN( PORTF_1, PORTF_1, NRK_PORTF )
+NRK_PIN( PORTF_2, PORTF_2, NRK_PORTF )
+NRK_PIN( PORTF_3, PORTF_3, NRK_PORTF )
+NRK_PIN( PORTF_4, PORTF_4, NRK_PORTF )
+NRK_PIN( PORTF_5, PORTF_5, NRK_PORTF )
+NRK_PIN( PORTF_6, PORTF_6, NRK_PORTF )
+NRK_PIN( PORTF_7, PORTF_7, NRK_PORTF )
+NRK_PIN( ADC_INPUT_0, ADC_INPUT_0, NRK_PORTF )
+NRK_PIN( ADC_INPUT_1, ADC_INPUT_1, NRK_PORTF )
+NRK_PIN( ADC_INPUT_2, ADC_INPUT_2, NRK_PORTF )
+NRK_PIN( ADC_INPUT_3, ADC_INPUT_3, NRK_PORTF )
+NRK_PIN( ADC_INPUT_4, ADC_INPUT_4, NRK_PORTF )
+NRK_PIN( ADC_INPUT_5, ADC_INPUT_5, NRK_PORTF )
+NRK_PIN( ADC_INPUT_6, ADC_INPUT_6, NRK_PORTF )
+NRK_PIN( ADC_INPUT_7, ADC_INPUT_7, NRK_PORTF )
+
+// SIGUSR1 presses the button: PD1 is pulled low for a moment, which
+// reaches INT1 through the pin change logic like a real press would
+static void _nrk_posix_button_isr(void)
+{
+if(_nrk_posix_button_req)
+	{
+	_nrk_posix_button_req=0;
+	_nrk_posix_button_release=_nrk_posix_now_ns()+POSIX_BUTTON_HOLD_NS;
+	_nrk_posix_log("button pressed");
+	_nrk_posix_gpio_input(NRK_BUTTON,0);
+	}
+else if(_nrk_posix_button_release!=0 && _nrk_posix_now_ns()>=_nrk_posix_button_release)
+	{
+	_nrk_posix_button_release=0;
+	_nrk_posix_gpio_input(NRK_BUTTON,1);
+	}
+}
+
+void PORT_INIT(void) 
+{
+#ifdef SPI_SS_PULLUP
+        DDRB  = BM(MOSI) | BM(SCK) | BM(SPI_SS);  
+        PORTB = BM(MOSI) | BM(SCK) | BM(SPI_SS); 
+#else
+        DDRB  = BM(MOSI) | BM(SCK);  
+        PORTB = BM(MOSI) | BM(SCK); 
+#endif
+        DDRD  = BM(LED_0) | BM(LED_1) | BM(LED_2) | BM(LED_3) |  BM(UART1_TXD) ; 
+	PORTD = BM(LED_0)|BM(LED_1)|BM(LED_2)|BM(LED_3);
+        DDRE = BM(UART0_TXD); 
+
+	_nrk_posix_irq_register(-1,_nrk_posix_button_isr);
+} 
+
+
+
+//-------------------------------
+// GPIO handling functions
+
+// Input pins read the external level, output pins read back what is driven
+static uint8_t _nrk_posix_pin_level(uint8_t port)
+{
+	_nrk_posix_pin[port]=(_nrk_posix_port[port] & _nrk_posix_ddr[port]) |
+		(_nrk_posix_ext[port] & ~_nrk_posix_ddr[port]);
+	return _nrk_posix_pin[port];
+}
+
+static void _nrk_posix_gpio_log(uint8_t port, uint8_t bit, uint8_t old)
+{
+uint8_t level;
+
+	level=_nrk_posix_pin_level(port);
+	if(((old ^ level) & BM(bit))==0 || (_nrk_posix_ddr[port] & BM(bit))==0) return;
+	level=!!(level & BM(bit));
+	// The LEDs are active low
+	if(port==NRK_PORTD && bit>=LED_0 && bit<=LED_3)
+		_nrk_posix_log("led %u %s",bit-LED_0,level ? "off" : "on");
+	else
+		_nrk_posix_log("gpio P%c%u = %u",'A'+port,bit,level);
+}
+
+static int8_t _nrk_posix_gpio_write(uint8_t pin, uint8_t op)
+{
+uint8_t port,bit,old;
+
+        if (pin == NRK_INVALID_PIN_VAL) return -1;
+        port=pin & 0x07;
+        bit=(pin & 0xF8) >> 3;
+        if (port > NRK_PORTG) return -1;
+        old=_nrk_posix_pin_level(port);
+        switch (op) {
+                case 0: _nrk_posix_port[port] &= ~BM(bit); break;
+                case 1: _nrk_posix_port[port] |= BM(bit); break;
+                default: _nrk_posix_port[port] ^= BM(bit); break;
+        }
+        _nrk_posix_gpio_log(port,bit,old);
+        return 1;
+}
+
+int8_t nrk_gpio_set(uint8_t pin)
+{
+        return _nrk_posix_gpio_write(pin,1);
+}
+
+int8_t nrk_gpio_clr(uint8_t pin)
+{
+        return _nrk_posix_gpio_write(pin,0);
+}
+
+int8_t nrk_gpio_get(uint8_t pin)
+{
+uint8_t port;
+
+        if (pin == NRK_INVALID_PIN_VAL) return -1;
+        port=pin & 0x07;
+        if (port > NRK_PORTG) return -1;
+        return !!(_nrk_posix_pin_level(port) & BM((pin & 0xF8) >> 3));
+}
+
+int8_t nrk_gpio_toggle(uint8_t pin)
+{
+        return _nrk_posix_gpio_write(pin,2);
+}
+
+int8_t nrk_gpio_direction(uint8_t pin, uint8_t pin_direction)
+{
+uint8_t port,bit,old;
+
+        if (pin == NRK_INVALID_PIN_VAL) return -1;
+        port=pin & 0x07;
+        bit=(pin & 0xF8) >> 3;
+        if (port > NRK_PORTG) return -1;
+        old=_nrk_posix_pin_level(port);
+        if (pin_direction == NRK_PIN_INPUT)
+                _nrk_posix_ddr[port] &= ~BM(bit);
+        else
+                _nrk_posix_ddr[port] |= BM(bit);
+        _nrk_posix_gpio_log(port,bit,old);
+        return 1;
+}
+
+void _nrk_posix_gpio_input(uint8_t pin, uint8_t level)
+{
+uint8_t port,bit,old;
+
+        if (pin == NRK_INVALID_PIN_VAL) return;
+        port=pin & 0x07;
+        bit=(pin & 0xF8) >> 3;
+        if (port > NRK_PORTG) return;
+        old=_nrk_posix_pin_level(port);
+        if (level) _nrk_posix_ext[port] |= BM(bit);
+        else _nrk_posix_ext[port] &= ~BM(bit);
+        if ((old ^ _nrk_posix_pin_level(port)) & BM(bit))
+                _nrk_posix_ext_int_pin(port,bit,level);
+}
+
+int8_t nrk_get_button(uint8_t b)
+{
+if(b==0) {
+	 return( !(_nrk_posix_pin_level(NRK_PORTD) & BM(BUTTON))); 
+	} 
+return -1;
+}
+
+int8_t nrk_led_toggle( int led )
+{
+if(led==0) { nrk_gpio_toggle(NRK_LED_0); return 1; }
+if(led==1) { nrk_gpio_toggle(NRK_LED_1); return 1; }
+if(led==2) { nrk_gpio_toggle(NRK_LED_2); return 1; }
+if(led==3) { nrk_gpio_toggle(NRK_LED_3); return 1; }
+return -1;
+}
+
+int8_t nrk_led_clr( int led )
+{
+if(led==0) { nrk_gpio_set(NRK_LED_0); return 1; }
+if(led==1) { nrk_gpio_set(NRK_LED_1); return 1; }
+if(led==2) { nrk_gpio_set(NRK_LED_2); return 1; }
+if(led==3) { nrk_gpio_set(NRK_LED_3); return 1; }
+return -1;
+}
+
+int8_t nrk_led_set( int led )
+{
+if(led==0) { nrk_gpio_clr(NRK_LED_0); return 1; }
+if(led==1) { nrk_gpio_clr(NRK_LED_1); return 1; }
+if(led==2) { nrk_gpio_clr(NRK_LED_2); return 1; }
+if(led==3) { nrk_gpio_clr(NRK_LED_3); return 1; }
+return -1;
+}
+
+int8_t nrk_gpio_pullups(uint8_t enable)
+{
+return NRK_OK;
+}
+
+
+//-------------------------------
+// SPI master
+//
+// Models the sequence the FireFly3 drivers use: writing SPDR with SPIF
+// clear starts a transfer, the next SPSR read completes it through
+// _nrk_posix_spi_xfer() and sets SPIF, and the SPDR access that follows
+// (the read of the received byte) clears SPIF again.
+
+volatile uint8_t *_nrk_posix_spdr(void)
+{
+if(_nrk_posix_spi_sr & BM(7)) _nrk_posix_spi_sr &= ~BM(7);
+else _nrk_posix_spi_busy=1;
+return &_nrk_posix_spi_dr;
+}
+
+volatile uint8_t *_nrk_posix_spsr(void)
+{
+if(_nrk_posix_spi_busy)
+	{
+	_nrk_posix_spi_busy=0;
+	_nrk_posix_spi_dr=_nrk_posix_spi_xfer(_nrk_posix_spi_dr);
+	_nrk_posix_spi_sr |= BM(7);
+	}
+return &_nrk_posix_spi_sr;
+}
+
+
+//-------------------------------
+// stdio on UART0
+
+static ssize_t _nrk_posix_stdout_write(void *cookie, const char *buf, size_t size)
+{
+_nrk_posix_uart_write(buf,size);
+return size;
+}
+
+static ssize_t _nrk_posix_stdin_read(void *cookie, char *buf, size_t size)
+{
+if(size==0) return 0;
+buf[0]=getc0();
+return 1;
+}
+
+void putc0(char x)
+{
+     _nrk_posix_uart_write(&x,1);
+}
+
+// There is no second UART on the host; UART1 output goes to stderr
+void putc1(char x)
+{
+     fputc(x,stderr);
+}
+
+void setup_uart0(uint16_t baudrate)
+{
+_nrk_posix_uart_open();
+}
+
+void setup_uart1(uint16_t baudrate)
+{
+}
+
+
+
+
+
+/**
+ * nrk_setup_uart()
+ *
+ * Sets a default uart for a given platform and
+ * direct stdin and stdout to that port.
+ *
+ * More advanced UART usage will require manually
+ * setting parameters.
+ */
+void nrk_setup_uart(uint16_t baudrate)
+{
+cookie_io_functions_t out = { NULL, _nrk_posix_stdout_write, NULL, NULL };
+cookie_io_functions_t in = { _nrk_posix_stdin_read, NULL, NULL, NULL };
+
+  setup_uart0(baudrate);
+
+  // Unbuffered, like fdevopen() streams on avr-libc
+  stdout = fopencookie( NULL, "w", out);
+  stdin = fopencookie( NULL, "r", in);
+  setvbuf(stdout, NULL, _IONBF, 0);
+  setvbuf(stdin, NULL, _IONBF, 0);
+
+#ifdef NRK_UART_BUF
+   uart_rx_signal=nrk_signal_create();
+   if(uart_rx_signal==NRK_ERROR) nrk_error_add(NRK_SIGNAL_CREATE_ERROR);
+   uart_rx_buf_start=0;
+   uart_rx_buf_end=0;
+   _nrk_posix_irq_register(_nrk_posix_uart_rx_fd,_nrk_posix_uart0_rx_isr);
+#endif
+
+}
+
+char getc1()
+{
+return 0;
+}
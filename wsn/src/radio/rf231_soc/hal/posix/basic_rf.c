@@ -0,0 +1,859 @@
+/******************************************************************************
+*  Nano-RK, a real-time operating system for sensor networks.
+*  Copyright (C) 2007, Real-Time and Multimedia Lab, Carnegie Mellon University
+*  All rights reserved.
+*
+*  This is the Open Source Version of Nano-RK included as part of a Dual
+*  Licensing Model. If you are unsure which license to use please refer to:
+*  http://www.nanork.org/nano-RK/wiki/Licensing
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, version 2.0 of the License.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+/*
+ * Host (POSIX) rf231 SoC radio on a simulated 802.15.4 medium.
+ *
+ * Every simulated node joins the same UDP multicast group on the loopback
+ * interface, the "ether".  A transmission is one datagram per frame that
+ * carries the frame and its time on air (CLOCK_MONOTONIC, which all the
+ * processes on one host share).  The sender stays busy for the frame's
+ * airtime at 250 kb/s, so the medium has the same timing as the real one.
+ *
+ * Each receiver applies its own view of the link from the link matrix:
+ *   - frames below RF_POSIX_SENSITIVITY are not heard at all,
+ *   - heard frames raise CCA while on air if they are above the threshold,
+ *   - frames that overlap in time collide, unless one of them is
+ *     RF_POSIX_CAPTURE_DB stronger than the other,
+ *   - a frame that survived fails its CRC with the link's loss rate,
+ *   - the link's latency delays the whole frame.
+ * The receiver only gets a frame if it was listening from its first
+ * symbol to its last and its frame buffer was free, as on the rf231.
+ *
+ * Configuration comes from the environment:
+ *   NRK_POSIX_ETHER   multicast group and port (default 239.255.21.54:15404)
+ *   NRK_POSIX_LINKS   link matrix file, one "src dst loss% rssi latency_us"
+ *                     per line, '*' matches any address and later lines
+ *                     override earlier ones.  A link that is not listed is
+ *                     out of range.  Without a file every node hears every
+ *                     other at -60 dBm with no loss and no latency.
+ *   NRK_POSIX_SEED    seed for the loss process, for repeatable runs
+ *
+ * Per node counters are written to stderr when the process exits.
+ */
+
+#define _GNU_SOURCE
+#include <include.h>
+#include <basic_rf.h>
+#include <ulib.h>
+#include <nrk.h>
+#include <nrk_error.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// 802.15.4 O-QPSK at 250 kb/s
+#define RF_POSIX_BYTE_NS	32000ULL
+#define RF_POSIX_PHY_HDR	6	// preamble, SFD and frame length
+#define RF_POSIX_MAC_HDR	9	// FCF, sequence number, PAN id, destination, source
+#define RF_POSIX_FCS		2
+#define RF_POSIX_ACK_LEN	5	// FCF, sequence number and FCS
+#define RF_POSIX_TURNAROUND_NS	192000ULL	// aTurnaroundTime, 12 symbols
+#define RF_POSIX_ACK_WAIT_NS	864000ULL	// macAckWaitDuration, 54 symbols
+
+// How much longer than the ack window the sender waits for the datagram,
+// to ride out host scheduling jitter of the receiving process
+#define RF_POSIX_ACK_GRACE_NS	2000000ULL
+
+#define RF_POSIX_SENSITIVITY	-100	// dBm
+#define RF_POSIX_CAPTURE_DB	6
+#define RF_POSIX_ED_BASE	-90	// dBm at ED level 0 (RSSI_BASE_VAL)
+#define RF_POSIX_ED_MAX		84
+
+#define RF_POSIX_DEFAULT_RSSI	-60
+#define RF_POSIX_OUT_OF_RANGE	-128
+
+// Frames that one receiver can follow on air at the same time
+#define RF_POSIX_AIR_SLOTS	16
+
+#define RF_POSIX_ETHER		"239.255.21.54:15404"
+#define RF_POSIX_MAGIC		0x4e524b45
+
+#define RF_POSIX_FLAG_ACK_REQ	0x01
+#define RF_POSIX_FLAG_ACK	0x02
+
+// Wildcard address in the link matrix
+#define RF_POSIX_ANY		0x10000
+
+typedef struct rf_posix_frame {
+	uint32_t magic;
+	uint32_t station;	// sending process, to skip our own loopback copy
+	uint64_t start_ns;	// first preamble symbol on air
+	uint64_t end_ns;	// last FCS symbol on air
+	uint16_t pan;
+	uint16_t src;
+	uint16_t dest;
+	uint8_t channel;
+	uint8_t seq;
+	uint8_t flags;
+	int8_t power;		// tx power below the maximum, in dB
+	uint8_t length;		// payload bytes
+	uint8_t payload[RF_MAX_PAYLOAD_SIZE];
+} __attribute__ ((packed)) rf_posix_frame_t;
+
+#define RF_POSIX_FRAME_HDR	(sizeof(rf_posix_frame_t)-RF_MAX_PAYLOAD_SIZE)
+
+typedef struct rf_posix_link {
+	uint32_t src;
+	uint32_t dst;
+	uint8_t loss;		// percent of frames that fail the CRC
+	int8_t rssi;		// dBm at the receiver, sender at full power
+	uint32_t latency_us;
+} rf_posix_link_t;
+
+typedef struct rf_posix_air {
+	rf_posix_frame_t f;
+	int8_t rssi;
+	uint8_t loss;
+	uint8_t collided;
+	uint8_t used;
+} rf_posix_air_t;
+
+typedef struct rf_posix_stats {
+	uint32_t tx_frames;
+	uint32_t tx_no_ack;
+	uint32_t tx_cca_fail;
+	uint64_t tx_air_ns;
+	uint32_t rx_frames;
+	uint32_t rx_acks;
+	uint32_t rx_collided;
+	uint32_t rx_lost;
+	uint32_t rx_missed;	// receiver off, asleep or transmitting
+	uint32_t rx_overrun;	// frame buffer still held the last frame
+	uint32_t cca_busy;
+} rf_posix_stats_t;
+
+// rf231 TX_PWR settings 0x0 (+3 dBm) to 0xF (-17 dBm), in dB below +3 dBm
+static const int8_t rf_posix_tx_atten[16] =
+	{ 0, 0, 1, 1, 2, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20 };
+
+nrk_sem_t *radio_sem;
+
+volatile RF_SETTINGS rfSettings;
+uint8_t rf_ready;
+volatile uint8_t rx_ready;
+
+void (*rx_start_func)(void) = 0;
+void (*rx_end_func)(void) = 0;
+
+static int rf_posix_sock = -1;
+static struct sockaddr_in rf_posix_ether;
+static uint32_t rf_posix_station;
+static unsigned short rf_posix_rand[3];
+
+static rf_posix_link_t *rf_posix_links;
+static uint16_t rf_posix_link_cnt;
+static uint8_t rf_posix_link_file;
+
+static uint8_t rf_posix_channel;
+static int8_t rf_posix_cca_dbm;
+static int8_t rf_posix_power;
+static uint8_t rf_posix_auto_ack;
+static uint8_t rf_posix_addr_decode;
+static uint8_t rf_posix_sleeping;
+static uint8_t rf_posix_busy;
+
+static uint64_t rf_posix_rx_since;	// receiver on since, 0 when off
+static uint64_t rf_posix_tx_start;	// our last transmission; deaf meanwhile
+static uint64_t rf_posix_tx_end;
+
+static uint8_t rf_posix_ack_wait;
+static uint8_t rf_posix_ack_seq;
+static uint8_t rf_posix_ack_got;
+static uint64_t rf_posix_ack_deadline;
+
+static rf_posix_air_t rf_posix_air[RF_POSIX_AIR_SLOTS];
+static uint64_t rf_posix_next_end = ~0ULL;
+
+// The frame buffer (TRXFBST) and what the PHY measured for its frame
+static rf_posix_frame_t rf_posix_rx_buf;
+static int8_t rf_posix_rx_rssi;
+static uint8_t rf_posix_rx_lqi;
+
+static rf_posix_stats_t rf_posix_stats;
+
+static void rf_posix_service(void);
+
+
+static uint64_t rf_posix_airtime(uint8_t mpdu_len)
+{
+	return (uint64_t)(RF_POSIX_PHY_HDR + mpdu_len) * RF_POSIX_BYTE_NS;
+}
+
+static void rf_posix_send(rf_posix_frame_t *f)
+{
+	ssize_t n;
+
+	f->magic = RF_POSIX_MAGIC;
+	f->station = rf_posix_station;
+	do {
+		n = sendto(rf_posix_sock, f, RF_POSIX_FRAME_HDR + f->length, 0,
+				(struct sockaddr *)&rf_posix_ether, sizeof(rf_posix_ether));
+	} while(n < 0 && errno == EINTR);
+}
+
+static void rf_posix_load_links(void)
+{
+	char line[128], src[16], dst[16];
+	unsigned int loss, latency;
+	int rssi;
+	rf_posix_link_t *l;
+	FILE *fp;
+	char *name;
+
+	name = getenv("NRK_POSIX_LINKS");
+	if(name == NULL)
+		return;
+	fp = fopen(name, "r");
+	if(fp == NULL){
+		_nrk_posix_log("rf links %s: %s", name, strerror(errno));
+		return;
+	}
+	rf_posix_link_file = 1;
+	while(fgets(line, sizeof(line), fp) != NULL){
+		if(line[0] == '#')
+			continue;
+		if(sscanf(line, "%15s %15s %u %d %u", src, dst, &loss, &rssi, &latency) != 5)
+			continue;
+		l = realloc(rf_posix_links, (rf_posix_link_cnt + 1) * sizeof(rf_posix_link_t));
+		if(l == NULL)
+			break;
+		rf_posix_links = l;
+		l = &rf_posix_links[rf_posix_link_cnt++];
+		l->src = (src[0] == '*') ? RF_POSIX_ANY : (strtoul(src, NULL, 0) & 0xFFFF);
+		l->dst = (dst[0] == '*') ? RF_POSIX_ANY : (strtoul(dst, NULL, 0) & 0xFFFF);
+		l->loss = (loss > 100) ? 100 : loss;
+		l->rssi = (rssi < -128) ? -128 : ((rssi > 127) ? 127 : rssi);
+		l->latency_us = latency;
+	}
+	fclose(fp);
+	_nrk_posix_log("rf %u links from %s", rf_posix_link_cnt, name);
+}
+
+// Link from src to this node; the last matching line of the file wins
+static rf_posix_link_t rf_posix_link(uint16_t src)
+{
+	static rf_posix_link_t in_range = { RF_POSIX_ANY, RF_POSIX_ANY, 0, RF_POSIX_DEFAULT_RSSI, 0 };
+	static rf_posix_link_t out_of_range = { RF_POSIX_ANY, RF_POSIX_ANY, 100, RF_POSIX_OUT_OF_RANGE, 0 };
+	rf_posix_link_t *l;
+	uint16_t i;
+
+	for(i = rf_posix_link_cnt; i > 0; i--){
+		l = &rf_posix_links[i-1];
+		if((l->src == RF_POSIX_ANY || l->src == src) &&
+				(l->dst == RF_POSIX_ANY || l->dst == rfSettings.myAddr))
+			return *l;
+	}
+	return rf_posix_link_file ? out_of_range : in_range;
+}
+
+static void rf_posix_report(void)
+{
+	_nrk_posix_log("rf tx %u frames %llu ms air %u no-ack %u cca-fail"
+			" rx %u frames %u acks %u collided %u lost %u missed %u overrun %u cca-busy",
+			rf_posix_stats.tx_frames,
+			(unsigned long long)(rf_posix_stats.tx_air_ns / 1000000ULL),
+			rf_posix_stats.tx_no_ack, rf_posix_stats.tx_cca_fail,
+			rf_posix_stats.rx_frames, rf_posix_stats.rx_acks,
+			rf_posix_stats.rx_collided, rf_posix_stats.rx_lost,
+			rf_posix_stats.rx_missed, rf_posix_stats.rx_overrun,
+			rf_posix_stats.cca_busy);
+}
+
+// Datagrams arrived on the ether
+static void rf_posix_isr(void)
+{
+	rf_posix_service();
+}
+
+// Polled on every dispatch: finish the frames whose last symbol has passed
+static void rf_posix_end_isr(void)
+{
+	if(rf_posix_next_end <= _nrk_posix_now_ns())
+		rf_posix_service();
+	else if(rf_posix_next_end != ~0ULL)
+		_nrk_posix_irq_wake(rf_posix_next_end);
+}
+
+static int8_t rf_posix_open(void)
+{
+	struct sockaddr_in any;
+	struct ip_mreq mreq;
+	char ether[64], *s, *port;
+	uint32_t seed;
+	int one = 1, rcvbuf = 256 * 1024;
+	unsigned char loop = 1;
+	struct in_addr lo;
+
+	if(rf_posix_sock >= 0)
+		return NRK_OK;
+
+	s = getenv("NRK_POSIX_ETHER");
+	snprintf(ether, sizeof(ether), "%s", (s != NULL) ? s : RF_POSIX_ETHER);
+	port = strchr(ether, ':');
+	if(port != NULL)
+		*port++ = '\0';
+	memset(&rf_posix_ether, 0, sizeof(rf_posix_ether));
+	rf_posix_ether.sin_family = AF_INET;
+	rf_posix_ether.sin_port = htons((port != NULL) ? atoi(port) : 15404);
+	if(inet_aton(ether, &rf_posix_ether.sin_addr) == 0){
+		_nrk_posix_log("rf bad ether %s", ether);
+		return NRK_ERROR;
+	}
+
+	rf_posix_sock = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(rf_posix_sock < 0){
+		_nrk_posix_log("rf socket: %s", strerror(errno));
+		return NRK_ERROR;
+	}
+	setsockopt(rf_posix_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	setsockopt(rf_posix_sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+	// Every node binds the group port; the kernel hands each a copy
+	any = rf_posix_ether;
+	any.sin_addr.s_addr = htonl(INADDR_ANY);
+	if(bind(rf_posix_sock, (struct sockaddr *)&any, sizeof(any)) < 0){
+		_nrk_posix_log("rf bind: %s", strerror(errno));
+		close(rf_posix_sock);
+		rf_posix_sock = -1;
+		return NRK_ERROR;
+	}
+	lo.s_addr = htonl(INADDR_LOOPBACK);
+	mreq.imr_multiaddr = rf_posix_ether.sin_addr;
+	mreq.imr_interface = lo;
+	setsockopt(rf_posix_sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+	setsockopt(rf_posix_sock, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo));
+	setsockopt(rf_posix_sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+	rf_posix_station = (uint32_t)getpid();
+	s = getenv("NRK_POSIX_SEED");
+	seed = (s != NULL) ? (uint32_t)strtoul(s, NULL, 0) : (uint32_t)_nrk_posix_now_ns();
+	rf_posix_rand[0] = seed & 0xFFFF;
+	rf_posix_rand[1] = seed >> 16;
+	rf_posix_rand[2] = (s != NULL) ? _nrk_posix_mac_addr(0) : rf_posix_station;
+
+	rf_posix_load_links();
+	_nrk_posix_irq_register(rf_posix_sock, rf_posix_isr);
+	_nrk_posix_irq_register(-1, rf_posix_end_isr);
+	atexit(rf_posix_report);
+	_nrk_posix_log("rf ether %s:%u", ether, ntohs(rf_posix_ether.sin_port));
+	return NRK_OK;
+}
+
+// A frame was heard: track it on air and resolve overlaps
+static void rf_posix_arrive(rf_posix_frame_t *f)
+{
+	rf_posix_link_t link;
+	rf_posix_air_t *a, *slot;
+	uint64_t latency;
+	uint8_t collided;
+	int16_t rssi;
+	uint8_t i;
+
+	if(f->channel != rf_posix_channel)
+		return;
+	link = rf_posix_link(f->src);
+	rssi = link.rssi - f->power;
+	if(rssi < RF_POSIX_SENSITIVITY)
+		return;
+	latency = (uint64_t)link.latency_us * 1000ULL;
+	f->start_ns += latency;
+	f->end_ns += latency;
+
+	slot = NULL;
+	collided = 0;
+	for(i = 0; i < RF_POSIX_AIR_SLOTS; i++){
+		a = &rf_posix_air[i];
+		if(!a->used){
+			if(slot == NULL)
+				slot = a;
+			continue;
+		}
+		if(a->f.start_ns >= f->end_ns || f->start_ns >= a->f.end_ns)
+			continue;
+		if(rssi >= a->rssi + RF_POSIX_CAPTURE_DB)
+			a->collided = 1;
+		else if(a->rssi >= rssi + RF_POSIX_CAPTURE_DB)
+			collided = 1;
+		else {
+			a->collided = 1;
+			collided = 1;
+		}
+	}
+	// More overlapping frames than we can follow are just noise
+	if(slot == NULL)
+		return;
+	slot->f = *f;
+	slot->collided = collided;
+	slot->rssi = rssi;
+	slot->loss = link.loss;
+	slot->used = 1;
+	if(f->end_ns < rf_posix_next_end)
+		rf_posix_next_end = f->end_ns;
+}
+
+// The last symbol of a tracked frame has passed
+static void rf_posix_finish(rf_posix_air_t *a)
+{
+	rf_posix_frame_t *f = &a->f;
+	rf_posix_frame_t ack;
+	uint8_t lost;
+
+	lost = a->collided || ((nrand48(rf_posix_rand) % 100) < a->loss);
+
+	if(f->flags & RF_POSIX_FLAG_ACK){
+		if(rf_posix_ack_wait && !lost && f->dest == rfSettings.myAddr &&
+				f->seq == rf_posix_ack_seq && f->start_ns <= rf_posix_ack_deadline){
+			rf_posix_ack_got = 1;
+			rf_posix_stats.rx_acks++;
+		}
+		return;
+	}
+
+	// Address recognition happens before anything is counted
+	if(rf_posix_addr_decode &&
+			((f->dest != rfSettings.myAddr && f->dest != 0xFFFF) ||
+			 (f->pan != rfSettings.panId && f->pan != 0xFFFF && rfSettings.panId != 0xFFFF)))
+		return;
+
+	if(rf_posix_sleeping || rf_posix_rx_since == 0 || rf_posix_rx_since > f->start_ns ||
+			(f->start_ns < rf_posix_tx_end && rf_posix_tx_start < f->end_ns)){
+		rf_posix_stats.rx_missed++;
+		return;
+	}
+	if(a->collided){
+		rf_posix_stats.rx_collided++;
+		return;
+	}
+	if(lost){
+		rf_posix_stats.rx_lost++;
+		return;
+	}
+	if(rx_ready){
+		rf_posix_stats.rx_overrun++;
+		return;
+	}
+
+	rf_posix_rx_buf = *f;
+	rf_posix_rx_rssi = a->rssi;
+	rf_posix_rx_lqi = (uint8_t)((255 * (100 - a->loss)) / 100);
+	rx_ready = 1;
+	rf_posix_stats.rx_frames++;
+
+	if((f->flags & RF_POSIX_FLAG_ACK_REQ) && rf_posix_auto_ack && f->dest == rfSettings.myAddr){
+		memset(&ack, 0, RF_POSIX_FRAME_HDR);
+		ack.start_ns = f->end_ns + RF_POSIX_TURNAROUND_NS;
+		ack.end_ns = ack.start_ns + rf_posix_airtime(RF_POSIX_ACK_LEN);
+		ack.pan = rfSettings.panId;
+		ack.src = rfSettings.myAddr;
+		ack.dest = f->src;
+		ack.channel = rf_posix_channel;
+		ack.seq = f->seq;
+		ack.flags = RF_POSIX_FLAG_ACK;
+		ack.power = rf_posix_power;
+		rf_posix_send(&ack);
+	}
+
+	if(rx_end_func)
+		rx_end_func();
+}
+
+// Drain the ether and finish every frame that is over
+static void rf_posix_service(void)
+{
+	rf_posix_frame_t f;
+	rf_posix_air_t *a;
+	uint64_t now;
+	ssize_t n;
+	uint8_t i;
+
+	if(rf_posix_sock < 0 || rf_posix_busy)
+		return;
+	rf_posix_busy = 1;
+
+	while((n = recv(rf_posix_sock, &f, sizeof(f), MSG_DONTWAIT)) >= (ssize_t)RF_POSIX_FRAME_HDR){
+		if(f.magic != RF_POSIX_MAGIC || f.station == rf_posix_station)
+			continue;
+		if(n != (ssize_t)(RF_POSIX_FRAME_HDR + f.length) || f.length > RF_MAX_PAYLOAD_SIZE)
+			continue;
+		rf_posix_arrive(&f);
+	}
+
+	now = _nrk_posix_now_ns();
+	rf_posix_next_end = ~0ULL;
+	for(i = 0; i < RF_POSIX_AIR_SLOTS; i++){
+		a = &rf_posix_air[i];
+		if(!a->used)
+			continue;
+		if(a->f.end_ns <= now){
+			rf_posix_finish(a);
+			a->used = 0;
+		}
+		else if(a->f.end_ns < rf_posix_next_end)
+			rf_posix_next_end = a->f.end_ns;
+	}
+	if(rf_posix_next_end != ~0ULL)
+		_nrk_posix_irq_wake(rf_posix_next_end);
+
+	rf_posix_busy = 0;
+}
+
+
+void rf_power_down()
+{
+	rf_posix_service();
+	rf_posix_sleeping = 1;
+	rf_posix_rx_since = 0;
+}
+
+void rf_power_up()
+{
+	rf_posix_sleeping = 0;
+}
+
+void rf_tx_power(uint8_t pwr)
+{
+	rf_posix_power = rf_posix_tx_atten[pwr & 0xF];
+}
+
+void rf_addr_decode_enable()
+{
+	rf_posix_addr_decode = 1;
+}
+
+void rf_addr_decode_disable()
+{
+	rf_posix_addr_decode = 0;
+}
+
+void rf_auto_ack_enable()
+{
+	rf_posix_auto_ack = 1;
+}
+
+void rf_auto_ack_disable()
+{
+	rf_posix_auto_ack = 0;
+}
+
+void rf_addr_decode_set_my_mac(uint16_t my_mac)
+{
+	rfSettings.myAddr = my_mac;
+}
+
+void rf_set_rx(RF_RX_INFO *pRRI, uint8_t channel)
+{
+	rfSettings.pRxInfo = pRRI;
+	rf_posix_channel = channel;
+}
+
+void rx_start_callback(void (*func)(void))
+{
+	rx_start_func = func;
+}
+
+void rx_end_callback(void (*func)(void))
+{
+	rx_end_func = func;
+}
+
+void rf_init(RF_RX_INFO *pRRI, uint8_t channel, uint16_t panId, uint16_t myAddr)
+{
+	rf_posix_open();
+
+	rf_posix_channel = channel;
+	/* CCA_THRES = 0xC5 */
+	rf_posix_cca_dbm = RF_POSIX_ED_BASE + 2 * 5;
+	rf_posix_power = 0;
+	rf_posix_addr_decode = 1;
+	rf_posix_auto_ack = 1;
+
+	/* Initialize settings struct */
+	rfSettings.pRxInfo = pRRI;
+	rfSettings.txSeqNumber = 0;
+	rfSettings.ackReceived = 0;
+	rfSettings.panId = panId;
+	rfSettings.myAddr = myAddr;
+	rfSettings.receiveOn = 0;
+
+	rf_ready = 1;
+	rx_ready = 0;
+	rf_posix_sleeping = 0;
+	rf_posix_rx_since = 0;
+} // rf_init()
+
+void rf_rx_on(void)
+{
+	if(!rf_ready)
+		return;
+	rf_posix_service();
+	rfSettings.receiveOn = 1;
+	if(rf_posix_rx_since == 0)
+		rf_posix_rx_since = _nrk_posix_now_ns();
+}
+
+void rf_polling_rx_on(void)
+{
+	rf_rx_on();
+}
+
+void rf_rx_off(void)
+{
+	rf_posix_service();
+	rfSettings.receiveOn = 0;
+	rf_posix_rx_since = 0;
+	rx_ready = 0;
+}
+
+uint8_t rf_tx_packet(RF_TX_INFO *pRTI)
+{
+	return rf_tx_packet_repeat(pRTI, 0);
+}
+
+uint8_t rf_tx_packet_repeat(RF_TX_INFO *pRTI, uint16_t ms)
+{
+	rf_posix_frame_t f;
+	uint64_t now, stop, air;
+
+	if(!rf_ready || rf_posix_sleeping || rf_posix_sock < 0)
+		return NRK_ERROR;
+	if(pRTI->length < 0 || pRTI->length > RF_MAX_PAYLOAD_SIZE)
+		return NRK_ERROR;
+
+	/* Perform CCA if requested */
+	if(pRTI->cca && rf_cca_check() != 1){
+		rf_posix_stats.tx_cca_fail++;
+		return NRK_ERROR;
+	}
+
+	/* Build the MAC header */
+	rfSettings.txSeqNumber++;
+	f.pan = rfSettings.panId;
+	f.src = rfSettings.myAddr;
+	f.dest = pRTI->destAddr;
+	f.channel = rf_posix_channel;
+	f.seq = rfSettings.txSeqNumber;
+	f.flags = pRTI->ackRequest ? RF_POSIX_FLAG_ACK_REQ : 0;
+	f.power = rf_posix_power;
+	f.length = pRTI->length;
+	memcpy(f.payload, pRTI->pPayload, pRTI->length);
+	air = rf_posix_airtime(RF_POSIX_MAC_HDR + f.length + RF_POSIX_FCS);
+
+	now = _nrk_posix_now_ns();
+	stop = now + (uint64_t)ms * NANOS_PER_MS;
+	rf_posix_tx_start = now;
+	do {
+		f.start_ns = now;
+		f.end_ns = now + air;
+		rf_posix_tx_end = f.end_ns;
+		rf_posix_send(&f);
+		rf_posix_stats.tx_frames++;
+		rf_posix_stats.tx_air_ns += air;
+		_nrk_posix_sleep_until(f.end_ns);
+		now = _nrk_posix_now_ns();
+	} while(ms != 0 && now < stop);
+
+	if(!pRTI->ackRequest)
+		return NRK_OK;
+
+	/* Return an error if no ACK received */
+	rf_posix_ack_seq = f.seq;
+	rf_posix_ack_got = 0;
+	rf_posix_ack_deadline = f.end_ns + RF_POSIX_ACK_WAIT_NS;
+	rf_posix_ack_wait = 1;
+	while(!rf_posix_ack_got && _nrk_posix_now_ns() < rf_posix_ack_deadline + RF_POSIX_ACK_GRACE_NS){
+		_nrk_posix_sleep_until(_nrk_posix_now_ns() + 100000ULL);
+		rf_posix_service();
+	}
+	rf_posix_ack_wait = 0;
+	rfSettings.ackReceived = rf_posix_ack_got;
+	if(!rf_posix_ack_got){
+		rf_posix_stats.tx_no_ack++;
+		return NRK_ERROR;
+	}
+	return NRK_OK;
+}
+
+/* Returns 1 if the channel is clear
+ * Returns 0 if the channel is being used
+ */
+int8_t rf_cca_check()
+{
+	rf_posix_air_t *a;
+	uint64_t now;
+	uint8_t i;
+
+	if(!rf_ready)
+		return NRK_ERROR;
+
+	rf_posix_service();
+	now = _nrk_posix_now_ns();
+	if(now < rf_posix_tx_end)
+		return 0;
+	for(i = 0; i < RF_POSIX_AIR_SLOTS; i++){
+		a = &rf_posix_air[i];
+		if(a->used && a->f.start_ns <= now && now < a->f.end_ns && a->rssi >= rf_posix_cca_dbm){
+			rf_posix_stats.cca_busy++;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int8_t rf_rx_packet_nonblock()
+{
+	int16_t ed;
+
+	if(!rf_ready)
+		return NRK_ERROR;
+
+	rf_posix_service();
+	if(!rx_ready)
+		return 0;
+
+	rfSettings.pRxInfo->seqNumber = rf_posix_rx_buf.seq;
+	rfSettings.pRxInfo->srcAddr = rf_posix_rx_buf.src;
+	rfSettings.pRxInfo->length = rf_posix_rx_buf.length;
+
+	if(rfSettings.pRxInfo->length > rfSettings.pRxInfo->max_length){
+		rx_ready = 0;
+		return NRK_ERROR;
+	}
+
+	memcpy(rfSettings.pRxInfo->pPayload, rf_posix_rx_buf.payload, rf_posix_rx_buf.length);
+	rfSettings.pRxInfo->ackRequest = (rf_posix_rx_buf.flags & RF_POSIX_FLAG_ACK_REQ) ? 1 : 0;
+
+	/* PHY_ED_LEVEL in 1 dB steps, PHY_RSSI in 3 dB steps with RX_CRC_VALID */
+	ed = rf_posix_rx_rssi - RF_POSIX_ED_BASE;
+	if(ed < 0) ed = 0;
+	if(ed > RF_POSIX_ED_MAX) ed = RF_POSIX_ED_MAX;
+	rfSettings.pRxInfo->rssi = ed;
+	rfSettings.pRxInfo->actualRssi = (0x80 | (ed / 3 + 1)) >> 3;
+	rfSettings.pRxInfo->energyDetectionLevel = ed;
+	rfSettings.pRxInfo->linkQualityIndication = rf_posix_rx_lqi;
+
+	rx_ready = 0;
+
+	return NRK_OK;
+}
+
+int8_t rf_rx_packet()
+{
+	uint8_t tmp;
+
+	rf_posix_service();
+	if(rx_ready>0) { tmp=rx_ready; rx_ready=0; return tmp;}
+	return 0;
+}
+
+void rf_set_cca_thresh(int8_t t)
+{
+	/* CCA_ED_THRES: RSSI_BASE_VAL + 2 dB per step */
+	rf_posix_cca_dbm = RF_POSIX_ED_BASE + 2 * (t & 0xF);
+}
+
+void rf_set_channel(uint8_t channel)
+{
+	rf_posix_channel = channel;
+}
+
+uint8_t rf_security_last_pkt_status()
+{
+	return NRK_ERROR;
+}
+
+void rf_security_set_ctr_counter(uint8_t *counter)
+{
+}
+
+void rf_security_set_key(uint8_t *key)
+{
+}
+
+void rf_security_enable()
+{
+}
+
+void rf_security_disable()
+{
+}
+
+uint8_t rf_tx_tdma_packet(RF_TX_INFO *pRTI, uint16_t slot_start_time, uint16_t tx_guard_time)
+{
+	return rf_tx_packet(pRTI);
+}
+
+nrk_sem_t* rf_get_sem()
+{
+	return radio_sem;
+}
+
+void rf_flush_rx_fifo()
+{
+	rx_ready = 0;
+}
+
+uint8_t rf_busy()
+{
+	return _nrk_posix_now_ns() < rf_posix_tx_end;
+}
+
+uint8_t rf_rx_check_fifop()
+{
+	rf_posix_service();
+	return rx_ready;
+}
+
+uint8_t rf_rx_check_sfd()
+{
+	return !rf_cca_check();
+}
+
+void rf_carrier_on()
+{
+}
+
+void rf_carrier_off()
+{
+}
+
+void rf_test_mode()
+{
+}
+
+void rf_data_mode()
+{
+}
+
+void rf_rx_set_serial()
+{
+}
+
+void rf_tx_set_serial()
+{
+}
@@ -0,0 +1,253 @@
+#include <termios.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+
+// Decodes a binary Nano-RK trace dump (see nrk_trace_dump()) into the
+// Chrome trace event JSON format which can be opened in chrome://tracing
+// or https://ui.perfetto.dev
+
+#define TRACE_SWITCH	1
+#define TRACE_SEM_PEND	2
+#define TRACE_SEM_BLOCK	3
+#define TRACE_SEM_POST	4
+#define TRACE_SIG_SEND	5
+#define TRACE_SIG_WAIT	6
+#define TRACE_ISR	7
+#define TRACE_USER	8
+
+#define IDLE_TASK_ID	0
+
+const char *isr_names[] = { "?", "UART0_RX", "EXT_INT0", "EXT_INT1",
+  "EXT_INT2", "PC_INT0", "APP_TIMER" };
+
+void print_usage ();
+
+int read_byte (int fd)
+{
+  uint8_t c;
+  int res;
+
+  do {
+    res = read (fd, &c, 1);
+  } while (res < 0 && errno == EINTR);
+  if (res != 1)
+    return -1;
+  return c;
+}
+
+int read_le (int fd, int bytes, uint32_t * v)
+{
+  int i, c;
+
+  *v = 0;
+  for (i = 0; i < bytes; i++) {
+    c = read_byte (fd);
+    if (c < 0)
+      return -1;
+    *v |= ((uint32_t) c) << (8 * i);
+  }
+  return 0;
+}
+
+void open_serial (int fd)
+{
+  struct termios newtio;
+
+  memset (&newtio, 0, sizeof (newtio));
+  newtio.c_cflag = B115200 | CS8 | CLOCAL | CREAD;
+  newtio.c_iflag = IGNPAR;
+  newtio.c_oflag = 0;
+  newtio.c_lflag = 0;
+  newtio.c_cc[VMIN] = 1;
+  newtio.c_cc[VTIME] = 0;
+  tcflush (fd, TCIFLUSH);
+  tcsetattr (fd, TCSANOW, &newtio);
+}
+
+// Skip any console text until the "NRKT" magic
+int find_magic (int fd)
+{
+  const char *magic = "NRKT";
+  int matched = 0, c;
+
+  while (matched < 4) {
+    c = read_byte (fd);
+    if (c < 0)
+      return -1;
+    if (c == magic[matched])
+      matched++;
+    else
+      matched = (c == magic[0]) ? 1 : 0;
+  }
+  return 0;
+}
+
+void print_event (FILE * fp, int *first, const char *name, const char *ph,
+                  double ts, int tid, double dur)
+{
+  fprintf (fp, "%s\n  {\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+           *first ? "" : ",", name, ph, ts, tid);
+  if (ph[0] == 'X')
+    fprintf (fp, ",\"dur\":%.3f", dur);
+  if (ph[0] == 'i')
+    fprintf (fp, ",\"s\":\"t\"");
+  fprintf (fp, "}");
+  *first = 0;
+}
+
+int main (int argc, char *argv[])
+{
+  int fd, i, first;
+  uint32_t version, entry_size, count, nanos_per_tick, hs_hz;
+  uint32_t type, pid, arg, tick, hs;
+  uint32_t last_tick, base_tick;
+  uint64_t ticks;
+  int have_base, running;
+  double hs_ns, t_us, coarse_us, run_start;
+  char name[64];
+  struct stat st;
+  FILE *fp;
+
+  if (argc < 2 || argc > 3)
+    print_usage ();
+
+  fd = open (argv[1], O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror (argv[1]);
+    exit (-1);
+  }
+  if (fstat (fd, &st) == 0 && S_ISCHR (st.st_mode))
+    open_serial (fd);
+
+  fp = stdout;
+  if (argc == 3) {
+    fp = fopen (argv[2], "w");
+    if (fp == NULL) {
+      perror (argv[2]);
+      exit (-1);
+    }
+  }
+
+  if (find_magic (fd) < 0 ||
+      read_le (fd, 1, &version) < 0 || read_le (fd, 1, &entry_size) < 0 ||
+      read_le (fd, 2, &count) < 0 || read_le (fd, 4, &nanos_per_tick) < 0 ||
+      read_le (fd, 4, &hs_hz) < 0) {
+    fprintf (stderr, "no trace header found\n");
+    exit (-1);
+  }
+  if (version != 1 || entry_size != 7 || hs_hz == 0) {
+    fprintf (stderr, "unsupported trace version %u entry size %u\n",
+             version, entry_size);
+    exit (-1);
+  }
+  hs_ns = 1e9 / (double) hs_hz;
+  fprintf (stderr, "%u events, %u ns/tick, %u Hz high speed timer\n", count,
+           nanos_per_tick, hs_hz);
+
+  fprintf (fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  first = 1;
+  ticks = 0;
+  last_tick = 0;
+  have_base = 0;
+  base_tick = 0;
+  running = -1;
+  run_start = 0;
+
+  for (i = 0; i < count; i++) {
+    if (read_le (fd, 1, &type) < 0 || read_le (fd, 1, &pid) < 0 ||
+        read_le (fd, 1, &arg) < 0 || read_le (fd, 2, &tick) < 0 ||
+        read_le (fd, 2, &hs) < 0) {
+      fprintf (stderr, "trace truncated after %d events\n", i);
+      break;
+    }
+
+    // Unwrap the 16 bit tick counter
+    if (i > 0)
+      ticks += (uint16_t) (tick - last_tick);
+    last_tick = tick;
+    coarse_us = (double) ticks * nanos_per_tick / 1000.0;
+
+    // The high speed timer restarts at each scheduler entry, which is
+    // recorded by the switch event.  Add as many 16 bit timer wraps as
+    // needed to land closest to the coarse tick time.
+    if (type == TRACE_SWITCH) {
+      have_base = 1;
+      base_tick = ticks;
+    }
+    if (have_base) {
+      double base_us = (double) base_tick * nanos_per_tick / 1000.0;
+      double wrap_us = 65536.0 * hs_ns / 1000.0;
+      t_us = base_us + hs * hs_ns / 1000.0;
+      while (t_us + wrap_us / 2 < coarse_us)
+        t_us += wrap_us;
+    }
+    else
+      t_us = coarse_us;
+
+    switch (type) {
+    case TRACE_SWITCH:
+      if (running >= 0 && t_us > run_start) {
+        sprintf (name, running == IDLE_TASK_ID ? "idle" : "task %d", running);
+        print_event (fp, &first, name, "X", run_start, running,
+                     t_us - run_start);
+      }
+      running = arg;
+      run_start = t_us;
+      break;
+    case TRACE_SEM_PEND:
+      sprintf (name, "sem_pend %u", arg);
+      print_event (fp, &first, name, "i", t_us, (int8_t) pid, 0);
+      break;
+    case TRACE_SEM_BLOCK:
+      sprintf (name, "sem_block %u", arg);
+      print_event (fp, &first, name, "i", t_us, (int8_t) pid, 0);
+      break;
+    case TRACE_SEM_POST:
+      sprintf (name, "sem_post %u", arg);
+      print_event (fp, &first, name, "i", t_us, (int8_t) pid, 0);
+      break;
+    case TRACE_SIG_SEND:
+      sprintf (name, "signal %u", arg);
+      print_event (fp, &first, name, "i", t_us, (int8_t) pid, 0);
+      break;
+    case TRACE_SIG_WAIT:
+      sprintf (name, "wait %u", arg);
+      print_event (fp, &first, name, "i", t_us, (int8_t) pid, 0);
+      break;
+    case TRACE_ISR:
+      sprintf (name, "isr %s",
+               arg < sizeof (isr_names) / sizeof (isr_names[0]) ?
+               isr_names[arg] : "?");
+      print_event (fp, &first, name, "i", t_us, -1, 0);
+      break;
+    case TRACE_USER:
+      sprintf (name, "user %u", arg);
+      print_event (fp, &first, name, "i", t_us, (int8_t) pid, 0);
+      break;
+    default:
+      fprintf (stderr, "unknown event type %u\n", type);
+      break;
+    }
+  }
+
+  fprintf (fp, "\n]}\n");
+  if (fp != stdout)
+    fclose (fp);
+  close (fd);
+  return 0;
+}
+
+void print_usage ()
+{
+  printf ("Usage: TraceScope com-port|dump-file [json-file]\n");
+  printf ("  Ex: TraceScope /dev/ttyUSB1 trace.json\n");
+  printf ("  Ex: TraceScope dump.bin > trace.json\n\n");
+  exit (-1);
+}
@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * blockdiff - block level patch generator for phoenix (update mode 3)
+ *
+ * Unlike nanodiff, which builds an edit script byte by byte in O(old * new)
+ * memory, blockdiff describes the new image as runs copied out of the old
+ * (running) image plus the bytes that have no match, in linear memory. A
+ * rebuilt image is mostly the old code shifted around, so a small fix costs
+ * a few hundred bytes of airtime instead of the whole image.
+ *
+ * Patch file:
+ *   byte 0      checksum of the old image (taken by binder as UpdateChecksum)
+ *   byte 1      checksum of the new image
+ *   byte 2,3    new image size (big endian)
+ *   ops         until the new image is complete
+ *     0lllllll                      INSERT l+1 bytes, which follow
+ *     1lllllll llllllll aaaa aaaa   COPY l bytes from old image offset a
+ */
+
+#define MAX_SIZE	(48*1024)
+
+#define HASH_BITS	14
+#define HASH_SIZE	(1 << HASH_BITS)
+#define HASH_KEY	4	// bytes hashed to find match candidates
+#define MAX_CHAIN	256	// candidates tried per position
+
+#define MIN_COPY	6	// shorter matches cost more than their bytes
+#define MAX_COPY	0x7FFF
+#define MAX_INSERT	128
+
+#define NO_POS		0xFFFF
+
+unsigned char nfile[MAX_SIZE];
+unsigned char ofile[MAX_SIZE];
+unsigned char pfile[2 * MAX_SIZE];
+
+unsigned short head[HASH_SIZE];
+unsigned short chain[MAX_SIZE];
+
+unsigned int m, n, p_count;
+unsigned int copy_ops, insert_ops, copied, inserted;
+
+// Function to compute image checksum
+unsigned char computeCRC(unsigned char *file, unsigned int len);
+
+unsigned int readFile(char *name, unsigned char *file);
+unsigned short hash(unsigned char *key);
+void indexOld(void);
+unsigned int findMatch(unsigned int pos, unsigned int *src);
+void encodeInsert(unsigned int pos, unsigned int len);
+void encodeCopy(unsigned int src, unsigned int len);
+
+
+int main(int argc, char *argv[])
+{
+  unsigned int i, lit, src, len, expect;
+  FILE *patchFile;
+
+  if (argc != 4)
+  {
+    printf("Invalid Number of Arguments\n");
+    printf("Usage: blockdiff <oldfile> <newfile> <patchfile>\n");
+    return 1;
+  }
+
+  n = readFile(argv[1], ofile);
+  m = readFile(argv[2], nfile);
+
+  printf("\noldFile Size: %d Bytes\n", n);
+  printf("newFile Size: %d Bytes\n", m);
+
+  // Header
+  pfile[0] = computeCRC(ofile, n);
+  pfile[1] = computeCRC(nfile, m);
+  pfile[2] = (unsigned char)(m >> 8);
+  pfile[3] = (unsigned char)m;
+  p_count = 4;
+
+  indexOld();
+
+  printf("\nDiffing...Wait\n");
+
+  // Greedy: take the longest match at each position, otherwise the byte
+  // joins the pending literal run
+  i = 0;
+  lit = 0;
+  expect = NO_POS;
+  while(i < m)
+  {
+    len = findMatch(i, &src);
+
+    // The old image shifted past a changed byte often lines up again where
+    // the last copy left off
+    if(expect != NO_POS && expect < n)
+    {
+      unsigned int l = 0;
+      while(i + l < m && expect + l < n && l < MAX_COPY &&
+            nfile[i + l] == ofile[expect + l])
+        l++;
+      if(l >= len)
+      {
+        len = l;
+        src = expect;
+      }
+    }
+
+    if(len < MIN_COPY)
+    {
+      i++;
+      lit++;
+      if(expect != NO_POS)
+        expect++;
+      continue;
+    }
+
+    // Grow the match back over bytes left pending as literals
+    while(lit > 0 && src > 0 && len < MAX_COPY &&
+          nfile[i - 1] == ofile[src - 1])
+    {
+      i--;
+      src--;
+      lit--;
+      len++;
+    }
+
+    encodeInsert(i - lit, lit);
+    lit = 0;
+    encodeCopy(src, len);
+    i += len;
+    expect = src + len;
+  }
+  encodeInsert(i - lit, lit);
+
+  if((patchFile = fopen(argv[3],"wb")) == NULL)
+  { // open a file
+    printf("Could not open <patchfile>\n"); // print an error
+    exit(1);
+  }
+  fwrite(pfile, sizeof(char), p_count, patchFile);
+  fclose(patchFile);
+
+  printf("\nOld File CheckSUM: 0x%x\n", pfile[0]);
+  printf("New File CheckSUM: 0x%x\n", pfile[1]);
+  printf("\nCOPY: %d ops, %d Bytes\n", copy_ops, copied);
+  printf("INSERT: %d ops, %d Bytes\n", insert_ops, inserted);
+  printf("\nPatch Size: %d Bytes (%d%% of newFile)\n", p_count,
+         m ? (p_count * 100) / m : 0);
+
+  if(p_count >= m)
+    printf("Patch is no smaller than newFile, send the full image instead\n");
+
+  return 0;
+}
+
+/*
+ * Reads a whole image, exits if it does not fit in the load section
+ */
+unsigned int readFile(char *name, unsigned char *file)
+{
+  FILE *f;
+  unsigned int len;
+
+  if((f = fopen(name,"rb")) == NULL)
+  { // open a file
+    printf("Could not open <%s>\n", name); // print an error
+    exit(1);
+  }
+
+  len = fread(file, sizeof(char), MAX_SIZE, f);
+  if(fgetc(f) != EOF)
+  {
+    printf("<%s> is larger than %d Bytes\n", name, MAX_SIZE);
+    exit(1);
+  }
+  fclose(f);
+
+  return len;
+}
+
+unsigned short hash(unsigned char *key)
+{
+  unsigned long h;
+
+  h = ((unsigned long)key[0] << 24) | ((unsigned long)key[1] << 16) |
+      ((unsigned long)key[2] << 8) | key[3];
+  return (unsigned short)((h * 2654435761UL) >> (32 - HASH_BITS)) & (HASH_SIZE - 1);
+}
+
+/*
+ * Chains every offset of the old image under the hash of the bytes there,
+ * latest first
+ */
+void indexOld(void)
+{
+  unsigned int j;
+  unsigned short h;
+
+  for(j = 0; j < HASH_SIZE; j++)
+    head[j] = NO_POS;
+
+  for(j = 0; j + HASH_KEY <= n; j++)
+  {
+    h = hash(&ofile[j]);
+    chain[j] = head[h];
+    head[h] = j;
+  }
+}
+
+/*
+ * Returns the length of the longest old image run matching the new image at
+ * pos, and where it starts in src
+ */
+unsigned int findMatch(unsigned int pos, unsigned int *src)
+{
+  unsigned int j, l, best = 0, tries = 0;
+
+  if(pos + HASH_KEY > m)
+    return 0;
+
+  for(j = head[hash(&nfile[pos])]; j != NO_POS && tries < MAX_CHAIN; j = chain[j])
+  {
+    tries++;
+    l = 0;
+    while(pos + l < m && j + l < n && l < MAX_COPY && nfile[pos + l] == ofile[j + l])
+      l++;
+    if(l > best)
+    {
+      best = l;
+      *src = j;
+    }
+  }
+
+  return best;
+}
+
+void encodeInsert(unsigned int pos, unsigned int len)
+{
+  unsigned int l;
+
+  while(len > 0)
+  {
+    l = (len > MAX_INSERT) ? MAX_INSERT : len;
+    pfile[p_count++] = (unsigned char)(l - 1);
+    memcpy(&pfile[p_count], &nfile[pos], l);
+    p_count += l;
+    pos += l;
+    len -= l;
+    insert_ops++;
+    inserted += l;
+  }
+}
+
+void encodeCopy(unsigned int src, unsigned int len)
+{
+  //endian independent
+  pfile[p_count++] = (unsigned char)(0x80 | (len >> 8));
+  pfile[p_count++] = (unsigned char)len;
+  pfile[p_count++] = (unsigned char)(src >> 8);
+  pfile[p_count++] = (unsigned char)src;
+  copy_ops++;
+  copied += len;
+}
+
+unsigned char computeCRC(unsigned char *file, unsigned int len)
+{
+  unsigned int i;
+  unsigned char data = 0;
+
+  for ( i = 0; i < len; i++ )
+  {
+    data += file[i];
+  }
+  return data;
+}